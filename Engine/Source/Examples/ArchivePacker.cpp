@@ -0,0 +1,85 @@
+#include "Log.hpp"
+#include "Platform.hpp"
+#include "PackedArchive.hpp"
+
+#include <vector>
+#include <utility>
+#include <string_view>
+
+using namespace worse;
+
+// ArchivePacker [--no-compress] [directory output]...
+// packs the bundled Binary and Shaders directories to Intermediate/Archives
+// when none is given, builds with WS_ENGINE_MOUNT_ARCHIVES mount them from there
+int main(int argc, char** argv)
+{
+    Logger::initialize();
+
+    bool compress = true;
+    std::vector<std::filesystem::path> arguments;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string_view{argv[i]} == "--no-compress")
+        {
+            compress = false;
+        }
+        else
+        {
+            arguments.emplace_back(argv[i]);
+        }
+    }
+
+    if (arguments.size() % 2 != 0)
+    {
+        WS_LOG_ERROR("ArchivePacker", "Expected pairs of directory and output archive");
+        Logger::shutdown();
+        return 1;
+    }
+
+    std::vector<std::pair<std::filesystem::path, std::filesystem::path>> jobs;
+    for (usize i = 0; i < arguments.size(); i += 2)
+    {
+        jobs.emplace_back(arguments[i], arguments[i + 1]);
+    }
+    if (jobs.empty())
+    {
+        // outside the source tree, the archives are build output
+        std::filesystem::path const engine = EngineDirectory;
+        for (char const* name : {"Binary", "Shaders"})
+        {
+            jobs.emplace_back(engine / name, PackedArchive::getEngineArchivePath(name));
+        }
+    }
+
+    u32 failed = 0;
+    PackedArchiveStatistics total;
+    for (auto const& [directory, output] : jobs)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(output.parent_path(), ec);
+
+        PackedArchiveStatistics statistics;
+        if (!PackedArchive::build(directory, output, compress, &statistics))
+        {
+            ++failed;
+            continue;
+        }
+        total.fileCount += statistics.fileCount;
+        total.compressedCount += statistics.compressedCount;
+        total.sourceBytes += statistics.sourceBytes;
+        total.archiveBytes += statistics.archiveBytes;
+        total.elapsedMs += statistics.elapsedMs;
+    }
+
+    WS_LOG_INFO("ArchivePacker",
+                "Total: {} files, {} compressed, failed {} in {:.2f} ms, {:.1f} MB -> {:.1f} MB",
+                total.fileCount,
+                total.compressedCount,
+                failed,
+                total.elapsedMs,
+                total.sourceBytes / (1024.0 * 1024.0),
+                total.archiveBytes / (1024.0 * 1024.0));
+
+    Logger::shutdown();
+    return failed ? 1 : 0;
+}
@@ -8,6 +8,7 @@
 #include "Window.hpp"
 #include "Engine.hpp"
 #include "Renderer.hpp"
+#include "RenderGraph.hpp"
 #include "Input/Input.hpp"
 #include "Profiling/Stopwatch.hpp"
 #include "ImGuiRenderer.hpp"
@@ -52,7 +53,8 @@ public:
     static void initialize(
         ecs::Commands commands,
         ecs::ResourceArray<StandardMaterial> materials,
-        ecs::Resource<glTFManager> gltfManager)
+        ecs::Resource<glTFManager> gltfManager,
+        ecs::Resource<AssetServer> assetServer)
     {
         // clang-format off
         Camera& camera = commands.emplaceResource<Camera>()
@@ -125,6 +127,11 @@ public:
             ImGui::End();
         });
 
+        ImGuiRenderer::registerAlwaysRenderPage([assetServer = &(*assetServer)](ecs::Commands, ecs::Resource<GlobalContext>)
+        {
+            ImGuiRenderer::drawMemoryStatistics(assetServer);
+            ImGuiRenderer::drawRendererStatistics();
+        });
         // clang-format on
 
         gltfManager->load(std::string(EngineDirectory) + "/Binary/Models/DamagedHelmet/glTF-Binary/DamagedHelmet.glb", "helmet");
@@ -133,7 +140,8 @@ public:
     static void inputControll(
         ecs::Commands commands,
         ecs::Resource<Camera> camera,
-        ecs::Resource<GlobalContext> globalContext)
+        ecs::Resource<GlobalContext> globalContext,
+        ecs::ResourceArray<TextureWrite> textureWrites)
     {
         if (Input::isKeyDown(KeyCode::Escape))
         {
@@ -245,6 +253,46 @@ public:
         {
             globalContext->isWireFrameMode = !globalContext->isWireFrameMode;
         }
+
+        if (Input::isKeyDown(KeyCode::C))
+        {
+            globalContext->isAsyncComputeMode = !globalContext->isAsyncComputeMode;
+        }
+
+        if (Input::isKeyDown(KeyCode::G))
+        {
+            Renderer::getRenderGraph()->dumpToFile("render_graph.dot");
+        }
+
+        // 无绑定纹理压力测试: 追加/移除 10k 个槽位, 观察 updateBuffers 耗时
+        if (Input::isKeyDown(KeyCode::B))
+        {
+            static constexpr usize STRESS_TEXTURE_COUNT = 10000;
+            static usize stressBegin                    = 0;
+
+            std::vector<TextureWrite>& writes = textureWrites->data();
+            if (stressBegin == 0)
+            {
+                stressBegin = writes.size();
+
+                usize index = static_cast<usize>(RendererTexture::Max);
+                for (TextureWrite const& write : writes)
+                {
+                    index = std::max(index, write.index + 1);
+                }
+                for (usize i = 0; i < STRESS_TEXTURE_COUNT; ++i)
+                {
+                    writes.push_back(TextureWrite{Renderer::getTexture(RendererTexture::DefaultAlbedo), index + i});
+                }
+            }
+            else
+            {
+                writes.resize(stressBegin);
+                stressBegin = 0;
+            }
+            Renderer::invalidateBindlessTextures();
+            WS_LOG_INFO("Example", "Bindless stress textures {}", stressBegin ? "on" : "off");
+        }
     }
 
     static void setupScene(
@@ -0,0 +1,216 @@
+#include "Log.hpp"
+#include "FileStream.hpp"
+#include "ThreadPool.hpp"
+#include "PackedArchive.hpp"
+#include "VirtualFileSystem.hpp"
+#include "Profiling/Stopwatch.hpp"
+
+#include <span>
+#include <limits>
+#include <string>
+#include <vector>
+#include <future>
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace worse;
+
+namespace
+{
+    struct FileSet
+    {
+        char const* name;
+        std::vector<std::filesystem::path> paths;
+        u64 bytes = 0;
+    };
+
+    FileSet writeFiles(std::filesystem::path const& directory, char const* name, u32 const count, u64 const size)
+    {
+        FileSet set;
+        set.name = name;
+
+        std::filesystem::create_directories(directory);
+        std::vector<byte> data(size);
+        for (u32 i = 0; i < count; ++i)
+        {
+            for (u64 j = 0; j < size; ++j)
+            {
+                data[j] = static_cast<byte>((i * 131 + j * 7) & 0xff);
+            }
+
+            std::filesystem::path path = directory / ("file_" + std::to_string(i) + ".bin");
+            FileStream stream(path, FileStreamUsageFlagBits::Write);
+            stream.write(data.data(), data.size());
+            stream.close();
+
+            set.paths.push_back(std::move(path));
+            set.bytes += size;
+        }
+        return set;
+    }
+
+    // drops the files from the page cache so the reads go to the device,
+    // false where that is not possible and every pass reads cached pages
+    bool evict(std::span<std::filesystem::path const> paths)
+    {
+#if defined(__linux__)
+        bool evicted = true;
+        for (std::filesystem::path const& path : paths)
+        {
+            int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            evicted      = evicted && (fd >= 0) && (fdatasync(fd) == 0) && (posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0);
+            if (fd >= 0)
+            {
+                ::close(fd);
+            }
+        }
+        return evicted;
+#else
+        return false;
+#endif
+    }
+
+    // one file after the other on the calling thread
+    u64 readBlocking(FileSet const& set)
+    {
+        u64 bytes = 0;
+        for (std::filesystem::path const& path : set.paths)
+        {
+            FileStream stream(path, FileStreamUsageFlagBits::Read);
+            bytes += stream.readBytes().size();
+        }
+        return bytes;
+    }
+
+    // every file submitted at once, then collected
+    template <typename ReadFn>
+    u64 readConcurrently(FileSet const& set, ReadFn&& read)
+    {
+        std::vector<std::shared_future<std::vector<byte>>> reads;
+        reads.reserve(set.paths.size());
+        for (std::filesystem::path const& path : set.paths)
+        {
+            reads.push_back(read(path));
+        }
+
+        u64 bytes = 0;
+        for (std::shared_future<std::vector<byte>> const& read : reads)
+        {
+            bytes += read.get().size();
+        }
+        return bytes;
+    }
+
+    // storage is what the reads hit on disk, the files or their archive
+    template <typename PassFn>
+    void measure(FileSet const& set, std::span<std::filesystem::path const> storage, char const* mode, u32 const runs, PassFn&& pass)
+    {
+        f32 best     = std::numeric_limits<f32>::max();
+        bool isCold  = true;
+        bool isValid = true;
+        for (u32 i = 0; i < runs; ++i)
+        {
+            isCold = evict(storage) && isCold;
+
+            profiling::Stopwatch stopwatch;
+            u64 const bytes = pass();
+            best            = std::min(best, stopwatch.elapsedMs());
+            isValid         = isValid && (bytes == set.bytes);
+        }
+
+        f64 const seconds = std::max(best / 1000.0, 1e-6);
+        WS_LOG_INFO("FileBenchmark",
+                    "{:<6} {:<14} {:9.2f} ms {:9.0f} files/s {:8.1f} MB/s{}{}",
+                    set.name,
+                    mode,
+                    best,
+                    set.paths.size() / seconds,
+                    set.bytes / (1024.0 * 1024.0) / seconds,
+                    isCold ? "" : " (cached)",
+                    isValid ? "" : " SIZE MISMATCH");
+    }
+} // namespace
+
+// FileBenchmark [--small COUNT SIZE] [--large COUNT SIZE] [--runs N]
+// writes the file sets to the temp directory and times blocking reads,
+// readAsync with every read in flight, and readAsync from a packed archive
+int main(int argc, char** argv)
+{
+    Logger::initialize();
+    ThreadPool::initialize();
+
+    u32 smallCount = 2000;
+    u64 smallSize  = 4 * 1024;
+    u32 largeCount = 4;
+    u64 largeSize  = 64 * 1024 * 1024;
+    u32 runs       = 3;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view const argument = argv[i];
+        if ((argument == "--small") && (i + 2 < argc))
+        {
+            smallCount = static_cast<u32>(std::max(std::stoi(argv[i + 1]), 1));
+            smallSize  = static_cast<u64>(std::max(std::stoll(argv[i + 2]), 1ll));
+            i += 2;
+        }
+        else if ((argument == "--large") && (i + 2 < argc))
+        {
+            largeCount = static_cast<u32>(std::max(std::stoi(argv[i + 1]), 1));
+            largeSize  = static_cast<u64>(std::max(std::stoll(argv[i + 2]), 1ll));
+            i += 2;
+        }
+        else if ((argument == "--runs") && (i + 1 < argc))
+        {
+            runs = static_cast<u32>(std::max(std::stoi(argv[++i]), 1));
+        }
+    }
+
+    std::filesystem::path const directory = std::filesystem::temp_directory_path() / "worse_FileBenchmark";
+    std::filesystem::remove_all(directory);
+
+    WS_LOG_INFO("FileBenchmark", "readAsync backend: {}", FileStream::getAsyncBackendName());
+
+    for (FileSet const& set : {writeFiles(directory / "small", "small", smallCount, smallSize),
+                               writeFiles(directory / "large", "large", largeCount, largeSize)})
+    {
+        measure(set, set.paths, "blocking", runs, [&set]() { return readBlocking(set); });
+        measure(set, set.paths, "readAsync", runs,
+                [&set]()
+                {
+                    return readConcurrently(set,
+                                            [](std::filesystem::path const& path)
+                                            {
+                                                return FileStream::readAsync(path);
+                                            });
+                });
+
+        // uncompressed, the entries are ranges of the one archive file
+        std::filesystem::path const source  = set.paths.front().parent_path();
+        std::filesystem::path const archive = std::filesystem::path{source}.concat(PackedArchive::EXTENSION);
+        if (PackedArchive::build(source, archive, false) && VirtualFileSystem::mount(source, archive))
+        {
+            measure(set, {&archive, 1}, "archive async", runs,
+                    [&set]()
+                    {
+                        return readConcurrently(set,
+                                                [](std::filesystem::path const& path)
+                                                {
+                                                    return VirtualFileSystem::readAsync(path);
+                                                });
+                    });
+            VirtualFileSystem::unmountAll();
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+
+    ThreadPool::shutdown();
+    Logger::shutdown();
+    return 0;
+}
@@ -0,0 +1,374 @@
+#include "Log.hpp"
+#include "FileSystem.hpp"
+#include "ThreadPool.hpp"
+#include "TextureImporter.hpp"
+#include "Profiling/Stopwatch.hpp"
+
+#include "fastgltf/core.hpp"
+#include "fastgltf/tools.hpp"
+
+#define STB_IMAGE_RESIZE_IMPLEMENTATION
+#include "stb_image_resize2.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <string_view>
+
+using namespace worse;
+
+namespace
+{
+    // one plane per channel, a cleared bit in mask leaves the channel null
+    struct Planes
+    {
+        std::vector<u8> storage[4];
+        u8 const* pointers[4] = {};
+    };
+
+    Planes makePlanes(usize const texelCount, u32 const mask, std::mt19937& random)
+    {
+        Planes planes;
+        for (usize c = 0; c < 4; ++c)
+        {
+            if (mask & (1u << c))
+            {
+                planes.storage[c].resize(texelCount);
+                std::generate(planes.storage[c].begin(), planes.storage[c].end(), [&random]() { return static_cast<u8>(random()); });
+                planes.pointers[c] = planes.storage[c].data();
+            }
+        }
+        return planes;
+    }
+
+    // the SSE2 loop handles 16 texels at a time, the sizes cover empty,
+    // partial and whole blocks and a large texture with a tail
+    bool checkPacking()
+    {
+        std::mt19937 random{42};
+        usize const texelCounts[] = {0, 1, 15, 16, 17, 31, 33, 1000, 4096 * 7 + 13};
+
+        for (usize const texelCount : texelCounts)
+        {
+            for (u32 mask = 0; mask < 16; ++mask)
+            {
+                Planes const planes = makePlanes(texelCount, mask, random);
+
+                // poisoned so bytes that are never written show up as well
+                std::vector<byte> scalar(texelCount * 4, byte{0xcd});
+                std::vector<byte> vectorized(texelCount * 4, byte{0xcd});
+                TextureImporter::packChannels(planes.pointers, scalar.data(), texelCount, false);
+                TextureImporter::packChannels(planes.pointers, vectorized.data(), texelCount, true);
+
+                if (!scalar.empty() && (std::memcmp(scalar.data(), vectorized.data(), scalar.size()) != 0))
+                {
+                    WS_LOG_ERROR("TextureBenchmark", "Packing differs for {} texels, channel mask {:#x}", texelCount, mask);
+                    return false;
+                }
+            }
+        }
+
+        WS_LOG_INFO("TextureBenchmark", "Vectorized packing matches the scalar path");
+        return true;
+    }
+
+    // best of runs, the first call also faults the destination in
+    f32 measurePacking(Planes const& planes, std::vector<byte>& dst, usize const texelCount, bool const vectorized, u32 const runs)
+    {
+        f32 best = std::numeric_limits<f32>::max();
+        for (u32 i = 0; i < runs; ++i)
+        {
+            profiling::Stopwatch stopwatch;
+            TextureImporter::packChannels(planes.pointers, dst.data(), texelCount, vectorized);
+            best = std::min(best, stopwatch.elapsedMs());
+        }
+        return best;
+    }
+
+    // single channel sources that hand out a prepared plane, so combine
+    // is measured without image decoding
+    std::optional<TextureLoadView> makeChannelView(std::vector<u8> const& plane, u32 const size)
+    {
+        TextureLoadView view;
+        view.width             = static_cast<i32>(size);
+        view.height            = static_cast<i32>(size);
+        view.depth             = 1;
+        view.layers            = 1;
+        view.mipLevels         = 1;
+        view.type              = RHITextureType::Texture2D;
+        view.format            = RHIFormat::R8G8B8A8Unorm;
+        view.size              = plane.size() * 4;
+        view.deferredChannelFn = [&plane](byte* dst)
+        {
+            std::memcpy(dst, plane.data(), plane.size());
+        };
+        return view;
+    }
+
+    // identical data caps at 99 dB
+    f64 computePsnr(byte const* a, byte const* b, usize const size)
+    {
+        f64 error = 0.0;
+        for (usize i = 0; i < size; ++i)
+        {
+            f64 const difference = static_cast<f64>(a[i]) - static_cast<f64>(b[i]);
+            error += difference * difference;
+        }
+        f64 const mse = error / static_cast<f64>(std::max<usize>(size, 1));
+        return (mse > 0.0) ? std::min(10.0 * std::log10(255.0 * 255.0 / mse), 99.0) : 99.0;
+    }
+
+    struct MipReport
+    {
+        u32 imageCount     = 0;
+        usize baseBytes    = 0;
+        usize chainBytes   = 0;
+        f32 generateMs     = 0.0f;
+        f64 worstBoxPsnr   = 99.0;
+        f64 worstSharpPsnr = 99.0;
+    };
+
+    // times generateMips on one decoded image and compares every level with
+    // a float resample straight from mip 0, a box filter shows the error the
+    // chained 8 bit filtering adds, Mitchell how far it is from a sharper
+    // filter. precompressed .dds chains are skipped
+    void reportMips(std::string const& name, std::optional<TextureLoadView> view, u32 const runs, MipReport& report)
+    {
+        if (!view || (view->format != RHIFormat::R8G8B8A8Unorm))
+        {
+            return;
+        }
+
+        u32 const width    = static_cast<u32>(view->width);
+        u32 const height   = static_cast<u32>(view->height);
+        u32 const mipCount = static_cast<u32>(view->mipLevels);
+
+        std::vector<byte> chain(TextureImporter::getChainSize(RHIFormat::R8G8B8A8Unorm, width, height, mipCount));
+        view->deferredCopyFn(chain.data());
+
+        // mip 0 is only read, every run regenerates the same levels
+        f32 generateMs = std::numeric_limits<f32>::max();
+        for (u32 i = 0; i < runs; ++i)
+        {
+            profiling::Stopwatch stopwatch;
+            TextureImporter::generateMips(width, height, mipCount, chain.data());
+            generateMs = std::min(generateMs, stopwatch.elapsedMs());
+        }
+
+        f64 boxPsnr   = 99.0;
+        f64 sharpPsnr = 99.0;
+        std::vector<byte> reference;
+        usize offset = TextureImporter::getMipSize(RHIFormat::R8G8B8A8Unorm, width, height, 0);
+        for (u32 level = 1; level < mipCount; ++level)
+        {
+            i32 const levelWidth  = static_cast<i32>(std::max(width >> level, 1u));
+            i32 const levelHeight = static_cast<i32>(std::max(height >> level, 1u));
+            usize const size      = TextureImporter::getMipSize(RHIFormat::R8G8B8A8Unorm, width, height, level);
+            reference.resize(size);
+
+            for (stbir_filter const filter : {STBIR_FILTER_BOX, STBIR_FILTER_MITCHELL})
+            {
+                stbir_resize(chain.data(), static_cast<i32>(width), static_cast<i32>(height), 0,
+                             reference.data(), levelWidth, levelHeight, 0,
+                             STBIR_4CHANNEL, STBIR_TYPE_UINT8, STBIR_EDGE_CLAMP, filter);
+                f64& psnr = (filter == STBIR_FILTER_BOX) ? boxPsnr : sharpPsnr;
+                psnr      = std::min(psnr, computePsnr(chain.data() + offset, reference.data(), size));
+            }
+            offset += size;
+        }
+
+        usize const baseBytes = TextureImporter::getMipSize(RHIFormat::R8G8B8A8Unorm, width, height, 0);
+        WS_LOG_INFO("TextureBenchmark",
+                    "{}: {}x{}, {} mips, upload {} -> {} bytes, generate {:.2f} ms, worst level PSNR box {:.1f} dB, Mitchell {:.1f} dB",
+                    name,
+                    width,
+                    height,
+                    mipCount,
+                    baseBytes,
+                    chain.size(),
+                    generateMs,
+                    boxPsnr,
+                    sharpPsnr);
+
+        ++report.imageCount;
+        report.baseBytes += baseBytes;
+        report.chainBytes += chain.size();
+        report.generateMs += generateMs;
+        report.worstBoxPsnr   = std::min(report.worstBoxPsnr, boxPsnr);
+        report.worstSharpPsnr = std::min(report.worstSharpPsnr, sharpPsnr);
+    }
+
+    // images of a directory, a glTF model or a single image file
+    void reportMipsOf(std::filesystem::path const& path, u32 const runs, MipReport& report)
+    {
+        if (std::filesystem::is_directory(path))
+        {
+            std::vector<std::filesystem::path> files;
+            for (std::filesystem::directory_entry const& entry : std::filesystem::recursive_directory_iterator(path))
+            {
+                if (entry.is_regular_file())
+                {
+                    files.push_back(entry.path());
+                }
+            }
+            std::sort(files.begin(), files.end());
+            for (std::filesystem::path const& file : files)
+            {
+                if (FileSystem::isSupportedImage(file) || (file.extension() == ".glb") || (file.extension() == ".gltf"))
+                {
+                    reportMipsOf(file, runs, report);
+                }
+            }
+            return;
+        }
+
+        if ((path.extension() != ".glb") && (path.extension() != ".gltf"))
+        {
+            reportMips(path.string(), TextureImporter::fromFile(path), runs, report);
+            return;
+        }
+
+        auto data = fastgltf::GltfDataBuffer::FromPath(path);
+        if (data.error() != fastgltf::Error::None)
+        {
+            WS_LOG_ERROR("TextureBenchmark", "Failed to read {}", path.string());
+            return;
+        }
+
+        fastgltf::Parser parser;
+        auto asset = parser.loadGltf(data.get(), path.parent_path(), fastgltf::Options::LoadExternalBuffers);
+        if (asset.error() != fastgltf::Error::None)
+        {
+            WS_LOG_ERROR("TextureBenchmark", "Failed to parse {}", path.string());
+            return;
+        }
+
+        // the same orientation as the glTF loader
+        for (usize i = 0; i < asset->images.size(); ++i)
+        {
+            std::string const name = path.filename().string() + "#" + std::to_string(i);
+
+            // clang-format off
+            std::visit(fastgltf::visitor{
+                [&](fastgltf::sources::BufferView const& source)
+                {
+                    fastgltf::BufferView const& bufferView = asset->bufferViews[source.bufferViewIndex];
+                    std::visit(fastgltf::visitor{
+                        [&](fastgltf::sources::Array const& array)
+                        {
+                            std::span<byte const> bytes{array.bytes.data() + bufferView.byteOffset, bufferView.byteLength};
+                            reportMips(name, TextureImporter::fromMemory(bytes, name, false), runs, report);
+                        },
+                        [&](fastgltf::sources::Vector const& vector)
+                        {
+                            std::span<byte const> bytes{vector.bytes.data() + bufferView.byteOffset, bufferView.byteLength};
+                            reportMips(name, TextureImporter::fromMemory(bytes, name, false), runs, report);
+                        },
+                        [](auto const&) {}}, asset->buffers[bufferView.bufferIndex].data);
+                },
+                [&](fastgltf::sources::URI const& uri)
+                {
+                    reportMips(name, TextureImporter::fromFile(path.parent_path() / uri.uri.fspath(), 0, false), runs, report);
+                },
+                [](auto const&) {}}, asset->images[i].data);
+            // clang-format on
+        }
+    }
+} // namespace
+
+// TextureBenchmark [--size N] [--runs N] [--mips path]...
+// checks the vectorized channel packing against the scalar path, then
+// times both and a full combine of four size x size channels. with
+// --mips it reports the mip chain upload size, generation time and
+// quality of the images under each path instead
+int main(int argc, char** argv)
+{
+    Logger::initialize();
+    ThreadPool::initialize();
+
+    u32 size = 4096;
+    u32 runs = 10;
+    std::vector<std::filesystem::path> mipPaths;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::string_view{argv[i]} == "--size")
+        {
+            size = static_cast<u32>(std::max(std::stoi(argv[i + 1]), 1));
+        }
+        else if (std::string_view{argv[i]} == "--runs")
+        {
+            runs = static_cast<u32>(std::max(std::stoi(argv[i + 1]), 1));
+        }
+        else if (std::string_view{argv[i]} == "--mips")
+        {
+            mipPaths.emplace_back(argv[i + 1]);
+        }
+    }
+
+    if (!mipPaths.empty())
+    {
+        for (std::filesystem::path const& path : mipPaths)
+        {
+            MipReport report;
+            reportMipsOf(path, runs, report);
+            WS_LOG_INFO("TextureBenchmark",
+                        "{}: {} images, upload {:.2f} -> {:.2f} MB (+{:.1f}%), generate {:.2f} ms, worst PSNR box {:.1f} dB, Mitchell {:.1f} dB",
+                        path.string(),
+                        report.imageCount,
+                        report.baseBytes / (1024.0 * 1024.0),
+                        report.chainBytes / (1024.0 * 1024.0),
+                        100.0 * (static_cast<f64>(report.chainBytes) / std::max<usize>(report.baseBytes, 1) - 1.0),
+                        report.generateMs,
+                        report.worstBoxPsnr,
+                        report.worstSharpPsnr);
+        }
+
+        ThreadPool::shutdown();
+        Logger::shutdown();
+        return 0;
+    }
+
+    bool const matches = checkPacking();
+
+    std::mt19937 random{7};
+    usize const texelCount = static_cast<usize>(size) * size;
+    Planes const planes    = makePlanes(texelCount, 0xf, random);
+    std::vector<byte> dst(texelCount * 4);
+
+    f32 const scalarMs     = measurePacking(planes, dst, texelCount, false, runs);
+    f32 const vectorizedMs = measurePacking(planes, dst, texelCount, true, runs);
+    f64 const megabytes    = dst.size() / (1024.0 * 1024.0);
+    WS_LOG_INFO("TextureBenchmark",
+                "Pack {}x{}: scalar {:.2f} ms ({:.0f} MB/s), vectorized {:.2f} ms ({:.0f} MB/s), {:.1f}x",
+                size,
+                size,
+                scalarMs,
+                megabytes / std::max(scalarMs / 1000.0, 1e-6),
+                vectorizedMs,
+                megabytes / std::max(vectorizedMs / 1000.0, 1e-6),
+                scalarMs / std::max(vectorizedMs, 1e-6f));
+
+    // combine logs its decode and pack split per call
+    f32 combineMs = std::numeric_limits<f32>::max();
+    for (u32 i = 0; i < runs; ++i)
+    {
+        std::optional<TextureLoadView> view = TextureImporter::combine(
+            makeChannelView(planes.storage[0], size),
+            makeChannelView(planes.storage[1], size),
+            makeChannelView(planes.storage[2], size),
+            makeChannelView(planes.storage[3], size));
+
+        profiling::Stopwatch stopwatch;
+        view->deferredCopyFn(dst.data());
+        combineMs = std::min(combineMs, stopwatch.elapsedMs());
+    }
+    WS_LOG_INFO("TextureBenchmark", "Combine {}x{}: best {:.2f} ms over {} runs", size, size, combineMs, runs);
+
+    ThreadPool::shutdown();
+    Logger::shutdown();
+    return matches ? 0 : 1;
+}
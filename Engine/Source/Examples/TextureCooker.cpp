@@ -0,0 +1,62 @@
+#include "Log.hpp"
+#include "Platform.hpp"
+#include "ThreadPool.hpp"
+#include "TextureCooker.hpp"
+
+#include <string_view>
+
+using namespace worse;
+
+// TextureCooker [--force] [directory...]
+// cooks the bundled Binary directories when none is given
+int main(int argc, char** argv)
+{
+    Logger::initialize();
+    ThreadPool::initialize();
+
+    bool force = false;
+    std::vector<std::filesystem::path> directories;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string_view{argv[i]} == "--force")
+        {
+            force = true;
+        }
+        else
+        {
+            directories.emplace_back(argv[i]);
+        }
+    }
+
+    if (directories.empty())
+    {
+        std::filesystem::path const binary = std::filesystem::path{EngineDirectory} / "Binary";
+        directories = {binary / "Textures", binary / "Materials", binary / "Models"};
+    }
+
+    TextureCookStatistics total;
+    for (std::filesystem::path const& directory : directories)
+    {
+        TextureCookStatistics const statistics = TextureCooker::cookDirectory(directory, force);
+        total.cooked += statistics.cooked;
+        total.skipped += statistics.skipped;
+        total.failed += statistics.failed;
+        total.sourceBytes += statistics.sourceBytes;
+        total.cookedBytes += statistics.cookedBytes;
+        total.elapsedMs += statistics.elapsedMs;
+    }
+
+    WS_LOG_INFO("TextureCooker",
+                "Total: cooked {}, up to date {}, failed {} in {:.2f} ms, {:.1f} MB -> {:.1f} MB ({:.1f}x smaller)",
+                total.cooked,
+                total.skipped,
+                total.failed,
+                total.elapsedMs,
+                total.sourceBytes / (1024.0 * 1024.0),
+                total.cookedBytes / (1024.0 * 1024.0),
+                total.cookedBytes ? static_cast<f64>(total.sourceBytes) / total.cookedBytes : 0.0);
+
+    ThreadPool::shutdown();
+    Logger::shutdown();
+    return total.failed ? 1 : 0;
+}
@@ -0,0 +1,331 @@
+#include "Log.hpp"
+#include "Platform.hpp"
+#include "Renderer.hpp"
+#include "glTF/glTF.hpp"
+#include "Engine.hpp"
+
+#include "ECS/Registry.hpp"
+#include "ECS/Resource.hpp"
+#include "ECS/Schedule.hpp"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+#include <cmath>
+#include <format>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
+
+using namespace worse;
+
+namespace
+{
+    // a grid of GRID_CELLS x GRID_CELLS quads per primitive
+    constexpr u32 GRID_CELLS          = 8;
+    constexpr u32 GRID_VERTICES       = (GRID_CELLS + 1) * (GRID_CELLS + 1);
+    constexpr u32 GRID_INDICES        = GRID_CELLS * GRID_CELLS * 6;
+    constexpr u32 PRIMITIVES_PER_MESH = 8;
+    constexpr u32 IMAGE_SIZE          = 1024;
+
+    // pattern with enough detail that the encoded size and decode cost are
+    // close to a real texture
+    void writeSyntheticImage(std::filesystem::path const& path, u32 const seed)
+    {
+        std::vector<u8> pixels(static_cast<usize>(IMAGE_SIZE) * IMAGE_SIZE * 3);
+        for (u32 y = 0; y < IMAGE_SIZE; ++y)
+        {
+            for (u32 x = 0; x < IMAGE_SIZE; ++x)
+            {
+                u32 hash = (x * 73856093u) ^ (y * 19349663u) ^ (seed * 83492791u);
+                hash     = (hash ^ (hash >> 13)) * 0x5bd1e995u;
+
+                u8* pixel      = &pixels[(static_cast<usize>(y) * IMAGE_SIZE + x) * 3];
+                bool const odd = (((x >> 6) + (y >> 6) + seed) & 1) != 0;
+                pixel[0]       = static_cast<u8>((odd ? 160 : 64) + (hash & 31));
+                pixel[1]       = static_cast<u8>((x * 255 / IMAGE_SIZE + seed * 37) & 0xff);
+                pixel[2]       = static_cast<u8>((y * 255 / IMAGE_SIZE) ^ ((hash >> 8) & 15));
+            }
+        }
+        stbi_write_jpg(path.string().c_str(), IMAGE_SIZE, IMAGE_SIZE, 3, pixels.data(), 90);
+    }
+
+    // writes a Sponza sized model: primitiveCount small grids in meshes of
+    // PRIMITIVES_PER_MESH, imageCount external JPEG images and a material
+    // per three images. an existing model with the same counts is reused
+    std::string writeSyntheticModel(u32 const primitiveCount, u32 const imageCount)
+    {
+        std::filesystem::path const directory = std::filesystem::temp_directory_path() / "worse_glTFBenchmark";
+        std::filesystem::path const path      = directory / std::format("synthetic_{}_{}.gltf", primitiveCount, imageCount);
+        if (std::filesystem::exists(path))
+        {
+            return path.string();
+        }
+        std::filesystem::create_directories(directory);
+
+        for (u32 i = 0; i < imageCount; ++i)
+        {
+            writeSyntheticImage(directory / std::format("image_{}.jpg", i), i);
+        }
+
+        // one buffer view per attribute, the primitives' accessors are
+        // consecutive ranges of it
+        usize const positionBytes = static_cast<usize>(primitiveCount) * GRID_VERTICES * sizeof(f32) * 3;
+        usize const uvBytes       = static_cast<usize>(primitiveCount) * GRID_VERTICES * sizeof(f32) * 2;
+        usize const tangentBytes  = static_cast<usize>(primitiveCount) * GRID_VERTICES * sizeof(f32) * 4;
+        usize const indexBytes    = static_cast<usize>(primitiveCount) * GRID_INDICES * sizeof(u32);
+
+        std::vector<f32> positions, normals, uvs, tangents;
+        std::vector<u32> indices;
+        positions.reserve(positionBytes / sizeof(f32));
+        normals.reserve(positionBytes / sizeof(f32));
+        uvs.reserve(uvBytes / sizeof(f32));
+        tangents.reserve(tangentBytes / sizeof(f32));
+        indices.reserve(indexBytes / sizeof(u32));
+
+        std::string accessors;
+        std::string meshes;
+        for (u32 primitive = 0; primitive < primitiveCount; ++primitive)
+        {
+            f32 const phase = static_cast<f32>(primitive) * 0.37f;
+            f32 const left  = static_cast<f32>(primitive % PRIMITIVES_PER_MESH);
+            f32 minZ = 1.0f, maxZ = -1.0f;
+            for (u32 y = 0; y <= GRID_CELLS; ++y)
+            {
+                for (u32 x = 0; x <= GRID_CELLS; ++x)
+                {
+                    f32 const u = static_cast<f32>(x) / GRID_CELLS;
+                    f32 const v = static_cast<f32>(y) / GRID_CELLS;
+                    f32 const z = 0.1f * std::sin(phase + u * 6.0f) * std::cos(phase + v * 6.0f);
+                    minZ        = std::min(minZ, z);
+                    maxZ        = std::max(maxZ, z);
+                    positions.insert(positions.end(), {left + u, v, z});
+                    normals.insert(normals.end(), {0.0f, 0.0f, 1.0f});
+                    uvs.insert(uvs.end(), {u, v});
+                    tangents.insert(tangents.end(), {1.0f, 0.0f, 0.0f, 1.0f});
+                }
+            }
+            for (u32 y = 0; y < GRID_CELLS; ++y)
+            {
+                for (u32 x = 0; x < GRID_CELLS; ++x)
+                {
+                    u32 const corner = y * (GRID_CELLS + 1) + x;
+                    indices.insert(indices.end(), {corner, corner + 1, corner + GRID_CELLS + 2, corner, corner + GRID_CELLS + 2, corner + GRID_CELLS + 1});
+                }
+            }
+
+            usize const vertexOffset = static_cast<usize>(primitive) * GRID_VERTICES;
+            accessors += std::format(
+                R"({{"bufferView":0,"byteOffset":{},"componentType":5126,"count":{},"type":"VEC3","min":[{},0,{}],"max":[{},1,{}]}},)"
+                R"({{"bufferView":1,"byteOffset":{},"componentType":5126,"count":{},"type":"VEC3"}},)"
+                R"({{"bufferView":2,"byteOffset":{},"componentType":5126,"count":{},"type":"VEC2"}},)"
+                R"({{"bufferView":3,"byteOffset":{},"componentType":5126,"count":{},"type":"VEC4"}},)"
+                R"({{"bufferView":4,"byteOffset":{},"componentType":5125,"count":{},"type":"SCALAR"}},)",
+                vertexOffset * 12, GRID_VERTICES, left, minZ, left + 1.0f, maxZ,
+                vertexOffset * 12, GRID_VERTICES,
+                vertexOffset * 8, GRID_VERTICES,
+                vertexOffset * 16, GRID_VERTICES,
+                static_cast<usize>(primitive) * GRID_INDICES * sizeof(u32), GRID_INDICES);
+
+            if (primitive % PRIMITIVES_PER_MESH == 0)
+            {
+                meshes += std::format(R"({}{{"name":"mesh_{}","primitives":[)", primitive == 0 ? "" : "]},", primitive / PRIMITIVES_PER_MESH);
+            }
+            else
+            {
+                meshes += ",";
+            }
+            u32 const accessor = primitive * 5;
+            meshes += std::format(R"({{"attributes":{{"POSITION":{},"NORMAL":{},"TEXCOORD_0":{},"TANGENT":{}}},"indices":{},"material":{}}})",
+                                  accessor, accessor + 1, accessor + 2, accessor + 3, accessor + 4,
+                                  primitive % std::max(imageCount / 3, 1u));
+        }
+        meshes += "]}";
+        accessors.pop_back();
+
+        std::ofstream buffer(directory / std::format("synthetic_{}.bin", primitiveCount), std::ios::binary);
+        buffer.write(reinterpret_cast<char const*>(positions.data()), positionBytes);
+        buffer.write(reinterpret_cast<char const*>(normals.data()), positionBytes);
+        buffer.write(reinterpret_cast<char const*>(uvs.data()), uvBytes);
+        buffer.write(reinterpret_cast<char const*>(tangents.data()), tangentBytes);
+        buffer.write(reinterpret_cast<char const*>(indices.data()), indexBytes);
+        buffer.close();
+
+        std::string images;
+        std::string textures;
+        for (u32 i = 0; i < imageCount; ++i)
+        {
+            images += std::format(R"({}{{"uri":"image_{}.jpg","name":"image_{}"}})", i == 0 ? "" : ",", i, i);
+            textures += std::format(R"({}{{"source":{}}})", i == 0 ? "" : ",", i);
+        }
+
+        // base color, normal and metallic roughness from consecutive images
+        std::string materials;
+        u32 const materialCount = std::max(imageCount / 3, 1u);
+        for (u32 i = 0; (i < materialCount) && (imageCount > 0); ++i)
+        {
+            materials += std::format(
+                R"({}{{"name":"material_{}","pbrMetallicRoughness":{{"baseColorTexture":{{"index":{}}},"metallicRoughnessTexture":{{"index":{}}}}},"normalTexture":{{"index":{}}}}})",
+                i == 0 ? "" : ",", i, (3 * i) % imageCount, (3 * i + 2) % imageCount, (3 * i + 1) % imageCount);
+        }
+        if (imageCount == 0)
+        {
+            materials = R"({"name":"material_0"})";
+        }
+
+        // one node per mesh on a grid
+        u32 const meshCount = (primitiveCount + PRIMITIVES_PER_MESH - 1) / PRIMITIVES_PER_MESH;
+        u32 const side      = static_cast<u32>(std::ceil(std::sqrt(static_cast<f32>(meshCount))));
+        std::string nodes;
+        std::string sceneNodes;
+        for (u32 i = 0; i < meshCount; ++i)
+        {
+            nodes += std::format(R"({}{{"name":"node_{}","mesh":{},"translation":[{},0,{}]}})",
+                                 i == 0 ? "" : ",", i, i, static_cast<f32>(i % side) * 10.0f, static_cast<f32>(i / side) * 2.0f);
+            sceneNodes += std::format("{}{}", i == 0 ? "" : ",", i);
+        }
+
+        std::ofstream file(path);
+        file << std::format(
+            R"({{"asset":{{"version":"2.0"}},"scene":0,"scenes":[{{"nodes":[{}]}}],"nodes":[{}],"meshes":[{}],"materials":[{}],)"
+            R"("textures":[{}],"images":[{}],"accessors":[{}],)"
+            R"("bufferViews":[{{"buffer":0,"byteOffset":0,"byteLength":{}}},{{"buffer":0,"byteOffset":{},"byteLength":{}}},)"
+            R"({{"buffer":0,"byteOffset":{},"byteLength":{}}},{{"buffer":0,"byteOffset":{},"byteLength":{}}},{{"buffer":0,"byteOffset":{},"byteLength":{}}}],)"
+            R"("buffers":[{{"uri":"synthetic_{}.bin","byteLength":{}}}]}})",
+            sceneNodes, nodes, meshes, materials,
+            textures, images, accessors,
+            positionBytes, positionBytes, positionBytes,
+            2 * positionBytes, uvBytes, 2 * positionBytes + uvBytes, tangentBytes,
+            2 * positionBytes + uvBytes + tangentBytes, indexBytes,
+            primitiveCount, 2 * positionBytes + uvBytes + tangentBytes + indexBytes);
+
+        WS_LOG_INFO("glTFBenchmark", "Generated {} with {} primitives and {} images", path.string(), primitiveCount, imageCount);
+        return path.string();
+    }
+} // namespace
+
+class Benchmark
+{
+public:
+    inline static u32 runs = 8;
+    inline static std::vector<std::string> models;
+    inline static bool failed = false;
+
+    // imports every model runs times under fresh names, the first import
+    // cooks the geometry cache, the later ones read it
+    static void run(ecs::Resource<glTFManager> gltfManager)
+    {
+        for (std::string const& model : models)
+        {
+            std::vector<glTFLoadStatistics> samples;
+            for (u32 i = 0; i < runs; ++i)
+            {
+                glTFLoadStatistics statistics;
+                if (!gltfManager->load(model, "benchmark_" + std::to_string(i) + "_" + model, &statistics))
+                {
+                    WS_LOG_ERROR("glTFBenchmark", "Failed to import {}", model);
+                    failed = true;
+                    break;
+                }
+                samples.push_back(statistics);
+            }
+
+            if (samples.empty())
+            {
+                continue;
+            }
+
+            glTFLoadStatistics const& first = samples.front();
+            WS_LOG_INFO("glTFBenchmark",
+                        "{}: {} images, {} primitives",
+                        model,
+                        first.imageCount,
+                        first.primitiveCount);
+            WS_LOG_INFO("glTFBenchmark",
+                        "  first  total {:8.2f} ms (parse {:.2f}, images {:.2f}, meshes {:.2f}{})",
+                        first.totalMs,
+                        first.parseMs,
+                        first.imageMs,
+                        first.meshMs,
+                        first.isCached ? " cached" : "");
+
+            if (samples.size() < 2)
+            {
+                continue;
+            }
+
+            // median of the repeated imports
+            auto median = [&samples](f32 glTFLoadStatistics::* stage)
+            {
+                std::vector<f32> values;
+                for (usize i = 1; i < samples.size(); ++i)
+                {
+                    values.push_back(samples[i].*stage);
+                }
+                std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+                return values[values.size() / 2];
+            };
+            WS_LOG_INFO("glTFBenchmark",
+                        "  median total {:8.2f} ms (parse {:.2f}, images {:.2f}, meshes {:.2f}{}) over {} runs",
+                        median(&glTFLoadStatistics::totalMs),
+                        median(&glTFLoadStatistics::parseMs),
+                        median(&glTFLoadStatistics::imageMs),
+                        median(&glTFLoadStatistics::meshMs),
+                        samples.back().isCached ? " cached" : "",
+                        samples.size() - 1);
+        }
+    }
+};
+
+// glTFBenchmark [--runs N] [--synthetic PRIMITIVES IMAGES] [model...]
+// imports the bundled models when none is given. --synthetic generates a
+// model with many primitives and external images, 4096 and 96 are about
+// the size of Sponza
+int main(int argc, char** argv)
+{
+    Logger::initialize();
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if ((std::string_view{argv[i]} == "--runs") && (i + 1 < argc))
+        {
+            Benchmark::runs = static_cast<u32>(std::max(std::stoi(argv[++i]), 1));
+        }
+        else if ((std::string_view{argv[i]} == "--synthetic") && (i + 2 < argc))
+        {
+            u32 const primitiveCount = static_cast<u32>(std::max(std::stoi(argv[i + 1]), 1));
+            u32 const imageCount     = static_cast<u32>(std::max(std::stoi(argv[i + 2]), 0));
+            Benchmark::models.push_back(writeSyntheticModel(primitiveCount, imageCount));
+            i += 2;
+        }
+        else
+        {
+            Benchmark::models.emplace_back(argv[i]);
+        }
+    }
+
+    if (Benchmark::models.empty())
+    {
+        std::string const models = std::string(EngineDirectory) + "/Binary/Models";
+        Benchmark::models        = {models + "/DamagedHelmet/glTF-Binary/DamagedHelmet.glb", models + "/Cube/cube.glb"};
+    }
+
+    ecs::Registry registry;
+    ecs::Schedule schedule;
+
+    schedule.addSystem<ecs::CoreStage::StartUp, &Engine::initialize>();
+    schedule.addSystem<ecs::CoreStage::StartUp, &Renderer::initialize>();
+    schedule.addSystem<ecs::CoreStage::StartUp, &Benchmark::run>();
+
+    schedule.addSystem<ecs::CoreStage::CleanUp, &Renderer::shutdown>();
+    schedule.addSystem<ecs::CoreStage::CleanUp, &Engine::shutdown>();
+
+    schedule.initialize(registry);
+    schedule.shutdown(registry);
+
+    Logger::shutdown();
+    return Benchmark::failed ? 1 : 0;
+}
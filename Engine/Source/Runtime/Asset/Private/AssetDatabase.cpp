@@ -0,0 +1,451 @@
+#include "Log.hpp"
+#include "Platform.hpp"
+#include "Math/Hash.hpp"
+#include "MappedFile.hpp"
+#include "AssetDatabase.hpp"
+
+#include <mutex>
+#include <string>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace worse
+{
+
+    namespace
+    {
+        // clang-format off
+        constexpr u32 DATABASE_MAGIC   = 0x44415357; // "WSAD"
+        constexpr u32 DATABASE_VERSION = 1;
+        // clang-format on
+
+        struct DatabaseHeader
+        {
+            u32 magic       = DATABASE_MAGIC;
+            u32 version     = DATABASE_VERSION;
+            u32 recordCount = 0;
+            u32 reserved    = 0;
+        };
+
+        struct Database
+        {
+            std::mutex mutex;
+            bool isLoaded = false;
+            bool isDirty  = false;
+            // keyed by the normalized source path
+            std::unordered_map<std::string, AssetRecord> records;
+        };
+
+        Database& getDatabase()
+        {
+            static Database database;
+            return database;
+        }
+
+        std::string makeKey(std::filesystem::path const& path)
+        {
+            std::error_code ec;
+            std::filesystem::path const canonicalPath = std::filesystem::weakly_canonical(path, ec);
+            return (ec ? path : canonicalPath).generic_string();
+        }
+
+        // size and timestamp only, false when the file is missing
+        bool statFile(std::filesystem::path const& path, u64& size, i64& time)
+        {
+            std::error_code ec;
+            size = std::filesystem::file_size(path, ec);
+            if (ec)
+            {
+                return false;
+            }
+            time = static_cast<i64>(std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+            return !ec;
+        }
+
+        std::optional<AssetFileState> captureFile(std::filesystem::path const& path)
+        {
+            AssetFileState state;
+            state.path = makeKey(path);
+            if (!statFile(path, state.size, state.time))
+            {
+                return std::nullopt;
+            }
+            state.contentHash = AssetDatabase::hashFile(path);
+            return state;
+        }
+
+        // true when the content still matches, the timestamp is refreshed
+        // when only it changed
+        bool isFileCurrent(AssetFileState& state, bool& isTouched)
+        {
+            u64 size = 0;
+            i64 time = 0;
+            if (!statFile(state.path, size, time) || (size != state.size))
+            {
+                return false;
+            }
+            if (time == state.time)
+            {
+                return true;
+            }
+
+            if (AssetDatabase::hashFile(state.path) != state.contentHash)
+            {
+                return false;
+            }
+            state.time = time;
+            isTouched  = true;
+            return true;
+        }
+
+        template <typename T>
+        void writePod(std::ofstream& stream, T const& value)
+        {
+            stream.write(reinterpret_cast<char const*>(&value), sizeof(T));
+        }
+
+        template <typename T>
+        bool readPod(std::ifstream& stream, T& value)
+        {
+            return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+        }
+
+        void writeString(std::ofstream& stream, std::string const& value)
+        {
+            writePod(stream, static_cast<u32>(value.size()));
+            stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+        }
+
+        bool readString(std::ifstream& stream, std::string& value)
+        {
+            u32 length = 0;
+            if (!readPod(stream, length) || (length > 4096))
+            {
+                return false;
+            }
+            value.resize(length);
+            return (length == 0) || static_cast<bool>(stream.read(value.data(), length));
+        }
+
+        void writeFileState(std::ofstream& stream, AssetFileState const& state)
+        {
+            writeString(stream, state.path.generic_string());
+            writePod(stream, state.contentHash);
+            writePod(stream, state.size);
+            writePod(stream, state.time);
+        }
+
+        bool readFileState(std::ifstream& stream, AssetFileState& state)
+        {
+            std::string path;
+            bool const valid = readString(stream, path) &&
+                               readPod(stream, state.contentHash) &&
+                               readPod(stream, state.size) &&
+                               readPod(stream, state.time);
+            state.path = path;
+            return valid;
+        }
+
+        void loadLocked(Database& database)
+        {
+            if (database.isLoaded)
+            {
+                return;
+            }
+            database.isLoaded = true;
+
+            std::filesystem::path const path = AssetDatabase::getPath();
+            std::ifstream stream(path, std::ios::binary);
+            if (!stream.is_open())
+            {
+                return;
+            }
+
+            DatabaseHeader header = {};
+            if (!readPod(stream, header) || (header.magic != DATABASE_MAGIC) || (header.version != DATABASE_VERSION))
+            {
+                WS_LOG_WARN("AssetDatabase", "Ignoring outdated database {}", path.string());
+                return;
+            }
+
+            for (u32 i = 0; i < header.recordCount; ++i)
+            {
+                AssetRecord record;
+                u32 dependencyCount = 0;
+                u32 artifactCount   = 0;
+                if (!readFileState(stream, record.source) || !readPod(stream, dependencyCount) || (dependencyCount > 4096))
+                {
+                    break;
+                }
+
+                record.dependencies.resize(dependencyCount);
+                bool valid = true;
+                for (AssetFileState& dependency : record.dependencies)
+                {
+                    valid = valid && readFileState(stream, dependency);
+                }
+                valid = valid && readPod(stream, artifactCount) && (artifactCount <= 4096);
+                for (u32 j = 0; valid && (j < artifactCount); ++j)
+                {
+                    std::string artifact;
+                    valid = readString(stream, artifact);
+                    record.artifacts.emplace_back(artifact);
+                }
+
+                if (!valid)
+                {
+                    WS_LOG_WARN("AssetDatabase", "Truncated database {}, kept {} records", path.string(), i);
+                    break;
+                }
+                database.records[record.source.path.generic_string()] = std::move(record);
+            }
+        }
+    } // namespace
+
+    bool AssetDatabase::isUpToDate(std::filesystem::path const& source)
+    {
+        Database& database    = getDatabase();
+        std::string const key = makeKey(source);
+
+        AssetRecord record;
+        {
+            std::lock_guard<std::mutex> lock(database.mutex);
+            loadLocked(database);
+
+            auto it = database.records.find(key);
+            if (it == database.records.end())
+            {
+                return false;
+            }
+            record = it->second;
+        }
+
+        // hashing reads whole files, keep it outside the lock
+        bool isTouched = false;
+        if (!isFileCurrent(record.source, isTouched))
+        {
+            return false;
+        }
+        for (AssetFileState& dependency : record.dependencies)
+        {
+            if (!isFileCurrent(dependency, isTouched))
+            {
+                return false;
+            }
+        }
+        for (std::filesystem::path const& artifact : record.artifacts)
+        {
+            std::error_code ec;
+            if (!std::filesystem::is_regular_file(artifact, ec))
+            {
+                return false;
+            }
+        }
+
+        if (isTouched)
+        {
+            std::lock_guard<std::mutex> lock(database.mutex);
+            database.records[key] = std::move(record);
+            database.isDirty      = true;
+        }
+        return true;
+    }
+
+    void AssetDatabase::record(std::filesystem::path const& source,
+                               std::vector<std::filesystem::path> const& dependencies,
+                               std::vector<std::filesystem::path> const& artifacts)
+    {
+        std::optional<AssetFileState> sourceState = captureFile(source);
+        if (!sourceState)
+        {
+            WS_LOG_WARN("AssetDatabase", "Cannot record missing source {}", source.string());
+            return;
+        }
+
+        AssetRecord record;
+        record.source = std::move(sourceState.value());
+        for (std::filesystem::path const& dependency : dependencies)
+        {
+            if (std::optional<AssetFileState> state = captureFile(dependency))
+            {
+                record.dependencies.push_back(std::move(state.value()));
+            }
+        }
+        for (std::filesystem::path const& artifact : artifacts)
+        {
+            record.artifacts.emplace_back(makeKey(artifact));
+        }
+
+        Database& database = getDatabase();
+        std::lock_guard<std::mutex> lock(database.mutex);
+        loadLocked(database);
+        database.records[record.source.path.generic_string()] = std::move(record);
+        database.isDirty                                      = true;
+    }
+
+    std::vector<std::filesystem::path> AssetDatabase::invalidate(std::filesystem::path const& source)
+    {
+        Database& database = getDatabase();
+        std::lock_guard<std::mutex> lock(database.mutex);
+        loadLocked(database);
+
+        std::vector<std::filesystem::path> removed;
+        std::unordered_set<std::string> visited;
+        std::vector<std::string> pending = {makeKey(source)};
+        while (!pending.empty())
+        {
+            std::string const key = std::move(pending.back());
+            pending.pop_back();
+            if (!visited.insert(key).second)
+            {
+                continue;
+            }
+
+            if (database.records.erase(key) > 0)
+            {
+                removed.emplace_back(key);
+                database.isDirty = true;
+            }
+
+            for (auto const& [dependentKey, record] : database.records)
+            {
+                for (AssetFileState const& dependency : record.dependencies)
+                {
+                    if (dependency.path.generic_string() == key)
+                    {
+                        pending.push_back(dependentKey);
+                        break;
+                    }
+                }
+            }
+        }
+
+        return removed;
+    }
+
+    std::vector<std::filesystem::path> AssetDatabase::getDependents(std::filesystem::path const& source)
+    {
+        std::string const key = makeKey(source);
+
+        Database& database = getDatabase();
+        std::lock_guard<std::mutex> lock(database.mutex);
+        loadLocked(database);
+
+        std::vector<std::filesystem::path> dependents;
+        for (auto const& [dependentKey, record] : database.records)
+        {
+            for (AssetFileState const& dependency : record.dependencies)
+            {
+                if (dependency.path.generic_string() == key)
+                {
+                    dependents.emplace_back(dependentKey);
+                    break;
+                }
+            }
+        }
+        return dependents;
+    }
+
+    std::optional<AssetRecord> AssetDatabase::getRecord(std::filesystem::path const& source)
+    {
+        std::string const key = makeKey(source);
+
+        Database& database = getDatabase();
+        std::lock_guard<std::mutex> lock(database.mutex);
+        loadLocked(database);
+
+        auto it = database.records.find(key);
+        return (it != database.records.end()) ? std::make_optional(it->second) : std::nullopt;
+    }
+
+    bool AssetDatabase::save()
+    {
+        Database& database = getDatabase();
+        std::lock_guard<std::mutex> lock(database.mutex);
+        if (!database.isDirty)
+        {
+            return true;
+        }
+
+        std::filesystem::path const path = getPath();
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+        if (ec)
+        {
+            WS_LOG_WARN("AssetDatabase", "Failed to create directory {}: {}", path.parent_path().string(), ec.message());
+            return false;
+        }
+
+        // a crash mid write keeps the previous database
+        std::filesystem::path const tempPath = std::filesystem::path{path}.concat(".tmp");
+        {
+            std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+            if (!stream.is_open())
+            {
+                WS_LOG_WARN("AssetDatabase", "Failed to write {}", tempPath.string());
+                return false;
+            }
+
+            DatabaseHeader header = {};
+            header.recordCount    = static_cast<u32>(database.records.size());
+            writePod(stream, header);
+
+            for (auto const& [key, record] : database.records)
+            {
+                writeFileState(stream, record.source);
+                writePod(stream, static_cast<u32>(record.dependencies.size()));
+                for (AssetFileState const& dependency : record.dependencies)
+                {
+                    writeFileState(stream, dependency);
+                }
+                writePod(stream, static_cast<u32>(record.artifacts.size()));
+                for (std::filesystem::path const& artifact : record.artifacts)
+                {
+                    writeString(stream, artifact.generic_string());
+                }
+            }
+
+            if (!stream.good())
+            {
+                stream.close();
+                std::filesystem::remove(tempPath, ec);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec)
+        {
+            WS_LOG_WARN("AssetDatabase", "Failed to write {}: {}", path.string(), ec.message());
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+
+        database.isDirty = false;
+        return true;
+    }
+
+    u64 AssetDatabase::hashFile(std::filesystem::path const& path)
+    {
+        std::error_code ec;
+        if (std::filesystem::file_size(path, ec) == 0)
+        {
+            return ec ? 0 : math::hashFnv1a({});
+        }
+
+        MappedFile file(path);
+        if (!file.isOpen())
+        {
+            return 0;
+        }
+        return math::hashFnv1a(std::string_view{reinterpret_cast<char const*>(file.getData()), file.getSize()});
+    }
+
+    std::filesystem::path AssetDatabase::getPath()
+    {
+        return std::filesystem::path{worse::EngineDirectory} / "Intermediate/AssetDatabase.bin";
+    }
+
+} // namespace worse
@@ -0,0 +1,120 @@
+#pragma once
+#include "Types.hpp"
+#include "RHITypes.hpp"
+
+namespace worse::dds
+{
+
+    // little endian four character code
+    constexpr u32 makeFourCC(char const a, char const b, char const c, char const d)
+    {
+        return static_cast<u32>(a) | (static_cast<u32>(b) << 8) | (static_cast<u32>(c) << 16) | (static_cast<u32>(d) << 24);
+    }
+
+    constexpr u32 MAGIC = makeFourCC('D', 'D', 'S', ' ');
+
+    // clang-format off
+    constexpr u32 FLAG_CAPS           = 0x1;
+    constexpr u32 FLAG_HEIGHT         = 0x2;
+    constexpr u32 FLAG_WIDTH          = 0x4;
+    constexpr u32 FLAG_PIXELFORMAT    = 0x1000;
+    constexpr u32 FLAG_MIPMAPCOUNT    = 0x20000;
+    constexpr u32 FLAG_LINEARSIZE     = 0x80000;
+    constexpr u32 PIXELFORMAT_FOURCC  = 0x4;
+    constexpr u32 CAPS_COMPLEX        = 0x8;
+    constexpr u32 CAPS_TEXTURE        = 0x1000;
+    constexpr u32 CAPS_MIPMAP         = 0x400000;
+    constexpr u32 DIMENSION_TEXTURE2D = 3;
+    // clang-format on
+
+    struct PixelFormat
+    {
+        u32 size;
+        u32 flags;
+        u32 fourCC;
+        u32 rgbBitCount;
+        u32 rBitMask;
+        u32 gBitMask;
+        u32 bBitMask;
+        u32 aBitMask;
+    };
+
+    struct Header
+    {
+        u32 size;
+        u32 flags;
+        u32 height;
+        u32 width;
+        u32 pitchOrLinearSize;
+        u32 depth;
+        u32 mipMapCount;
+        u32 reserved1[11];
+        PixelFormat pixelFormat;
+        u32 caps;
+        u32 caps2;
+        u32 caps3;
+        u32 caps4;
+        u32 reserved2;
+    };
+
+    struct HeaderDX10
+    {
+        u32 dxgiFormat;
+        u32 resourceDimension;
+        u32 miscFlag;
+        u32 arraySize;
+        u32 miscFlags2;
+    };
+
+    static_assert(sizeof(PixelFormat) == 32);
+    static_assert(sizeof(Header) == 124);
+    static_assert(sizeof(HeaderDX10) == 20);
+
+    // the engine samples colour textures as unorm, srgb variants load as unorm too
+    constexpr RHIFormat formatFromDxgi(u32 const dxgiFormat)
+    {
+        switch (dxgiFormat)
+        {
+            // clang-format off
+        case 71: case 72: return RHIFormat::BC1Unorm;
+        case 77: case 78: return RHIFormat::BC3Unorm;
+        case 80:          return RHIFormat::BC4Unorm;
+        case 83:          return RHIFormat::BC5Unorm;
+        case 98: case 99: return RHIFormat::BC7Unorm;
+        default:          return RHIFormat::Max;
+            // clang-format on
+        }
+    }
+
+    constexpr u32 formatToDxgi(RHIFormat const format)
+    {
+        switch (format)
+        {
+            // clang-format off
+        case RHIFormat::BC1Unorm: return 71;
+        case RHIFormat::BC3Unorm: return 77;
+        case RHIFormat::BC4Unorm: return 80;
+        case RHIFormat::BC5Unorm: return 83;
+        case RHIFormat::BC7Unorm: return 98;
+        default:                  return 0;
+            // clang-format on
+        }
+    }
+
+    constexpr RHIFormat formatFromFourCC(u32 const fourCC)
+    {
+        switch (fourCC)
+        {
+            // clang-format off
+        case makeFourCC('D', 'X', 'T', '1'): return RHIFormat::BC1Unorm;
+        case makeFourCC('D', 'X', 'T', '5'): return RHIFormat::BC3Unorm;
+        case makeFourCC('A', 'T', 'I', '1'):
+        case makeFourCC('B', 'C', '4', 'U'): return RHIFormat::BC4Unorm;
+        case makeFourCC('A', 'T', 'I', '2'):
+        case makeFourCC('B', 'C', '5', 'U'): return RHIFormat::BC5Unorm;
+        default:                             return RHIFormat::Max;
+            // clang-format on
+        }
+    }
+
+} // namespace worse::dds
@@ -0,0 +1,123 @@
+#include "ImageDecoder.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <mutex>
+#include <vector>
+#include <cstring>
+#include <limits>
+
+namespace worse
+{
+
+    namespace
+    {
+        // fallback for every format stb_image reads
+        class StbImageDecoder final : public IImageDecoder
+        {
+        public:
+            char const* getName() const override
+            {
+                return "stb_image";
+            }
+
+            bool readInfo(std::span<byte const> data, u32& width, u32& height) const override
+            {
+                if (data.size() > static_cast<usize>(std::numeric_limits<int>::max()))
+                {
+                    return false;
+                }
+
+                int w = 0, h = 0, channels = 0;
+                if (!stbi_info_from_memory(reinterpret_cast<stbi_uc const*>(data.data()), static_cast<int>(data.size()), &w, &h, &channels))
+                {
+                    return false;
+                }
+
+                width  = static_cast<u32>(w);
+                height = static_cast<u32>(h);
+                return (width > 0) && (height > 0);
+            }
+
+            bool decode(std::span<byte const> data, byte* dst, bool const flipVertically, u32 const channels) const override
+            {
+                // grey sources convert to one channel exactly, colour ones
+                // would be turned into luminance and are split below instead
+                int width = 0, height = 0, sourceChannels = 0;
+                stbi_info_from_memory(reinterpret_cast<stbi_uc const*>(data.data()), static_cast<int>(data.size()), &width, &height, &sourceChannels);
+                int const desired = ((channels == 1) && (sourceChannels <= 2)) ? 1 : 4;
+
+                stbi_uc* pixels = stbi_load_from_memory(reinterpret_cast<stbi_uc const*>(data.data()),
+                                                        static_cast<int>(data.size()),
+                                                        &width,
+                                                        &height,
+                                                        &sourceChannels,
+                                                        desired);
+                if (!pixels)
+                {
+                    return false;
+                }
+
+                // the global stbi flip flag is not thread safe, the copy
+                // below reverses the rows instead
+                usize const srcRowSize = static_cast<usize>(width) * desired;
+                usize const dstRowSize = static_cast<usize>(width) * channels;
+                for (int y = 0; y < height; ++y)
+                {
+                    stbi_uc const* src = pixels + static_cast<usize>(flipVertically ? height - 1 - y : y) * srcRowSize;
+                    byte* row          = dst + static_cast<usize>(y) * dstRowSize;
+                    if (desired == static_cast<int>(channels))
+                    {
+                        std::memcpy(row, src, dstRowSize);
+                        continue;
+                    }
+
+                    for (int x = 0; x < width; ++x)
+                    {
+                        row[x] = static_cast<byte>(src[x * desired]);
+                    }
+                }
+
+                stbi_image_free(pixels);
+                return true;
+            }
+        };
+
+        struct Registry
+        {
+            std::mutex mutex;
+            // newest first, the stb fallback stays last
+            std::vector<std::shared_ptr<IImageDecoder>> decoders = {std::make_shared<StbImageDecoder>()};
+        };
+
+        Registry& getRegistry()
+        {
+            static Registry registry;
+            return registry;
+        }
+    } // namespace
+
+    void ImageDecoder::registerDecoder(std::shared_ptr<IImageDecoder> decoder)
+    {
+        Registry& registry = getRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.decoders.insert(registry.decoders.begin(), std::move(decoder));
+    }
+
+    IImageDecoder const* ImageDecoder::find(std::span<byte const> data, u32& width, u32& height)
+    {
+        Registry& registry = getRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (std::shared_ptr<IImageDecoder> const& decoder : registry.decoders)
+        {
+            if (decoder->readInfo(data, width, height))
+            {
+                // decoders are never removed, the pointer stays valid
+                return decoder.get();
+            }
+        }
+        return nullptr;
+    }
+
+} // namespace worse
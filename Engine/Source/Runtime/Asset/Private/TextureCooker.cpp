@@ -0,0 +1,301 @@
+#include "Log.hpp"
+#include "DdsFormat.hpp"
+#include "FileSystem.hpp"
+#include "ThreadPool.hpp"
+#include "AssetDatabase.hpp"
+#include "TextureCooker.hpp"
+#include "TextureImporter.hpp"
+#include "VirtualFileSystem.hpp"
+#include "Profiling/Stopwatch.hpp"
+
+#define STB_DXT_IMPLEMENTATION
+#include "stb_dxt.h"
+
+#include <vector>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+
+namespace worse
+{
+
+    namespace
+    {
+        constexpr char const* COOKED_DIRECTORY = ".cooked";
+
+        bool isEncodable(RHIFormat const format)
+        {
+            return (format == RHIFormat::BC1Unorm) || (format == RHIFormat::BC3Unorm) ||
+                   (format == RHIFormat::BC4Unorm) || (format == RHIFormat::BC5Unorm);
+        }
+
+        RHIFormat chooseFormat(std::vector<byte> const& rgba)
+        {
+            u8 const* texels = reinterpret_cast<u8 const*>(rgba.data());
+            bool isGrey      = true;
+            bool isOpaque    = true;
+            for (usize i = 0; (i < rgba.size()) && (isGrey || isOpaque); i += 4)
+            {
+                isGrey   = isGrey && (texels[i] == texels[i + 1]) && (texels[i] == texels[i + 2]);
+                isOpaque = isOpaque && (texels[i + 3] == 255);
+            }
+
+            return !isOpaque ? RHIFormat::BC3Unorm : isGrey ? RHIFormat::BC4Unorm : RHIFormat::BC1Unorm;
+        }
+
+        // append the blocks of one RGBA8 level, partial edge blocks repeat
+        // the last row and column
+        void compressLevel(RHIFormat const format, std::vector<byte> const& rgba, u32 const width, u32 const height, std::vector<byte>& out)
+        {
+            u32 const blockSize = rhiFormatBlockSize(format);
+            u32 const blocksX   = (width + 3) / 4;
+            u32 const blocksY   = (height + 3) / 4;
+
+            usize const begin = out.size();
+            out.resize(begin + static_cast<usize>(blocksX) * blocksY * blockSize);
+            unsigned char* dst = reinterpret_cast<unsigned char*>(out.data() + begin);
+
+            u8 const* texels = reinterpret_cast<u8 const*>(rgba.data());
+            u8 block[16 * 4];
+            u8 channels[16 * 2];
+            for (u32 by = 0; by < blocksY; ++by)
+            {
+                for (u32 bx = 0; bx < blocksX; ++bx)
+                {
+                    for (u32 y = 0; y < 4; ++y)
+                    {
+                        u32 const sy = std::min(by * 4 + y, height - 1);
+                        for (u32 x = 0; x < 4; ++x)
+                        {
+                            u32 const sx = std::min(bx * 4 + x, width - 1);
+                            std::memcpy(block + (y * 4 + x) * 4, texels + (static_cast<usize>(sy) * width + sx) * 4, 4);
+                        }
+                    }
+
+                    switch (format)
+                    {
+                    case RHIFormat::BC1Unorm:
+                        stb_compress_dxt_block(dst, block, 0, STB_DXT_HIGHQUAL);
+                        break;
+                    case RHIFormat::BC3Unorm:
+                        stb_compress_dxt_block(dst, block, 1, STB_DXT_HIGHQUAL);
+                        break;
+                    case RHIFormat::BC4Unorm:
+                        for (u32 i = 0; i < 16; ++i)
+                        {
+                            channels[i] = block[i * 4];
+                        }
+                        stb_compress_bc4_block(dst, channels);
+                        break;
+                    case RHIFormat::BC5Unorm:
+                        for (u32 i = 0; i < 16; ++i)
+                        {
+                            channels[i * 2 + 0] = block[i * 4 + 0];
+                            channels[i * 2 + 1] = block[i * 4 + 1];
+                        }
+                        stb_compress_bc5_block(dst, channels);
+                        break;
+                    default:
+                        break;
+                    }
+
+                    dst += blockSize;
+                }
+            }
+        }
+
+        bool writeDds(std::filesystem::path const& path, RHIFormat const format, u32 const width, u32 const height, u32 const mipLevels, std::vector<byte> const& blocks)
+        {
+            dds::Header header        = {};
+            header.size               = sizeof(dds::Header);
+            header.flags              = dds::FLAG_CAPS | dds::FLAG_HEIGHT | dds::FLAG_WIDTH | dds::FLAG_PIXELFORMAT | dds::FLAG_MIPMAPCOUNT | dds::FLAG_LINEARSIZE;
+            header.height             = height;
+            header.width              = width;
+            header.pitchOrLinearSize  = static_cast<u32>(TextureImporter::getMipSize(format, width, height, 0));
+            header.depth              = 1;
+            header.mipMapCount        = mipLevels;
+            header.pixelFormat.size   = sizeof(dds::PixelFormat);
+            header.pixelFormat.flags  = dds::PIXELFORMAT_FOURCC;
+            header.pixelFormat.fourCC = dds::makeFourCC('D', 'X', '1', '0');
+            header.caps               = dds::CAPS_TEXTURE | ((mipLevels > 1) ? (dds::CAPS_COMPLEX | dds::CAPS_MIPMAP) : 0);
+
+            dds::HeaderDX10 headerDX10   = {};
+            headerDX10.dxgiFormat        = dds::formatToDxgi(format);
+            headerDX10.resourceDimension = dds::DIMENSION_TEXTURE2D;
+            headerDX10.arraySize         = 1;
+
+            // a crash mid write must not leave a file newer than its source
+            std::filesystem::path const temporary = std::filesystem::path{path}.concat(".tmp");
+            {
+                std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+                file.write(reinterpret_cast<char const*>(&dds::MAGIC), sizeof(dds::MAGIC));
+                file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+                file.write(reinterpret_cast<char const*>(&headerDX10), sizeof(headerDX10));
+                file.write(reinterpret_cast<char const*>(blocks.data()), static_cast<std::streamsize>(blocks.size()));
+                if (!file)
+                {
+                    return false;
+                }
+            }
+
+            std::error_code ec;
+            std::filesystem::rename(temporary, path, ec);
+            return !ec;
+        }
+    } // namespace
+
+    std::filesystem::path TextureCooker::getCookedPath(std::filesystem::path const& source)
+    {
+        return source.parent_path() / COOKED_DIRECTORY / std::filesystem::path{source.filename()}.concat(".dds");
+    }
+
+    bool TextureCooker::isCookedUpToDate(std::filesystem::path const& source)
+    {
+        // the record lists the cooked file as artifact, a missing file fails
+        return AssetDatabase::isUpToDate(source);
+    }
+
+    std::filesystem::path TextureCooker::resolve(std::filesystem::path const& source)
+    {
+        std::filesystem::path cookedPath = getCookedPath(source);
+        if (!FileSystem::isFileExists(source))
+        {
+            // packed sources have nothing to hash, the archive ships the
+            // cooked file built with them
+            return VirtualFileSystem::exists(cookedPath) ? cookedPath : source;
+        }
+        return isCookedUpToDate(source) ? cookedPath : source;
+    }
+
+    bool TextureCooker::cook(std::filesystem::path const& source, RHIFormat const format, TextureCookStatistics* statistics)
+    {
+        auto fail = [statistics]()
+        {
+            if (statistics)
+            {
+                ++statistics->failed;
+            }
+            return false;
+        };
+
+        std::optional<TextureLoadView> view = TextureImporter::fromFile(source);
+        if (!view || (view->format != RHIFormat::R8G8B8A8Unorm))
+        {
+            WS_LOG_ERROR("TextureCooker", "Failed to decode {}", source.string());
+            return fail();
+        }
+
+        u32 const width  = static_cast<u32>(view->width);
+        u32 const height = static_cast<u32>(view->height);
+
+        std::vector<std::vector<byte>> mips(view->mipLevels);
+        mips[0].resize(view->size);
+        view->deferredCopyFn(mips[0].data());
+
+        RHIFormat const target = (format == RHIFormat::Max) ? chooseFormat(mips[0]) : format;
+        if (!isEncodable(target))
+        {
+            WS_LOG_ERROR("TextureCooker", "Only BC1/BC3/BC4/BC5 can be cooked, skipping {}", source.string());
+            return fail();
+        }
+
+        TextureImporter::generateMips(width, height, mips);
+
+        usize sourceBytes = 0;
+        std::vector<byte> blocks;
+        for (usize level = 0; level < mips.size(); ++level)
+        {
+            compressLevel(target, mips[level], std::max(width >> level, 1u), std::max(height >> level, 1u), blocks);
+            sourceBytes += mips[level].size();
+        }
+
+        std::filesystem::path const cookedPath = getCookedPath(source);
+        std::error_code ec;
+        std::filesystem::create_directories(cookedPath.parent_path(), ec);
+        if (ec || !writeDds(cookedPath, target, width, height, static_cast<u32>(mips.size()), blocks))
+        {
+            WS_LOG_ERROR("TextureCooker", "Failed to write {}", cookedPath.string());
+            return fail();
+        }
+
+        AssetDatabase::record(source, {}, {cookedPath});
+
+        if (statistics)
+        {
+            ++statistics->cooked;
+            statistics->sourceBytes += sourceBytes;
+            statistics->cookedBytes += blocks.size();
+        }
+        return true;
+    }
+
+    TextureCookStatistics TextureCooker::cookDirectory(std::filesystem::path const& directory, bool const force)
+    {
+        profiling::Stopwatch stopwatch;
+        TextureCookStatistics statistics;
+
+        std::vector<std::filesystem::path> sources;
+        std::error_code ec;
+        for (std::filesystem::recursive_directory_iterator it(directory, ec), end; !ec && (it != end); it.increment(ec))
+        {
+            if (it->is_directory() && (it->path().filename() == COOKED_DIRECTORY))
+            {
+                it.disable_recursion_pending();
+                continue;
+            }
+
+            std::filesystem::path const& path = it->path();
+            if (!it->is_regular_file() || !FileSystem::isSupportedImage(path) || (path.extension() == ".dds"))
+            {
+                continue;
+            }
+
+            if (!force && isCookedUpToDate(path))
+            {
+                ++statistics.skipped;
+                continue;
+            }
+            sources.push_back(path);
+        }
+
+        // one task per file, mip generation runs inline on the workers
+        std::vector<TextureCookStatistics> results(sources.size());
+        std::vector<std::shared_future<void>> tasks;
+        tasks.reserve(sources.size());
+        for (usize i = 0; i < sources.size(); ++i)
+        {
+            tasks.push_back(ThreadPool::addTask(
+                [&sources, &results, i]()
+                {
+                    cook(sources[i], RHIFormat::Max, &results[i]);
+                }));
+        }
+        for (std::shared_future<void> const& task : tasks)
+        {
+            task.wait();
+        }
+
+        for (TextureCookStatistics const& result : results)
+        {
+            statistics.cooked += result.cooked;
+            statistics.failed += result.failed;
+            statistics.sourceBytes += result.sourceBytes;
+            statistics.cookedBytes += result.cookedBytes;
+        }
+        statistics.elapsedMs = stopwatch.elapsedMs();
+        AssetDatabase::save();
+
+        WS_LOG_INFO("TextureCooker",
+                    "{}: cooked {}, up to date {}, failed {} in {:.2f} ms, {:.1f} MB -> {:.1f} MB",
+                    directory.string(),
+                    statistics.cooked,
+                    statistics.skipped,
+                    statistics.failed,
+                    statistics.elapsedMs,
+                    statistics.sourceBytes / (1024.0 * 1024.0),
+                    statistics.cookedBytes / (1024.0 * 1024.0));
+
+        return statistics;
+    }
+
+} // namespace worse
@@ -0,0 +1,75 @@
+#pragma once
+#include "Types.hpp"
+
+#include <vector>
+#include <optional>
+#include <filesystem>
+
+namespace worse
+{
+
+    // what a file looked like when an import read it
+    struct AssetFileState
+    {
+        std::filesystem::path path;
+        // FNV-1a of the file bytes
+        u64 contentHash = 0;
+        // cheap fingerprint, the hash is only recomputed when it changes
+        u64 size = 0;
+        i64 time = 0;
+    };
+
+    struct AssetRecord
+    {
+        AssetFileState source;
+        // files the import read besides the source, e.g. glTF buffers and images
+        std::vector<AssetFileState> dependencies;
+        // files produced from the source, e.g. cooked textures and meshes
+        std::vector<std::filesystem::path> artifacts;
+    };
+
+    /**
+     * @brief 资源数据库
+     *
+     * 以规范化的源文件路径为键, 记录内容哈希, 时间戳, 依赖和烘焙产物,
+     * 持久化到 Intermediate/AssetDatabase.bin. 源文件及其依赖的内容未变且
+     * 产物都存在时, 导入直接复用产物; 仅修改时间变化不会使缓存失效
+     *
+     * @note 线程安全, 首次使用时从磁盘载入, record 后需调用 save 写回
+     */
+    class AssetDatabase
+    {
+    public:
+        /**
+         * @brief 源文件, 所有依赖的内容与记录一致且产物都存在
+         *
+         * @note 内容未变但时间戳变化时更新记录中的时间戳
+         */
+        static bool isUpToDate(std::filesystem::path const& source);
+
+        /**
+         * @brief 导入或烘焙完成后记录源文件和依赖当前的内容
+         */
+        static void record(std::filesystem::path const& source,
+                           std::vector<std::filesystem::path> const& dependencies,
+                           std::vector<std::filesystem::path> const& artifacts);
+
+        /**
+         * @brief 删除记录, 并递归删除直接或间接依赖它的资源的记录
+         *
+         * @return 被删除记录的源文件
+         */
+        static std::vector<std::filesystem::path> invalidate(std::filesystem::path const& source);
+
+        // assets that list the file as a dependency
+        static std::vector<std::filesystem::path> getDependents(std::filesystem::path const& source);
+        static std::optional<AssetRecord> getRecord(std::filesystem::path const& source);
+
+        // writes the database when records changed since the last save
+        static bool save();
+
+        static u64 hashFile(std::filesystem::path const& path);
+        static std::filesystem::path getPath();
+    };
+
+} // namespace worse
@@ -0,0 +1,47 @@
+#pragma once
+#include "Types.hpp"
+
+#include <span>
+#include <memory>
+
+namespace worse
+{
+
+    /**
+     * @brief 压缩图像(PNG/JPEG 等)解码器接口
+     *
+     * 解码结果为 R8G8B8A8, 直接写入调用方提供的内存. 实现必须可从多个线程
+     * 同时调用, 不能依赖全局状态
+     */
+    class IImageDecoder
+    {
+    public:
+        virtual ~IImageDecoder() = default;
+
+        virtual char const* getName() const = 0;
+
+        // header only, false when the data is not in a format of this decoder
+        virtual bool readInfo(std::span<byte const> data, u32& width, u32& height) const = 0;
+
+        // writes width * height * channels bytes, bottom row first when
+        // flipped. channels is 4 for RGBA8 or 1 for the first channel only
+        virtual bool decode(std::span<byte const> data, byte* dst, bool const flipVertically, u32 const channels = 4) const = 0;
+    };
+
+    class ImageDecoder
+    {
+    public:
+        /**
+         * @brief 注册解码器, 后注册的先尝试, 内置的 stb_image 解码器最后尝试
+         *
+         * @note 解码器在程序结束前不会被移除
+         */
+        static void registerDecoder(std::shared_ptr<IImageDecoder> decoder);
+
+        /**
+         * @brief 第一个能读取数据头的解码器, 同时返回图像尺寸
+         */
+        static IImageDecoder const* find(std::span<byte const> data, u32& width, u32& height);
+    };
+
+} // namespace worse
@@ -0,0 +1,67 @@
+#pragma once
+#include "Types.hpp"
+#include "RHITypes.hpp"
+
+#include <filesystem>
+
+namespace worse
+{
+
+    struct TextureCookStatistics
+    {
+        u32 cooked  = 0;
+        u32 skipped = 0; // cache was up to date
+        u32 failed  = 0;
+        // R8G8B8A8 with full mip chain, what the runtime uploads for the sources
+        u64 sourceBytes = 0;
+        u64 cookedBytes = 0;
+        f32 elapsedMs   = 0.0f;
+    };
+
+    /**
+     * @brief 离线纹理烘焙
+     *
+     * 将 PNG/JPG 源文件解码, 生成完整 mip 链并压缩为 BC1/BC3/BC4/BC5, 以 DDS
+     * 写入源文件旁的 .cooked 目录. 源文件内容与 AssetDatabase 中的记录一致时
+     * 视为有效缓存
+     */
+    class TextureCooker
+    {
+    public:
+        /**
+         * @brief 源文件对应的烘焙文件路径 <dir>/.cooked/<filename>.dds
+         */
+        static std::filesystem::path getCookedPath(std::filesystem::path const& source);
+
+        /**
+         * @brief 烘焙文件存在且源文件内容自烘焙以来未变
+         */
+        static bool isCookedUpToDate(std::filesystem::path const& source);
+
+        /**
+         * @brief 有有效烘焙文件时返回其路径, 否则返回源文件路径
+         *
+         * @note 源文件只存在于挂载的归档中时, 直接使用归档中的烘焙文件
+         */
+        static std::filesystem::path resolve(std::filesystem::path const& source);
+
+        /**
+         * @brief 烘焙单个纹理
+         *
+         * @param format RHIFormat::Max 时按内容选择: 灰度 BC4, 含透明 BC3, 其余 BC1
+         * @param statistics 可选, 累加本次烘焙的结果
+         * @note BC7 没有编码器, 只能加载外部工具生成的 DDS
+         */
+        static bool cook(std::filesystem::path const& source,
+                         RHIFormat const format             = RHIFormat::Max,
+                         TextureCookStatistics* statistics = nullptr);
+
+        /**
+         * @brief 递归烘焙目录下的所有 PNG/JPG, 每个文件一个线程池任务
+         *
+         * @param force 忽略缓存重新烘焙
+         */
+        static TextureCookStatistics cookDirectory(std::filesystem::path const& directory, bool const force = false);
+    };
+
+} // namespace worse
@@ -3,6 +3,7 @@
 #include "RHITypes.hpp"
 
 #include <span>
+#include <vector>
 #include <optional>
 #include <functional>
 #include <filesystem>
@@ -16,15 +17,22 @@ namespace worse
     {
         using CopyFn = std::function<void(byte*)>;
 
-        // 获取已加载到内存中的纹理数据，然后释放内存
+        // 将纹理数据写入目标内存, 目标可以是上传暂存缓冲, 只调用一次
         CopyFn deferredCopyFn;
+        // 只写入第一个通道, 每个纹素 1 字节, 供通道合并使用, 可为空
+        CopyFn deferredChannelFn;
         i32 width;
         i32 height;
         i32 depth;
         i32 layers;
+        // 完整 mip 链层数
         i32 mipLevels;
+        // deferredCopyFn 依次写入的 mip 层数, 其余由 generateMips 生成
+        i32 storedMipLevels = 1;
+        // 源文件中比 mip 0 更大, 未加载的层数
+        i32 skippedMipLevels = 0;
 
-        usize size; // Size in bytes
+        usize size; // Size in bytes of all stored mips
 
         RHITextureType type;
         RHIFormat format;
@@ -33,17 +41,71 @@ namespace worse
     class TextureImporter
     {
     public:
-        static std::optional<TextureLoadView> fromFile(std::filesystem::path const& filepath);
+        /**
+         * @brief 从文件加载纹理
+         *
+         * @param maxSize 非 0 时 .dds 跳过宽高都超过该值的 mip, 用于流式加载
+         * @param flipVertically 解码时上下翻转行序, .dds 忽略
+         * @note .dds 以块压缩格式原样加载文件中的 mip, 其余格式经 ImageDecoder
+         *       解码为 R8G8B8A8, 文件以内存映射保持到 deferredCopyFn 调用
+         */
+        static std::optional<TextureLoadView> fromFile(std::filesystem::path const& filepath, u32 const maxSize = 0, bool const flipVertically = true);
 
-        static std::optional<TextureLoadView> fromMemory(std::span<byte> data, std::string const& name);
+        /**
+         * @brief 从内存中的编码图像加载纹理
+         *
+         * @param flipVertically 解码时上下翻转行序
+         * @note 只读取图像头, 解码在 deferredCopyFn 中直接写入目标内存,
+         *       data 须保持有效直到 deferredCopyFn 调用结束
+         */
+        static std::optional<TextureLoadView> fromMemory(std::span<byte const> data, std::string const& name, bool const flipVertically = false);
 
         /**
          * @brief 将多个单通道纹理合并
+         *
+         * @note 各输入只解码第一个通道, 在线程池上并行解码并按行块交织
          */
         static std::optional<TextureLoadView> combine(std::optional<TextureLoadView> r = std::nullopt,
                                                       std::optional<TextureLoadView> g = std::nullopt,
                                                       std::optional<TextureLoadView> b = std::nullopt,
                                                       std::optional<TextureLoadView> a = std::nullopt);
+
+        /**
+         * @brief 将每纹素一字节的平面交织为 R8G8B8A8, 空平面写 0
+         *
+         * @param vectorized false 时只走标量路径, 用于和 SIMD 路径逐字节比较
+         */
+        static void packChannels(u8 const* const planes[4], byte* dst, usize const texelCount, bool const vectorized = true);
+
+        /**
+         * @brief 单个 mip 层的字节数, 块压缩格式按 4x4 块向上取整
+         */
+        static usize getMipSize(RHIFormat const format, u32 const width, u32 const height, u32 const level);
+
+        /**
+         * @brief 前 mipCount 层连续存放的总字节数
+         */
+        static usize getChainSize(RHIFormat const format, u32 const width, u32 const height, u32 const mipCount);
+
+        /**
+         * @brief 完整 mip 链的层数
+         */
+        static u32 getMipCount(u32 const width, u32 const height);
+
+        /**
+         * @brief 由 mip 0 逐级 2x2 盒式滤波生成其余 mip
+         *
+         * @param mips mips[0] 为 R8G8B8A8 源数据, 其余层按 mips.size() 生成
+         * @note 大尺寸层按行拆分到线程池并行
+         */
+        static void generateMips(u32 const width, u32 const height, std::span<std::vector<byte>> mips);
+
+        /**
+         * @brief 同上, mip 链连续存放, 每层紧接上一层, 可直接写入上传暂存内存
+         *
+         * @param chain 开头为 R8G8B8A8 的 mip 0, 需容纳 getChainSize 字节
+         */
+        static void generateMips(u32 const width, u32 const height, u32 const mipCount, byte* chain);
     };
 
 } // namespace worse
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "Log.hpp"
+#include "Definitions.hpp"
+#include "ThreadPool.hpp"
+
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <condition_variable>
+
+namespace worse
+{
+
+    namespace
+    {
+        std::vector<std::thread> threads;
+        std::queue<std::packaged_task<void()>> tasks;
+        std::mutex mtxTasks;
+        std::condition_variable cvTasks;
+        bool stopping = false;
+
+        thread_local bool isWorker = false;
+
+        void workerLoop()
+        {
+            isWorker = true;
+
+            while (true)
+            {
+                std::packaged_task<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mtxTasks);
+                    cvTasks.wait(lock,
+                                 []()
+                                 {
+                                     return stopping || !tasks.empty();
+                                 });
+
+                    // drain the queue before exiting
+                    if (tasks.empty())
+                    {
+                        return;
+                    }
+
+                    task = std::move(tasks.front());
+                    tasks.pop();
+                }
+
+                task();
+            }
+        }
+    } // namespace
+
+    void ThreadPool::initialize(u32 const threadCount)
+    {
+        WS_ASSERT_MSG(threads.empty(), "Thread pool already initialized");
+
+        u32 count = threadCount;
+        if (count == 0)
+        {
+            u32 const hardwareCount = std::thread::hardware_concurrency();
+            count                   = std::max(hardwareCount, 2u) - 1;
+        }
+
+        stopping = false;
+        threads.reserve(count);
+        for (u32 i = 0; i < count; ++i)
+        {
+            threads.emplace_back(workerLoop);
+        }
+
+        WS_LOG_INFO("ThreadPool", "Started {} worker threads", count);
+    }
+
+    void ThreadPool::shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtxTasks);
+            stopping = true;
+        }
+        cvTasks.notify_all();
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        threads.clear();
+    }
+
+    std::shared_future<void> ThreadPool::addTask(Task task)
+    {
+        std::packaged_task<void()> packagedTask(std::move(task));
+        std::shared_future<void> future = packagedTask.get_future().share();
+
+        if (threads.empty())
+        {
+            packagedTask();
+            return future;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mtxTasks);
+            tasks.push(std::move(packagedTask));
+        }
+        cvTasks.notify_one();
+
+        return future;
+    }
+
+    u32 ThreadPool::getThreadCount()
+    {
+        return static_cast<u32>(threads.size());
+    }
+
+    u32 ThreadPool::getPendingTaskCount()
+    {
+        std::lock_guard<std::mutex> lock(mtxTasks);
+        return static_cast<u32>(tasks.size());
+    }
+
+    bool ThreadPool::isWorkerThread()
+    {
+        return isWorker;
+    }
+
+} // namespace worse
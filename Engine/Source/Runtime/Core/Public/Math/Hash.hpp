@@ -2,6 +2,7 @@
 #include "Types.hpp"
 #include <cstdint>
 #include <concepts>
+#include <string_view>
 
 namespace worse::math
 {
@@ -49,4 +50,16 @@ namespace worse::math
         return seed ^ (x + 0x9e3779b9 + (seed << 6) + (seed >> 2));
     }
 
+    // FNV-1a, stable across runs and platforms, usable as on-disk key
+    static constexpr u64 hashFnv1a(std::string_view data, u64 seed = 0xcbf29ce484222325ull)
+    {
+        u64 hash = seed;
+        for (char const c : data)
+        {
+            hash ^= static_cast<u8>(c);
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
 } // namespace worse::math
\ No newline at end of file
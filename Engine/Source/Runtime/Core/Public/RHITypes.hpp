@@ -29,6 +29,12 @@ namespace worse
         R16G16B16A16Snorm,
         R16G16B16A16Float,
         R32G32B32A32Float,
+        // Block compressed, 4x4 texel blocks
+        BC1Unorm,
+        BC3Unorm,
+        BC4Unorm,
+        BC5Unorm,
+        BC7Unorm,
         // Depth
         D16Unorm,
         D32Float,
@@ -37,6 +43,28 @@ namespace worse
         Max
     };
 
+    constexpr bool rhiFormatIsBlockCompressed(RHIFormat const format)
+    {
+        return (format >= RHIFormat::BC1Unorm) && (format <= RHIFormat::BC7Unorm);
+    }
+
+    // bytes of one 4x4 block, 0 for uncompressed formats
+    constexpr u32 rhiFormatBlockSize(RHIFormat const format)
+    {
+        switch (format)
+        {
+        case RHIFormat::BC1Unorm:
+        case RHIFormat::BC4Unorm:
+            return 8;
+        case RHIFormat::BC3Unorm:
+        case RHIFormat::BC5Unorm:
+        case RHIFormat::BC7Unorm:
+            return 16;
+        default:
+            return 0;
+        }
+    }
+
     enum class RHITextureType
     {
         Texture2D,
@@ -0,0 +1,35 @@
+#pragma once
+#include "Types.hpp"
+
+#include <future>
+#include <functional>
+
+namespace worse
+{
+
+    /**
+     * @brief 全局工作线程池
+     *
+     * 任务按提交顺序由工作线程执行, 返回的 future 用于等待单个任务完成.
+     * 未初始化时任务在调用线程上同步执行
+     */
+    class ThreadPool
+    {
+    public:
+        using Task = std::function<void()>;
+
+        // 0 means hardware concurrency - 1, leaving one core for the main thread
+        static void initialize(u32 const threadCount = 0);
+        // finish queued tasks and join all workers
+        static void shutdown();
+
+        static std::shared_future<void> addTask(Task task);
+
+        // clang-format off
+        static u32 getThreadCount();
+        static u32 getPendingTaskCount();
+        static bool isWorkerThread();
+        // clang-format on
+    };
+
+} // namespace worse
@@ -9,9 +9,10 @@ namespace worse
 {
     struct GlobalContext
     {
-        f32 deltaTime        = 0.0f;
-        f32 time             = 0.0f;
-        bool isWireFrameMode = false;
+        f32 deltaTime           = 0.0f;
+        f32 time                = 0.0f;
+        bool isWireFrameMode    = false;
+        bool isAsyncComputeMode = false;
     };
 
     struct Object
@@ -1,8 +1,12 @@
 #include "Log.hpp"
 #include "Engine.hpp"
 #include "Window.hpp"
+#include "Platform.hpp"
+#include "ThreadPool.hpp"
 #include "Input/Input.hpp"
 #include "RHIDefinitions.hpp"
+#include "PackedArchive.hpp"
+#include "VirtualFileSystem.hpp"
 
 namespace worse
 {
@@ -17,6 +21,23 @@ namespace worse
 #endif
 
         WS_LOG_INFO("Engine", "Initializing...");
+        ThreadPool::initialize();
+
+#ifdef WS_ENGINE_MOUNT_ARCHIVES
+        // packed builds read ArchivePacker's archives in place of the asset
+        // directories, other builds never mount them so a stale archive
+        // cannot shadow edited assets
+        std::filesystem::path const engineDirectory = EngineDirectory;
+        for (char const* name : {"Binary", "Shaders"})
+        {
+            std::filesystem::path const archive = PackedArchive::getEngineArchivePath(name);
+            if (!std::filesystem::exists(archive) || !VirtualFileSystem::mount(engineDirectory / name, archive))
+            {
+                WS_LOG_WARN("Engine", "No archive {}, reading {} from its directory", archive.string(), name);
+            }
+        }
+#endif
+
         Window::initialize();
         Input::initialize();
     }
@@ -30,6 +51,8 @@ namespace worse
     void Engine::shutdown()
     {
         Window::shutdown();
+        ThreadPool::shutdown();
+        VirtualFileSystem::unmountAll();
     }
 
 } // namespace worse
\ No newline at end of file
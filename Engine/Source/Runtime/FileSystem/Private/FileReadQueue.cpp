@@ -0,0 +1,447 @@
+#include "Log.hpp"
+#include "ThreadPool.hpp"
+#include "FileReadQueue.hpp"
+
+#include <limits>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#else
+#include <fstream>
+#endif
+
+#ifdef WS_FILE_IO_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+namespace worse
+{
+
+    struct FileReadQueue::Request
+    {
+        std::filesystem::path path;
+        u64 offset = 0;
+        u64 size   = 0;
+        // bytes already read into data
+        u64 done = 0;
+        int fd   = -1;
+
+        std::vector<byte> data;
+        std::promise<std::vector<byte>> promise;
+    };
+
+    namespace
+    {
+        using Request = FileReadQueue::Request;
+
+        // one read never asks for more, larger ranges are continued
+        constexpr u64 MAX_READ_SIZE = 1u << 30;
+        constexpr u32 RING_ENTRIES  = 64;
+
+        void finish(Request& request, bool const success)
+        {
+#if defined(__unix__) || defined(__APPLE__)
+            if (request.fd >= 0)
+            {
+                ::close(request.fd);
+                request.fd = -1;
+            }
+#endif
+            request.data.resize(success ? request.done : 0);
+            request.promise.set_value(std::move(request.data));
+        }
+
+#if defined(__unix__) || defined(__APPLE__)
+
+        // opens the file and sizes the destination
+        bool prepare(Request& request)
+        {
+            request.fd = ::open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (request.fd < 0)
+            {
+                WS_LOG_ERROR("FileStream", "Failed to open {}, errno {}", request.path.string(), errno);
+                return false;
+            }
+
+            struct stat info = {};
+            if ((fstat(request.fd, &info) != 0) || (request.offset > static_cast<u64>(info.st_size)))
+            {
+                WS_LOG_ERROR("FileStream", "Failed to stat {} or offset past the end", request.path.string());
+                return false;
+            }
+
+            u64 const available = static_cast<u64>(info.st_size) - request.offset;
+            request.size        = (request.size == 0) ? available : std::min(request.size, available);
+            request.data.resize(request.size);
+            return true;
+        }
+
+        void readBlocking(Request& request)
+        {
+            if (!prepare(request))
+            {
+                finish(request, false);
+                return;
+            }
+
+            while (request.done < request.size)
+            {
+                usize const chunk  = static_cast<usize>(std::min(request.size - request.done, MAX_READ_SIZE));
+                ssize_t const read = pread(request.fd, request.data.data() + request.done, chunk, static_cast<off_t>(request.offset + request.done));
+                if ((read < 0) && (errno == EINTR))
+                {
+                    continue;
+                }
+                if (read <= 0)
+                {
+                    // a file truncated meanwhile ends the read early
+                    break;
+                }
+                request.done += static_cast<u64>(read);
+            }
+            finish(request, true);
+        }
+
+#else
+
+        void readBlocking(Request& request)
+        {
+            std::ifstream file(request.path, std::ios::binary | std::ios::ate);
+            u64 const fileSize = file ? static_cast<u64>(file.tellg()) : 0;
+            if (!file || (request.offset > fileSize))
+            {
+                WS_LOG_ERROR("FileStream", "Failed to open {} or offset past the end", request.path.string());
+                finish(request, false);
+                return;
+            }
+
+            u64 const available = fileSize - request.offset;
+            request.size        = (request.size == 0) ? available : std::min(request.size, available);
+            request.data.resize(request.size);
+
+            file.seekg(static_cast<std::streamoff>(request.offset));
+            file.read(reinterpret_cast<char*>(request.data.data()), static_cast<std::streamsize>(request.size));
+            request.done = static_cast<u64>(file.gcount());
+            finish(request, true);
+        }
+
+#endif
+    } // namespace
+
+    FileReadQueue& FileReadQueue::get()
+    {
+        static FileReadQueue queue;
+        return queue;
+    }
+
+    FileReadQueue::FileReadQueue()
+    {
+#ifdef WS_FILE_IO_URING
+        if (!initializeRing())
+        {
+            destroyRing();
+            WS_LOG_WARN("FileStream", "io_uring unavailable, async reads run on the thread pool");
+        }
+#endif
+    }
+
+    FileReadQueue::~FileReadQueue()
+    {
+#ifdef WS_FILE_IO_URING
+        if (m_ringFd >= 0)
+        {
+            // a drained nop without user data starts only after every read
+            // before it completed, the reaper then finishes the short read
+            // continuations still in flight and stops
+            io_uring_sqe stop = {};
+            stop.opcode       = IORING_OP_NOP;
+            stop.flags        = IOSQE_IO_DRAIN;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_slotFreed.wait(lock, [this]() { return m_inFlight < m_entries; });
+                m_isStopping = true;
+                pushLocked(stop);
+            }
+            m_reaper.join();
+        }
+        destroyRing();
+#endif
+    }
+
+    std::shared_future<std::vector<byte>> FileReadQueue::submit(std::filesystem::path const& path, u64 const offset, u64 const size)
+    {
+        std::unique_ptr<Request> request = std::make_unique<Request>();
+        request->path   = path;
+        request->offset = offset;
+        request->size   = size;
+
+        std::shared_future<std::vector<byte>> future = request->promise.get_future().share();
+
+#ifdef WS_FILE_IO_URING
+        if (m_ringFd >= 0)
+        {
+            submitRing(std::move(request));
+            return future;
+        }
+#endif
+        submitFallback(std::move(request));
+        return future;
+    }
+
+    char const* FileReadQueue::getBackendName() const
+    {
+#ifdef WS_FILE_IO_URING
+        if (m_ringFd >= 0)
+        {
+            return "io_uring";
+        }
+#endif
+        return "thread pool";
+    }
+
+    void FileReadQueue::submitFallback(std::unique_ptr<Request> request)
+    {
+        // a worker waiting on its own pool could starve it, read inline there
+        if (ThreadPool::isWorkerThread())
+        {
+            readBlocking(*request);
+            return;
+        }
+
+        std::shared_ptr<Request> shared = std::move(request);
+        ThreadPool::addTask(
+            [shared]()
+            {
+                readBlocking(*shared);
+            });
+    }
+
+#ifdef WS_FILE_IO_URING
+
+    namespace
+    {
+        int ioUringSetup(u32 const entries, io_uring_params* params)
+        {
+            return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+        }
+
+        int ioUringEnter(int const fd, u32 const toSubmit, u32 const minComplete, u32 const flags)
+        {
+            return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+        }
+
+        template <typename T>
+        T* ringField(void* ring, u32 const offset)
+        {
+            return reinterpret_cast<T*>(static_cast<byte*>(ring) + offset);
+        }
+    } // namespace
+
+    bool FileReadQueue::initializeRing()
+    {
+        io_uring_params params = {};
+        m_ringFd               = ioUringSetup(RING_ENTRIES, &params);
+        // IORING_OP_READ came with the same kernel as this feature bit
+        if ((m_ringFd < 0) || !(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_RW_CUR_POS))
+        {
+            return false;
+        }
+
+        m_entries    = params.sq_entries;
+        m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(u32);
+        m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        // both rings share one mapping
+        m_sqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+        m_cqRingSize = m_sqRingSize;
+
+        m_sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+        if (m_sqRing == MAP_FAILED)
+        {
+            m_sqRing = nullptr;
+            return false;
+        }
+        m_cqRing = m_sqRing;
+
+        m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+        {
+            return false;
+        }
+        m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+        // clang-format off
+        m_sqHead  = ringField<u32>(m_sqRing, params.sq_off.head);
+        m_sqTail  = ringField<u32>(m_sqRing, params.sq_off.tail);
+        m_sqMask  = ringField<u32>(m_sqRing, params.sq_off.ring_mask);
+        m_sqArray = ringField<u32>(m_sqRing, params.sq_off.array);
+        m_cqHead  = ringField<u32>(m_cqRing, params.cq_off.head);
+        m_cqTail  = ringField<u32>(m_cqRing, params.cq_off.tail);
+        m_cqMask  = ringField<u32>(m_cqRing, params.cq_off.ring_mask);
+        m_cqes    = ringField<io_uring_cqe>(m_cqRing, params.cq_off.cqes);
+        // clang-format on
+
+        m_reaper = std::thread(&FileReadQueue::reap, this);
+        return true;
+    }
+
+    void FileReadQueue::destroyRing()
+    {
+        if (m_sqes)
+        {
+            munmap(m_sqes, m_sqesSize);
+            m_sqes = nullptr;
+        }
+        if (m_sqRing)
+        {
+            munmap(m_sqRing, m_sqRingSize);
+            m_sqRing = nullptr;
+            m_cqRing = nullptr;
+        }
+        if (m_ringFd >= 0)
+        {
+            ::close(m_ringFd);
+            m_ringFd = -1;
+        }
+    }
+
+    void FileReadQueue::submitRing(std::unique_ptr<Request> request)
+    {
+        // opening stays synchronous, only the read goes through the ring
+        if (!prepare(*request))
+        {
+            finish(*request, false);
+            return;
+        }
+        if (request->size == 0)
+        {
+            finish(*request, true);
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_slotFreed.wait(lock, [this]() { return (m_inFlight < m_entries) || m_isStopping; });
+        if (m_isStopping)
+        {
+            // the reaper is about to stop, the fallback reads from the start
+            lock.unlock();
+            ::close(request->fd);
+            request->fd = -1;
+            submitFallback(std::move(request));
+            return;
+        }
+
+        io_uring_sqe sqe = {};
+        sqe.opcode       = IORING_OP_READ;
+        sqe.fd           = request->fd;
+        sqe.addr         = reinterpret_cast<u64>(request->data.data());
+        sqe.len          = static_cast<u32>(std::min(request->size, MAX_READ_SIZE));
+        sqe.off          = request->offset;
+        sqe.user_data    = reinterpret_cast<u64>(request.release());
+        pushLocked(sqe);
+    }
+
+    void FileReadQueue::pushLocked(io_uring_sqe const& sqe)
+    {
+        // the mutex makes this the only producer, the kernel only reads
+        u32 const tail  = *m_sqTail;
+        u32 const index = tail & *m_sqMask;
+        m_sqes[index]   = sqe;
+        m_sqArray[index] = index;
+        __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+        ++m_inFlight;
+
+        // entries left by an interrupted enter go with this one
+        u32 const pending = tail + 1 - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+        if (ioUringEnter(m_ringFd, pending, 0, 0) < 0)
+        {
+            WS_LOG_ERROR("FileStream", "io_uring_enter failed to submit, errno {}", errno);
+        }
+    }
+
+    void FileReadQueue::reap()
+    {
+        while (true)
+        {
+            if ((ioUringEnter(m_ringFd, 0, 1, IORING_ENTER_GETEVENTS) < 0) && (errno != EINTR))
+            {
+                WS_LOG_ERROR("FileStream", "io_uring_enter failed to wait, errno {}", errno);
+            }
+
+            // the reaper is the only consumer
+            u32 head       = *m_cqHead;
+            u32 const tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head)
+            {
+                io_uring_cqe const cqe = m_cqes[head & *m_cqMask];
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_inFlight;
+                m_slotFreed.notify_all();
+
+                // the stop nop
+                Request* request = reinterpret_cast<Request*>(cqe.user_data);
+                if (!request)
+                {
+                    continue;
+                }
+
+                if ((cqe.res == -EINTR) || (cqe.res == -EAGAIN))
+                {
+                    // retried as is below
+                }
+                else if (cqe.res < 0)
+                {
+                    WS_LOG_ERROR("FileStream", "Failed to read {}, errno {}", request->path.string(), -cqe.res);
+                    finish(*request, false);
+                    delete request;
+                    continue;
+                }
+                else if (cqe.res == 0)
+                {
+                    // truncated meanwhile
+                    request->size = request->done;
+                }
+                else
+                {
+                    request->done += static_cast<u64>(cqe.res);
+                }
+
+                if (request->done >= request->size)
+                {
+                    finish(*request, true);
+                    delete request;
+                    continue;
+                }
+
+                // short read, continue where it ended
+                io_uring_sqe sqe = {};
+                sqe.opcode       = IORING_OP_READ;
+                sqe.fd           = request->fd;
+                sqe.addr         = reinterpret_cast<u64>(request->data.data() + request->done);
+                sqe.len          = static_cast<u32>(std::min(request->size - request->done, MAX_READ_SIZE));
+                sqe.off          = request->offset + request->done;
+                sqe.user_data    = reinterpret_cast<u64>(request);
+                pushLocked(sqe);
+            }
+            __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+
+            // every promise is set once nothing is in flight after the stop
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_isStopping && (m_inFlight == 0))
+            {
+                return;
+            }
+        }
+    }
+
+#endif
+
+} // namespace worse
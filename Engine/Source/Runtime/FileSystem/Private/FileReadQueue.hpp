@@ -0,0 +1,75 @@
+#pragma once
+#include "Types.hpp"
+
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+#include <future>
+#include <memory>
+#include <filesystem>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define WS_FILE_IO_URING
+struct io_uring_sqe;
+struct io_uring_cqe;
+#endif
+
+namespace worse
+{
+
+    // backend of FileStream::readAsync
+    class FileReadQueue : public NonCopyable
+    {
+    public:
+        // one readAsync call, owned by the ring while a read is in flight
+        struct Request;
+
+        static FileReadQueue& get();
+        ~FileReadQueue();
+
+        std::shared_future<std::vector<byte>> submit(std::filesystem::path const& path, u64 const offset, u64 const size);
+        char const* getBackendName() const;
+
+    private:
+        FileReadQueue();
+
+        // blocking read on a worker, or inline when already on one
+        static void submitFallback(std::unique_ptr<Request> request);
+
+#ifdef WS_FILE_IO_URING
+        bool initializeRing();
+        void destroyRing();
+        // blocks while every slot is in flight
+        void submitRing(std::unique_ptr<Request> request);
+        void pushLocked(io_uring_sqe const& sqe);
+        void reap();
+
+        int m_ringFd        = -1;
+        u32 m_entries       = 0;
+        u32 m_inFlight      = 0;
+        bool m_isStopping   = false;
+        std::mutex m_mutex;
+        // signalled by the reaper whenever a slot frees up
+        std::condition_variable m_slotFreed;
+        std::thread m_reaper;
+
+        void* m_sqRing      = nullptr;
+        void* m_cqRing      = nullptr;
+        usize m_sqRingSize  = 0;
+        usize m_cqRingSize  = 0;
+        io_uring_sqe* m_sqes = nullptr;
+        usize m_sqesSize    = 0;
+
+        u32* m_sqHead  = nullptr;
+        u32* m_sqTail  = nullptr;
+        u32* m_sqMask  = nullptr;
+        u32* m_sqArray = nullptr;
+        u32* m_cqHead  = nullptr;
+        u32* m_cqTail  = nullptr;
+        u32* m_cqMask  = nullptr;
+        io_uring_cqe* m_cqes = nullptr;
+#endif
+    };
+
+} // namespace worse
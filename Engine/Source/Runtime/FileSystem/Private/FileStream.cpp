@@ -1,10 +1,40 @@
 #include "Log.hpp"
 #include "FileStream.hpp"
+#include "FileReadQueue.hpp"
 #include "Definitions.hpp"
 
+#include <cstring>
+
 namespace worse
 {
 
+    namespace
+    {
+        // writes smaller than this are gathered, larger ones go out directly
+        constexpr usize WRITE_BUFFER_SIZE = 64 * 1024;
+
+        template <typename Container>
+        Container readRemaining(std::fstream& stream)
+        {
+            // one read of the known size instead of streaming per character
+            std::streampos const begin = stream.tellg();
+            stream.seekg(0, std::ios::end);
+            std::streampos const end = stream.tellg();
+            stream.seekg(begin);
+
+            Container content;
+            if ((begin < 0) || (end <= begin))
+            {
+                return content;
+            }
+
+            content.resize(static_cast<usize>(end - begin));
+            stream.read(reinterpret_cast<char*>(content.data()), static_cast<std::streamsize>(content.size()));
+            content.resize(static_cast<usize>(stream.gcount()));
+            return content;
+        }
+    } // namespace
+
     FileStream::FileStream(std::filesystem::path const& path,
                            FileStreamUsageFlags usage)
     {
@@ -39,6 +69,7 @@ namespace worse
                              path.string());
                 return;
             }
+            m_writeBuffer.reserve(WRITE_BUFFER_SIZE);
         }
 
         m_isOpen = m_stream.is_open();
@@ -64,7 +95,7 @@ namespace worse
 
         if ((m_usage & FileStreamUsageFlagBits::Write))
         {
-            m_stream.flush();
+            flush();
             m_stream.close();
         }
 
@@ -76,14 +107,68 @@ namespace worse
         WS_ASSERT(m_isOpen);
         WS_ASSERT(m_usage & FileStreamUsageFlagBits::Read);
 
-        std::string content((std::istreambuf_iterator<char>(m_stream)),
-                            std::istreambuf_iterator<char>());
-        return content;
+        return readRemaining<std::string>(m_stream);
+    }
+
+    std::vector<byte> FileStream::readBytes()
+    {
+        WS_ASSERT(m_isOpen);
+        WS_ASSERT(m_usage & FileStreamUsageFlagBits::Read);
+
+        return readRemaining<std::vector<byte>>(m_stream);
+    }
+
+    bool FileStream::write(void const* data, usize const size)
+    {
+        WS_ASSERT(m_isOpen);
+        WS_ASSERT(m_usage & FileStreamUsageFlagBits::Write);
+
+        if (m_writeBuffer.size() + size > WRITE_BUFFER_SIZE)
+        {
+            flush();
+        }
+
+        if (size >= WRITE_BUFFER_SIZE)
+        {
+            m_stream.write(static_cast<char const*>(data), static_cast<std::streamsize>(size));
+            m_isGood = m_isGood && m_stream.good();
+            return m_isGood;
+        }
+
+        usize const offset = m_writeBuffer.size();
+        m_writeBuffer.resize(offset + size);
+        std::memcpy(m_writeBuffer.data() + offset, data, size);
+        return m_isGood;
+    }
+
+    bool FileStream::write(std::string_view text)
+    {
+        return write(text.data(), text.size());
+    }
+
+    bool FileStream::flush()
+    {
+        if (!m_writeBuffer.empty())
+        {
+            m_stream.write(reinterpret_cast<char const*>(m_writeBuffer.data()), static_cast<std::streamsize>(m_writeBuffer.size()));
+            m_writeBuffer.clear();
+        }
+        m_stream.flush();
+
+        m_isGood = m_isGood && m_stream.good();
+        return m_isGood;
+    }
+
+    std::shared_future<std::vector<byte>> FileStream::readAsync(std::filesystem::path const& path,
+                                                                u64 const offset,
+                                                                u64 const size)
+    {
+        return FileReadQueue::get().submit(path, offset, size);
     }
 
-    void FileStream::write()
+    char const* FileStream::getAsyncBackendName()
     {
-        UNIMPLEMENTED();
+        return FileReadQueue::get().getBackendName();
     }
 
-} // namespace worse
\ No newline at end of file
+} // namespace worse
@@ -11,6 +11,7 @@ namespace worse
         std::array<std::string, 3> supporteImagedExtensions = {
             ".png",
             ".jpg",
+            ".dds",
         };
         // clang-format on
     } // namespace
@@ -43,4 +44,15 @@ namespace worse
         return std::filesystem::is_directory(path);
     }
 
+    std::filesystem::path FileSystem::canonicalize(std::filesystem::path const& path)
+    {
+        std::error_code ec;
+        std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(path, ec);
+        if (ec)
+        {
+            canonicalPath = std::filesystem::absolute(path, ec).lexically_normal();
+        }
+        return canonicalPath;
+    }
+
 } // namespace worse
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "Log.hpp"
+#include "FileSystem.hpp"
+#include "FileWatcher.hpp"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <cerrno>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+namespace worse
+{
+
+    namespace
+    {
+        void addUnique(std::vector<std::filesystem::path>& paths, std::filesystem::path const& path)
+        {
+            std::filesystem::path const canonicalPath = FileSystem::canonicalize(path);
+            if (std::find(paths.begin(), paths.end(), canonicalPath) == paths.end())
+            {
+                paths.push_back(canonicalPath);
+            }
+        }
+    } // namespace
+
+#ifdef __linux__
+
+    FileWatcher::FileWatcher()
+    {
+        m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_fd < 0)
+        {
+            WS_LOG_ERROR("FileWatcher", "Failed to initialize inotify, errno {}", errno);
+            return;
+        }
+
+        m_isValid = true;
+    }
+
+    FileWatcher::~FileWatcher()
+    {
+        if (m_fd >= 0)
+        {
+            // closing the instance removes all watches
+            close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    bool FileWatcher::watchDirectory(std::filesystem::path const& directory)
+    {
+        if (!m_isValid || !std::filesystem::is_directory(directory))
+        {
+            return false;
+        }
+
+        // editors either rewrite the file or rename a temporary over it
+        u32 const mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+        std::vector<std::filesystem::path> directories = {directory};
+        for (std::filesystem::directory_entry const& entry : std::filesystem::recursive_directory_iterator(directory))
+        {
+            if (entry.is_directory())
+            {
+                directories.push_back(entry.path());
+            }
+        }
+
+        for (std::filesystem::path const& path : directories)
+        {
+            int const wd = inotify_add_watch(m_fd, path.c_str(), mask);
+            if (wd < 0)
+            {
+                WS_LOG_WARN("FileWatcher", "Failed to watch {}, errno {}", path.string(), errno);
+                continue;
+            }
+            m_directories[wd] = path;
+        }
+
+        return true;
+    }
+
+    std::vector<std::filesystem::path> FileWatcher::poll()
+    {
+        std::vector<std::filesystem::path> changed;
+        if (!m_isValid)
+        {
+            return changed;
+        }
+
+        alignas(inotify_event) char buffer[4096];
+        while (true)
+        {
+            ssize_t const length = read(m_fd, buffer, sizeof(buffer));
+            if (length <= 0)
+            {
+                // EAGAIN, nothing left to read
+                break;
+            }
+
+            for (char const* ptr = buffer; ptr < buffer + length;)
+            {
+                inotify_event const* event = reinterpret_cast<inotify_event const*>(ptr);
+                ptr += sizeof(inotify_event) + event->len;
+
+                if ((event->len == 0) || (event->mask & IN_ISDIR))
+                {
+                    continue;
+                }
+
+                auto it = m_directories.find(event->wd);
+                if (it != m_directories.end())
+                {
+                    addUnique(changed, it->second / event->name);
+                }
+            }
+        }
+
+        return changed;
+    }
+
+#else
+
+    FileWatcher::FileWatcher()
+    {
+        m_isValid = true;
+    }
+
+    FileWatcher::~FileWatcher()
+    {
+    }
+
+    bool FileWatcher::watchDirectory(std::filesystem::path const& directory)
+    {
+        if (!std::filesystem::is_directory(directory))
+        {
+            return false;
+        }
+
+        m_directories.push_back(directory);
+        for (std::filesystem::directory_entry const& entry : std::filesystem::recursive_directory_iterator(directory))
+        {
+            if (entry.is_regular_file())
+            {
+                m_writeTimes[entry.path()] = entry.last_write_time();
+            }
+        }
+
+        return true;
+    }
+
+    std::vector<std::filesystem::path> FileWatcher::poll()
+    {
+        std::vector<std::filesystem::path> changed;
+
+        for (std::filesystem::path const& directory : m_directories)
+        {
+            std::error_code ec;
+            for (std::filesystem::directory_entry const& entry : std::filesystem::recursive_directory_iterator(directory, ec))
+            {
+                if (!entry.is_regular_file())
+                {
+                    continue;
+                }
+
+                std::filesystem::file_time_type const writeTime = entry.last_write_time(ec);
+                auto [it, inserted] = m_writeTimes.try_emplace(entry.path(), writeTime);
+                if (inserted || (it->second != writeTime))
+                {
+                    it->second = writeTime;
+                    addUnique(changed, entry.path());
+                }
+            }
+        }
+
+        return changed;
+    }
+
+#endif
+
+} // namespace worse
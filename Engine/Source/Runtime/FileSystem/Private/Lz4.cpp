@@ -0,0 +1,203 @@
+#include "Lz4.hpp"
+
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+namespace worse::lz4
+{
+
+    namespace
+    {
+        // clang-format off
+        constexpr usize MIN_MATCH     = 4;
+        // the last match starts this far before the end at the latest
+        constexpr usize MATCH_LIMIT   = 12;
+        // the block always ends with this many literals
+        constexpr usize LAST_LITERALS = 5;
+        constexpr usize MAX_OFFSET    = 65535;
+        constexpr u32 HASH_BITS       = 16;
+        // clang-format on
+
+        u32 read32(u8 const* p)
+        {
+            u32 value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        u32 hash(u32 const sequence)
+        {
+            return (sequence * 2654435761u) >> (32 - HASH_BITS);
+        }
+
+        // length above the 4 bit token field, 255 per byte
+        u8* writeLength(u8* op, usize length)
+        {
+            for (; length >= 255; length -= 255)
+            {
+                *op++ = 255;
+            }
+            *op++ = static_cast<u8>(length);
+            return op;
+        }
+
+        u8* writeSequence(u8* op, u8 const* literals, usize const literalLength, usize const offset, usize const matchLength)
+        {
+            u8* token = op++;
+            *token    = static_cast<u8>(std::min<usize>(literalLength, 15) << 4);
+            if (literalLength >= 15)
+            {
+                op = writeLength(op, literalLength - 15);
+            }
+            std::memcpy(op, literals, literalLength);
+            op += literalLength;
+
+            // the last sequence only has literals
+            if (matchLength == 0)
+            {
+                return op;
+            }
+
+            *op++ = static_cast<u8>(offset & 0xFF);
+            *op++ = static_cast<u8>(offset >> 8);
+
+            usize const length = matchLength - MIN_MATCH;
+            *token |= static_cast<u8>(std::min<usize>(length, 15));
+            if (length >= 15)
+            {
+                op = writeLength(op, length - 15);
+            }
+            return op;
+        }
+
+        // false when the extension runs past the end
+        bool readLength(u8 const*& ip, u8 const* end, usize& length)
+        {
+            u8 value = 255;
+            while (value == 255)
+            {
+                if (ip >= end)
+                {
+                    return false;
+                }
+                value = *ip++;
+                length += value;
+            }
+            return true;
+        }
+    } // namespace
+
+    usize compressBound(usize const size)
+    {
+        return size + size / 255 + 16;
+    }
+
+    usize compress(std::span<byte const> src, byte* dst)
+    {
+        u8 const* base = reinterpret_cast<u8 const*>(src.data());
+        u8* op         = reinterpret_cast<u8*>(dst);
+        usize const n  = src.size();
+
+        usize anchor = 0;
+        if (n > MATCH_LIMIT)
+        {
+            // positions + 1, zero is an empty slot
+            std::vector<u32> table(1u << HASH_BITS, 0);
+
+            usize const matchEnd = n - LAST_LITERALS;
+            usize ip             = 0;
+            while (ip < n - MATCH_LIMIT)
+            {
+                u32 const sequence = read32(base + ip);
+                u32& slot          = table[hash(sequence)];
+                usize const ref    = slot;
+                slot               = static_cast<u32>(ip + 1);
+
+                if ((ref == 0) || (ip - (ref - 1) > MAX_OFFSET) || (read32(base + ref - 1) != sequence))
+                {
+                    ++ip;
+                    continue;
+                }
+
+                usize const match = ref - 1;
+                usize length      = MIN_MATCH;
+                while ((ip + length < matchEnd) && (base[match + length] == base[ip + length]))
+                {
+                    ++length;
+                }
+
+                op     = writeSequence(op, base + anchor, ip - anchor, ip - match, length);
+                ip     += length;
+                anchor = ip;
+            }
+        }
+
+        op = writeSequence(op, base + anchor, n - anchor, 0, 0);
+        return static_cast<usize>(op - reinterpret_cast<u8*>(dst));
+    }
+
+    bool decompress(std::span<byte const> src, std::span<byte> dst)
+    {
+        u8 const* ip        = reinterpret_cast<u8 const*>(src.data());
+        u8 const* const end = ip + src.size();
+        u8* const begin     = reinterpret_cast<u8*>(dst.data());
+        u8* op              = begin;
+        u8* const opEnd     = begin + dst.size();
+
+        while (ip < end)
+        {
+            u8 const token       = *ip++;
+            usize literalLength  = token >> 4;
+            if ((literalLength == 15) && !readLength(ip, end, literalLength))
+            {
+                return false;
+            }
+            if ((literalLength > static_cast<usize>(end - ip)) || (literalLength > static_cast<usize>(opEnd - op)))
+            {
+                return false;
+            }
+            std::memcpy(op, ip, literalLength);
+            ip += literalLength;
+            op += literalLength;
+
+            if (ip == end)
+            {
+                break;
+            }
+
+            if (end - ip < 2)
+            {
+                return false;
+            }
+            usize const offset = static_cast<usize>(ip[0]) | (static_cast<usize>(ip[1]) << 8);
+            ip += 2;
+            if ((offset == 0) || (offset > static_cast<usize>(op - begin)))
+            {
+                return false;
+            }
+
+            usize matchLength = token & 15;
+            if ((matchLength == 15) && !readLength(ip, end, matchLength))
+            {
+                return false;
+            }
+            matchLength += MIN_MATCH;
+            if (matchLength > static_cast<usize>(opEnd - op))
+            {
+                return false;
+            }
+
+            // overlapping copies repeat the last offset bytes
+            u8 const* match = op - offset;
+            for (usize i = 0; i < matchLength; ++i)
+            {
+                op[i] = match[i];
+            }
+            op += matchLength;
+        }
+
+        return op == opEnd;
+    }
+
+} // namespace worse::lz4
@@ -0,0 +1,18 @@
+#pragma once
+#include "Types.hpp"
+
+#include <span>
+
+namespace worse::lz4
+{
+
+    // LZ4 block format, without the frame header of the lz4 tool
+
+    // worst case size of the compressed data
+    usize compressBound(usize const size);
+    // returns the compressed size, dst holds at least compressBound bytes
+    usize compress(std::span<byte const> src, byte* dst);
+    // false unless the block expands to exactly dst.size() bytes
+    bool decompress(std::span<byte const> src, std::span<byte> dst);
+
+} // namespace worse::lz4
@@ -0,0 +1,129 @@
+#include "Log.hpp"
+#include "MappedFile.hpp"
+
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#include <fstream>
+#endif
+
+namespace worse
+{
+
+    MappedFile::MappedFile(std::filesystem::path const& path)
+    {
+        open(path);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+#if !defined(__unix__) && !defined(__APPLE__)
+            m_buffer = std::move(other.m_buffer);
+#endif
+        }
+        return *this;
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+
+    bool MappedFile::open(std::filesystem::path const& path)
+    {
+        close();
+
+        int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            WS_LOG_ERROR("MappedFile", "Failed to open {}, errno {}", path.string(), errno);
+            return false;
+        }
+
+        struct stat info = {};
+        if ((fstat(fd, &info) != 0) || (info.st_size <= 0))
+        {
+            WS_LOG_ERROR("MappedFile", "Failed to stat {} or file is empty", path.string());
+            ::close(fd);
+            return false;
+        }
+
+        void* data = mmap(nullptr, static_cast<usize>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        // the mapping keeps its own reference to the file
+        ::close(fd);
+        if (data == MAP_FAILED)
+        {
+            WS_LOG_ERROR("MappedFile", "Failed to map {}, errno {}", path.string(), errno);
+            return false;
+        }
+
+        m_data = static_cast<byte const*>(data);
+        m_size = static_cast<usize>(info.st_size);
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_data)
+        {
+            munmap(const_cast<byte*>(m_data), m_size);
+        }
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+#else
+
+    bool MappedFile::open(std::filesystem::path const& path)
+    {
+        close();
+
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            WS_LOG_ERROR("MappedFile", "Failed to open {}", path.string());
+            return false;
+        }
+
+        m_buffer.resize(static_cast<usize>(file.tellg()));
+        file.seekg(0);
+        if (m_buffer.empty() || !file.read(reinterpret_cast<char*>(m_buffer.data()), static_cast<std::streamsize>(m_buffer.size())))
+        {
+            WS_LOG_ERROR("MappedFile", "Failed to read {} or file is empty", path.string());
+            m_buffer = {};
+            return false;
+        }
+
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        m_buffer = {};
+        m_data   = nullptr;
+        m_size   = 0;
+    }
+
+#endif
+
+} // namespace worse
@@ -0,0 +1,295 @@
+#include "Log.hpp"
+#include "Lz4.hpp"
+#include "Platform.hpp"
+#include "PackedArchive.hpp"
+#include "Profiling/Stopwatch.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+
+namespace worse
+{
+
+    static_assert(sizeof(PackedArchive::FileHeader) == 24);
+    static_assert(sizeof(PackedArchive::Entry) == 40);
+
+    namespace
+    {
+        u64 alignUp(u64 const value)
+        {
+            return (value + PackedArchive::DATA_ALIGNMENT - 1) & ~static_cast<u64>(PackedArchive::DATA_ALIGNMENT - 1);
+        }
+
+        bool isInside(u64 const offset, u64 const size, u64 const fileSize)
+        {
+            return (offset <= fileSize) && (size <= fileSize - offset);
+        }
+
+        bool isKnown(PackedCompression const compression)
+        {
+            return (compression == PackedCompression::None) || (compression == PackedCompression::LZ4);
+        }
+    } // namespace
+
+    bool PackedArchive::open(std::filesystem::path const& path)
+    {
+        m_entries = {};
+        m_names   = {};
+        if (!m_file.open(path))
+        {
+            return false;
+        }
+
+        byte const* data = m_file.getData();
+        u64 const size   = m_file.getSize();
+
+        FileHeader header = {};
+        if (size >= sizeof(header))
+        {
+            std::memcpy(&header, data, sizeof(header));
+        }
+        if ((size < sizeof(header)) || (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) || (header.version != VERSION))
+        {
+            WS_LOG_ERROR("PackedArchive", "{} is not a version {} archive", path.string(), VERSION);
+            m_file.close();
+            return false;
+        }
+
+        u64 const tocSize = static_cast<u64>(header.entryCount) * sizeof(Entry);
+        if ((header.tocOffset % alignof(Entry) != 0) || !isInside(header.tocOffset, tocSize + header.namesSize, size))
+        {
+            WS_LOG_ERROR("PackedArchive", "{} has a damaged table of contents", path.string());
+            m_file.close();
+            return false;
+        }
+
+        m_entries = {reinterpret_cast<Entry const*>(data + header.tocOffset), header.entryCount};
+        m_names   = {reinterpret_cast<char const*>(data + header.tocOffset + tocSize), header.namesSize};
+        for (usize i = 0; i < m_entries.size(); ++i)
+        {
+            Entry const& entry = m_entries[i];
+            char const* error  = nullptr;
+            if (!isInside(entry.nameOffset, entry.nameSize, m_names.size()) || !isInside(entry.dataOffset, entry.storedSize, size))
+            {
+                error = "an entry out of bounds";
+            }
+            else if (!isKnown(entry.compression) || ((entry.compression == PackedCompression::None) && (entry.storedSize != entry.size)))
+            {
+                error = "an entry with an unknown compression";
+            }
+            // find bisects, so the names have to be strictly increasing
+            else if ((i > 0) && !(getName(m_entries[i - 1]) < getName(entry)))
+            {
+                error = "an unsorted or duplicate name";
+            }
+
+            if (error)
+            {
+                WS_LOG_ERROR("PackedArchive", "{} has {}", path.string(), error);
+                m_entries = {};
+                m_names   = {};
+                m_file.close();
+                return false;
+            }
+        }
+
+        m_path = path;
+        return true;
+    }
+
+    PackedArchive::Entry const* PackedArchive::find(std::string_view relativePath) const
+    {
+        auto it = std::lower_bound(m_entries.begin(),
+                                   m_entries.end(),
+                                   relativePath,
+                                   [this](Entry const& entry, std::string_view name)
+                                   {
+                                       return getName(entry) < name;
+                                   });
+        return ((it != m_entries.end()) && (getName(*it) == relativePath)) ? &*it : nullptr;
+    }
+
+    std::string_view PackedArchive::getName(Entry const& entry) const
+    {
+        return m_names.substr(entry.nameOffset, entry.nameSize);
+    }
+
+    std::span<byte const> PackedArchive::getStoredData(Entry const& entry) const
+    {
+        return m_file.getSpan().subspan(entry.dataOffset, entry.storedSize);
+    }
+
+    bool PackedArchive::decompress(Entry const& entry, std::span<byte> dst) const
+    {
+        return decompress(entry, getStoredData(entry), dst);
+    }
+
+    bool PackedArchive::decompress(Entry const& entry, std::span<byte const> stored, std::span<byte> dst)
+    {
+        if ((dst.size() != entry.size) || (stored.size() != entry.storedSize))
+        {
+            return false;
+        }
+
+        switch (entry.compression)
+        {
+        case PackedCompression::None:
+            if (!dst.empty())
+            {
+                std::memcpy(dst.data(), stored.data(), dst.size());
+            }
+            return true;
+        case PackedCompression::LZ4:
+            return lz4::decompress(stored, dst);
+        default:
+            return false;
+        }
+    }
+
+    std::filesystem::path PackedArchive::getEngineArchivePath(std::string_view name)
+    {
+        return (std::filesystem::path{EngineDirectory} / "Intermediate/Archives" / name).concat(EXTENSION);
+    }
+
+    bool PackedArchive::build(std::filesystem::path const& directory,
+                              std::filesystem::path const& output,
+                              bool const compress,
+                              PackedArchiveStatistics* statistics)
+    {
+        profiling::Stopwatch stopwatch;
+
+        // sorted once here, lookups bisect the table
+        std::vector<std::pair<std::string, std::filesystem::path>> files;
+        std::error_code ec;
+        for (std::filesystem::recursive_directory_iterator it(directory, ec), end; !ec && (it != end); it.increment(ec))
+        {
+            // an older archive may sit in the directory it packs
+            std::error_code same;
+            if (!it->is_regular_file() || std::filesystem::equivalent(it->path(), output, same))
+            {
+                continue;
+            }
+            files.emplace_back(it->path().lexically_relative(directory).generic_string(), it->path());
+        }
+        if (ec)
+        {
+            WS_LOG_ERROR("PackedArchive", "Failed to list {}", directory.string());
+            return false;
+        }
+        std::sort(files.begin(), files.end());
+
+        PackedArchiveStatistics result;
+        std::vector<Entry> entries(files.size());
+        std::string names;
+
+        // a crash mid write must not leave a truncated archive in place. the
+        // stream closes when the lambda returns, so a failed write can be removed
+        std::filesystem::path const temporary = std::filesystem::path{output}.concat(".tmp");
+        bool const isWritten = [&]()
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            auto padTo = [&file](u64 const position)
+            {
+                char const zeros[DATA_ALIGNMENT] = {};
+                file.write(zeros, static_cast<std::streamsize>(position - static_cast<u64>(file.tellp())));
+            };
+
+            FileHeader header = {};
+            file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+            std::vector<byte> compressed;
+            for (usize i = 0; i < files.size(); ++i)
+            {
+                Entry& entry      = entries[i];
+                entry             = {};
+                entry.nameOffset  = static_cast<u32>(names.size());
+                entry.nameSize    = static_cast<u32>(files[i].first.size());
+                entry.compression = PackedCompression::None;
+                names.append(files[i].first);
+
+                // empty files have nothing to map
+                MappedFile source;
+                if ((std::filesystem::file_size(files[i].second, ec) > 0) && !source.open(files[i].second))
+                {
+                    WS_LOG_ERROR("PackedArchive", "Failed to read {}", files[i].second.string());
+                    return false;
+                }
+
+                std::span<byte const> stored = source.getSpan();
+                if (compress && !stored.empty())
+                {
+                    compressed.resize(lz4::compressBound(stored.size()));
+                    usize const compressedSize = lz4::compress(stored, compressed.data());
+                    // already compressed formats rarely gain enough to pay for the decode
+                    if (compressedSize < stored.size() - stored.size() / 8)
+                    {
+                        stored            = {compressed.data(), compressedSize};
+                        entry.compression = PackedCompression::LZ4;
+                        ++result.compressedCount;
+                    }
+                }
+
+                padTo(alignUp(static_cast<u64>(file.tellp())));
+                entry.dataOffset = static_cast<u64>(file.tellp());
+                entry.storedSize = stored.size();
+                entry.size       = source.getSize();
+                file.write(reinterpret_cast<char const*>(stored.data()), static_cast<std::streamsize>(stored.size()));
+
+                result.sourceBytes += entry.size;
+            }
+
+            padTo(alignUp(static_cast<u64>(file.tellp())));
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version    = VERSION;
+            header.entryCount = static_cast<u32>(entries.size());
+            header.namesSize  = static_cast<u32>(names.size());
+            header.tocOffset  = static_cast<u64>(file.tellp());
+            file.write(reinterpret_cast<char const*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+            file.write(names.data(), static_cast<std::streamsize>(names.size()));
+            result.archiveBytes = static_cast<u64>(file.tellp());
+
+            file.seekp(0);
+            file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+            if (!file)
+            {
+                WS_LOG_ERROR("PackedArchive", "Failed to write {}", temporary.string());
+                return false;
+            }
+            return true;
+        }();
+
+        if (isWritten)
+        {
+            std::filesystem::rename(temporary, output, ec);
+            if (ec)
+            {
+                WS_LOG_ERROR("PackedArchive", "Failed to move {} into place", output.string());
+            }
+        }
+        if (!isWritten || ec)
+        {
+            std::error_code removed;
+            std::filesystem::remove(temporary, removed);
+            return false;
+        }
+
+        result.fileCount = static_cast<u32>(entries.size());
+        result.elapsedMs = stopwatch.elapsedMs();
+        if (statistics)
+        {
+            *statistics = result;
+        }
+
+        WS_LOG_INFO("PackedArchive",
+                    "{}: {} files, {} compressed in {:.2f} ms, {:.1f} MB -> {:.1f} MB",
+                    output.string(),
+                    result.fileCount,
+                    result.compressedCount,
+                    result.elapsedMs,
+                    result.sourceBytes / (1024.0 * 1024.0),
+                    result.archiveBytes / (1024.0 * 1024.0));
+        return true;
+    }
+
+} // namespace worse
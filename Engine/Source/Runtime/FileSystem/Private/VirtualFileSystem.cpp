@@ -0,0 +1,244 @@
+#include "Log.hpp"
+#include "FileSystem.hpp"
+#include "FileStream.hpp"
+#include "MappedFile.hpp"
+#include "PackedArchive.hpp"
+#include "VirtualFileSystem.hpp"
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <shared_mutex>
+
+namespace worse
+{
+
+    namespace
+    {
+        struct Mount
+        {
+            // normalized, without trailing separator
+            std::string prefix;
+            std::filesystem::path directory;
+            // shared with the files that reference its mapping
+            std::shared_ptr<PackedArchive> archive;
+        };
+
+        std::shared_mutex mtxMounts;
+        std::vector<Mount> mounts;
+
+        // absolute with '/' separators, the form archive entries are keyed by
+        std::string normalize(std::filesystem::path const& path)
+        {
+            std::error_code ec;
+            std::filesystem::path const absolute = std::filesystem::absolute(path, ec);
+            std::string normalized               = (ec ? path : absolute).lexically_normal().generic_string();
+            while ((normalized.size() > 1) && (normalized.back() == '/'))
+            {
+                normalized.pop_back();
+            }
+            return normalized;
+        }
+
+        // path below the mount point, empty when outside of it
+        std::string_view getRelative(std::string_view path, std::string const& prefix)
+        {
+            if ((path.size() <= prefix.size() + 1) || !path.starts_with(prefix) || (path[prefix.size()] != '/'))
+            {
+                return {};
+            }
+            return path.substr(prefix.size() + 1);
+        }
+
+        std::optional<VirtualFile> openPhysical(std::filesystem::path const& path)
+        {
+            std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+            if (!file->open(path))
+            {
+                // empty files have nothing to map
+                std::error_code ec;
+                bool const isEmpty = std::filesystem::is_regular_file(path, ec) && (std::filesystem::file_size(path, ec) == 0) && !ec;
+                return isEmpty ? std::make_optional(VirtualFile{}) : std::nullopt;
+            }
+
+            std::span<byte const> const data = file->getSpan();
+            return VirtualFile{std::move(file), data};
+        }
+
+        std::optional<VirtualFile> openEntry(std::shared_ptr<PackedArchive> const& archive, PackedArchive::Entry const& entry)
+        {
+            if (entry.compression == PackedCompression::None)
+            {
+                return VirtualFile{archive, archive->getStoredData(entry)};
+            }
+
+            std::shared_ptr<std::vector<byte>> buffer = std::make_shared<std::vector<byte>>(entry.size);
+            if (!archive->decompress(entry, *buffer))
+            {
+                WS_LOG_ERROR("VirtualFileSystem", "Damaged entry {} in {}", archive->getName(entry), archive->getPath().string());
+                return std::nullopt;
+            }
+
+            std::span<byte const> const data{buffer->data(), buffer->size()};
+            return VirtualFile{std::move(buffer), data};
+        }
+
+        std::shared_future<std::vector<byte>> readEntryAsync(std::shared_ptr<PackedArchive> const& archive, PackedArchive::Entry const& entry)
+        {
+            // a size of 0 would read to the end of the archive
+            if (entry.storedSize == 0)
+            {
+                std::promise<std::vector<byte>> empty;
+                empty.set_value({});
+                return empty.get_future().share();
+            }
+
+            std::shared_future<std::vector<byte>> stored = FileStream::readAsync(archive->getPath(), entry.dataOffset, entry.storedSize);
+            if (entry.compression == PackedCompression::None)
+            {
+                return stored;
+            }
+
+            return std::async(std::launch::deferred,
+                              [archive, entry, stored]()
+                              {
+                                  std::vector<byte> data(entry.size);
+                                  if (!PackedArchive::decompress(entry, stored.get(), data))
+                                  {
+                                      WS_LOG_ERROR("VirtualFileSystem", "Damaged entry {} in {}", archive->getName(entry), archive->getPath().string());
+                                      data.clear();
+                                  }
+                                  return data;
+                              })
+                .share();
+        }
+    } // namespace
+
+    bool VirtualFileSystem::mount(std::filesystem::path const& mountPoint, std::filesystem::path const& source)
+    {
+        Mount mount;
+        mount.prefix = normalize(mountPoint);
+
+        if (FileSystem::isDirectoryExists(source))
+        {
+            mount.directory = source;
+            WS_LOG_INFO("VirtualFileSystem", "Mounted {} at {}", source.string(), mount.prefix);
+        }
+        else
+        {
+            mount.archive = std::make_shared<PackedArchive>();
+            if (!mount.archive->open(source))
+            {
+                WS_LOG_ERROR("VirtualFileSystem", "Failed to mount {}", source.string());
+                return false;
+            }
+            WS_LOG_INFO("VirtualFileSystem", "Mounted {} at {} ({} files)", source.string(), mount.prefix, mount.archive->getEntries().size());
+        }
+
+        std::unique_lock<std::shared_mutex> lock(mtxMounts);
+        mounts.push_back(std::move(mount));
+        return true;
+    }
+
+    void VirtualFileSystem::unmountAll()
+    {
+        // files still open keep their archive mapped
+        std::unique_lock<std::shared_mutex> lock(mtxMounts);
+        mounts.clear();
+    }
+
+    bool VirtualFileSystem::exists(std::filesystem::path const& path)
+    {
+        {
+            std::shared_lock<std::shared_mutex> lock(mtxMounts);
+            if (!mounts.empty())
+            {
+                std::string const normalized = normalize(path);
+                for (auto it = mounts.rbegin(); it != mounts.rend(); ++it)
+                {
+                    std::string_view const relative = getRelative(normalized, it->prefix);
+                    if (relative.empty())
+                    {
+                        continue;
+                    }
+
+                    bool const found = it->archive ? (it->archive->find(relative) != nullptr)
+                                                   : FileSystem::isFileExists(it->directory / relative);
+                    if (found)
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        return FileSystem::isFileExists(path);
+    }
+
+    std::optional<VirtualFile> VirtualFileSystem::open(std::filesystem::path const& path)
+    {
+        {
+            std::shared_lock<std::shared_mutex> lock(mtxMounts);
+            if (!mounts.empty())
+            {
+                std::string const normalized = normalize(path);
+                for (auto it = mounts.rbegin(); it != mounts.rend(); ++it)
+                {
+                    std::string_view const relative = getRelative(normalized, it->prefix);
+                    if (relative.empty())
+                    {
+                        continue;
+                    }
+
+                    if (it->archive)
+                    {
+                        if (PackedArchive::Entry const* entry = it->archive->find(relative))
+                        {
+                            return openEntry(it->archive, *entry);
+                        }
+                    }
+                    else if (FileSystem::isFileExists(it->directory / relative))
+                    {
+                        return openPhysical(it->directory / relative);
+                    }
+                }
+            }
+        }
+
+        return openPhysical(path);
+    }
+
+    std::shared_future<std::vector<byte>> VirtualFileSystem::readAsync(std::filesystem::path const& path)
+    {
+        {
+            std::shared_lock<std::shared_mutex> lock(mtxMounts);
+            if (!mounts.empty())
+            {
+                std::string const normalized = normalize(path);
+                for (auto it = mounts.rbegin(); it != mounts.rend(); ++it)
+                {
+                    std::string_view const relative = getRelative(normalized, it->prefix);
+                    if (relative.empty())
+                    {
+                        continue;
+                    }
+
+                    if (it->archive)
+                    {
+                        if (PackedArchive::Entry const* entry = it->archive->find(relative))
+                        {
+                            return readEntryAsync(it->archive, *entry);
+                        }
+                    }
+                    else if (FileSystem::isFileExists(it->directory / relative))
+                    {
+                        return FileStream::readAsync(it->directory / relative);
+                    }
+                }
+            }
+        }
+
+        return FileStream::readAsync(path);
+    }
+
+} // namespace worse
@@ -1,6 +1,9 @@
 #pragma once
 #include "Types.hpp"
 
+#include <span>
+#include <vector>
+#include <future>
 #include <fstream>
 #include <filesystem>
 
@@ -14,7 +17,13 @@ namespace worse
         static constexpr FileStreamUsageFlags Write{1 << 1};
     };
 
-    class FileStream
+    /**
+     * @brief 文件读写流
+     *
+     * 写入先进入固定大小的缓冲, 写满或关闭时整块写出. 只读的整文件访问使用
+     * MappedFile, 后台读取使用 readAsync
+     */
+    class FileStream : public NonCopyable
     {
     public:
         FileStream(std::filesystem::path const& path,
@@ -23,10 +32,30 @@ namespace worse
 
         void close();
 
-        // read string file
+        // read the rest of the file as string
         std::string read();
+        // read the rest of the file as bytes
+        std::vector<byte> readBytes();
 
-        void write();
+        // buffered, false once a write to the file failed
+        bool write(void const* data, usize const size);
+        bool write(std::string_view text);
+        bool flush();
+
+        /**
+         * @brief 异步读取文件的一段
+         *
+         * Linux 上提交到 io_uring, 由一个完成线程收集结果, 其他平台或内核不支持
+         * 时在线程池上读取. 出错时结果为空
+         *
+         * @param size 0 时读取到文件末尾
+         */
+        static std::shared_future<std::vector<byte>> readAsync(std::filesystem::path const& path,
+                                                               u64 const offset = 0,
+                                                               u64 const size   = 0);
+
+        // name of the backend serving readAsync
+        static char const* getAsyncBackendName();
 
         // clang-format off
         bool isOpen() const { return m_isOpen; }
@@ -34,9 +63,11 @@ namespace worse
 
     private:
         std::fstream m_stream;
+        std::vector<byte> m_writeBuffer;
 
         bool m_isOpen;
+        bool m_isGood = true;
         FileStreamUsageFlags m_usage;
     };
 
-}; // namespace worse
\ No newline at end of file
+}; // namespace worse
@@ -15,6 +15,10 @@ namespace worse
         static bool isFileExists(std::filesystem::path const& path);
         // Checks if the given path is a existing directory
         static bool isDirectoryExists(std::filesystem::path const& path);
+
+        // Symlinks of the existing part resolved, the rest lexically
+        // normalized. Paths compared across modules use this form
+        static std::filesystem::path canonicalize(std::filesystem::path const& path);
     };
 
 } // namespace worse
\ No newline at end of file
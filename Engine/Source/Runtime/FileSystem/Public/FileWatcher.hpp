@@ -0,0 +1,46 @@
+#pragma once
+#include "Types.hpp"
+
+#include <vector>
+#include <filesystem>
+#include <unordered_map>
+
+namespace worse
+{
+
+    /**
+     * @brief 目录文件变化监听
+     *
+     * Linux 上使用 inotify, 其他平台退化为按修改时间轮询.
+     * poll 不阻塞, 返回上次调用以来被写入的文件
+     */
+    class FileWatcher : public NonCopyable
+    {
+    public:
+        FileWatcher();
+        ~FileWatcher();
+
+        // watch every file under the directory, subdirectories included
+        bool watchDirectory(std::filesystem::path const& directory);
+
+        // canonical paths of files changed since the last poll, no duplicates
+        std::vector<std::filesystem::path> poll();
+
+        // clang-format off
+        bool isValid() const { return m_isValid; }
+        // clang-format on
+
+    private:
+        bool m_isValid = false;
+
+#ifdef __linux__
+        int m_fd = -1;
+        // watch descriptor -> watched directory
+        std::unordered_map<int, std::filesystem::path> m_directories;
+#else
+        std::vector<std::filesystem::path> m_directories;
+        std::unordered_map<std::filesystem::path, std::filesystem::file_time_type> m_writeTimes;
+#endif
+    };
+
+} // namespace worse
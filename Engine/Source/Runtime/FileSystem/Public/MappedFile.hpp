@@ -0,0 +1,45 @@
+#pragma once
+#include "Types.hpp"
+
+#include <span>
+#include <vector>
+#include <filesystem>
+
+namespace worse
+{
+
+    /**
+     * @brief 只读内存映射文件
+     *
+     * POSIX 上使用 mmap, 页面在首次访问时才读入. 其他平台退化为整个文件读入内存
+     */
+    class MappedFile : public NonCopyable
+    {
+    public:
+        MappedFile() = default;
+        explicit MappedFile(std::filesystem::path const& path);
+        ~MappedFile();
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        bool open(std::filesystem::path const& path);
+        void close();
+
+        // clang-format off
+        bool isOpen() const                   { return m_data != nullptr; }
+        byte const* getData() const           { return m_data; }
+        usize getSize() const                 { return m_size; }
+        std::span<byte const> getSpan() const { return {m_data, m_size}; }
+        // clang-format on
+
+    private:
+        byte const* m_data = nullptr;
+        usize m_size       = 0;
+
+#if !defined(__unix__) && !defined(__APPLE__)
+        std::vector<byte> m_buffer;
+#endif
+    };
+
+} // namespace worse
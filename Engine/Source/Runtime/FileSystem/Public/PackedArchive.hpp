@@ -0,0 +1,106 @@
+#pragma once
+#include "Types.hpp"
+#include "MappedFile.hpp"
+
+#include <span>
+#include <vector>
+#include <string_view>
+#include <filesystem>
+
+namespace worse
+{
+
+    enum class PackedCompression : u32
+    {
+        None,
+        LZ4,
+    };
+
+    struct PackedArchiveStatistics
+    {
+        u32 fileCount       = 0;
+        u32 compressedCount = 0;
+        u64 sourceBytes     = 0;
+        u64 archiveBytes    = 0;
+        f32 elapsedMs       = 0.0f;
+    };
+
+    /**
+     * @brief 打包归档 .wspak
+     *
+     * 单个文件保存一个目录树. 文件头之后是按 DATA_ALIGNMENT 对齐的条目数据,
+     * 末尾是按路径排序的目录表, 查找使用二分. 归档以内存映射打开, 未压缩的
+     * 条目直接引用映射内存, LZ4 压缩的条目读取时解压
+     */
+    class PackedArchive : public NonCopyable
+    {
+    public:
+        // clang-format off
+        static constexpr char MAGIC[4]            = {'W', 'S', 'P', 'K'};
+        static constexpr u32 VERSION              = 1;
+        static constexpr u32 DATA_ALIGNMENT       = 64;
+        static constexpr char const* EXTENSION    = ".wspak";
+        // clang-format on
+
+        struct FileHeader
+        {
+            char magic[4];
+            u32 version;
+            u32 entryCount;
+            u32 namesSize;
+            u64 tocOffset; // entries, then the names they point into
+        };
+
+        struct Entry
+        {
+            u64 dataOffset;
+            u64 storedSize;
+            u64 size;
+            u32 nameOffset;
+            u32 nameSize;
+            PackedCompression compression;
+            u32 padding;
+        };
+
+        PackedArchive() = default;
+
+        bool open(std::filesystem::path const& path);
+
+        // entry of a path relative to the archive root with '/' separators
+        Entry const* find(std::string_view relativePath) const;
+        std::string_view getName(Entry const& entry) const;
+
+        // stored bytes in the mapping, compressed ones still compressed
+        std::span<byte const> getStoredData(Entry const& entry) const;
+        // false when the data is damaged, dst holds entry.size bytes
+        bool decompress(Entry const& entry, std::span<byte> dst) const;
+        // same with the stored bytes read elsewhere, e.g. by readAsync
+        static bool decompress(Entry const& entry, std::span<byte const> stored, std::span<byte> dst);
+
+        // Intermediate/Archives/<name>.wspak, where ArchivePacker writes the
+        // engine asset directories and packed builds mount them from
+        static std::filesystem::path getEngineArchivePath(std::string_view name);
+
+        /**
+         * @brief 将目录下的所有文件打包为一个归档
+         *
+         * @param compress 按条目尝试 LZ4, 仅在节省超过 1/8 时保留压缩结果
+         */
+        static bool build(std::filesystem::path const& directory,
+                          std::filesystem::path const& output,
+                          bool const compress                 = true,
+                          PackedArchiveStatistics* statistics = nullptr);
+
+        // clang-format off
+        std::span<Entry const> getEntries() const       { return m_entries; }
+        std::filesystem::path const& getPath() const    { return m_path; }
+        // clang-format on
+
+    private:
+        std::filesystem::path m_path;
+        MappedFile m_file;
+        std::span<Entry const> m_entries;
+        std::string_view m_names;
+    };
+
+} // namespace worse
@@ -0,0 +1,76 @@
+#pragma once
+#include "Types.hpp"
+
+#include <span>
+#include <vector>
+#include <future>
+#include <memory>
+#include <optional>
+#include <filesystem>
+
+namespace worse
+{
+
+    /**
+     * @brief 只读的文件内容, 持有其所在的映射或解压缓冲
+     */
+    class VirtualFile
+    {
+    public:
+        VirtualFile() = default;
+        VirtualFile(std::shared_ptr<void const> owner, std::span<byte const> data)
+            : m_owner(std::move(owner)), m_data(data)
+        {
+        }
+
+        // clang-format off
+        std::span<byte const> getSpan() const             { return m_data; }
+        byte const* getData() const                       { return m_data.data(); }
+        usize getSize() const                             { return m_data.size(); }
+        // keeps the bytes alive beyond this object
+        std::shared_ptr<void const> const& getOwner() const { return m_owner; }
+        // clang-format on
+
+    private:
+        std::shared_ptr<void const> m_owner;
+        std::span<byte const> m_data;
+    };
+
+    /**
+     * @brief 虚拟文件系统
+     *
+     * 挂载点把一个路径前缀映射到目录或 .wspak 归档, 加载器继续使用原来的完整
+     * 路径. 后挂载的优先查找, 挂载点中没有的文件继续查找更早的挂载点, 最后
+     * 直接访问磁盘
+     */
+    class VirtualFileSystem
+    {
+    public:
+        /**
+         * @brief 挂载目录或归档
+         *
+         * @param mountPoint 被替换的路径前缀, 例如 EngineDirectory/Binary
+         * @param source 目录, 或 PackedArchive::build 生成的归档
+         */
+        static bool mount(std::filesystem::path const& mountPoint, std::filesystem::path const& source);
+        static void unmountAll();
+
+        static bool exists(std::filesystem::path const& path);
+
+        /**
+         * @brief 读取文件
+         *
+         * @note 未压缩的归档条目和磁盘文件直接引用映射内存, 压缩条目解压到新缓冲
+         */
+        static std::optional<VirtualFile> open(std::filesystem::path const& path);
+
+        /**
+         * @brief 通过 FileStream::readAsync 在后台读取整个文件, 出错时结果为空
+         *
+         * @note 归档条目从归档文件中读取存储的字节而不经过映射, 压缩条目在
+         *       第一次 get 时解压
+         */
+        static std::shared_future<std::vector<byte>> readAsync(std::filesystem::path const& path);
+    };
+
+} // namespace worse
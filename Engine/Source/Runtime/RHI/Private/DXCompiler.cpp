@@ -1,29 +1,57 @@
 #include "DXCompiler.hpp"
 #include "Log.hpp"
 
+#include <mutex>
+#include <atomic>
+#include <memory>
+
 namespace worse
 {
 
+    namespace
+    {
+        std::mutex mtxInstances;
+        std::vector<std::unique_ptr<DXCompiler>> instances;
+        bool initialized = false;
+        // bumped on shutdown, invalidates instance pointers cached by threads
+        std::atomic<u32> generation = 0;
+
+        thread_local DXCompiler* threadInstance = nullptr;
+        thread_local u32 threadGeneration       = 0;
+    } // namespace
+
     void DXCompiler::initialize()
     {
-        if (!s_instance)
-        {
-            s_instance = new DXCompiler();
-        }
+        std::lock_guard<std::mutex> lock(mtxInstances);
+        initialized = true;
     }
 
     void DXCompiler::shutdown()
     {
-        if (s_instance)
-        {
-            delete s_instance;
-            s_instance = nullptr;
-        }
+        std::lock_guard<std::mutex> lock(mtxInstances);
+        instances.clear();
+        initialized = false;
+        generation.fetch_add(1, std::memory_order_release);
     }
 
     DXCompiler* DXCompiler::instance()
     {
-        return s_instance;
+        u32 const currentGeneration = generation.load(std::memory_order_acquire);
+        if (threadInstance && (threadGeneration == currentGeneration))
+        {
+            return threadInstance;
+        }
+
+        std::lock_guard<std::mutex> lock(mtxInstances);
+        if (!initialized)
+        {
+            return nullptr;
+        }
+
+        instances.push_back(std::make_unique<DXCompiler>());
+        threadInstance   = instances.back().get();
+        threadGeneration = currentGeneration;
+        return threadInstance;
     }
 
     DXCompiler::DXCompiler()
@@ -41,6 +69,33 @@ namespace worse
         {
             WS_LOG_ERROR("dxc", "Failed to initialize DXC utils");
         }
+
+        // version
+        m_version = "unknown";
+        if (m_compiler)
+        {
+            CComPtr<IDxcVersionInfo> versionInfo;
+            if (SUCCEEDED(m_compiler->QueryInterface(IID_PPV_ARGS(&versionInfo))))
+            {
+                UINT32 major = 0;
+                UINT32 minor = 0;
+                versionInfo->GetVersion(&major, &minor);
+                m_version = std::to_string(major) + "." + std::to_string(minor);
+
+                CComPtr<IDxcVersionInfo2> versionInfo2;
+                if (SUCCEEDED(versionInfo->QueryInterface(IID_PPV_ARGS(&versionInfo2))))
+                {
+                    UINT32 commitCount = 0;
+                    char* commitHash   = nullptr;
+                    if (SUCCEEDED(versionInfo2->GetCommitInfo(&commitCount, &commitHash)) && commitHash)
+                    {
+                        m_version += "-";
+                        m_version += commitHash;
+                        CoTaskMemFree(commitHash);
+                    }
+                }
+            }
+        }
     }
 
     DXCompiler::~DXCompiler()
@@ -1,6 +1,8 @@
 #include "RHICommandList.hpp"
 #include "RHISyncPrimitive.hpp" // IWYU pragma: keep
 
+#include <algorithm>
+
 namespace worse
 {
 
@@ -13,4 +15,26 @@ namespace worse
         m_state = RHICommandListState::Idle;
     }
 
+    void RHICommandList::waitQueue(RHIQueue* queue, u64 const value, RHIPipelineStageFlags const stage)
+    {
+        WS_ASSERT(m_state == RHICommandListState::Recording);
+        WS_ASSERT(queue != m_submissionQueue);
+
+        if (value == 0)
+        {
+            return;
+        }
+
+        for (RHIQueueWait& wait : m_queueWaits)
+        {
+            if (wait.queue == queue)
+            {
+                wait.value = std::max(wait.value, value);
+                wait.stage = wait.stage | stage;
+                return;
+            }
+        }
+        m_queueWaits.push_back({queue, value, stage});
+    }
+
 } // namespace worse
\ No newline at end of file
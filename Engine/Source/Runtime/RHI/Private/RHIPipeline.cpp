@@ -1,6 +1,11 @@
+#include "Log.hpp"
+#include "FileSystem.hpp"
+#include "VirtualFileSystem.hpp"
+#include "ThreadPool.hpp"
 #include "Math/Hash.hpp"
 #include "Pipeline/RHIPipeline.hpp"
 #include "RHIDevice.hpp"
+#include "RHIShader.hpp"
 
 namespace worse
 {
@@ -32,28 +37,202 @@ namespace worse
 
     RHIPipelinePool::RHIPipelinePool()
     {
+        m_manifest.load();
     }
 
     RHIPipelinePool::~RHIPipelinePool()
     {
+        // prewarm jobs reference the pool
+        waitPending();
+
+        m_manifest.save();
+
         m_pipelines.clear();
+        m_prewarmEntries.clear();
     }
 
     RHIPipeline* RHIPipelinePool::getPipeline(RHIPipelineState const& pso)
     {
-        u64 hash = pso.getHash();
-        auto it  = m_pipelines.find(hash);
-        if (it != m_pipelines.end())
+        u64 const hash = pso.getPipelineHash();
+
+        std::shared_future<void> pending;
         {
-            return it->second.get();
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            auto it = m_pipelines.find(hash);
+            if (it != m_pipelines.end())
+            {
+                return it->second.get();
+            }
+
+            auto itPending = m_pending.find(hash);
+            if (itPending != m_pending.end())
+            {
+                pending = itPending->second;
+            }
         }
 
+        // being created in the background, waiting is still cheaper than
+        // creating it again
+        if (pending.valid())
+        {
+            pending.wait();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending.erase(hash);
+
+            auto it = m_pipelines.find(hash);
+            if (it != m_pipelines.end())
+            {
+                return it->second.get();
+            }
+        }
+
+        // not in the manifest, creation stalls the frame
+        std::shared_ptr<RHIPipeline> pipeline = createPipeline(pso);
+        m_manifest.record(pso);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_pipelines.emplace(hash, pipeline).first->second.get();
+    }
+
+    void RHIPipelinePool::prewarm()
+    {
+        // copy, entries recorded later are not prewarmed in this run
+        std::vector<RHIPipelineManifestEntry> const entries = m_manifest.getEntries();
+        if (entries.empty())
+        {
+            return;
+        }
+
+        WS_LOG_INFO("Pipeline", "Prewarming {} pipelines from {}", entries.size(), RHIPipelineManifest::getPath().string());
+
+        for (RHIPipelineManifestEntry const& desc : entries)
+        {
+            std::unique_ptr<PrewarmEntry> entry = std::make_unique<PrewarmEntry>();
+            entry->desc                         = desc;
+            PrewarmEntry* entryPtr              = entry.get();
+
+            std::shared_future<void> future = ThreadPool::addTask(
+                [this, entryPtr]()
+                {
+                    prewarmEntry(*entryPtr);
+                });
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_prewarmEntries.push_back(std::move(entry));
+            m_pending.emplace(desc.pipelineHash, future);
+        }
+    }
+
+    u32 RHIPipelinePool::evict(std::filesystem::path const& shaderPath)
+    {
+        // a prewarm job could insert a pipeline of the old source afterwards
+        waitPending();
+
+        std::filesystem::path const canonicalPath = FileSystem::canonicalize(shaderPath);
+
+        u32 count = 0;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_pipelines.begin(); it != m_pipelines.end();)
+        {
+            bool uses = false;
+            for (RHIShader const* shader : it->second->getState()->shaders)
+            {
+                if (shader && (FileSystem::canonicalize(shader->getPath()) == canonicalPath))
+                {
+                    uses = true;
+                    break;
+                }
+            }
+
+            if (uses)
+            {
+                // native handles go through the deletion queue
+                m_manifest.remove(it->first);
+                it = m_pipelines.erase(it);
+                ++count;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        return count;
+    }
+
+    void RHIPipelinePool::waitPending()
+    {
+        std::unordered_map<u64, std::shared_future<void>> pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            pending.swap(m_pending);
+        }
+
+        for (auto& [hash, future] : pending)
+        {
+            future.wait();
+        }
+    }
+
+    std::shared_ptr<RHIPipeline> RHIPipelinePool::createPipeline(RHIPipelineState const& pso)
+    {
         RHIDescriptorSetLayout* descriptorSetLayout = RHIDevice::getSpecificDescriptorSetLayout(pso);
         WS_ASSERT(descriptorSetLayout != nullptr);
-        std::shared_ptr<RHIPipeline> pipeline = std::make_shared<RHIPipeline>(pso, *descriptorSetLayout);
-        m_pipelines.emplace(hash, pipeline);
+        return std::make_shared<RHIPipeline>(pso, *descriptorSetLayout);
+    }
+
+    void RHIPipelinePool::prewarmEntry(PrewarmEntry& entry)
+    {
+        RHIPipelineManifestEntry const& desc = entry.desc;
+
+        RHIPipelineState pso;
+        pso.name              = desc.name;
+        pso.type              = desc.type;
+        pso.primitiveTopology = desc.primitiveTopology;
+        pso.rasterizerState   = desc.hasRasterizerState ? &entry.desc.rasterizerState : nullptr;
+        pso.depthStencilState = desc.hasDepthStencilState ? &entry.desc.depthStencilState : nullptr;
+        pso.blendState        = desc.hasBlendState ? &entry.desc.blendState : nullptr;
+
+        // compiled on this worker, normally a spirv cache hit
+        for (RHIPipelineManifestEntry::Shader const& shaderDesc : desc.shaders)
+        {
+            if (!VirtualFileSystem::exists(shaderDesc.path) || (shaderDesc.type == RHIShaderType::Max))
+            {
+                m_manifest.remove(desc.pipelineHash);
+                return;
+            }
+
+            std::unique_ptr<RHIShader> shader = std::make_unique<RHIShader>(desc.name + "_prewarm");
+            shader->compile(shaderDesc.path, shaderDesc.type, shaderDesc.vertexType);
+            if (shader->getState() != RHIShaderCompilationState::CompiledSuccess)
+            {
+                return;
+            }
+
+            pso.shaders[shaderDesc.type] = shader.get();
+            entry.shaders.push_back(std::move(shader));
+        }
+
+        pso.renderTargetColorFormats = desc.renderTargetColorFormats;
+        pso.renderTargetDepthFormat  = desc.renderTargetDepthFormat;
+        pso.finalizeForPrewarm();
+
+        // shader set or state layout changed since the entry was recorded
+        if (pso.getPipelineHash() != desc.pipelineHash)
+        {
+            WS_LOG_DEBUG("Pipeline", "Drop stale manifest entry `{}`", desc.name);
+            m_manifest.remove(desc.pipelineHash);
+            return;
+        }
+
+        std::shared_ptr<RHIPipeline> pipeline = createPipeline(pso);
+        m_prewarmedCount.fetch_add(1, std::memory_order_relaxed);
 
-        return pipeline.get();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pipelines.emplace(desc.pipelineHash, pipeline);
     }
 
 } // namespace worse
\ No newline at end of file
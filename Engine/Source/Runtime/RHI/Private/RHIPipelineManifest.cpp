@@ -0,0 +1,267 @@
+#include "Log.hpp"
+#include "Platform.hpp"
+#include "RHIShader.hpp"
+#include "Pipeline/RHIPipelineState.hpp"
+#include "Pipeline/RHIPipelineManifest.hpp"
+
+#include <fstream>
+#include <type_traits>
+
+namespace worse
+{
+    namespace
+    {
+        // clang-format off
+        constexpr u32 MANIFEST_MAGIC   = 0x4d505357; // "WSPM"
+        constexpr u32 MANIFEST_VERSION = 1;
+        // clang-format on
+
+        // states are stored as raw bytes, the manifest is local to the machine
+        static_assert(std::is_trivially_copyable_v<RHIRasterizerState>);
+        static_assert(std::is_trivially_copyable_v<RHIDepthStencilState>);
+        static_assert(std::is_trivially_copyable_v<RHIBlendState>);
+
+        template <typename T>
+        void writePod(std::ofstream& stream, T const& value)
+        {
+            stream.write(reinterpret_cast<char const*>(&value), sizeof(T));
+        }
+
+        template <typename T>
+        bool readPod(std::ifstream& stream, T& value)
+        {
+            return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+        }
+
+        void writeString(std::ofstream& stream, std::string const& value)
+        {
+            writePod(stream, static_cast<u32>(value.size()));
+            stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+        }
+
+        bool readString(std::ifstream& stream, std::string& value)
+        {
+            u32 length = 0;
+            if (!readPod(stream, length) || (length > 4096))
+            {
+                return false;
+            }
+            value.resize(length);
+            return (length == 0) || static_cast<bool>(stream.read(value.data(), length));
+        }
+
+        bool readEntry(std::ifstream& stream, RHIPipelineManifestEntry& entry)
+        {
+            u32 shaderCount = 0;
+            bool valid      = readPod(stream, entry.pipelineHash) &&
+                         readString(stream, entry.name) &&
+                         readPod(stream, entry.type) &&
+                         readPod(stream, entry.primitiveTopology) &&
+                         readPod(stream, entry.hasRasterizerState) &&
+                         readPod(stream, entry.hasDepthStencilState) &&
+                         readPod(stream, entry.hasBlendState) &&
+                         readPod(stream, entry.rasterizerState) &&
+                         readPod(stream, entry.depthStencilState) &&
+                         readPod(stream, entry.blendState) &&
+                         readPod(stream, entry.renderTargetColorFormats) &&
+                         readPod(stream, entry.renderTargetDepthFormat) &&
+                         readPod(stream, shaderCount);
+            if (!valid || (shaderCount > static_cast<u32>(RHIShaderType::Max)))
+            {
+                return false;
+            }
+
+            entry.shaders.resize(shaderCount);
+            for (RHIPipelineManifestEntry::Shader& shader : entry.shaders)
+            {
+                if (!readString(stream, shader.path) ||
+                    !readPod(stream, shader.type) ||
+                    !readPod(stream, shader.vertexType))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        void writeEntry(std::ofstream& stream, RHIPipelineManifestEntry const& entry)
+        {
+            writePod(stream, entry.pipelineHash);
+            writeString(stream, entry.name);
+            writePod(stream, entry.type);
+            writePod(stream, entry.primitiveTopology);
+            writePod(stream, entry.hasRasterizerState);
+            writePod(stream, entry.hasDepthStencilState);
+            writePod(stream, entry.hasBlendState);
+            writePod(stream, entry.rasterizerState);
+            writePod(stream, entry.depthStencilState);
+            writePod(stream, entry.blendState);
+            writePod(stream, entry.renderTargetColorFormats);
+            writePod(stream, entry.renderTargetDepthFormat);
+            writePod(stream, static_cast<u32>(entry.shaders.size()));
+            for (RHIPipelineManifestEntry::Shader const& shader : entry.shaders)
+            {
+                writeString(stream, shader.path);
+                writePod(stream, shader.type);
+                writePod(stream, shader.vertexType);
+            }
+        }
+    } // namespace
+
+    std::filesystem::path RHIPipelineManifest::getPath()
+    {
+        return std::filesystem::path{worse::EngineDirectory} / "Intermediate/PipelineCache/pso_manifest.bin";
+    }
+
+    bool RHIPipelineManifest::load()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_entries.clear();
+        m_hashes.clear();
+        m_dirty = false;
+
+        std::ifstream stream(getPath(), std::ios::binary);
+        if (!stream.is_open())
+        {
+            return false;
+        }
+
+        u32 magic   = 0;
+        u32 version = 0;
+        u32 count   = 0;
+        if (!readPod(stream, magic) || !readPod(stream, version) || !readPod(stream, count) ||
+            (magic != MANIFEST_MAGIC) || (version != MANIFEST_VERSION))
+        {
+            WS_LOG_WARN("Pipeline", "Discard invalid pso manifest {}", getPath().string());
+            return false;
+        }
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            RHIPipelineManifestEntry entry = {};
+            if (!readEntry(stream, entry))
+            {
+                WS_LOG_WARN("Pipeline", "Truncated pso manifest, {} of {} entries read", i, count);
+                m_dirty = true;
+                break;
+            }
+
+            if (m_hashes.insert(entry.pipelineHash).second)
+            {
+                m_entries.push_back(std::move(entry));
+            }
+        }
+
+        return true;
+    }
+
+    bool RHIPipelineManifest::save()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (!m_dirty)
+        {
+            return true;
+        }
+
+        std::filesystem::path const path = getPath();
+        std::filesystem::path tempPath   = path;
+        tempPath += ".tmp";
+
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+        {
+            std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+            if (!stream.is_open())
+            {
+                WS_LOG_WARN("Pipeline", "Failed to write pso manifest {}", tempPath.string());
+                return false;
+            }
+
+            writePod(stream, MANIFEST_MAGIC);
+            writePod(stream, MANIFEST_VERSION);
+            writePod(stream, static_cast<u32>(m_entries.size()));
+            for (RHIPipelineManifestEntry const& entry : m_entries)
+            {
+                writeEntry(stream, entry);
+            }
+        }
+
+        std::filesystem::rename(tempPath, path, error);
+        if (error)
+        {
+            WS_LOG_WARN("Pipeline", "Failed to write pso manifest {}: {}", path.string(), error.message());
+            return false;
+        }
+
+        m_dirty = false;
+        return true;
+    }
+
+    bool RHIPipelineManifest::record(RHIPipelineState const& pso)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (!m_hashes.insert(pso.getPipelineHash()).second)
+        {
+            return false;
+        }
+
+        RHIPipelineManifestEntry entry = {};
+        entry.pipelineHash             = pso.getPipelineHash();
+        entry.name                     = pso.name;
+        entry.type                     = pso.type;
+        entry.primitiveTopology        = pso.primitiveTopology;
+
+        if (pso.rasterizerState)
+        {
+            entry.hasRasterizerState = true;
+            entry.rasterizerState    = *pso.rasterizerState;
+        }
+        if (pso.depthStencilState)
+        {
+            entry.hasDepthStencilState = true;
+            entry.depthStencilState    = *pso.depthStencilState;
+        }
+        if (pso.blendState)
+        {
+            entry.hasBlendState = true;
+            entry.blendState    = *pso.blendState;
+        }
+
+        for (RHIShader const* shader : pso.shaders)
+        {
+            if (shader)
+            {
+                entry.shaders.push_back({shader->getPath().string(), shader->getShaderType(), shader->getVertexType()});
+            }
+        }
+
+        entry.renderTargetColorFormats = pso.renderTargetColorFormats;
+        entry.renderTargetDepthFormat  = pso.renderTargetDepthFormat;
+
+        m_entries.push_back(std::move(entry));
+        m_dirty = true;
+        return true;
+    }
+
+    void RHIPipelineManifest::remove(u64 const pipelineHash)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_hashes.erase(pipelineHash) == 0)
+        {
+            return;
+        }
+
+        std::erase_if(m_entries,
+                      [pipelineHash](RHIPipelineManifestEntry const& entry)
+                      {
+                          return entry.pipelineHash == pipelineHash;
+                      });
+        m_dirty = true;
+    }
+
+} // namespace worse
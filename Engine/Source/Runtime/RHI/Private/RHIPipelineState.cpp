@@ -1,4 +1,5 @@
 #include "Math/Hash.hpp"
+#include "RHIDevice.hpp"
 #include "RHIShader.hpp"
 #include "RHITexture.hpp"
 #include "Pipeline/RHIBlendState.hpp"
@@ -108,6 +109,59 @@ namespace worse
             return hash;
         }
 
+        u64 computePipelineHash(RHIPipelineState const& pso)
+        {
+            u64 hash = 0;
+
+            hash = math::hashCombine(hash, static_cast<u64>(pso.type));
+            hash = math::hashCombine(hash, static_cast<u64>(pso.primitiveTopology));
+
+            if (pso.rasterizerState)
+            {
+                hash = math::hashCombine(hash, pso.rasterizerState->getHash());
+            }
+
+            if (pso.depthStencilState)
+            {
+                hash = math::hashCombine(hash, pso.depthStencilState->getHash());
+            }
+
+            if (pso.blendState)
+            {
+                hash = math::hashCombine(hash, pso.blendState->getHash());
+            }
+
+            for (RHIShader* shader : pso.shaders)
+            {
+                if (shader)
+                {
+                    hash = math::hashCombine(hash, shader->getHash());
+                    hash = math::hashCombine(hash, static_cast<u64>(shader->getShaderType()));
+                    hash = math::hashCombine(hash, static_cast<u64>(shader->getVertexType()));
+                }
+            }
+
+            for (RHIFormat const format : pso.renderTargetColorFormats)
+            {
+                hash = math::hashCombine(hash, static_cast<u64>(format));
+            }
+            hash = math::hashCombine(hash, static_cast<u64>(pso.renderTargetDepthFormat));
+
+            return hash;
+        }
+
+        void waitShaders(RHIPipelineState const& pso)
+        {
+            // shaders may still be compiling on the thread pool
+            for (RHIShader const* shader : pso.shaders)
+            {
+                if (shader != nullptr)
+                {
+                    shader->waitForCompilation();
+                }
+            }
+        }
+
         // find descriptors bound to the same slot, merge their
         // stageFlags
         void mergeDescriptors(std::vector<RHIDescriptor>& bases, std::vector<RHIDescriptor> const& additionals)
@@ -140,12 +194,45 @@ namespace worse
 
     void RHIPipelineState::finalize()
     {
+        waitShaders(*this);
+
         validate(*this);
 
-        m_hash = computeHash(*this);
+        renderTargetColorFormats.fill(RHIFormat::Max);
+        for (usize i = 0; i < renderTargetColorTextures.size(); ++i)
+        {
+            // render target are set in order, so stop once hit a null texture
+            if (!renderTargetColorTextures[i])
+            {
+                break;
+            }
+            renderTargetColorFormats[i] = renderTargetColorTextures[i]->getFormat();
+        }
+        renderTargetDepthFormat = renderTargetDepthTexture ? renderTargetDepthTexture->getFormat() : RHIFormat::Max;
+
+        m_hash         = computeHash(*this);
+        m_pipelineHash = computePipelineHash(*this);
 
         // if not valid, assertion will be triggered before
         m_validated = true;
+
+        // lookup once here so binding does not touch the pool
+        m_pipeline = RHIDevice::getPipeline(*this);
+    }
+
+    void RHIPipelineState::finalizeForPrewarm()
+    {
+        waitShaders(*this);
+
+        WS_ASSERT_MSG(!name.empty(), "Pipeline state must have a name");
+        WS_ASSERT_MSG((renderTargetColorTextures[0] == nullptr) && (renderTargetDepthTexture == nullptr),
+                      "Prewarm pipeline state has no render target texture");
+
+        m_hash         = computeHash(*this);
+        m_pipelineHash = computePipelineHash(*this);
+
+        // never bound, only used to create the native pipeline
+        m_validated = false;
     }
 
     RHIShader const* RHIPipelineState::getShader(RHIShaderType const type) const
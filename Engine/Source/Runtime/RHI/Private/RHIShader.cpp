@@ -1,10 +1,11 @@
 #include "Profiling/Stopwatch.hpp"
 #include "FileSystem.hpp"
+#include "VirtualFileSystem.hpp"
+#include "ThreadPool.hpp"
 #include "Math/Hash.hpp"
 #include "RHIDevice.hpp"
 #include "RHIShader.hpp"
 
-#include <fstream>
 #include <sstream>
 #include <functional>
 
@@ -12,16 +13,10 @@ namespace worse
 {
     std::string PreprocessIncludesParser::recursiveParse(std::filesystem::path const& path)
     {
-        std::filesystem::path canonicalPath;
-        try
-        {
-            canonicalPath = std::filesystem::canonical(path);
-        }
-        catch (std::filesystem::filesystem_error const& e)
-        {
-            WS_LOG_ERROR("Shader", "Failed to canonicalize path: {}", e.what());
-            return {};
-        }
+        // opened by the lexical path, mount points are matched against it.
+        // recorded in the form the file watcher reports
+        std::filesystem::path const normalPath    = std::filesystem::absolute(path).lexically_normal();
+        std::filesystem::path const canonicalPath = FileSystem::canonicalize(normalPath);
 
         // skip duplicate includes
         if (m_includes.count(canonicalPath))
@@ -31,20 +26,22 @@ namespace worse
 
         m_includes.insert(canonicalPath);
 
-        std::ifstream fileStream(canonicalPath);
-        if (!fileStream.is_open())
+        std::optional<VirtualFile> file = VirtualFileSystem::open(normalPath);
+        if (!file)
         {
             WS_LOG_ERROR("Shader",
                          "Failed to open file: {}",
-                         canonicalPath.string());
+                         normalPath.string());
             return {};
         }
+        std::istringstream fileStream(std::string{reinterpret_cast<char const*>(file->getData()), file->getSize()});
+        file.reset();
 
         std::stringstream outputStream;
         std::string line;
         int lineNumber = 0;
 
-        std::filesystem::path baseDir = canonicalPath.parent_path();
+        std::filesystem::path baseDir = normalPath.parent_path();
 
         while (std::getline(fileStream, line))
         {
@@ -56,7 +53,7 @@ namespace worse
 
                 std::filesystem::path includePath = baseDir / includeName;
 
-                if (!FileSystem::isFileExists(includePath))
+                if (!VirtualFileSystem::exists(includePath))
                 {
                     WS_LOG_ERROR("Shader", "{} (line {}) does not exist", includePath.string(), lineNumber);
                     continue;
@@ -72,7 +69,6 @@ namespace worse
             }
         }
 
-        fileStream.close();
         return outputStream.str();
     }
 
@@ -80,7 +76,7 @@ namespace worse
     {
         m_includes.clear();
 
-        if (!FileSystem::isFileExists(path))
+        if (!VirtualFileSystem::exists(path))
         {
             WS_LOG_ERROR("Shader", "Failed to read file: {}", path.string());
             return {};
@@ -95,26 +91,64 @@ namespace worse
 
     RHIShader::~RHIShader()
     {
+        waitForCompilation();
         RHIDevice::deletionQueueAdd(m_shaderModule);
     }
 
     void RHIShader::compile(std::filesystem::path const& filepath, RHIShaderType const shaderType, RHIVertexType const vertexType)
+    {
+        waitForCompilation();
+
+        m_path       = filepath;
+        m_shaderType = shaderType;
+        m_vertexType = vertexType;
+        m_state.store(RHIShaderCompilationState::Compiling, std::memory_order_release);
+
+        compileInternal();
+    }
+
+    void RHIShader::compileAsync(std::filesystem::path const& filepath, RHIShaderType const shaderType, RHIVertexType const vertexType)
+    {
+        waitForCompilation();
+
+        m_path       = filepath;
+        m_shaderType = shaderType;
+        m_vertexType = vertexType;
+        m_state.store(RHIShaderCompilationState::Compiling, std::memory_order_release);
+
+        m_compileTask = ThreadPool::addTask(
+            [this]()
+            {
+                compileInternal();
+            });
+    }
+
+    void RHIShader::waitForCompilation() const
+    {
+        if (m_compileTask.valid())
+        {
+            m_compileTask.wait();
+        }
+    }
+
+    void RHIShader::compileInternal()
     {
         m_source.clear();
         m_descriptors.clear();
-        m_inputLayout = {};
-
-        m_path        = filepath;
-        m_shaderType  = shaderType;
-        m_vertexType  = vertexType;
         m_inputLayout = RHIInputLayout(m_vertexType);
 
+        // parser is stateful, one per compilation so jobs do not share it
+        PreprocessIncludesParser preprocessParser;
         m_source = preprocessParser.parse(m_path);
+        // files the source is assembled from, used to find shaders to reload
+        m_dependencies.assign(preprocessParser.getIncludes().begin(), preprocessParser.getIncludes().end());
 
         // generate hash
         {
             std::hash<std::string> hasher;
-            m_hash = math::hashCombine(m_hash, hasher(m_path.string()));
+            // content takes part so an edited shader never maps to the
+            // pipelines built from its old source
+            m_hash = math::hashCombine(hasher(m_path.string()), math::hashFnv1a(m_source));
 
             // TODO: hash definitions
         }
@@ -122,19 +156,21 @@ namespace worse
         // compile
         {
             profiling::Stopwatch sw;
-            m_state        = RHIShaderCompilationState::Compiling;
             m_shaderModule = nativeCompile();
 
             // 创建后缓存，不立即放入删除队列，转而在析构函数中处理
 
-            m_state = m_shaderModule
-                          ? RHIShaderCompilationState::CompiledSuccess
-                          : RHIShaderCompilationState::CompiledFailure;
+            RHIShaderCompilationState const state = m_shaderModule
+                                                        ? RHIShaderCompilationState::CompiledSuccess
+                                                        : RHIShaderCompilationState::CompiledFailure;
 
-            if (m_state == RHIShaderCompilationState::CompiledSuccess)
+            if (state == RHIShaderCompilationState::CompiledSuccess)
             {
-                WS_LOG_INFO("Shader", "Compiled: {} took: {:.1f}ms", m_path.string(), sw.elapsedMs());
+                WS_LOG_INFO("Shader", "Compiled: {} took: {:.1f}ms{}", m_path.string(), sw.elapsedMs(), m_fromCache ? " (cached)" : "");
             }
+
+            // publish after all members are written
+            m_state.store(state, std::memory_order_release);
         }
     }
 
@@ -0,0 +1,212 @@
+#include "Log.hpp"
+#include "Platform.hpp"
+#include "FileSystem.hpp"
+#include "Math/Hash.hpp"
+#include "RHIShaderCache.hpp"
+
+#include <format>
+#include <fstream>
+#include <thread>
+#include <functional>
+
+namespace worse
+{
+    namespace
+    {
+        // clang-format off
+        constexpr u32 CACHE_MAGIC   = 0x43535357; // "WSSC"
+        constexpr u32 CACHE_VERSION = 1;
+        // clang-format on
+
+        struct CacheHeader
+        {
+            u32 magic           = CACHE_MAGIC;
+            u32 version         = CACHE_VERSION;
+            u64 key             = 0;
+            u32 spirvWordCount  = 0;
+            u32 descriptorCount = 0;
+        };
+
+        template <typename T>
+        void writePod(std::ofstream& stream, T const& value)
+        {
+            stream.write(reinterpret_cast<char const*>(&value), sizeof(T));
+        }
+
+        template <typename T>
+        bool readPod(std::ifstream& stream, T& value)
+        {
+            return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+        }
+
+        std::filesystem::path entryPath(u64 const key)
+        {
+            return RHIShaderCache::getDirectory() / std::format("{:016x}.spv", key);
+        }
+    } // namespace
+
+    u64 RHIShaderCache::computeKey(std::string_view source,
+                                   std::string_view entryPoint,
+                                   RHIShaderType const shaderType,
+                                   std::vector<std::wstring> const& arguments,
+                                   std::string_view compilerVersion)
+    {
+        u64 key = math::hashFnv1a(source);
+        key     = math::hashFnv1a(entryPoint, key);
+        key     = math::hashCombine(key, static_cast<u64>(shaderType));
+        // includes target profile, defines and register shifts
+        for (std::wstring const& argument : arguments)
+        {
+            key = math::hashFnv1a(std::string_view{reinterpret_cast<char const*>(argument.data()), argument.size() * sizeof(wchar_t)}, key);
+        }
+        key = math::hashFnv1a(compilerVersion, key);
+        key = math::hashCombine(key, CACHE_VERSION);
+        return key;
+    }
+
+    bool RHIShaderCache::load(u64 const key, RHIShaderCacheEntry& entry)
+    {
+        std::filesystem::path const path = entryPath(key);
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream.is_open())
+        {
+            s_missCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        auto invalid = [&]()
+        {
+            WS_LOG_WARN("ShaderCache", "Invalid cache file: {}", path.string());
+            entry = {};
+            s_missCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        };
+
+        CacheHeader header = {};
+        if (!readPod(stream, header) ||
+            (header.magic != CACHE_MAGIC) ||
+            (header.version != CACHE_VERSION) ||
+            (header.key != key) ||
+            (header.spirvWordCount == 0))
+        {
+            return invalid();
+        }
+
+        entry.spirv.resize(header.spirvWordCount);
+        if (!stream.read(reinterpret_cast<char*>(entry.spirv.data()), header.spirvWordCount * sizeof(u32)))
+        {
+            return invalid();
+        }
+
+        entry.descriptors.resize(header.descriptorCount);
+        for (RHIDescriptor& descriptor : entry.descriptors)
+        {
+            u32 stageFlags = 0;
+            u32 nameLength = 0;
+            bool valid     = readPod(stream, descriptor.space) &&
+                         readPod(stream, descriptor.slot) &&
+                         readPod(stream, stageFlags) &&
+                         readPod(stream, descriptor.type) &&
+                         readPod(stream, descriptor.layout) &&
+                         readPod(stream, descriptor.range) &&
+                         readPod(stream, descriptor.dynamicOffset) &&
+                         readPod(stream, descriptor.size) &&
+                         readPod(stream, descriptor.isArray) &&
+                         readPod(stream, descriptor.arrayLength) &&
+                         readPod(stream, nameLength);
+            if (!valid || (nameLength > 1024))
+            {
+                return invalid();
+            }
+
+            descriptor.stageFlags = RHIShaderStageFlags{stageFlags};
+            descriptor.name.resize(nameLength);
+            if ((nameLength > 0) && !stream.read(descriptor.name.data(), nameLength))
+            {
+                return invalid();
+            }
+        }
+
+        s_hitCount.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool RHIShaderCache::store(u64 const key, RHIShaderCacheEntry const& entry)
+    {
+        WS_ASSERT(!entry.spirv.empty());
+
+        std::filesystem::path const directory = getDirectory();
+        std::error_code error;
+        if (!FileSystem::isDirectoryExists(directory))
+        {
+            std::filesystem::create_directories(directory, error);
+            if (error)
+            {
+                WS_LOG_WARN("ShaderCache", "Failed to create directory {}: {}", directory.string(), error.message());
+                return false;
+            }
+        }
+
+        // unique temporary name, concurrent writers of the same key never
+        // see a half written file
+        std::filesystem::path const path = entryPath(key);
+        std::filesystem::path tempPath   = path;
+        tempPath += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+        {
+            std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+            if (!stream.is_open())
+            {
+                WS_LOG_WARN("ShaderCache", "Failed to write {}", tempPath.string());
+                return false;
+            }
+
+            CacheHeader header     = {};
+            header.key             = key;
+            header.spirvWordCount  = static_cast<u32>(entry.spirv.size());
+            header.descriptorCount = static_cast<u32>(entry.descriptors.size());
+            writePod(stream, header);
+
+            stream.write(reinterpret_cast<char const*>(entry.spirv.data()), entry.spirv.size() * sizeof(u32));
+
+            for (RHIDescriptor const& descriptor : entry.descriptors)
+            {
+                writePod(stream, descriptor.space);
+                writePod(stream, descriptor.slot);
+                writePod(stream, descriptor.stageFlags.value);
+                writePod(stream, descriptor.type);
+                writePod(stream, descriptor.layout);
+                writePod(stream, descriptor.range);
+                writePod(stream, descriptor.dynamicOffset);
+                writePod(stream, descriptor.size);
+                writePod(stream, descriptor.isArray);
+                writePod(stream, descriptor.arrayLength);
+                writePod(stream, static_cast<u32>(descriptor.name.size()));
+                stream.write(descriptor.name.data(), descriptor.name.size());
+            }
+
+            if (!stream.good())
+            {
+                stream.close();
+                std::filesystem::remove(tempPath, error);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(tempPath, path, error);
+        if (error)
+        {
+            WS_LOG_WARN("ShaderCache", "Failed to write {}: {}", path.string(), error.message());
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+
+        return true;
+    }
+
+    std::filesystem::path RHIShaderCache::getDirectory()
+    {
+        return std::filesystem::path{worse::EngineDirectory} / "Intermediate/ShaderCache";
+    }
+
+} // namespace worse
@@ -2,6 +2,7 @@
 #include "RHIDevice.hpp"
 #include "RHICommandList.hpp"
 #include "RHITexture.hpp"
+#include "Profiling/Stopwatch.hpp"
 
 namespace worse
 {
@@ -22,7 +23,7 @@ namespace worse
         m_format   = format;
         m_usage    = usage;
 
-        m_slices = data;
+        m_slices = std::move(data);
 
         if (!nativeCreate())
         {
@@ -30,33 +31,33 @@ namespace worse
         }
     }
 
-    RHITexture::RHITexture(std::filesystem::path const& path)
+    RHITexture::RHITexture(std::filesystem::path const& path, u32 const maxSize, bool const flipVertically)
     {
-        if (std::optional<TextureLoadView> view = TextureImporter::fromFile(path))
+        profiling::Stopwatch stopwatch;
+        if (std::optional<TextureLoadView> view = TextureImporter::fromFile(path, maxSize, flipVertically))
         {
-            m_name     = path.filename().string();
-            m_type     = view->type;
-            m_width    = view->width;
-            m_height   = view->height;
-            m_depth    = view->depth;
-            m_mipCount = view->mipLevels;
-            m_format   = view->format;
-            m_usage    = RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit;
-
-            m_slices.resize(view->layers);            // only 1 now, no array
-            m_slices[0].mips.resize(view->mipLevels); // mip 0 only
-            m_slices[0].mips[0].bytes.resize(view->size);
-
-            view->deferredCopyFn(reinterpret_cast<byte*>(m_slices[0].mips[0].bytes.data()));
-
-            if (!nativeCreate())
+            m_name            = path.filename().string();
+            m_type            = view->type;
+            m_width           = view->width;
+            m_height          = view->height;
+            m_depth           = view->depth;
+            m_mipCount        = view->mipLevels;
+            m_skippedMipCount = view->skippedMipLevels;
+            m_format          = view->format;
+            m_usage           = RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit;
+
+            // decoded straight into the staging memory of the upload
+            if (!nativeCreate(&*view))
             {
                 WS_LOG_ERROR("RHITexture", "Failed to create texture from file: {}", path.string());
+                return;
             }
+
+            WS_LOG_INFO("RHITexture", "Created {} ({}) in {:.2f} ms", m_name, rhiFormatToString(m_format), stopwatch.elapsedMs());
         }
     }
 
-    RHITexture::RHITexture(std::span<byte> data, std::string const& name)
+    RHITexture::RHITexture(std::span<byte const> data, std::string const& name, bool const flipVertically)
     {
         if (data.empty())
         {
@@ -64,7 +65,7 @@ namespace worse
             return;
         }
 
-        if (std::optional<TextureLoadView> view = TextureImporter::fromMemory(data, name))
+        if (std::optional<TextureLoadView> view = TextureImporter::fromMemory(data, name, flipVertically))
         {
             m_name     = name;
             m_type     = RHITextureType::Texture2D;
@@ -75,13 +76,8 @@ namespace worse
             m_format   = view->format;
             m_usage    = RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit;
 
-            m_slices.resize(view->layers);            // only 1 now, no array
-            m_slices[0].mips.resize(view->mipLevels); // mip
-            m_slices[0].mips[0].bytes.resize(view->size);
-
-            view->deferredCopyFn(reinterpret_cast<byte*>(m_slices[0].mips[0].bytes.data()));
-
-            if (!nativeCreate())
+            // decoded straight into the staging memory of the upload
+            if (!nativeCreate(&*view))
             {
                 WS_LOG_ERROR("RHITexture", "Failed to create texture from memory");
             }
@@ -109,13 +105,8 @@ namespace worse
             m_format   = view->format;
             m_usage    = RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit;
 
-            m_slices.resize(view->layers);            // only 1 now, no array
-            m_slices[0].mips.resize(view->mipLevels); // mip 0 only
-            m_slices[0].mips[0].bytes.resize(view->size);
-
-            view->deferredCopyFn(reinterpret_cast<byte*>(m_slices[0].mips[0].bytes.data()));
-
-            if (!nativeCreate())
+            // decoded straight into the staging memory of the upload
+            if (!nativeCreate(&*view))
             {
                 WS_LOG_ERROR("RHITexture", "Failed to create combined texture: {}", name);
             }
@@ -0,0 +1,79 @@
+#include "Log.hpp"
+#include "RHIBuffer.hpp"
+#include "RHIUploadRing.hpp"
+
+#include <string>
+#include <cstring>
+#include <algorithm>
+
+namespace worse
+{
+
+    RHIUploadRing::RHIUploadRing(u32 const frameSize, std::string_view name)
+    {
+        // every frame region starts at an aligned offset
+        m_frameSize = (frameSize + RHIConfig::UPLOAD_RING_ALIGNMENT - 1) & ~(RHIConfig::UPLOAD_RING_ALIGNMENT - 1);
+
+        m_buffer = std::make_shared<RHIBuffer>(
+            RHIBufferUsageFlagBits::Upload,
+            m_frameSize,
+            RHIConfig::MAX_FRAMES_IN_FLIGHT,
+            nullptr,
+            true,
+            name);
+
+        m_mappedData = static_cast<byte*>(m_buffer->getMappedData());
+        WS_ASSERT_MSG(m_mappedData, "Upload ring is not mapped");
+    }
+
+    RHIUploadRing::~RHIUploadRing()
+    {
+        m_buffer.reset();
+    }
+
+    void RHIUploadRing::beginFrame(u32 const frameIndex)
+    {
+        WS_ASSERT(frameIndex < RHIConfig::MAX_FRAMES_IN_FLIGHT);
+
+        m_peakUsedSize = std::max(m_peakUsedSize, m_head.load(std::memory_order_relaxed));
+        m_frameOffset  = frameIndex * m_frameSize;
+        m_head.store(0, std::memory_order_relaxed);
+    }
+
+    RHIUploadAllocation RHIUploadRing::allocate(u32 const size, u32 const alignment)
+    {
+        WS_ASSERT(size > 0);
+        WS_ASSERT_MSG((alignment & (alignment - 1)) == 0, "Alignment must be power of two");
+
+        u32 head = m_head.load(std::memory_order_relaxed);
+        u32 begin = 0;
+        do
+        {
+            begin = (head + alignment - 1) & ~(alignment - 1);
+            if (begin + size > m_frameSize)
+            {
+                WS_LOG_ERROR("UploadRing", "Out of frame memory, request {} bytes, used {} of {} bytes", size, head, m_frameSize);
+                return {};
+            }
+        } while (!m_head.compare_exchange_weak(head, begin + size, std::memory_order_relaxed));
+
+        RHIUploadAllocation allocation = {};
+        allocation.buffer              = m_buffer.get();
+        allocation.offset              = m_frameOffset + begin;
+        allocation.size                = size;
+        allocation.data                = m_mappedData + allocation.offset;
+        return allocation;
+    }
+
+    RHIUploadAllocation RHIUploadRing::write(void const* data, u32 const size, u32 const alignment)
+    {
+        RHIUploadAllocation allocation = allocate(size, alignment);
+        if (allocation)
+        {
+            // host coherent memory, no flush needed
+            std::memcpy(allocation.data, data, size);
+        }
+        return allocation;
+    }
+
+} // namespace worse
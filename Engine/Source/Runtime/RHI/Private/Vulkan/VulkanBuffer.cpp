@@ -1,6 +1,7 @@
 #include "RHIDevice.hpp"
 #include "RHICommandList.hpp"
 #include "RHIBuffer.hpp"
+#include "RHIUploadQueue.hpp"
 
 #include <bit>
 
@@ -17,6 +18,29 @@ namespace worse
         bool isVIIStorage  = false;
         bool isUniform     = false;
 
+        // upload buffer, host visible and always mapped. frame constants in
+        // it are read by async compute, so it is shared across queues
+        if (m_usage & RHIBufferUsageFlagBits::Upload)
+        {
+            WS_ASSERT_MSG(m_usage == RHIBufferUsageFlagBits::Upload,
+                          "Upload buffer can not combine with other usages");
+
+            m_handle = RHIDevice::memoryBufferCreate(
+                m_size,
+                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                    VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                data,
+                m_name,
+                true);
+            WS_ASSERT_MSG(m_handle, "Failed to create buffer");
+
+            m_mappable = true;
+            m_gpuData  = RHIDevice::memoryGetMappedBufferData(m_handle);
+            return;
+        }
+
         // validation
         {
             WS_ASSERT(m_usage != RHIBufferUsageFlagBits::None);
@@ -113,13 +137,6 @@ namespace worse
 
         if (isStaggingCreation)
         {
-            RHINativeHandle stagingBuffer = RHIDevice::memoryBufferCreate(
-                m_size,
-                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                data,
-                {m_name + "_staging"});
-
             m_handle = RHIDevice::memoryBufferCreate(
                 m_size,
                 bufferUsage,
@@ -127,32 +144,11 @@ namespace worse
                 nullptr,
                 m_name);
 
-            if (RHICommandList* cmdList = RHIDevice::cmdImmediateBegin(RHIQueueType::Transfer))
+            // recorded into the current transfer batch, the frame that first
+            // uses the buffer waits for the batch on the GPU
+            if (m_handle && data)
             {
-                VkCommandBuffer vkCmdBUffer = cmdList->getHandle().asValue<VkCommandBuffer>();
-
-                VkBufferCopy2 copyRegion = {};
-                copyRegion.sType         = VK_STRUCTURE_TYPE_BUFFER_COPY_2;
-                copyRegion.srcOffset     = 0;
-                copyRegion.dstOffset     = 0;
-                copyRegion.size          = m_size;
-
-                VkCopyBufferInfo2 infoCopy = {};
-                infoCopy.sType             = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2;
-                infoCopy.srcBuffer         = stagingBuffer.asValue<VkBuffer>();
-                infoCopy.dstBuffer         = m_handle.asValue<VkBuffer>();
-                infoCopy.regionCount       = 1;
-                infoCopy.pRegions          = &copyRegion;
-
-                vkCmdCopyBuffer2KHR(vkCmdBUffer, &infoCopy);
-                RHIDevice::cmdImmediateSubmit(cmdList);
-                RHIDevice::memoryBufferDestroy(stagingBuffer);
-            }
-            else // error handling
-            {
-                WS_LOG_ERROR("RHIBuffer", "Failed to transfer buffer data");
-                RHIDevice::memoryBufferDestroy(stagingBuffer);
-                RHIDevice::memoryBufferDestroy(m_handle);
+                RHIDevice::getUploadQueue()->uploadBuffer(m_handle, data, m_size);
             }
         }
         else if (isDirectlyCreation || isUniform)
@@ -179,28 +175,4 @@ namespace worse
         }
     }
 
-    void RHIBuffer::update(RHICommandList* cmdList, void const* cpuData, u32 const size)
-    {
-        if (!cmdList)
-        {
-            WS_LOG_ERROR("RHIBuffer",
-                         "Failed to update buffer, cmdList is null");
-            return;
-        }
-        WS_ASSERT_MSG(m_mappable, "Cannot update unmappable buffer");
-        WS_ASSERT_MSG(m_gpuData, "Cannot update buffer, invalid GPU data");
-        WS_ASSERT_MSG(m_offset + size <= m_size, "Update buffer out of range");
-
-        if (m_firstUpdate)
-        {
-            m_firstUpdate = false;
-        }
-        else
-        {
-            m_offset += m_stride;
-        }
-
-        cmdList->updateBuffer(this, m_offset, size != 0 ? size : m_stride, cpuData);
-    }
-
 } // namespace worse
\ No newline at end of file
@@ -56,6 +56,81 @@ namespace worse
         }
     } // namespace map
 
+    namespace
+    {
+        // release and acquire record identical barriers, only the half
+        // executed on its queue carries access and stage masks
+        void recordOwnershipBarriers(RHINativeHandle cmdBuffer,
+                                     std::span<RHIOwnershipTransfer const> transfers,
+                                     u32 const srcFamily, u32 const dstFamily,
+                                     bool const release)
+        {
+            if (transfers.empty())
+            {
+                return;
+            }
+
+            std::vector<VkImageMemoryBarrier2> imageBarriers;
+            std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+
+            // clang-format off
+            for (RHIOwnershipTransfer const& transfer : transfers)
+            {
+                WS_ASSERT(transfer.resource);
+
+                VkPipelineStageFlags2 const srcStage  = release ? VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT : VK_PIPELINE_STAGE_2_NONE;
+                VkAccessFlags2 const srcAccess        = release ? VK_ACCESS_2_MEMORY_WRITE_BIT : VK_ACCESS_2_NONE;
+                VkPipelineStageFlags2 const dstStage  = release ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+                VkAccessFlags2 const dstAccess        = release ? VK_ACCESS_2_NONE : VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+                if (transfer.resource.getType() == RHINativeHandleType::Image)
+                {
+                    VkImageMemoryBarrier2& barrier = imageBarriers.emplace_back();
+                    barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+                    barrier.srcStageMask                    = srcStage;
+                    barrier.srcAccessMask                   = srcAccess;
+                    barrier.dstStageMask                    = dstStage;
+                    barrier.dstAccessMask                   = dstAccess;
+                    barrier.oldLayout                       = vulkanImageLayout(transfer.layoutOld);
+                    barrier.newLayout                       = vulkanImageLayout(transfer.layoutNew);
+                    barrier.srcQueueFamilyIndex             = srcFamily;
+                    barrier.dstQueueFamilyIndex             = dstFamily;
+                    barrier.image                           = transfer.resource.asValue<VkImage>();
+                    barrier.subresourceRange.aspectMask     = vulkanImageAspectFlags(transfer.format);
+                    barrier.subresourceRange.baseMipLevel   = 0;
+                    barrier.subresourceRange.levelCount     = VK_REMAINING_MIP_LEVELS;
+                    barrier.subresourceRange.baseArrayLayer = 0;
+                    barrier.subresourceRange.layerCount     = 1;
+                }
+                else
+                {
+                    WS_ASSERT(transfer.resource.getType() == RHINativeHandleType::Buffer);
+
+                    VkBufferMemoryBarrier2& barrier = bufferBarriers.emplace_back();
+                    barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+                    barrier.srcStageMask        = srcStage;
+                    barrier.srcAccessMask       = srcAccess;
+                    barrier.dstStageMask        = dstStage;
+                    barrier.dstAccessMask       = dstAccess;
+                    barrier.srcQueueFamilyIndex = srcFamily;
+                    barrier.dstQueueFamilyIndex = dstFamily;
+                    barrier.buffer              = transfer.resource.asValue<VkBuffer>();
+                    barrier.offset              = transfer.offset;
+                    barrier.size                = transfer.size;
+                }
+            }
+
+            VkDependencyInfo infoDependency         = {};
+            infoDependency.sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+            infoDependency.imageMemoryBarrierCount  = static_cast<u32>(imageBarriers.size());
+            infoDependency.pImageMemoryBarriers     = imageBarriers.data();
+            infoDependency.bufferMemoryBarrierCount = static_cast<u32>(bufferBarriers.size());
+            infoDependency.pBufferMemoryBarriers    = bufferBarriers.data();
+            // clang-format on
+            vkCmdPipelineBarrier2KHR(cmdBuffer.asValue<VkCommandBuffer>(), &infoDependency);
+        }
+    } // namespace
+
     RHICommandList::RHICommandList(RHIQueue* queue, RHINativeHandle cmdPool, std::string_view name)
         : RHIResource(name)
 
@@ -98,9 +173,12 @@ namespace worse
 
         m_state               = RHICommandListState::Recording;
         m_isFirstGraphicsPass = true;
+        // bindings do not persist across command buffers
+        m_pso      = nullptr;
+        m_pipeline = nullptr;
     }
 
-    void RHICommandList::submit(RHISyncPrimitive* semaphoreWait)
+    void RHICommandList::submit(RHISyncPrimitive* semaphoreWait, RHIPipelineStageFlags const semaphoreWaitStage)
     {
         WS_ASSERT(m_state == RHICommandListState::Recording);
         renderPassEnd();
@@ -112,7 +190,8 @@ namespace worse
             m_renderingCompleteTimelineSemaphore = std::make_shared<RHISyncPrimitive>(RHISyncPrimitiveType::TimelineSemaphore, m_renderingCompleteTimelineSemaphore->getName());
         }
 
-        m_submissionQueue->submit(m_handle.asValue<VkCommandBuffer>(), 0, semaphoreWait, m_renderingCompleteBinaySemaphore.get(), m_renderingCompleteTimelineSemaphore.get());
+        m_submissionQueue->submit(m_handle.asValue<VkCommandBuffer>(), semaphoreWaitStage, semaphoreWait, m_renderingCompleteBinaySemaphore.get(), m_renderingCompleteTimelineSemaphore.get(), m_queueWaits);
+        m_queueWaits.clear();
 
         if (semaphoreWait)
         {
@@ -128,20 +207,20 @@ namespace worse
         WS_ASSERT(m_state == RHICommandListState::Recording);
         renderPassEnd();
 
-        if (!(m_pso.type == RHIPipelineType::Graphics))
+        if (!(m_pso->type == RHIPipelineType::Graphics))
         {
             return;
         }
 
         VkRenderingInfo infoRender = {};
 
-        VkClearColorValue clearColor = {m_pso.clearColor.r,
-                                        m_pso.clearColor.g,
-                                        m_pso.clearColor.b,
-                                        m_pso.clearColor.a};
+        VkClearColorValue clearColor = {m_pso->clearColor.r,
+                                        m_pso->clearColor.g,
+                                        m_pso->clearColor.b,
+                                        m_pso->clearColor.a};
 
         std::vector<VkRenderingAttachmentInfo> colorAttachments;
-        for (RHITexture* texture : m_pso.renderTargetColorTextures)
+        for (RHITexture* texture : m_pso->renderTargetColorTextures)
         {
             if (!texture)
             {
@@ -155,8 +234,8 @@ namespace worse
             colorAttachment.sType            = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
             colorAttachment.imageView        = texture->getView().asValue<VkImageView>();
             colorAttachment.imageLayout      = vulkanImageLayout(texture->getImageLayout());
-            colorAttachment.loadOp           = ((m_pso.rasterizerState->getPolygonMode() == RHIPolygonMode::Wirefame) ||
-                                                (m_pso.primitiveTopology == RHIPrimitiveTopology::PointList))
+            colorAttachment.loadOp           = ((m_pso->rasterizerState->getPolygonMode() == RHIPolygonMode::Wirefame) ||
+                                                (m_pso->primitiveTopology == RHIPrimitiveTopology::PointList))
                                                    ? VK_ATTACHMENT_LOAD_OP_LOAD
                                                    : VK_ATTACHMENT_LOAD_OP_CLEAR;
             colorAttachment.storeOp          = VK_ATTACHMENT_STORE_OP_STORE;
@@ -167,25 +246,25 @@ namespace worse
         }
 
         VkRenderingAttachmentInfo depthAttachment = {};
-        if (m_pso.renderTargetDepthTexture)
+        if (m_pso->renderTargetDepthTexture)
         {
             // clang-format off
-            RHITexture* depthTexture = m_pso.renderTargetDepthTexture;
+            RHITexture* depthTexture = m_pso->renderTargetDepthTexture;
 
             depthTexture->convertImageLayout(this, RHIImageLayout::Attachment);
 
             depthAttachment.sType       = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
             depthAttachment.imageView   = depthTexture->getView().asValue<VkImageView>();
             depthAttachment.imageLayout = vulkanImageLayout(depthTexture->getImageLayout());
-            depthAttachment.loadOp      = m_pso.clearDepth == 2.0f // means just load
+            depthAttachment.loadOp      = m_pso->clearDepth == 2.0f // means just load
                                              ? VK_ATTACHMENT_LOAD_OP_LOAD
                                              : VK_ATTACHMENT_LOAD_OP_CLEAR;
-            depthAttachment.storeOp     = (m_pso.depthStencilState->getDepthWriteEnabled() ||
-                                           (m_pso.primitiveTopology == RHIPrimitiveTopology::PointList))
+            depthAttachment.storeOp     = (m_pso->depthStencilState->getDepthWriteEnabled() ||
+                                           (m_pso->primitiveTopology == RHIPrimitiveTopology::PointList))
                                              ? VK_ATTACHMENT_STORE_OP_STORE
                                              : VK_ATTACHMENT_STORE_OP_DONT_CARE;
 
-            depthAttachment.clearValue.depthStencil.depth = m_pso.clearDepth;
+            depthAttachment.clearValue.depthStencil.depth = m_pso->clearDepth;
             // clang-format on
 
             infoRender.pDepthAttachment = &depthAttachment;
@@ -193,7 +272,7 @@ namespace worse
 
         // clang-format off
         infoRender.sType                = VK_STRUCTURE_TYPE_RENDERING_INFO;
-        infoRender.renderArea           = {m_pso.scissor.x, m_pso.scissor.y, m_pso.scissor.width, m_pso.scissor.height};
+        infoRender.renderArea           = {m_pso->scissor.x, m_pso->scissor.y, m_pso->scissor.width, m_pso->scissor.height};
         infoRender.layerCount           = 1;
         infoRender.colorAttachmentCount = static_cast<u32>(colorAttachments.size());
         infoRender.pColorAttachments    = colorAttachments.data();
@@ -201,7 +280,7 @@ namespace worse
 
         vkCmdBeginRenderingKHR(m_handle.asValue<VkCommandBuffer>(), &infoRender);
 
-        setViewport(m_pso.viewport);
+        setViewport(m_pso->viewport);
 
         m_isRenderPassActive = true;
     }
@@ -259,40 +338,39 @@ namespace worse
         vkCmdDrawIndexed(m_handle.asValue<VkCommandBuffer>(), indexCount, instanceCount, indexOffset, vertexOffset, instanceIndex);
     }
 
-    void RHICommandList::setPipelineState(RHIPipelineState const& pso)
+    void RHICommandList::setPipelineState(RHIPipelineState const* pso)
     {
         WS_ASSERT(m_state == RHICommandListState::Recording);
-        WS_ASSERT(pso.isValidated());
+        WS_ASSERT(pso && pso->isValidated());
 
         // skip if the pso is not changed
-        if (pso.getHash() == m_pso.getHash())
+        if (pso == m_pso)
         {
             return;
         }
 
-        m_pso = pso;
-
-        m_pipeline = RHIDevice::getPipeline(pso);
+        m_pso      = pso;
+        m_pipeline = pso->getPipeline();
 
         renderPassBegin();
 
-        VkPipelineBindPoint bindPoint = (m_pso.type == RHIPipelineType::Graphics)
+        VkPipelineBindPoint bindPoint = (m_pso->type == RHIPipelineType::Graphics)
                                             ? VK_PIPELINE_BIND_POINT_GRAPHICS
                                             : VK_PIPELINE_BIND_POINT_COMPUTE;
 
         vkCmdBindPipeline(m_handle.asValue<VkCommandBuffer>(), bindPoint, m_pipeline->getHandle().asValue<VkPipeline>());
 
-        if (m_pso.type == RHIPipelineType::Graphics)
+        if (m_pso->type == RHIPipelineType::Graphics)
         {
-            setScissor(pso.scissor);
+            setScissor(pso->scissor);
         }
 
-        if ((m_pso.type == RHIPipelineType::Graphics) && m_isFirstGraphicsPass)
+        if ((m_pso->type == RHIPipelineType::Graphics) && m_isFirstGraphicsPass)
         {
             bindGlobalSet();
             m_isFirstGraphicsPass = false;
         }
-        if (m_pso.type == RHIPipelineType::Compute)
+        if (m_pso->type == RHIPipelineType::Compute)
         {
             bindGlobalSet();
         }
@@ -302,7 +380,8 @@ namespace worse
 
     void RHICommandList::clearPipelineState()
     {
-        m_pso = {};
+        m_pso      = nullptr;
+        m_pipeline = nullptr;
     }
 
     void RHICommandList::dispatch(u32 const x, u32 const y, u32 const z)
@@ -369,7 +448,8 @@ namespace worse
         imageBarrier.image                           = image.asValue<VkImage>();
         imageBarrier.subresourceRange.aspectMask     = vulkanImageAspectFlags(format);
         imageBarrier.subresourceRange.baseMipLevel   = 0;
-        imageBarrier.subresourceRange.levelCount     = 1;
+        // layouts are tracked per image, every mip moves together
+        imageBarrier.subresourceRange.levelCount     = VK_REMAINING_MIP_LEVELS;
         imageBarrier.subresourceRange.baseArrayLayer = 0;
         imageBarrier.subresourceRange.layerCount     = 1;
         // clang-format on
@@ -385,6 +465,53 @@ namespace worse
         map::setImageLayout(image, layoutNew);
     }
 
+    void RHICommandList::insertMemoryBarrier(
+        RHIPipelineStageFlags const srcStage,
+        RHIAccessFlags const srcAccess,
+        RHIPipelineStageFlags const dstStage,
+        RHIAccessFlags const dstAccess)
+    {
+        WS_ASSERT(m_state == RHICommandListState::Recording);
+
+        // clang-format off
+        VkMemoryBarrier2 memoryBarrier = {};
+        memoryBarrier.sType            = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+        memoryBarrier.srcStageMask     = static_cast<VkPipelineStageFlags2>(srcStage);
+        memoryBarrier.srcAccessMask    = static_cast<VkAccessFlags2>(srcAccess);
+        memoryBarrier.dstStageMask     = static_cast<VkPipelineStageFlags2>(dstStage);
+        memoryBarrier.dstAccessMask    = static_cast<VkAccessFlags2>(dstAccess);
+
+        VkDependencyInfo infoDependency   = {};
+        infoDependency.sType              = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        infoDependency.memoryBarrierCount = 1;
+        infoDependency.pMemoryBarriers    = &memoryBarrier;
+        // clang-format on
+        vkCmdPipelineBarrier2KHR(m_handle.asValue<VkCommandBuffer>(), &infoDependency);
+    }
+
+    void RHICommandList::releaseOwnership(std::span<RHIOwnershipTransfer const> transfers, RHIQueueType const destination)
+    {
+        WS_ASSERT(m_state == RHICommandListState::Recording);
+
+        recordOwnershipBarriers(m_handle, transfers, RHIDevice::getQueueIndex(m_submissionQueue->getType()), RHIDevice::getQueueIndex(destination), true);
+
+        // later recordings on any queue see the layout after the transfer
+        for (RHIOwnershipTransfer const& transfer : transfers)
+        {
+            if (transfer.resource.getType() == RHINativeHandleType::Image)
+            {
+                map::setImageLayout(transfer.resource, transfer.layoutNew);
+            }
+        }
+    }
+
+    void RHICommandList::acquireOwnership(std::span<RHIOwnershipTransfer const> transfers, RHIQueueType const source)
+    {
+        WS_ASSERT(m_state == RHICommandListState::Recording);
+
+        recordOwnershipBarriers(m_handle, transfers, RHIDevice::getQueueIndex(source), RHIDevice::getQueueIndex(m_submissionQueue->getType()), false);
+    }
+
     void RHICommandList::blit(RHITexture const* source,
                               RHITexture const* destination)
     {
@@ -453,7 +580,8 @@ namespace worse
         RHIImageLayout initialLayout = source->getImageLayout();
 
         source->convertImageLayout(this, RHIImageLayout::TransferSource);
-        insertBarrier(destination->getCurrentRt(), destination->getFormat(), RHIImageLayout::TransferDestination, RHIPipelineStageFlagBits::TopOfPipe, RHIAccessFlagBits::MemoryRead, RHIPipelineStageFlagBits::Transfer, RHIAccessFlagBits::MemoryWrite);
+        // chained to the image acquire semaphore, which is waited at Transfer
+        insertBarrier(destination->getCurrentRt(), destination->getFormat(), RHIImageLayout::TransferDestination, RHIPipelineStageFlagBits::Transfer, RHIAccessFlagBits::None, RHIPipelineStageFlagBits::Transfer, RHIAccessFlagBits::MemoryWrite);
 
         RHIFilter filter = (source->getWidth() == destination->getWidth() &&
                             source->getHeight() == destination->getHeight())
@@ -559,7 +687,8 @@ namespace worse
         RHIImageLayout sourceInitialLayout = source->getImageLayout();
 
         source->convertImageLayout(this, RHIImageLayout::TransferSource);
-        insertBarrier(destination->getCurrentRt(), destination->getFormat(), RHIImageLayout::TransferDestination, RHIPipelineStageFlagBits::TopOfPipe, RHIAccessFlagBits::MemoryRead, RHIPipelineStageFlagBits::Transfer, RHIAccessFlagBits::MemoryWrite);
+        // chained to the image acquire semaphore, which is waited at Transfer
+        insertBarrier(destination->getCurrentRt(), destination->getFormat(), RHIImageLayout::TransferDestination, RHIPipelineStageFlagBits::Transfer, RHIAccessFlagBits::None, RHIPipelineStageFlagBits::Transfer, RHIAccessFlagBits::MemoryWrite);
 
         VkImageCopy2 region                  = {};
         region.sType                         = VK_STRUCTURE_TYPE_IMAGE_COPY_2;
@@ -598,15 +727,15 @@ namespace worse
         WS_ASSERT(m_pipeline);
 
         VkShaderStageFlags stageFlags = 0;
-        if (m_pso.shaders[RHIShaderType::Compute])
+        if (m_pso->shaders[RHIShaderType::Compute])
         {
             stageFlags |= VK_SHADER_STAGE_COMPUTE_BIT;
         }
-        if (m_pso.shaders[RHIShaderType::Vertex])
+        if (m_pso->shaders[RHIShaderType::Vertex])
         {
             stageFlags |= VK_SHADER_STAGE_VERTEX_BIT;
         }
-        if (m_pso.shaders[RHIShaderType::Pixel])
+        if (m_pso->shaders[RHIShaderType::Pixel])
         {
             stageFlags |= VK_SHADER_STAGE_FRAGMENT_BIT;
         }
@@ -614,15 +743,14 @@ namespace worse
         vkCmdPushConstants(m_handle.asValue<VkCommandBuffer>(), m_pipeline->getLayout().asValue<VkPipelineLayout>(), stageFlags, 0, data.size(), data.data());
     }
 
-    void RHICommandList::setBufferVertex(RHIBuffer* buffer)
+    void RHICommandList::setBufferVertex(RHIBuffer* buffer, u32 const offset)
     {
         WS_ASSERT(m_state == RHICommandListState::Recording);
 
         VkBuffer vertexBuffer = buffer->getHandle().asValue<VkBuffer>();
-        VkDeviceSize offset   = 0;
-
+        VkDeviceSize vkOffset = offset;
 
-        vkCmdBindVertexBuffers(m_handle.asValue<VkCommandBuffer>(), 0, 1, &vertexBuffer, &offset);
+        vkCmdBindVertexBuffers(m_handle.asValue<VkCommandBuffer>(), 0, 1, &vertexBuffer, &vkOffset);
     }
 
     void RHICommandList::setBufferIndex(RHIBuffer* buffer)
@@ -687,7 +815,7 @@ namespace worse
 
         VkDescriptorSet vkSet = RHIDevice::getGlobalDescriptorSet().asValue<VkDescriptorSet>();
 
-        VkPipelineBindPoint bindPoint = (m_pso.type == RHIPipelineType::Graphics)
+        VkPipelineBindPoint bindPoint = (m_pso->type == RHIPipelineType::Graphics)
                                             ? VK_PIPELINE_BIND_POINT_GRAPHICS
                                             : VK_PIPELINE_BIND_POINT_COMPUTE;
 
@@ -714,7 +842,7 @@ namespace worse
 
         VkDescriptorSet vkSet = set.asValue<VkDescriptorSet>();
 
-        VkPipelineBindPoint bindPoint = (m_pso.type == RHIPipelineType::Graphics)
+        VkPipelineBindPoint bindPoint = (m_pso->type == RHIPipelineType::Graphics)
                                             ? VK_PIPELINE_BIND_POINT_GRAPHICS
                                             : VK_PIPELINE_BIND_POINT_COMPUTE;
 
@@ -777,6 +905,12 @@ namespace worse
                 infoImage.imageView             = texture->getView().asValue<VkImageView>();
                 infoImage.imageLayout           = vulkanImageLayout(texture->getImageLayout());
                 infoImage.sampler               = VK_NULL_HANDLE;
+
+                // persistent set already holds this view in this layout
+                if (!RHIDevice::cacheSpecificDescriptorWrite(set, shift + desc.reg, desc.index, texture->getView().asValue(), static_cast<u64>(infoImage.imageLayout), 0))
+                {
+                    break;
+                }
                 infoImages.push_back(infoImage);
 
                 VkWriteDescriptorSet writeSet = {};
@@ -817,8 +951,13 @@ namespace worse
 
                 VkDescriptorBufferInfo infoBuffer = {};
                 infoBuffer.buffer                 = buffer->getHandle().asValue<VkBuffer>();
-                infoBuffer.offset                 = buffer->getOffset();
-                infoBuffer.range                  = buffer->getSize();
+                infoBuffer.offset                 = desc.offset;
+                infoBuffer.range                  = (desc.range != 0) ? desc.range : (buffer->getSize() - desc.offset);
+
+                if (!RHIDevice::cacheSpecificDescriptorWrite(set, shift + desc.reg, desc.index, buffer->getHandle().asValue(), infoBuffer.offset, infoBuffer.range))
+                {
+                    break;
+                }
                 infoBuffers.push_back(infoBuffer);
 
                 VkWriteDescriptorSet writeSet = {};
@@ -837,7 +976,10 @@ namespace worse
             }
         }
 
-        vkUpdateDescriptorSets(RHIContext::device, static_cast<u32>(vkWrites.size()), vkWrites.data(), 0, nullptr);
+        if (!vkWrites.empty())
+        {
+            vkUpdateDescriptorSets(RHIContext::device, static_cast<u32>(vkWrites.size()), vkWrites.data(), 0, nullptr);
+        }
     }
 
     RHIImageLayout RHICommandList::getImageLayout(RHINativeHandle image)
@@ -9,6 +9,9 @@
 #include "RHIDescriptorSetLayout.hpp"
 #include "Pipeline/RHIPipelineState.hpp"
 
+#include <vector>
+#include <algorithm>
+
 namespace worse
 {
 
@@ -42,7 +45,7 @@ namespace worse
         RHINativeHandle poolHandle = RHINativeHandle{vkPool, RHINativeHandleType::DescriptorPool};
         m_pools[m_rotateIndex].push_back(poolHandle);
 
-        std::string name = "descriptor_pool_" + std::to_string(m_pools.size() - 1);
+        std::string name = "descriptor_pool_" + std::to_string(m_rotateIndex) + "_" + std::to_string(m_pools[m_rotateIndex].size() - 1);
         RHIDevice::setResourceName(poolHandle, name);
 
         return poolHandle;
@@ -100,31 +103,31 @@ namespace worse
 
     RHIDescriptorAllocator::RHIDescriptorAllocator()
     {
-        m_currentPoolIndex = {0, 0};
+        m_currentPoolIndex.fill(0);
     }
 
     RHIDescriptorAllocator::~RHIDescriptorAllocator()
     {
-        WS_LOG_DEBUG("Descriptor", "Destroying {} descriptor pools", m_pools[0].size() + m_pools[1].size());
-        for (RHINativeHandle pool : m_pools[0])
+        usize poolCount = 0;
+        for (std::vector<RHINativeHandle> const& pools : m_pools)
         {
-            RHIDevice::deletionQueueAdd(pool);
+            poolCount += pools.size();
         }
-        for (RHINativeHandle pool : m_pools[1])
+        WS_LOG_DEBUG("Descriptor", "Destroying {} descriptor pools", poolCount);
+
+        for (std::vector<RHINativeHandle> const& pools : m_pools)
         {
-            RHIDevice::deletionQueueAdd(pool);
+            for (RHINativeHandle pool : pools)
+            {
+                RHIDevice::deletionQueueAdd(pool);
+            }
         }
     }
 
-    void RHIDescriptorAllocator::resetAll()
+    void RHIDescriptorAllocator::setFrameIndex(u32 const frameIndex)
     {
-        m_rotateIndex = (m_rotateIndex + 1) % m_pools.size();
-
-        for (RHINativeHandle pool : m_pools[m_rotateIndex])
-        {
-            vkResetDescriptorPool(RHIContext::device, pool.asValue<VkDescriptorPool>(), 0);
-        }
-        m_currentPoolIndex[m_rotateIndex] = 0;
+        WS_ASSERT(frameIndex < m_pools.size());
+        m_rotateIndex = frameIndex;
     }
 
     RHINativeHandle RHIDescriptorAllocator::allocateSet(RHINativeHandle layout)
@@ -172,7 +175,7 @@ namespace worse
         layoutBindings[2].pImmutableSamplers = nullptr;
 
         layoutBindings[3].binding            = RHIConfig::HLSL_REGISTER_SHIFT_T + 0; // t0
-        layoutBindings[3].descriptorCount    = RHIConfig::MAX_DESCRIPTORS;
+        layoutBindings[3].descriptorCount    = RHIConfig::MAX_BINDLESS_TEXTURES;
         layoutBindings[3].descriptorType     = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
         layoutBindings[3].stageFlags         = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
         layoutBindings[3].pImmutableSamplers = nullptr;
@@ -202,155 +205,239 @@ namespace worse
         // clang-format on
     }
 
-    void VulkanGlobalSet::createInfos()
+    void VulkanGlobalSet::createPool()
     {
         // clang-format off
-        RHIBuffer* buffer = RHIDevice::getResourceProvider()->getFrameConstantBuffer();
+        std::array poolSizes = {
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, RHIConfig::MAX_FRAMES_IN_FLIGHT},
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_SAMPLER,        RHIConfig::MAX_FRAMES_IN_FLIGHT * 9},
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,  RHIConfig::MAX_FRAMES_IN_FLIGHT * RHIConfig::MAX_BINDLESS_TEXTURES},
+        };
+
+        VkDescriptorPoolCreateInfo infoPool = {};
+        infoPool.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        infoPool.flags         = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+        infoPool.maxSets       = RHIConfig::MAX_FRAMES_IN_FLIGHT;
+        infoPool.poolSizeCount = static_cast<u32>(poolSizes.size());
+        infoPool.pPoolSizes    = poolSizes.data();
 
-        m_frameConstantBufferInfo.buffer = buffer->getHandle().asValue<VkBuffer>();
-        m_frameConstantBufferInfo.offset = 0;
-        m_frameConstantBufferInfo.range  = buffer->getSize();
+        VkDescriptorPool vkPool = VK_NULL_HANDLE;
+        WS_ASSERT_VK(vkCreateDescriptorPool(RHIContext::device, &infoPool, nullptr, &vkPool));
+        m_pool = RHINativeHandle{vkPool, RHINativeHandleType::DescriptorPool};
+        RHIDevice::setResourceName(m_pool, "global_descriptor_pool");
+        // clang-format on
+    }
 
+    void VulkanGlobalSet::createSets()
+    {
+        // clang-format off
         EnumArray<RHISamplerType, RHISampler*> samplers = RHIDevice::getResourceProvider()->getSamplers();
 
-        m_samplerInfos[RHISamplerType::CompareDepth].sampler        = samplers[RHISamplerType::CompareDepth]->getHandle().asValue<VkSampler>();
-        m_samplerInfos[RHISamplerType::PointClampEdge].sampler      = samplers[RHISamplerType::PointClampEdge]->getHandle().asValue<VkSampler>();
-        m_samplerInfos[RHISamplerType::PointClampBorder].sampler    = samplers[RHISamplerType::PointClampBorder]->getHandle().asValue<VkSampler>();
-        m_samplerInfos[RHISamplerType::PointWrap].sampler                = samplers[RHISamplerType::PointWrap]->getHandle().asValue<VkSampler>();
-        m_samplerInfos[RHISamplerType::BilinearClampEdge].sampler   = samplers[RHISamplerType::BilinearClampEdge]->getHandle().asValue<VkSampler>();
-        m_samplerInfos[RHISamplerType::BilinearClampBorder].sampler = samplers[RHISamplerType::BilinearClampBorder]->getHandle().asValue<VkSampler>();
-        m_samplerInfos[RHISamplerType::BilinearWrap].sampler        = samplers[RHISamplerType::BilinearWrap]->getHandle().asValue<VkSampler>();
-        m_samplerInfos[RHISamplerType::TrilinearClamp].sampler      = samplers[RHISamplerType::TrilinearClamp]->getHandle().asValue<VkSampler>();
-        m_samplerInfos[RHISamplerType::AnisotropicClamp].sampler    = samplers[RHISamplerType::AnisotropicClamp]->getHandle().asValue<VkSampler>();
-
-        VkImageView imageView = RHIDevice::getResourceProvider()->getPlaceholderTexture()->getView().asValue<VkImageView>();
-
-        m_staticWrites[0].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        m_staticWrites[0].dstBinding      = RHIConfig::HLSL_REGISTER_SHIFT_B + 0; // b0
-        m_staticWrites[0].descriptorCount = 1;
-        m_staticWrites[0].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        m_staticWrites[0].pBufferInfo     = &m_frameConstantBufferInfo;
-
-        m_staticWrites[1].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        m_staticWrites[1].dstBinding      = RHIConfig::HLSL_REGISTER_SHIFT_S + 0; // s0
-        m_staticWrites[1].descriptorCount = 1;
-        m_staticWrites[1].descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLER;
-        m_staticWrites[1].pImageInfo      = &m_samplerInfos[RHISamplerType::CompareDepth];
-
-        m_staticWrites[2].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        m_staticWrites[2].dstBinding      = RHIConfig::HLSL_REGISTER_SHIFT_S + 1; // s1
-        m_staticWrites[2].descriptorCount = 8;
-        m_staticWrites[2].descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLER;
-        m_staticWrites[2].pImageInfo      = &m_samplerInfos[1];
+        EnumArray<RHISamplerType, VkDescriptorImageInfo> samplerInfos = {};
+        samplerInfos[RHISamplerType::CompareDepth].sampler        = samplers[RHISamplerType::CompareDepth]->getHandle().asValue<VkSampler>();
+        samplerInfos[RHISamplerType::PointClampEdge].sampler      = samplers[RHISamplerType::PointClampEdge]->getHandle().asValue<VkSampler>();
+        samplerInfos[RHISamplerType::PointClampBorder].sampler    = samplers[RHISamplerType::PointClampBorder]->getHandle().asValue<VkSampler>();
+        samplerInfos[RHISamplerType::PointWrap].sampler           = samplers[RHISamplerType::PointWrap]->getHandle().asValue<VkSampler>();
+        samplerInfos[RHISamplerType::BilinearClampEdge].sampler   = samplers[RHISamplerType::BilinearClampEdge]->getHandle().asValue<VkSampler>();
+        samplerInfos[RHISamplerType::BilinearClampBorder].sampler = samplers[RHISamplerType::BilinearClampBorder]->getHandle().asValue<VkSampler>();
+        samplerInfos[RHISamplerType::BilinearWrap].sampler        = samplers[RHISamplerType::BilinearWrap]->getHandle().asValue<VkSampler>();
+        samplerInfos[RHISamplerType::TrilinearClamp].sampler      = samplers[RHISamplerType::TrilinearClamp]->getHandle().asValue<VkSampler>();
+        samplerInfos[RHISamplerType::AnisotropicClamp].sampler    = samplers[RHISamplerType::AnisotropicClamp]->getHandle().asValue<VkSampler>();
+
+        u32 variableCount = RHIConfig::MAX_BINDLESS_TEXTURES;
+
+        VkDescriptorSetVariableDescriptorCountAllocateInfo variableCountInfo = {};
+        variableCountInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO;
+        variableCountInfo.descriptorSetCount = 1;
+        variableCountInfo.pDescriptorCounts  = &variableCount;
+
+        VkDescriptorSetLayout vkLayout = m_layout.asValue<VkDescriptorSetLayout>();
+
+        VkDescriptorSetAllocateInfo infoAlloc = {};
+        infoAlloc.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        infoAlloc.pNext              = &variableCountInfo;
+        infoAlloc.descriptorPool     = m_pool.asValue<VkDescriptorPool>();
+        infoAlloc.descriptorSetCount = 1;
+        infoAlloc.pSetLayouts        = &vkLayout;
+
+        for (u32 i = 0; i < RHIConfig::MAX_FRAMES_IN_FLIGHT; ++i)
+        {
+            VkDescriptorSet vkSet = VK_NULL_HANDLE;
+            WS_ASSERT_VK(vkAllocateDescriptorSets(RHIContext::device, &infoAlloc, &vkSet));
+            m_frameSets[i].set = RHINativeHandle{vkSet, RHINativeHandleType::DescriptorSet};
+
+            // samplers never change, write once
+            std::array<VkWriteDescriptorSet, 2> writes = {};
+            writes[0].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[0].dstSet          = vkSet;
+            writes[0].dstBinding      = RHIConfig::HLSL_REGISTER_SHIFT_S + 0; // s0
+            writes[0].descriptorCount = 1;
+            writes[0].descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLER;
+            writes[0].pImageInfo      = &samplerInfos[RHISamplerType::CompareDepth];
+
+            writes[1].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[1].dstSet          = vkSet;
+            writes[1].dstBinding      = RHIConfig::HLSL_REGISTER_SHIFT_S + 1; // s1
+            writes[1].descriptorCount = 8;
+            writes[1].descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLER;
+            writes[1].pImageInfo      = &samplerInfos[1];
+
+            vkUpdateDescriptorSets(RHIContext::device, static_cast<u32>(writes.size()), writes.data(), 0, nullptr);
+        }
         // clang-format on
+
+        m_bindlessViews.assign(RHIConfig::MAX_BINDLESS_TEXTURES, VK_NULL_HANDLE);
     }
 
-    VulkanGlobalSet::VulkanGlobalSet(RHIDescriptorAllocator* allocator)
+    void VulkanGlobalSet::writeBindless(FrameSet& frameSet, std::vector<u32>& indices)
     {
-        m_allocator = allocator;
+        if (indices.empty())
+        {
+            return;
+        }
+
+        std::sort(indices.begin(), indices.end());
+        indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+        // one write per run of contiguous indices
+        std::vector<VkWriteDescriptorSet> writes;
+        std::vector<VkDescriptorImageInfo> imageInfos(indices.size());
+
+        for (usize i = 0; i < indices.size(); ++i)
+        {
+            // clang-format off
+            imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            imageInfos[i].imageView   = m_bindlessViews[indices[i]];
+            imageInfos[i].sampler     = VK_NULL_HANDLE;
+
+            if ((i == 0) || (indices[i] != indices[i - 1] + 1))
+            {
+                VkWriteDescriptorSet write = {};
+                write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                write.dstSet          = frameSet.set.asValue<VkDescriptorSet>();
+                write.dstBinding      = RHIConfig::HLSL_REGISTER_SHIFT_T + 0; // t0
+                write.dstArrayElement = indices[i];
+                write.descriptorCount = 0;
+                write.descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+                write.pImageInfo      = imageInfos.data() + i;
+                writes.push_back(write);
+            }
+            ++writes.back().descriptorCount;
+            // clang-format on
+        }
+
+        vkUpdateDescriptorSets(RHIContext::device, static_cast<u32>(writes.size()), writes.data(), 0, nullptr);
+
+        m_writeCount += static_cast<u32>(indices.size());
+        indices.clear();
+    }
 
+    VulkanGlobalSet::VulkanGlobalSet()
+    {
         createLayout();
+        createPool();
     }
 
     VulkanGlobalSet::~VulkanGlobalSet()
     {
+        // sets are freed along with the pool
+        RHIDevice::deletionQueueAdd(m_pool);
         RHIDevice::deletionQueueAdd(m_layout);
     }
 
-    void VulkanGlobalSet::writeStatic()
+    void VulkanGlobalSet::beginFrame(u32 const frameIndex, RHIUploadAllocation const& frameConstant)
     {
-        WS_ASSERT(m_allocator);
+        WS_ASSERT(frameIndex < RHIConfig::MAX_FRAMES_IN_FLIGHT);
+        WS_ASSERT(frameConstant);
 
-        if (m_firstUpdate)
+        // samplers and placeholder come from renderer, create sets lazily
+        if (!m_frameSets[0].set)
         {
-            createInfos();
-            m_firstUpdate = false;
+            createSets();
         }
 
-        m_set = m_allocator->allocateVariableSet(m_layout, RHIConfig::MIN_DESCRIPTORS);
+        m_frameIndex       = frameIndex;
+        m_writeCount       = 0;
+        FrameSet& frameSet = m_frameSets[m_frameIndex];
 
-        // write static descriptors
+        // frame constant data is a sub-range of current frame's upload
+        // region, usually the same offset every frame, rewrite only if moved
+        // clang-format off
+        VkBuffer vkBuffer = frameConstant.buffer->getHandle().asValue<VkBuffer>();
+        if ((frameSet.frameConstantInfo.buffer != vkBuffer) ||
+            (frameSet.frameConstantInfo.offset != frameConstant.offset) ||
+            (frameSet.frameConstantInfo.range != frameConstant.size))
         {
-            for (VkWriteDescriptorSet& write : m_staticWrites)
-            {
-                write.dstSet = m_set.asValue<VkDescriptorSet>();
-            }
-
-            vkUpdateDescriptorSets(RHIContext::device, static_cast<u32>(m_staticWrites.size()), m_staticWrites.data(), 0, nullptr);
+            frameSet.frameConstantInfo.buffer = vkBuffer;
+            frameSet.frameConstantInfo.offset = frameConstant.offset;
+            frameSet.frameConstantInfo.range  = frameConstant.size;
+
+            VkWriteDescriptorSet write = {};
+            write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet          = frameSet.set.asValue<VkDescriptorSet>();
+            write.dstBinding      = RHIConfig::HLSL_REGISTER_SHIFT_B + 0; // b0
+            write.descriptorCount = 1;
+            write.descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            write.pBufferInfo     = &frameSet.frameConstantInfo;
+
+            vkUpdateDescriptorSets(RHIContext::device, 1, &write, 0, nullptr);
+            ++m_writeCount;
         }
+        // clang-format on
+
+        // bindless slots changed while this set was in flight
+        writeBindless(frameSet, frameSet.pendingIndices);
     }
 
-    void VulkanGlobalSet::writeBindlessTextures(std::span<RHIDescriptorWrite> updates)
+    void VulkanGlobalSet::forgetView(VkImageView view)
     {
-        WS_ASSERT(m_set);
-
-        std::sort(updates.begin(),
-                  updates.end(),
-                  [](RHIDescriptorWrite const& a, RHIDescriptorWrite const& b)
-                  {
-                      return a.index < b.index;
-                  });
-
-        // <startIndex, length>
-        std::vector<std::pair<uint32_t, uint32_t>> ranges;
-        for (usize i = 0; i < updates.size(); ++i)
-        {
-            uint32_t rangeStart = updates[i].index;
-            uint32_t rangeCount = 1;
+        // the slot compares unequal to any view and is written again with
+        // the next update
+        std::replace(m_bindlessViews.begin(), m_bindlessViews.end(), view, static_cast<VkImageView>(VK_NULL_HANDLE));
+    }
+
+    void VulkanGlobalSet::writeBindlessTextures(std::span<RHIDescriptorWrite const> updates)
+    {
+        WS_ASSERT(m_frameSets[m_frameIndex].set);
 
-            // Check for contiguous indices
-            while ((i + 1 < updates.size()) && (updates[i + 1].index == rangeStart + rangeCount))
+        RHITexture* placeholder = RHIDevice::getResourceProvider()->getPlaceholderTexture();
+
+        // diff against what the sets hold, only changed slots are written
+        std::vector<u32> changed;
+        for (RHIDescriptorWrite const& update : updates)
+        {
+            if (update.index >= RHIConfig::MAX_BINDLESS_TEXTURES)
             {
-                ++rangeCount;
-                ++i;
+                WS_LOG_ERROR("VulkanDescriptor", "Bindless index {} out of range {}", update.index, RHIConfig::MAX_BINDLESS_TEXTURES);
+                continue;
             }
 
-            ranges.emplace_back(rangeStart, rangeCount);
+            RHITexture* texture = update.resource.texture ? update.resource.texture : placeholder;
+            VkImageView view    = texture->getView().asValue<VkImageView>();
+            if (m_bindlessViews[update.index] != view)
+            {
+                m_bindlessViews[update.index] = view;
+                changed.push_back(update.index);
+            }
         }
 
-        std::vector<VkWriteDescriptorSet> writes(ranges.size());
-        std::vector<VkDescriptorImageInfo> imageInfos(updates.size());
+        if (changed.empty())
+        {
+            return;
+        }
 
-        uint32_t imageInfoIndex = 0;
-        uint32_t updatesIndex   = 0; // Track position in the original updates array
-        for (usize i = 0; i < ranges.size(); ++i)
+        // sets of other frames may still be read by GPU, write them when their
+        // frame begins again
+        for (u32 i = 0; i < RHIConfig::MAX_FRAMES_IN_FLIGHT; ++i)
         {
-            // clang-format off
-            auto const& range         = ranges[i];
-            writes[i].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            writes[i].dstSet          = m_set.asValue<VkDescriptorSet>();
-            writes[i].dstBinding      = RHIConfig::HLSL_REGISTER_SHIFT_T + 0; // t0
-            writes[i].dstArrayElement = range.first;
-            writes[i].descriptorCount = range.second;
-            writes[i].descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-            writes[i].pImageInfo      = imageInfos.data() + imageInfoIndex;
-
-            for (uint32_t j = 0; j < range.second; ++j)
+            if (i != m_frameIndex)
             {
-                // Bounds check to prevent heap buffer overflow
-                if (updatesIndex + j >= updates.size())
-                {
-                    WS_LOG_ERROR("VulkanDescriptor",
-                                 "Access out of bounds: updatesIndex({}) + j({}) >= updates.size({})", 
-                                 updatesIndex, j, updates.size());
-                    return;
-                }
-                
-                RHITexture* texture = updates[updatesIndex + j].resource.texture;
-                texture = texture ? texture : RHIDevice::getResourceProvider()->getPlaceholderTexture();
-
-                imageInfos[imageInfoIndex].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                imageInfos[imageInfoIndex].imageView   = texture->getView().asValue<VkImageView>();
-                imageInfos[imageInfoIndex].sampler     = VK_NULL_HANDLE;
-                ++imageInfoIndex;
+                std::vector<u32>& pending = m_frameSets[i].pendingIndices;
+                pending.insert(pending.end(), changed.begin(), changed.end());
             }
-            
-            // Move to the next range in updates array
-            updatesIndex += range.second;
-            // clang-format on
         }
 
-        vkUpdateDescriptorSets(RHIContext::device, static_cast<u32>(writes.size()), writes.data(), 0, nullptr);
+        writeBindless(m_frameSets[m_frameIndex], changed);
     }
 
     VulkanSpecificSet::VulkanSpecificSet(RHIDescriptorAllocator* allocator)
@@ -379,6 +466,8 @@ namespace worse
             // clang-format on
         }
 
+        std::lock_guard<std::mutex> lock(m_mtxLayouts);
+
         auto it = m_descriptorSetLayouts.find(hash);
         if (it != m_descriptorSetLayouts.end())
         {
@@ -392,6 +481,8 @@ namespace worse
 
     RHIDescriptorSetLayout* VulkanSpecificSet::getDescriptorSetLayout(u64 hash)
     {
+        std::lock_guard<std::mutex> lock(m_mtxLayouts);
+
         auto it = m_descriptorSetLayouts.find(hash);
         if (it != m_descriptorSetLayouts.end())
         {
@@ -403,8 +494,10 @@ namespace worse
 
     RHINativeHandle VulkanSpecificSet::getDescriptorSet(u64 hash)
     {
-        auto it = m_descriptorSets.find(hash);
-        if (it != m_descriptorSets.end())
+        std::unordered_map<u64, RHINativeHandle>& sets = m_descriptorSets[m_frameIndex];
+
+        auto it = sets.find(hash);
+        if (it != sets.end())
         {
             return it->second;
         }
@@ -414,14 +507,42 @@ namespace worse
         WS_ASSERT_MSG(layout, "Unmatched descriptor hash");
 
         RHINativeHandle set = m_allocator->allocateSet(layout->getLayout());
-        m_descriptorSets.emplace(hash, set);
+        sets.emplace(hash, set);
         return set;
     }
 
-    void VulkanSpecificSet::resetSets()
+    void VulkanSpecificSet::setFrameIndex(u32 const frameIndex)
+    {
+        WS_ASSERT(frameIndex < RHIConfig::MAX_FRAMES_IN_FLIGHT);
+        m_frameIndex = frameIndex;
+        m_allocator->setFrameIndex(frameIndex);
+    }
+
+    bool VulkanSpecificSet::cacheWrite(RHINativeHandle set, u32 const binding, u32 const arrayElement, u64 const resource, u64 const offset, u64 const range)
     {
-        // clear all sets
-        m_descriptorSets.clear();
+        u64 key                      = (static_cast<u64>(binding) << 32) | arrayElement;
+        std::array<u64, 3> const now = {resource, offset, range};
+
+        auto [it, inserted] = m_writtenDescriptors[set.asValue()].try_emplace(key, now);
+        if (inserted)
+        {
+            return true;
+        }
+        if (it->second == now)
+        {
+            return false;
+        }
+        it->second = now;
+        return true;
+    }
+
+    void VulkanSpecificSet::forgetResource(u64 const resource)
+    {
+        for (auto& [set, writes] : m_writtenDescriptors)
+        {
+            std::erase_if(writes, [resource](auto const& write)
+                          { return write.second[0] == resource; });
+        }
     }
 
-} // namespace worse
\ No newline at end of file
+} // namespace worse
@@ -1,48 +1,70 @@
 #pragma once
 #include "RHIResource.hpp"
 #include "RHIDescriptor.hpp"
+#include "RHIUploadRing.hpp"
 
 #include <span>
 #include <array>
+#include <mutex>
+#include <vector>
 #include <unordered_map>
 
 namespace worse
 {
 
+    /**
+     * @brief 全局描述符集 (set 0)
+     *
+     * 每个飞行帧一个常驻集合, 采样器只写一次, 帧常量仅在偏移变化时重写,
+     * 无绑定纹理与上一次写入的内容比较后只写变化的槽位, 其他帧的集合在其
+     * 下一次 beginFrame 时补写
+     */
     class VulkanGlobalSet
     {
+        struct FrameSet
+        {
+            RHINativeHandle set                      = {};
+            VkDescriptorBufferInfo frameConstantInfo = {};
+            // bindless slots changed while the set was in flight
+            std::vector<u32> pendingIndices;
+        };
+
         void createLayout();
-        // create allocation and write infos
-        void createInfos();
+        void createPool();
+        // allocate sets of all frames and write static descriptors
+        void createSets();
+        // write bindless slots from m_bindlessViews, clears indices
+        void writeBindless(FrameSet& frameSet, std::vector<u32>& indices);
 
     public:
-        VulkanGlobalSet(RHIDescriptorAllocator* allocator);
-
+        VulkanGlobalSet();
         ~VulkanGlobalSet();
 
-        // allocate set and write all descriptor, for bindless textures are
-        // wrote with default placeholder texture, call at frame start
-        void writeStatic();
-        // write bindless textures
-        // write and update bindless textures at runtime
-        void writeBindlessTextures(std::span<RHIDescriptorWrite> updates);
+        // select the set of the frame slot, the GPU must have finished the
+        // frame that used the slot last time
+        void beginFrame(u32 const frameIndex, RHIUploadAllocation const& frameConstant);
+        // write bindless textures that differ from the current content
+        void writeBindlessTextures(std::span<RHIDescriptorWrite const> updates);
+        // the view is destroyed, a new view may reuse its handle
+        void forgetView(VkImageView view);
 
         // clang-format off
         RHINativeHandle getLayout() const { return m_layout; }
-        RHINativeHandle getSet() const    { return m_set; }
+        RHINativeHandle getSet() const    { return m_frameSets[m_frameIndex].set; }
+        // descriptors written since the last beginFrame
+        u32 getWriteCount() const         { return m_writeCount; }
         // clang-format on
 
     private:
-        bool m_firstUpdate                  = true;
-        RHIDescriptorAllocator* m_allocator = nullptr;
-        RHINativeHandle m_layout            = {};
-        RHINativeHandle m_set               = {};
+        RHINativeHandle m_pool   = {};
+        RHINativeHandle m_layout = {};
 
-        // clang-format off
-        VkDescriptorBufferInfo m_frameConstantBufferInfo = {};
-        EnumArray<RHISamplerType, VkDescriptorImageInfo> m_samplerInfos = {};
-        std::array<VkWriteDescriptorSet, 3> m_staticWrites = {};
-        // clang-format on
+        std::array<FrameSet, RHIConfig::MAX_FRAMES_IN_FLIGHT> m_frameSets = {};
+        u32 m_frameIndex = 0;
+        u32 m_writeCount = 0;
+
+        // image view currently referenced by each bindless slot
+        std::vector<VkImageView> m_bindlessViews;
     };
 
     class VulkanSpecificSet
@@ -57,17 +79,27 @@ namespace worse
         // get descriptor set layout for specific hash, return nullptr if not
         // found
         RHIDescriptorSetLayout* getDescriptorSetLayout(u64 hash);
-        // get descriptor set, or allocate a new one
+        // get descriptor set of current frame, or allocate a new one
         RHINativeHandle getDescriptorSet(u64 hash);
 
-        // sets will be reset every frame, must invalidate cache
-        void resetSets();
+        // sets persist across frames, one per frame slot
+        void setFrameIndex(u32 const frameIndex);
+        // record content of a binding, returns false if the set already holds
+        // the same descriptor and the write can be skipped
+        bool cacheWrite(RHINativeHandle set, u32 const binding, u32 const arrayElement, u64 const resource, u64 const offset, u64 const range);
+        // drop cached writes of a destroyed view or buffer
+        void forgetResource(u64 const resource);
 
     private:
         RHIDescriptorAllocator* m_allocator = nullptr;
+        u32 m_frameIndex                    = 0;
         // clang-format off
         std::unordered_map<u64, std::shared_ptr<RHIDescriptorSetLayout>> m_descriptorSetLayouts;
-        std::unordered_map<u64, RHINativeHandle> m_descriptorSets;
+        // layouts are also created by pipeline prewarm jobs
+        std::mutex m_mtxLayouts;
+        std::array<std::unordered_map<u64, RHINativeHandle>, RHIConfig::MAX_FRAMES_IN_FLIGHT> m_descriptorSets;
+        // set -> (binding, array element) -> (resource, offset, range)
+        std::unordered_map<u64, std::unordered_map<u64, std::array<u64, 3>>> m_writtenDescriptors;
         // clang-format on
     };
 
@@ -7,6 +7,8 @@
 #include "RHIDescriptor.hpp"
 #include "VulkanDescriptor.hpp"
 #include "RHICommandList.hpp"
+#include "RHIUploadRing.hpp"
+#include "RHIUploadQueue.hpp"
 #include "Pipeline/RHIPipeline.hpp"
 #include "Pipeline/RHIPipelineState.hpp"
 
@@ -14,9 +16,15 @@
 #include "vk_mem_alloc.h"
 
 #include <mutex>
+#include <deque>
+#include <atomic>
 #include <vector>
+#include <algorithm>
 #include <limits>
 #include <memory>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
 #include <semaphore> // synchronize immediate command
 #include <unordered_map>
 
@@ -53,6 +61,20 @@ namespace worse
             return extensionsInstance;
         }
 
+        // real heap usage and budget from the driver instead of VMA estimates
+        bool hasMemoryBudget = false;
+
+        bool isDeviceExtensionSupported(char const* name)
+        {
+            u32 count = 0;
+            vkEnumerateDeviceExtensionProperties(RHIContext::physicalDevice, nullptr, &count, nullptr);
+            std::vector<VkExtensionProperties> properties(count);
+            vkEnumerateDeviceExtensionProperties(RHIContext::physicalDevice, nullptr, &count, properties.data());
+
+            return std::any_of(properties.begin(), properties.end(), [name](VkExtensionProperties const& property)
+                               { return std::strcmp(property.extensionName, name) == 0; });
+        }
+
         std::vector<char const*> getExtensionsDevice()
         {
             // must have
@@ -69,6 +91,13 @@ namespace worse
                 extensionsDevice.emplace_back("VK_KHR_portability_subset");
             }
 
+            // optional
+            hasMemoryBudget = isDeviceExtensionSupported(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+            if (hasMemoryBudget)
+            {
+                extensionsDevice.emplace_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+            }
+
             return extensionsDevice;
         }
     } // namespace extensions
@@ -158,7 +187,11 @@ namespace worse
 
         void detect()
         {
-            featureCore.fillModeNonSolid = VK_TRUE;
+            VkPhysicalDeviceFeatures supported = {};
+            vkGetPhysicalDeviceFeatures(RHIContext::physicalDevice, &supported);
+
+            featureCore.fillModeNonSolid     = VK_TRUE;
+            featureCore.textureCompressionBC = supported.textureCompressionBC;
 
             // clang-format off
             featureDescriptorIndexing.sType                                         = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
@@ -280,11 +313,24 @@ namespace worse
             // 找到一个支持图形和计算的队列族
             indexGraphics = getQueueFamilyIndex(queueFamilies, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT, false);
             
-            // 未使用
             indexCompute  = getQueueFamilyIndex(queueFamilies, VK_QUEUE_COMPUTE_BIT, false);
             indexTransfer = getQueueFamilyIndex(queueFamilies, VK_QUEUE_TRANSFER_BIT, false);
         }
 
+        /**
+         * @brief 跨队列资源共享的队列族
+         *
+         * 只有异步计算访问的资源使用并发共享, 其余资源独占, 上传由传输队列
+         * 释放所有权后再由图形队列获取
+         */
+        std::vector<u32> getSharingFamilies()
+        {
+            std::vector<u32> families{indexGraphics, indexCompute};
+            std::sort(families.begin(), families.end());
+            families.erase(std::unique(families.begin(), families.end()), families.end());
+            return families;
+        }
+
         void destroy()
         {
             regular.fill(nullptr);
@@ -301,7 +347,7 @@ namespace worse
         void initialize()
         {
             allocator   = std::make_unique<RHIDescriptorAllocator>();
-            globalSet   = std::make_unique<VulkanGlobalSet>(allocator.get());
+            globalSet   = std::make_unique<VulkanGlobalSet>();
             specificSet = std::make_unique<VulkanSpecificSet>(allocator.get());
         }
 
@@ -323,6 +369,8 @@ namespace worse
         {
             VmaAllocation allocation;
             RHINativeHandle handle;
+            RHIMemoryCategory category;
+            u64 size;
         };
 
         std::mutex mtxAllocation;
@@ -335,6 +383,10 @@ namespace worse
             infoAllocator.device           = RHIContext::device;
             infoAllocator.instance         = RHIContext::instance;
             infoAllocator.vulkanApiVersion = RHIContext::version;
+            if (extensions::hasMemoryBudget)
+            {
+                infoAllocator.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+            }
 
             VmaVulkanFunctions vulkanFunctions{};
             infoAllocator.pVulkanFunctions = &vulkanFunctions;
@@ -358,12 +410,61 @@ namespace worse
             vma::allocator = VK_NULL_HANDLE;
         }
 
-        void saveAllocation(VmaAllocation const& allocation, RHINativeHandle handle)
+        void saveAllocation(VmaAllocation const& allocation, RHINativeHandle handle, RHIMemoryCategory category, u64 size)
         {
             WS_ASSERT(handle);
 
             std::lock_guard lock{mtxAllocation};
-            allocations.emplace(handle.asValue(), AllocationData{allocation, handle});
+            allocations.emplace(handle.asValue(), AllocationData{allocation, handle, category, size});
+        }
+
+        RHIMemoryCategory getBufferCategory(u32 const bufferUsage)
+        {
+            if (bufferUsage & (VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT))
+            {
+                return RHIMemoryCategory::Mesh;
+            }
+            if (bufferUsage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+            {
+                return RHIMemoryCategory::Uniform;
+            }
+            if (bufferUsage == VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+            {
+                return RHIMemoryCategory::Staging;
+            }
+            return RHIMemoryCategory::Other;
+        }
+
+        RHIMemoryCategory getTextureCategory(RHITextureViewFlags const usage)
+        {
+            if (usage & (RHITextureViewFlagBits::RenderTargetView |
+                         RHITextureViewFlagBits::DepthStencilView |
+                         RHITextureViewFlagBits::UnorderedAccessView))
+            {
+                return RHIMemoryCategory::RenderTarget;
+            }
+            return RHIMemoryCategory::Texture;
+        }
+
+        void writeJsonString(std::ofstream& stream, std::string_view text)
+        {
+            stream << '"';
+            for (char const c : text)
+            {
+                if ((c == '"') || (c == '\\'))
+                {
+                    stream << '\\' << c;
+                }
+                else if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    stream << std::format("\\u{:04x}", static_cast<u32>(c));
+                }
+                else
+                {
+                    stream << c;
+                }
+            }
+            stream << '"';
         }
 
         // thread safe
@@ -393,22 +494,215 @@ namespace worse
     namespace pipeline
     {
         std::unique_ptr<RHIPipelinePool> pipelinePool = nullptr;
+        VkPipelineCache cache                         = VK_NULL_HANDLE;
+
+        std::filesystem::path getCachePath()
+        {
+            return std::filesystem::path{worse::EngineDirectory} / "Intermediate/PipelineCache/pipeline_cache.bin";
+        }
+
+        // cache data produced by another driver or device is rejected by
+        // the header check instead of being handed to the driver
+        bool validateCacheData(std::vector<char> const& data)
+        {
+            if (data.size() < sizeof(VkPipelineCacheHeaderVersionOne))
+            {
+                return false;
+            }
+
+            VkPipelineCacheHeaderVersionOne header = {};
+            std::memcpy(&header, data.data(), sizeof(header));
+
+            VkPhysicalDeviceProperties properties = {};
+            vkGetPhysicalDeviceProperties(RHIContext::physicalDevice, &properties);
+
+            return (header.headerSize >= sizeof(VkPipelineCacheHeaderVersionOne)) &&
+                   (header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE) &&
+                   (header.vendorID == properties.vendorID) &&
+                   (header.deviceID == properties.deviceID) &&
+                   (std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0);
+        }
+
+        void createCache()
+        {
+            std::vector<char> data;
+            {
+                std::ifstream stream(getCachePath(), std::ios::binary | std::ios::ate);
+                if (stream.is_open())
+                {
+                    data.resize(static_cast<usize>(stream.tellg()));
+                    stream.seekg(0);
+                    stream.read(data.data(), static_cast<std::streamsize>(data.size()));
+                }
+            }
+
+            if (!data.empty() && !validateCacheData(data))
+            {
+                WS_LOG_WARN("Pipeline", "Discard incompatible pipeline cache {}", getCachePath().string());
+                data.clear();
+            }
+
+            VkPipelineCacheCreateInfo infoCache = {};
+            infoCache.sType                     = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+            infoCache.initialDataSize           = data.size();
+            infoCache.pInitialData              = data.empty() ? nullptr : data.data();
+
+            WS_ASSERT_VK(vkCreatePipelineCache(RHIContext::device, &infoCache, nullptr, &cache));
+            RHIDevice::setResourceName(RHINativeHandle{cache, RHINativeHandleType::PipelineCache}, "pipeline_cache");
+
+            WS_LOG_INFO("Pipeline", "Pipeline cache loaded {} bytes", data.size());
+        }
+
+        void saveCache()
+        {
+            usize size = 0;
+            if ((vkGetPipelineCacheData(RHIContext::device, cache, &size, nullptr) != VK_SUCCESS) || (size == 0))
+            {
+                return;
+            }
+
+            std::vector<char> data(size);
+            if (vkGetPipelineCacheData(RHIContext::device, cache, &size, data.data()) != VK_SUCCESS)
+            {
+                return;
+            }
+
+            std::filesystem::path const path = getCachePath();
+            std::filesystem::path tempPath   = path;
+            tempPath += ".tmp";
+
+            std::error_code error;
+            std::filesystem::create_directories(path.parent_path(), error);
+            {
+                std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+                if (!stream.is_open())
+                {
+                    WS_LOG_WARN("Pipeline", "Failed to write pipeline cache {}", tempPath.string());
+                    return;
+                }
+                stream.write(data.data(), static_cast<std::streamsize>(size));
+            }
+            std::filesystem::rename(tempPath, path, error);
+
+            WS_LOG_INFO("Pipeline", "Pipeline cache saved {} bytes", size);
+        }
 
         void initialize()
         {
+            createCache();
             pipelinePool = std::make_unique<RHIPipelinePool>();
+            // create pipelines recorded by previous runs in the background
+            pipelinePool->prewarm();
         }
 
         void release()
         {
+            // waits pending prewarm jobs and saves the manifest
             pipelinePool.reset();
+
+            saveCache();
+            vkDestroyPipelineCache(RHIContext::device, cache, nullptr);
+            cache = VK_NULL_HANDLE;
         }
     } // namespace pipeline
 
+    namespace upload
+    {
+        std::unique_ptr<RHIUploadRing> ring   = nullptr;
+        std::unique_ptr<RHIUploadQueue> queue = nullptr;
+
+        void initialize()
+        {
+            ring  = std::make_unique<RHIUploadRing>(RHIConfig::UPLOAD_RING_FRAME_SIZE, "upload_ring");
+            queue = std::make_unique<RHIUploadQueue>(RHIConfig::UPLOAD_STAGING_SIZE, "upload_staging");
+        }
+
+        void release()
+        {
+            queue.reset();
+            ring.reset();
+        }
+    } // namespace upload
+
+    namespace map
+    {
+        // image layout tracking of command lists
+        void removeImageLayout(RHINativeHandle image);
+    } // namespace map
+
     namespace
     {
-        std::mutex mtxDeletionQueue;
-        std::unordered_map<RHINativeHandleType, std::vector<RHINativeHandle>> deletionQueue;
+        // enqueued from any thread, lock free intrusive stack
+        struct DeletionNode
+        {
+            RHINativeHandle handle;
+            DeletionNode* next = nullptr;
+        };
+        std::atomic<DeletionNode*> deletionPending = nullptr;
+
+        // resources of one frame, destroyed once every queue reached the
+        // timeline values submitted by the end of that frame
+        struct DeletionFrame
+        {
+            EnumArray<RHIQueueType, u64> values = {};
+            std::vector<RHINativeHandle> handles;
+        };
+        // render thread only
+        std::deque<DeletionFrame> deletionFrames;
+
+        std::vector<RHINativeHandle> takeDeletionPending()
+        {
+            DeletionNode* node = deletionPending.exchange(nullptr, std::memory_order_acquire);
+
+            std::vector<RHINativeHandle> handles;
+            while (node)
+            {
+                DeletionNode* next = node->next;
+                handles.push_back(node->handle);
+                delete node;
+                node = next;
+            }
+            // stack pops newest first, destroy in enqueue order
+            std::reverse(handles.begin(), handles.end());
+            return handles;
+        }
+
+        void destroyResource(RHINativeHandle handle)
+        {
+            // caches keyed by handle value must not match a recycled handle
+            if ((handle.getType() == RHINativeHandleType::ImageView) && descriptor::globalSet)
+            {
+                descriptor::globalSet->forgetView(handle.asValue<VkImageView>());
+            }
+            if (((handle.getType() == RHINativeHandleType::ImageView) || (handle.getType() == RHINativeHandleType::Buffer)) && descriptor::specificSet)
+            {
+                descriptor::specificSet->forgetResource(handle.asValue());
+            }
+            if (handle.getType() == RHINativeHandleType::Image)
+            {
+                map::removeImageLayout(handle);
+            }
+
+            // clang-format off
+            switch (handle.getType())
+            {
+            case RHINativeHandleType::Fence:               vkDestroyFence(RHIContext::device, handle.asValue<VkFence>(), nullptr);                             break;
+            case RHINativeHandleType::Semaphore:           vkDestroySemaphore(RHIContext::device, handle.asValue<VkSemaphore>(), nullptr);                     break;
+            case RHINativeHandleType::Shader:              vkDestroyShaderModule(RHIContext::device, handle.asValue<VkShaderModule>(), nullptr);               break;
+            case RHINativeHandleType::Pipeline:            vkDestroyPipeline(RHIContext::device, handle.asValue<VkPipeline>(), nullptr);                       break;
+            case RHINativeHandleType::PipelineLayout:      vkDestroyPipelineLayout(RHIContext::device, handle.asValue<VkPipelineLayout>(), nullptr);           break;
+            case RHINativeHandleType::Image:               RHIDevice::memoryTextureDestroy(handle);                                                            break;
+            case RHINativeHandleType::ImageView:           vkDestroyImageView(RHIContext::device, handle.asValue<VkImageView>(), nullptr);                     break;
+            case RHINativeHandleType::Sampler:             vkDestroySampler(RHIContext::device, handle.asValue<VkSampler>(), nullptr);                         break;
+            case RHINativeHandleType::Buffer:              RHIDevice::memoryBufferDestroy(handle);                                                             break;
+            case RHINativeHandleType::DescriptorPool:      vkDestroyDescriptorPool(RHIContext::device, handle.asValue<VkDescriptorPool>(), nullptr);           break;
+            case RHINativeHandleType::DescriptorSetLayout: vkDestroyDescriptorSetLayout(RHIContext::device, handle.asValue<VkDescriptorSetLayout>(), nullptr); break;
+            default:
+                WS_LOG_ERROR("RHI", "Unhandled handle type");
+                WS_ASSERT(false);
+            }
+            // clang-format on
+        }
 
         RHIResourceProvider* resourceProvider = nullptr;
     } // namespace
@@ -460,25 +754,25 @@ namespace worse
                     queues::indexTransfer,
                 };
 
-                // for (auto const& index : queueFamilyIndices)
-                // {
-                //     // clang-format off
-                //     VkDeviceQueueCreateInfo infoQueue = {};
-                //     infoQueue.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-                //     infoQueue.queueFamilyIndex = index;
-                //     infoQueue.queueCount       = 1;
-                //     infoQueue.pQueuePriorities = &queuePriority;
-                //     // clang-format on
-                //     queueInfos.emplace_back(infoQueue);
-                // };
-
-                // 暂时只启用 graphics 队列
-                VkDeviceQueueCreateInfo infoQueue = {};
-                infoQueue.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-                infoQueue.queueFamilyIndex = queueFamilyIndices[0];
-                infoQueue.queueCount       = 1;
-                infoQueue.pQueuePriorities = &queuePriority;
-                queueInfos.emplace_back(infoQueue);
+                // 每个不同的队列族创建一个队列, 计算队列与图形队列同族时共用
+                std::sort(queueFamilyIndices.begin(), queueFamilyIndices.end());
+                queueFamilyIndices.erase(std::unique(queueFamilyIndices.begin(), queueFamilyIndices.end()), queueFamilyIndices.end());
+                for (u32 const index : queueFamilyIndices)
+                {
+                    // clang-format off
+                    VkDeviceQueueCreateInfo infoQueue = {};
+                    infoQueue.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+                    infoQueue.queueFamilyIndex = index;
+                    infoQueue.queueCount       = 1;
+                    infoQueue.pQueuePriorities = &queuePriority;
+                    // clang-format on
+                    queueInfos.emplace_back(infoQueue);
+                }
+
+                if (queues::indexCompute == queues::indexGraphics)
+                {
+                    WS_LOG_WARN("RHI", "No dedicated compute queue family, async compute shares the graphics queue");
+                }
             }
 
             deviceFeatures::detect();
@@ -544,6 +838,7 @@ namespace worse
         DXCompiler::initialize();
         descriptor::initialize();
         pipeline::initialize();
+        upload::initialize();
     }
 
     void RHIDevice::destroy()
@@ -551,8 +846,10 @@ namespace worse
         RHIDevice::queueWaitAll();
         queues::destroy();
 
-        descriptor::release();
+        upload::release();
+        // pipeline prewarm jobs use descriptor set layouts, finish them first
         pipeline::release();
+        descriptor::release();
 
         RHIDevice::deletionQueueFlush();
 
@@ -583,10 +880,16 @@ namespace worse
         return resourceProvider;
     }
 
+    bool RHIDevice::isTextureCompressionSupported()
+    {
+        return deviceFeatures::featureCore.textureCompressionBC == VK_TRUE;
+    }
+
     void RHIDevice::queueWaitAll()
     {
         queues::regular[RHIQueueType::Graphics]->wait();
         queues::regular[RHIQueueType::Compute]->wait();
+        queues::regular[RHIQueueType::Transfer]->wait();
     }
 
     u32 RHIDevice::getQueueIndex(RHIQueueType const type)
@@ -617,6 +920,10 @@ namespace worse
         {
             return queues::regular[RHIQueueType::Compute].get();
         }
+        if (type == RHIQueueType::Transfer)
+        {
+            return queues::regular[RHIQueueType::Transfer].get();
+        }
 
         return nullptr;
     }
@@ -639,9 +946,23 @@ namespace worse
         return RHINativeHandle{};
     }
 
-    void RHIDevice::resetDescriptorAllocator()
+    RHIUploadRing* RHIDevice::getUploadRing()
+    {
+        WS_ASSERT(upload::ring);
+        return upload::ring.get();
+    }
+
+    RHIUploadQueue* RHIDevice::getUploadQueue()
     {
-        descriptor::allocator->resetAll();
+        WS_ASSERT(upload::queue);
+        return upload::queue.get();
+    }
+
+    void RHIDevice::beginDescriptorFrame(u32 const frameIndex, RHIUploadAllocation const& frameConstant)
+    {
+        WS_ASSERT(descriptor::globalSet && descriptor::specificSet);
+        descriptor::globalSet->beginFrame(frameIndex, frameConstant);
+        descriptor::specificSet->setFrameIndex(frameIndex);
     }
 
     RHINativeHandle RHIDevice::getGlobalDescriptorSetLayout()
@@ -656,14 +977,14 @@ namespace worse
         return descriptor::globalSet->getSet();
     }
 
-    void RHIDevice::writeGlobalDescriptorSet()
+    u32 RHIDevice::getGlobalDescriptorWriteCount()
     {
         WS_ASSERT(descriptor::globalSet);
-        descriptor::globalSet->writeStatic();
+        return descriptor::globalSet->getWriteCount();
     }
 
     void
-    RHIDevice::updateBindlessTextures(std::span<RHIDescriptorWrite> updates)
+    RHIDevice::updateBindlessTextures(std::span<RHIDescriptorWrite const> updates)
     {
         if (updates.empty())
         {
@@ -686,10 +1007,10 @@ namespace worse
         return descriptor::specificSet->getDescriptorSet(descriptorHash);
     }
 
-    void RHIDevice::resetSpecificDescriptorSets()
+    bool RHIDevice::cacheSpecificDescriptorWrite(RHINativeHandle set, u32 const binding, u32 const arrayElement, u64 const resource, u64 const offset, u64 const range)
     {
         WS_ASSERT(descriptor::specificSet);
-        descriptor::specificSet->resetSets();
+        return descriptor::specificSet->cacheWrite(set, binding, arrayElement, resource, offset, range);
     }
 
     RHINativeHandle RHIDevice::createImGuiPool(u32 descriptorCount, u32 maxSets)
@@ -727,6 +1048,17 @@ namespace worse
         return pipeline::pipelinePool->getPipeline(pso);
     }
 
+    u32 RHIDevice::evictPipelines(std::filesystem::path const& shaderPath)
+    {
+        WS_ASSERT(pipeline::pipelinePool);
+        return pipeline::pipelinePool->evict(shaderPath);
+    }
+
+    RHINativeHandle RHIDevice::getPipelineCache()
+    {
+        return RHINativeHandle{pipeline::cache, RHINativeHandleType::PipelineCache};
+    }
+
     void RHIDevice::memoryTextureCreate(RHITexture* texture)
     {
         VkImageUsageFlags vkUsage = 0;
@@ -745,13 +1077,21 @@ namespace worse
         infoImage.extent.width  = texture->getWidth();
         infoImage.extent.height = texture->getHeight();
         infoImage.extent.depth  = texture->getType() == RHITextureType::Texture3D ? texture->getDepth() : 1;
-        infoImage.mipLevels     = 1;
+        infoImage.mipLevels     = texture->getMipCount();
         infoImage.arrayLayers   = texture->getType() == RHITextureType::Texture3D ? 1 : texture->getDepth();
         infoImage.samples       = VK_SAMPLE_COUNT_1_BIT;
         infoImage.tiling        = VK_IMAGE_TILING_OPTIMAL;
         infoImage.usage         = vkUsage;
         infoImage.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
         infoImage.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        std::vector<u32> families = queues::getSharingFamilies();
+        if ((usage & RHITextureViewFlagBits::CrossQueue) && (families.size() > 1))
+        {
+            infoImage.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+            infoImage.queueFamilyIndexCount = static_cast<u32>(families.size());
+            infoImage.pQueueFamilyIndices   = families.data();
+        }
         // clang-format on
 
         VmaAllocationInfo infoAlloc = {};
@@ -779,7 +1119,7 @@ namespace worse
         vmaSetAllocationName(vma::allocator, allocation, texture->getName().c_str());
         RHIDevice::setResourceName(texture->getImage(), texture->getName());
 
-        vma::saveAllocation(allocation, texture->getImage());
+        vma::saveAllocation(allocation, texture->getImage(), vma::getTextureCategory(usage), infoAlloc.size);
     }
 
     void RHIDevice::memoryTextureDestroy(RHINativeHandle handle)
@@ -795,7 +1135,7 @@ namespace worse
         }
     }
 
-    RHINativeHandle RHIDevice::memoryBufferCreate(u32 size, u32 bufferUsage, u32 memoryProperty, void const* data, std::string_view name)
+    RHINativeHandle RHIDevice::memoryBufferCreate(u32 size, u32 bufferUsage, u32 memoryProperty, void const* data, std::string_view name, bool const crossQueue)
     {
         // clang-format off
         VkBufferCreateInfo infoBuffer = {};
@@ -804,6 +1144,14 @@ namespace worse
         infoBuffer.usage       = bufferUsage;
         infoBuffer.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+        std::vector<u32> families = queues::getSharingFamilies();
+        if (crossQueue && (families.size() > 1))
+        {
+            infoBuffer.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+            infoBuffer.queueFamilyIndexCount = static_cast<u32>(families.size());
+            infoBuffer.pQueueFamilyIndices   = families.data();
+        }
+
         VmaAllocationCreateInfo infoAllocCreate = {};
         infoAllocCreate.usage         = VMA_MEMORY_USAGE_AUTO;
         infoAllocCreate.requiredFlags = memoryProperty;
@@ -843,7 +1191,7 @@ namespace worse
             vmaUnmapMemory(vma::allocator, allocation);
         }
 
-        vma::saveAllocation(allocation, buffer);
+        vma::saveAllocation(allocation, buffer, vma::getBufferCategory(bufferUsage), infoAlloc.size);
 
         return buffer;
         // clang-format on
@@ -874,6 +1222,146 @@ namespace worse
         return nullptr;
     }
 
+    u64 RHIDevice::memoryGetAllocationSize(RHINativeHandle handle)
+    {
+        vma::AllocationData* data = vma::getAllocation(handle);
+        return data ? data->size : 0;
+    }
+
+    RHIMemoryStatistics RHIDevice::memoryGetStatistics()
+    {
+        RHIMemoryStatistics statistics = {};
+
+        VkPhysicalDeviceMemoryProperties const* properties = nullptr;
+        vmaGetMemoryProperties(vma::allocator, &properties);
+
+        VmaBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+        VmaTotalStatistics total               = {};
+        {
+            std::lock_guard guard{vma::mtxAllocator};
+            vmaGetHeapBudgets(vma::allocator, budgets);
+            vmaCalculateStatistics(vma::allocator, &total);
+        }
+
+        statistics.heaps.resize(properties->memoryHeapCount);
+        for (u32 i = 0; i < properties->memoryHeapCount; ++i)
+        {
+            RHIMemoryHeapBudget& heap = statistics.heaps[i];
+            heap.usage                = budgets[i].usage;
+            heap.budget               = budgets[i].budget;
+            heap.blockBytes           = budgets[i].statistics.blockBytes;
+            heap.allocationBytes      = budgets[i].statistics.allocationBytes;
+            heap.isDeviceLocal        = properties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+        }
+
+        statistics.blockBytes      = total.total.statistics.blockBytes;
+        statistics.allocationBytes = total.total.statistics.allocationBytes;
+        statistics.blockCount      = total.total.statistics.blockCount;
+        statistics.allocationCount = total.total.statistics.allocationCount;
+
+        {
+            std::lock_guard lock{vma::mtxAllocation};
+            for (auto const& [key, data] : vma::allocations)
+            {
+                statistics.categoryBytes[data.category] += data.size;
+                statistics.categoryCount[data.category] += 1;
+            }
+        }
+
+        return statistics;
+    }
+
+    bool RHIDevice::memoryDumpStatistics(std::filesystem::path const& path)
+    {
+        RHIMemoryStatistics const statistics = RHIDevice::memoryGetStatistics();
+
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+
+        std::ofstream stream(path, std::ios::trunc);
+        if (!stream.is_open())
+        {
+            WS_LOG_ERROR("VMA", "Failed to write memory statistics {}", path.string());
+            return false;
+        }
+
+        stream << "{\n";
+        stream << std::format("  \"blockBytes\": {},\n  \"allocationBytes\": {},\n", statistics.blockBytes, statistics.allocationBytes);
+        stream << std::format("  \"blockCount\": {},\n  \"allocationCount\": {},\n", statistics.blockCount, statistics.allocationCount);
+
+        stream << "  \"heaps\": [\n";
+        for (usize i = 0; i < statistics.heaps.size(); ++i)
+        {
+            RHIMemoryHeapBudget const& heap = statistics.heaps[i];
+            stream << std::format("    {{\"deviceLocal\": {}, \"usage\": {}, \"budget\": {}, \"blockBytes\": {}, \"allocationBytes\": {}}}{}\n",
+                                  heap.isDeviceLocal,
+                                  heap.usage,
+                                  heap.budget,
+                                  heap.blockBytes,
+                                  heap.allocationBytes,
+                                  (i + 1 < statistics.heaps.size()) ? "," : "");
+        }
+        stream << "  ],\n";
+
+        stream << "  \"categories\": {\n";
+        for (usize i = 0; i < static_cast<usize>(RHIMemoryCategory::Max); ++i)
+        {
+            RHIMemoryCategory const category = static_cast<RHIMemoryCategory>(i);
+            stream << std::format("    \"{}\": {{\"bytes\": {}, \"count\": {}}}{}\n",
+                                  rhiMemoryCategoryToString(category),
+                                  statistics.categoryBytes[category],
+                                  statistics.categoryCount[category],
+                                  (i + 1 < static_cast<usize>(RHIMemoryCategory::Max)) ? "," : "");
+        }
+        stream << "  },\n";
+
+        // named allocations, largest first
+        struct Entry
+        {
+            std::string name;
+            RHIMemoryCategory category;
+            u64 size;
+        };
+        std::vector<Entry> entries;
+        {
+            std::lock_guard lock{vma::mtxAllocation};
+            entries.reserve(vma::allocations.size());
+            for (auto const& [key, data] : vma::allocations)
+            {
+                VmaAllocationInfo info = {};
+                vmaGetAllocationInfo(vma::allocator, data.allocation, &info);
+                entries.push_back(Entry{info.pName ? info.pName : "", data.category, data.size});
+            }
+        }
+        std::sort(entries.begin(), entries.end(), [](Entry const& a, Entry const& b) { return a.size > b.size; });
+
+        stream << "  \"allocations\": [\n";
+        for (usize i = 0; i < entries.size(); ++i)
+        {
+            stream << "    {\"name\": ";
+            vma::writeJsonString(stream, entries[i].name);
+            stream << std::format(", \"category\": \"{}\", \"size\": {}}}{}\n",
+                                  rhiMemoryCategoryToString(entries[i].category),
+                                  entries[i].size,
+                                  (i + 1 < entries.size()) ? "," : "");
+        }
+        stream << "  ],\n";
+
+        // detailed block map from VMA, already JSON
+        char* vmaReport = nullptr;
+        {
+            std::lock_guard guard{vma::mtxAllocator};
+            vmaBuildStatsString(vma::allocator, &vmaReport, VK_TRUE);
+        }
+        stream << "  \"vma\": " << (vmaReport ? vmaReport : "null") << "\n";
+        vmaFreeStatsString(vma::allocator, vmaReport);
+
+        stream << "}\n";
+
+        WS_LOG_INFO("VMA", "Memory statistics written to {}", path.string());
+        return true;
+    }
+
     void RHIDevice::deletionQueueAdd(RHINativeHandle const& resource)
     {
         if (!resource)
@@ -881,44 +1369,87 @@ namespace worse
             return;
         }
 
-        std::lock_guard guard{mtxDeletionQueue};
-        deletionQueue[resource.getType()].emplace_back(resource);
+        DeletionNode* node = new DeletionNode{resource, deletionPending.load(std::memory_order_relaxed)};
+        while (!deletionPending.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
     }
 
-    void RHIDevice::deletionQueueFlush()
+    void RHIDevice::deletionQueueEndFrame()
+    {
+        std::vector<RHINativeHandle> handles = takeDeletionPending();
+        if (handles.empty())
+        {
+            return;
+        }
+
+        DeletionFrame& frame = deletionFrames.emplace_back();
+        frame.handles        = std::move(handles);
+        for (usize i = 0; i < static_cast<usize>(RHIQueueType::Max); ++i)
+        {
+            RHIQueueType const type = static_cast<RHIQueueType>(i);
+            frame.values[type]      = queues::regular[type]->getTimelineValue();
+        }
+        // copies recorded but not yet flushed may still read the resources
+        if (upload::queue)
+        {
+            frame.values[RHIQueueType::Transfer] = std::max(frame.values[RHIQueueType::Transfer], upload::queue->getPendingToken().value);
+        }
+    }
+
+    void RHIDevice::deletionQueueCollect()
     {
-        std::lock_guard guard{mtxDeletionQueue};
+        if (deletionFrames.empty())
+        {
+            return;
+        }
 
-        for (auto& [type, handles] : deletionQueue)
+        EnumArray<RHIQueueType, u64> completed = {};
+        for (usize i = 0; i < static_cast<usize>(RHIQueueType::Max); ++i)
         {
-            for (auto& handle : handles)
+            RHIQueueType const type = static_cast<RHIQueueType>(i);
+            completed[type]         = queues::regular[type]->getCompletedValue();
+        }
+
+        while (!deletionFrames.empty())
+        {
+            DeletionFrame& frame = deletionFrames.front();
+
+            bool isRetired = true;
+            for (usize i = 0; i < static_cast<usize>(RHIQueueType::Max); ++i)
             {
-                // clang-format off
-                switch (type)
-                {
-                case RHINativeHandleType::Fence:               vkDestroyFence(RHIContext::device, handle.asValue<VkFence>(), nullptr);                             break;
-                case RHINativeHandleType::Semaphore:           vkDestroySemaphore(RHIContext::device, handle.asValue<VkSemaphore>(), nullptr);                     break;
-                case RHINativeHandleType::Shader:              vkDestroyShaderModule(RHIContext::device, handle.asValue<VkShaderModule>(), nullptr);               break;
-                case RHINativeHandleType::Pipeline:            vkDestroyPipeline(RHIContext::device, handle.asValue<VkPipeline>(), nullptr);                       break;
-                case RHINativeHandleType::PipelineLayout:      vkDestroyPipelineLayout(RHIContext::device, handle.asValue<VkPipelineLayout>(), nullptr);           break;
-                case RHINativeHandleType::Image:               RHIDevice::memoryTextureDestroy(handle);                                                            break;
-                case RHINativeHandleType::ImageView:           vkDestroyImageView(RHIContext::device, handle.asValue<VkImageView>(), nullptr);                     break;
-                case RHINativeHandleType::Sampler:             vkDestroySampler(RHIContext::device, handle.asValue<VkSampler>(), nullptr);                         break;
-                case RHINativeHandleType::Buffer:              RHIDevice::memoryBufferDestroy(handle);                                                             break;
-                case RHINativeHandleType::DescriptorPool:      vkDestroyDescriptorPool(RHIContext::device, handle.asValue<VkDescriptorPool>(), nullptr);           break;
-                case RHINativeHandleType::DescriptorSetLayout: vkDestroyDescriptorSetLayout(RHIContext::device, handle.asValue<VkDescriptorSetLayout>(), nullptr); break;
-                default:
-                    WS_LOG_ERROR("RHI", "Unhandled handle type");
-                    WS_ASSERT(false);
-                }
-                // clang-format on
+                RHIQueueType const type = static_cast<RHIQueueType>(i);
+                isRetired               = isRetired && (frame.values[type] <= completed[type]);
+            }
+            // frames retire in order
+            if (!isRetired)
+            {
+                break;
+            }
 
-                handle = {};
+            for (RHINativeHandle handle : frame.handles)
+            {
+                destroyResource(handle);
             }
+            deletionFrames.pop_front();
         }
+    }
 
-        // Clear the deletion queue after processing
-        deletionQueue.clear();
+    void RHIDevice::deletionQueueFlush()
+    {
+        for (DeletionFrame& frame : deletionFrames)
+        {
+            for (RHINativeHandle handle : frame.handles)
+            {
+                destroyResource(handle);
+            }
+        }
+        deletionFrames.clear();
+
+        for (RHINativeHandle handle : takeDeletionPending())
+        {
+            destroyResource(handle);
+        }
     }
 
     RHICommandList* RHIDevice::cmdImmediateBegin(RHIQueueType const type)
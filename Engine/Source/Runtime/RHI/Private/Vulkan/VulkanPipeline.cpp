@@ -1,7 +1,6 @@
 #include "RHIDevice.hpp"
 #include "RHIShader.hpp"
 #include "RHIVertex.hpp"
-#include "RHITexture.hpp"
 #include "Pipeline/RHIPipeline.hpp"
 #include "Pipeline/RHIBlendState.hpp"
 #include "Pipeline/RHIRasterizerState.hpp"
@@ -101,7 +100,7 @@ namespace worse
             infoComputePipeline.stage  = shaderStages[0];
 
             VkPipeline pipeline = VK_NULL_HANDLE;
-            WS_ASSERT_VK(vkCreateComputePipelines(RHIContext::device, VK_NULL_HANDLE, 1, &infoComputePipeline, nullptr, &pipeline));
+            WS_ASSERT_VK(vkCreateComputePipelines(RHIContext::device, RHIDevice::getPipelineCache().asValue<VkPipelineCache>(), 1, &infoComputePipeline, nullptr, &pipeline));
             m_pipeline = RHINativeHandle{pipeline, RHINativeHandleType::Pipeline};
             RHIDevice::setResourceName(m_pipeline, pipelineState.name);
         }
@@ -111,22 +110,22 @@ namespace worse
             VkFormat depthFormat = VK_FORMAT_UNDEFINED;
             VkFormat stencilFormat = VK_FORMAT_UNDEFINED;
 
-            for (RHITexture* texture : m_state.renderTargetColorTextures)
+            // only formats matter, the pipeline can be created without textures
+            for (RHIFormat const format : m_state.renderTargetColorFormats)
             {
-                // render target are set in order, so stop once hit a null texture
-                if (!texture)
+                // render target are set in order, so stop once hit an unused slot
+                if (format == RHIFormat::Max)
                 {
                     break;
                 }
 
-                attachmentColorFormats.push_back(vulkanFormat(texture->getFormat()));
+                attachmentColorFormats.push_back(vulkanFormat(format));
             }
 
-            if (m_state.renderTargetDepthTexture)
+            if (m_state.renderTargetDepthFormat != RHIFormat::Max)
             {
-                RHITexture* depthTexture = m_state.renderTargetDepthTexture;
-                depthFormat = vulkanFormat(depthTexture->getFormat());
-                stencilFormat = depthTexture->isFormatStencil() ? depthFormat : VK_FORMAT_UNDEFINED;
+                depthFormat = vulkanFormat(m_state.renderTargetDepthFormat);
+                stencilFormat = (m_state.renderTargetDepthFormat == RHIFormat::D32FloatS8X24Uint) ? depthFormat : VK_FORMAT_UNDEFINED;
             }
 
             VkPipelineRenderingCreateInfo infoRendering = {};
@@ -237,16 +236,7 @@ namespace worse
                 colorBlendAttachment.dstAlphaBlendFactor = vulkanBlendFactor(m_state.blendState->getDstAlphaBlend());
                 colorBlendAttachment.alphaBlendOp        = vulkanBlendOp(m_state.blendState->getAlphaBlendOp());
 
-                for (RHITexture* texture : m_state.renderTargetColorTextures)
-                {
-                    // render target are set in order, so stop once hit a null texture
-                    if (!texture)
-                    {
-                        break;
-                    }
-
-                    colorBlendAttachments.push_back(colorBlendAttachment);
-                }
+                colorBlendAttachments.resize(attachmentColorFormats.size(), colorBlendAttachment);
             }
             VkPipelineColorBlendStateCreateInfo colorBlendState = {};
             colorBlendState.sType             = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
@@ -288,7 +278,7 @@ namespace worse
             // clang-format on
 
             VkPipeline pipeline = VK_NULL_HANDLE;
-            WS_ASSERT_VK(vkCreateGraphicsPipelines(RHIContext::device, VK_NULL_HANDLE, 1, &infoGraphicsPipeline, nullptr, &pipeline));
+            WS_ASSERT_VK(vkCreateGraphicsPipelines(RHIContext::device, RHIDevice::getPipelineCache().asValue<VkPipelineCache>(), 1, &infoGraphicsPipeline, nullptr, &pipeline));
             m_pipeline = RHINativeHandle{pipeline, RHINativeHandleType::Pipeline};
             RHIDevice::setResourceName(m_pipeline, pipelineState.name);
         }
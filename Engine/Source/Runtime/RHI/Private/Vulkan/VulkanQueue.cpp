@@ -3,6 +3,7 @@
 #include "RHIDevice.hpp"
 
 #include <mutex>
+#include <vector>
 
 namespace worse
 {
@@ -11,8 +12,20 @@ namespace worse
     {
         EnumArray<RHIQueueType, std::mutex> mtxes;
 
-        std::mutex const& getMutex(RHIQueueType const type)
+        // types without a family of their own fall back to the graphics
+        // VkQueue, access to a VkQueue is externally synchronized so they
+        // share its mutex
+        std::mutex& getMutex(RHIQueueType const type)
         {
+            VkQueue queue = RHIDevice::getQueueHandle(type).asValue<VkQueue>();
+            for (u32 i = 0; i < static_cast<u32>(RHIQueueType::Max); ++i)
+            {
+                RHIQueueType const other = static_cast<RHIQueueType>(i);
+                if (RHIDevice::getQueueHandle(other).asValue<VkQueue>() == queue)
+                {
+                    return mtxes[other];
+                }
+            }
             return mtxes[type];
         }
     } // namespace
@@ -37,6 +50,8 @@ namespace worse
             RHIDevice::setResourceName(m_handle, name);
         }
 
+        m_timeline = std::make_shared<RHISyncPrimitive>(RHISyncPrimitiveType::TimelineSemaphore, std::format("{}_timeline", name));
+
         // command lists
         {
             for (u32 i = 0; i < static_cast<u32>(m_cmdLists.size()); ++i)
@@ -56,34 +71,79 @@ namespace worse
         {
             cmdList.reset();
         }
+        m_timeline.reset();
 
         vkDestroyCommandPool(RHIContext::device, m_handle.asValue<VkCommandPool>(), nullptr);
     }
 
     void RHIQueue::wait()
     {
-        // TODO: lock
+        std::lock_guard<std::mutex> lock(getMutex(m_type));
 
         WS_ASSERT_VK(vkQueueWaitIdle(RHIDevice::getQueueHandle(m_type).asValue<VkQueue>()));
     }
 
-    void RHIQueue::submit(void* cmdBuffer, u32 const waitFlags,
+    u64 RHIQueue::getCompletedValue() const
+    {
+        u64 value = 0;
+        WS_ASSERT_VK(vkGetSemaphoreCounterValue(RHIContext::device, m_timeline->getHandle().asValue<VkSemaphore>(), &value));
+        return value;
+    }
+
+    void RHIQueue::waitTimeline(u64 const value)
+    {
+        if (value == 0)
+        {
+            return;
+        }
+
+        u64 const timeoutNs = 60'000'000'000; // 60s
+
+        // clang-format off
+        VkSemaphore semaphore        = m_timeline->getHandle().asValue<VkSemaphore>();
+        VkSemaphoreWaitInfo infoWait = {};
+        infoWait.sType               = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        infoWait.semaphoreCount      = 1;
+        infoWait.pSemaphores         = &semaphore;
+        infoWait.pValues             = &value;
+        // clang-format on
+
+        WS_ASSERT_VK(vkWaitSemaphores(RHIContext::device, &infoWait, timeoutNs));
+    }
+
+    void RHIQueue::submit(void* cmdBuffer, RHIPipelineStageFlags const semaphoreWaitStage,
                           RHISyncPrimitive* semaphoreWait,
                           RHISyncPrimitive* semaphoreSignal,
-                          RHISyncPrimitive* semaphoreTimeline)
+                          RHISyncPrimitive* semaphoreTimeline,
+                          std::span<RHIQueueWait const> queueWaits)
     {
-        // TODO: lock
+        // upload batches are submitted from worker threads
+        std::lock_guard<std::mutex> lock(getMutex(m_type));
 
         // clang-format off
-        VkSemaphoreSubmitInfo semaphoresWait[1] = {};
+        std::vector<VkSemaphoreSubmitInfo> semaphoresWait;
+        semaphoresWait.reserve(1 + queueWaits.size());
+        if (semaphoreWait)
         {
-            semaphoresWait[0].sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
-            semaphoresWait[0].semaphore = semaphoreWait ? semaphoreWait->getHandle().asValue<VkSemaphore>() : nullptr;
-            semaphoresWait[0].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
-            semaphoresWait[0].value     = 0;
+            VkSemaphoreSubmitInfo& info = semaphoresWait.emplace_back();
+            info.sType                  = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+            info.semaphore              = semaphoreWait->getHandle().asValue<VkSemaphore>();
+            info.stageMask              = static_cast<VkPipelineStageFlags2>(semaphoreWaitStage);
+            info.value                  = 0;
         }
 
-        VkSemaphoreSubmitInfo semaphoresSignal[2] = {};
+        // cross queue dependencies
+        for (RHIQueueWait const& queueWait : queueWaits)
+        {
+            WS_ASSERT(queueWait.queue && (queueWait.queue != this));
+            VkSemaphoreSubmitInfo& info = semaphoresWait.emplace_back();
+            info.sType                  = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+            info.semaphore              = queueWait.queue->getTimeline()->getHandle().asValue<VkSemaphore>();
+            info.stageMask              = static_cast<VkPipelineStageFlags2>(queueWait.stage);
+            info.value                  = queueWait.value;
+        }
+
+        VkSemaphoreSubmitInfo semaphoresSignal[3] = {};
         {
             // binary
             semaphoresSignal[0].sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
@@ -96,6 +156,12 @@ namespace worse
             semaphoresSignal[1].semaphore = semaphoreTimeline->getHandle().asValue<VkSemaphore>();
             semaphoresSignal[1].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
             semaphoresSignal[1].value     = semaphoreTimeline->getNextSignalValue();
+
+            // queue timeline
+            semaphoresSignal[2].sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+            semaphoresSignal[2].semaphore = m_timeline->getHandle().asValue<VkSemaphore>();
+            semaphoresSignal[2].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            semaphoresSignal[2].value     = m_timeline->getNextSignalValue();
         }
         // clang-format on
 
@@ -105,19 +171,20 @@ namespace worse
 
         VkSubmitInfo2 infoSubmit            = {};
         infoSubmit.sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
-        infoSubmit.waitSemaphoreInfoCount   = semaphoreWait ? 1 : 0;
-        infoSubmit.pWaitSemaphoreInfos      = semaphoresWait;
-        infoSubmit.signalSemaphoreInfoCount = 2;
+        infoSubmit.waitSemaphoreInfoCount   = static_cast<u32>(semaphoresWait.size());
+        infoSubmit.pWaitSemaphoreInfos      = semaphoresWait.data();
+        infoSubmit.signalSemaphoreInfoCount = 3;
         infoSubmit.pSignalSemaphoreInfos    = semaphoresSignal;
         infoSubmit.commandBufferInfoCount   = 1;
         infoSubmit.pCommandBufferInfos      = &infoCmdBuffer;
 
         WS_ASSERT_VK(vkQueueSubmit2KHR(RHIDevice::getQueueHandle(m_type).asValue<VkQueue>(), 1, &infoSubmit, nullptr));
+        m_timelineValue = semaphoresSignal[2].value;
     }
 
     void RHIQueue::present(RHINativeHandle swapchain, u32 const imageIndex, RHISyncPrimitive* semaphoreWait)
     {
-        // TODO: lock
+        std::lock_guard<std::mutex> lock(getMutex(m_type));
 
         VkSemaphore semaphoresWait[1] = {};
         semaphoresWait[0]             = semaphoreWait->getHandle().asValue<VkSemaphore>();
@@ -1,6 +1,7 @@
 #include "DXCompiler.hpp"
 #include "RHIDevice.hpp"
 #include "RHIShader.hpp"
+#include "RHIShaderCache.hpp"
 
 #include "spirv_reflect.h"
 
@@ -143,28 +144,45 @@ namespace worse
 
         RHINativeHandle shader = {};
 
-        CComPtr<IDxcBlob> codeBlob = DXCompiler::instance()->compile(m_source, wArguments);
+        // try the disk cache before invoking dxc
+        u64 const cacheKey = RHIShaderCache::computeKey(m_source, getEntryPoint(), m_shaderType, wArguments, DXCompiler::instance()->getVersion());
 
-        if (!codeBlob)
+        RHIShaderCacheEntry cacheEntry = {};
+        m_fromCache                    = RHIShaderCache::load(cacheKey, cacheEntry);
+        if (m_fromCache)
         {
-            WS_LOG_ERROR("Shader", "Compilation failed: {}", m_name);
-            return shader;
+            m_descriptors = std::move(cacheEntry.descriptors);
+        }
+        else
+        {
+            CComPtr<IDxcBlob> codeBlob = DXCompiler::instance()->compile(m_source, wArguments);
+
+            if (!codeBlob)
+            {
+                WS_LOG_ERROR("Shader", "Compilation failed: {}", m_name);
+                return shader;
+            }
+
+            u32 const* code = static_cast<u32 const*>(codeBlob->GetBufferPointer());
+            cacheEntry.spirv.assign(code, code + codeBlob->GetBufferSize() / sizeof(u32));
+            codeBlob.Release();
+
+            reflect(m_shaderType, cacheEntry.spirv.data(), cacheEntry.spirv.size());
+
+            cacheEntry.descriptors = m_descriptors;
+            RHIShaderCache::store(cacheKey, cacheEntry);
         }
 
         VkShaderModuleCreateInfo infoShader = {};
         infoShader.sType                    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        infoShader.pCode                    = static_cast<u32*>(codeBlob->GetBufferPointer());
-        infoShader.codeSize                 = codeBlob->GetBufferSize();
+        infoShader.pCode                    = cacheEntry.spirv.data();
+        infoShader.codeSize                 = cacheEntry.spirv.size() * sizeof(u32);
 
         VkShaderModule vkShader = VK_NULL_HANDLE;
         WS_ASSERT_VK(vkCreateShaderModule(RHIContext::device, &infoShader, nullptr, &vkShader));
         shader = RHINativeHandle{vkShader, RHINativeHandleType::Shader};
         RHIDevice::setResourceName(shader, m_name);
 
-        reflect(m_shaderType, static_cast<u32*>(codeBlob->GetBufferPointer()), codeBlob->GetBufferSize() / sizeof(u32));
-
-        codeBlob.Release();
-
         return shader;
     }
 
@@ -1,62 +1,12 @@
 #include "RHIDevice.hpp"
 #include "RHICommandList.hpp"
 #include "RHITexture.hpp"
+#include "RHIUploadQueue.hpp"
 
 namespace worse
 {
     namespace
     {
-        void uploadTexture(RHITexture& texture)
-        {
-            // clang-format off
-            usize size = texture.getMip(0, 0).bytes.size();
-
-            RHINativeHandle stagingBuffer = RHIDevice::memoryBufferCreate(
-                static_cast<u32>(size),
-                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                texture.getMip(0, 0).bytes.data(),
-                "texture_staging_buffer");
-            WS_ASSERT(stagingBuffer);
-
-            if (RHICommandList* cmdList =
-                    RHIDevice::cmdImmediateBegin(RHIQueueType::Graphics))
-            {
-                cmdList->insertBarrier(texture.getImage(),
-                                       texture.getFormat(),
-                                       RHIImageLayout::TransferDestination);
-
-                VkBufferImageCopy2 copyRegion = {};
-                copyRegion.sType                           = VK_STRUCTURE_TYPE_BUFFER_IMAGE_COPY_2;
-                copyRegion.bufferOffset                    = 0;
-                copyRegion.bufferRowLength                 = 0;
-                copyRegion.bufferImageHeight               = 0;
-                copyRegion.imageSubresource.aspectMask     = vulkanImageAspectFlags(texture.getFormat());
-                copyRegion.imageSubresource.baseArrayLayer = 0;
-                copyRegion.imageSubresource.layerCount     = 1;
-                copyRegion.imageSubresource.mipLevel       = 0;
-                copyRegion.imageOffset                     = {0, 0, 0};
-                copyRegion.imageExtent                     = {texture.getWidth(),
-                                                              texture.getHeight(),
-                                                              texture.getDepth()};
-
-                VkCopyBufferToImageInfo2 infoCopy = {};
-                infoCopy.sType = VK_STRUCTURE_TYPE_COPY_BUFFER_TO_IMAGE_INFO_2;
-                infoCopy.srcBuffer      = stagingBuffer.asValue<VkBuffer>();
-                infoCopy.dstImage       = texture.getImage().asValue<VkImage>();
-                infoCopy.dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-                infoCopy.regionCount    = 1;
-                infoCopy.pRegions       = &copyRegion;
-
-                vkCmdCopyBufferToImage2KHR(cmdList->getHandle().asValue<VkCommandBuffer>(), &infoCopy);
-
-                RHIDevice::cmdImmediateSubmit(cmdList);
-
-                RHIDevice::memoryBufferDestroy(stagingBuffer);
-            }
-            // clang-format on
-        }
-
         void createImageView(RHINativeHandle image, RHINativeHandle& imageView,
                              RHITexture* texture)
         {
@@ -71,7 +21,7 @@ namespace worse
             infoImageView.subresourceRange.aspectMask =
                 vulkanImageAspectFlags(texture->getFormat());
             infoImageView.subresourceRange.baseMipLevel = 0;
-            infoImageView.subresourceRange.levelCount   = 1;
+            infoImageView.subresourceRange.levelCount   = texture->getMipCount();
 
             if (texture->getType() == RHITextureType::TextureCube)
             {
@@ -93,6 +43,13 @@ namespace worse
             infoImageView.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
             infoImageView.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
             infoImageView.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+            if (texture->getFormat() == RHIFormat::BC4Unorm)
+            {
+                // grey sources cook to one channel, sample them as grey again
+                infoImageView.components.g = VK_COMPONENT_SWIZZLE_R;
+                infoImageView.components.b = VK_COMPONENT_SWIZZLE_R;
+                infoImageView.components.a = VK_COMPONENT_SWIZZLE_ONE;
+            }
 
             VkImageView vkImageView = VK_NULL_HANDLE;
             WS_ASSERT_VK(vkCreateImageView(RHIContext::device,
@@ -105,16 +62,11 @@ namespace worse
         }
     } // namespace
 
-    bool RHITexture::nativeCreate()
+    bool RHITexture::nativeCreate(TextureLoadView const* view)
     {
         // allocate memory
         RHIDevice::memoryTextureCreate(this);
 
-        if (hasShaderReadData())
-        {
-            uploadTexture(*this);
-        }
-
         // transition layout
         {
             RHIImageLayout layout = RHIImageLayout::Max;
@@ -131,10 +83,23 @@ namespace worse
                 layout = RHIImageLayout::ShaderRead;
             }
 
-            if (RHICommandList* cmdList =
-                    RHIDevice::cmdImmediateBegin(RHIQueueType::Graphics))
+            if (view)
+            {
+                RHIDevice::getUploadQueue()->uploadTexture(this, *view, layout);
+            }
+            else if (hasShaderReadData())
+            {
+                // copy and transition are batched on the transfer queue
+                RHIDevice::getUploadQueue()->uploadTexture(this, layout);
+                if (!(m_usage & RHITextureViewFlagBits::KeepData))
+                {
+                    // the staging ring holds its own copy now
+                    m_slices = {};
+                }
+            }
+            else if (RHICommandList* cmdList =
+                         RHIDevice::cmdImmediateBegin(RHIQueueType::Graphics))
             {
-
                 cmdList->insertBarrier(m_image, m_format, layout, RHIPipelineStageFlagBits::TopOfPipe, RHIAccessFlagBits::MemoryRead, RHIPipelineStageFlagBits::AllCommands, RHIAccessFlagBits::MemoryWrite);
 
                 RHIDevice::cmdImmediateSubmit(cmdList);
@@ -0,0 +1,414 @@
+#include "Log.hpp"
+#include "RHIDevice.hpp"
+#include "RHIQueue.hpp"
+#include "RHITexture.hpp"
+#include "RHICommandList.hpp"
+#include "RHIUploadQueue.hpp"
+#include "TextureImporter.hpp"
+
+#include <limits>
+#include <cstring>
+#include <algorithm>
+
+namespace worse
+{
+
+    namespace
+    {
+        // satisfies buffer copy and texel block alignment of every format
+        constexpr u32 STAGING_ALIGNMENT = 16;
+    } // namespace
+
+    RHIUploadQueue::RHIUploadQueue(u32 const stagingSize, std::string_view name)
+    {
+        m_queue = RHIDevice::getQueue(RHIQueueType::Transfer);
+        WS_ASSERT(m_queue);
+
+        m_ownershipTransfer = RHIDevice::getQueueIndex(RHIQueueType::Transfer) != RHIDevice::getQueueIndex(RHIQueueType::Graphics);
+
+        m_capacity = stagingSize;
+        m_staging  = RHIDevice::memoryBufferCreate(
+            stagingSize,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            nullptr,
+            name);
+        WS_ASSERT_MSG(m_staging, "Failed to create staging buffer");
+
+        m_mappedData = static_cast<byte*>(RHIDevice::memoryGetMappedBufferData(m_staging));
+        WS_ASSERT_MSG(m_mappedData, "Staging buffer is not mapped");
+    }
+
+    RHIUploadQueue::~RHIUploadQueue()
+    {
+        // the device waited every queue, nothing is in flight
+        for (Batch& batch : m_inFlight)
+        {
+            for (RHINativeHandle buffer : batch.dedicated)
+            {
+                RHIDevice::memoryBufferDestroy(buffer);
+            }
+        }
+        m_inFlight.clear();
+
+        for (RHINativeHandle buffer : m_recording.dedicated)
+        {
+            RHIDevice::memoryBufferDestroy(buffer);
+        }
+        m_recording = {};
+
+        RHIDevice::memoryBufferDestroy(m_staging);
+        m_staging    = {};
+        m_mappedData = nullptr;
+    }
+
+    RHIUploadToken RHIUploadQueue::uploadBuffer(RHINativeHandle buffer, void const* data, u32 const size, u32 const offset)
+    {
+        WS_ASSERT(buffer && data && (size > 0));
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        u64 srcOffset          = 0;
+        RHINativeHandle source = stage(data, size, STAGING_ALIGNMENT, srcOffset);
+        beginBatch();
+
+        VkBufferCopy2 copyRegion = {};
+        copyRegion.sType         = VK_STRUCTURE_TYPE_BUFFER_COPY_2;
+        copyRegion.srcOffset     = srcOffset;
+        copyRegion.dstOffset     = offset;
+        copyRegion.size          = size;
+
+        VkCopyBufferInfo2 infoCopy = {};
+        infoCopy.sType             = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2;
+        infoCopy.srcBuffer         = source.asValue<VkBuffer>();
+        infoCopy.dstBuffer         = buffer.asValue<VkBuffer>();
+        infoCopy.regionCount       = 1;
+        infoCopy.pRegions          = &copyRegion;
+
+        vkCmdCopyBuffer2KHR(m_cmdList->getHandle().asValue<VkCommandBuffer>(), &infoCopy);
+
+        RHIOwnershipTransfer transfer = {};
+        transfer.resource             = buffer;
+        transfer.offset               = offset;
+        transfer.size                 = size;
+        recordRelease(transfer);
+
+        m_uploadedBytes += size;
+        return recordingToken();
+    }
+
+    RHIUploadToken RHIUploadQueue::uploadTexture(RHITexture* texture, RHIImageLayout const layout)
+    {
+        WS_ASSERT(texture && texture->hasShaderReadData());
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // staging a level may submit the batch when the ring is full, the
+        // batch that continues the upload transitions the image again
+        u32 barrierBatch = std::numeric_limits<u32>::max();
+        u64 size         = 0;
+        for (u32 i = 0; i < texture->getMipCount(); ++i)
+        {
+            RHITextureMip const& mip = texture->getMip(0, i);
+            if (mip.bytes.empty())
+            {
+                continue;
+            }
+
+            u32 const mipSize      = static_cast<u32>(mip.bytes.size());
+            u64 srcOffset          = 0;
+            RHINativeHandle source = stage(mip.bytes.data(), mipSize, STAGING_ALIGNMENT, srcOffset);
+            recordMipCopy(texture, source, srcOffset, i, barrierBatch);
+
+            size += mipSize;
+        }
+        recordTextureEnd(texture, layout);
+
+        m_uploadedBytes += size;
+        return recordingToken();
+    }
+
+    RHIUploadToken RHIUploadQueue::uploadTexture(RHITexture* texture, TextureLoadView const& view, RHIImageLayout const layout)
+    {
+        WS_ASSERT(texture && view.deferredCopyFn);
+
+        RHIFormat const format = texture->getFormat();
+        u32 const width        = texture->getWidth();
+        u32 const height       = texture->getHeight();
+        // block compressed chains come complete from the cooker
+        bool const compressed = rhiFormatIsBlockCompressed(format);
+        u32 const levelCount  = compressed ? static_cast<u32>(view.storedMipLevels) : texture->getMipCount();
+        usize const size      = TextureImporter::getChainSize(format, width, height, levelCount);
+
+        // a buffer of its own so the ring is not held while decoding. the mip
+        // filter reads the previous level back, write combined memory would
+        // make that slow
+        RHINativeHandle staging = RHIDevice::memoryBufferCreate(
+            static_cast<u32>(size),
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+            nullptr,
+            "upload_staging_texture");
+        byte* data = static_cast<byte*>(RHIDevice::memoryGetMappedBufferData(staging));
+        WS_ASSERT_MSG(data, "Texture staging buffer is not mapped");
+
+        view.deferredCopyFn(data);
+        if (!compressed && (static_cast<u32>(view.storedMipLevels) < levelCount))
+        {
+            TextureImporter::generateMips(width, height, levelCount, data);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // the offsets of levels are multiples of the texel block size
+        u32 barrierBatch = std::numeric_limits<u32>::max();
+        u64 srcOffset    = 0;
+        for (u32 i = 0; i < levelCount; ++i)
+        {
+            recordMipCopy(texture, staging, srcOffset, i, barrierBatch);
+            srcOffset += TextureImporter::getMipSize(format, width, height, i);
+        }
+        recordTextureEnd(texture, layout);
+
+        // released with the batch like the dedicated buffers of large uploads
+        m_recording.dedicated.push_back(staging);
+
+        m_uploadedBytes += size;
+        return recordingToken();
+    }
+
+    RHIUploadToken RHIUploadQueue::flush(RHICommandList* consumer)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        reclaim();
+        RHIUploadToken const token = flushLocked();
+
+        // under the lock, a batch submitted by a worker in between would be
+        // acquired without being waited for
+        if (consumer && token)
+        {
+            WS_ASSERT(consumer->getQueue()->getType() == RHIQueueType::Graphics);
+            consumer->waitQueue(m_queue, token.value);
+            consumer->acquireOwnership(m_acquires, RHIQueueType::Transfer);
+            m_acquires.clear();
+        }
+
+        return token;
+    }
+
+    void RHIUploadQueue::wait(RHIUploadToken const token)
+    {
+        if (!token)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (token.value > m_submittedValue)
+            {
+                flushLocked();
+            }
+        }
+
+        m_queue->waitTimeline(token.value);
+    }
+
+    bool RHIUploadQueue::isComplete(RHIUploadToken const token) const
+    {
+        return m_queue->getCompletedValue() >= token.value;
+    }
+
+    RHIUploadToken RHIUploadQueue::getPendingToken() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return recordingToken();
+    }
+
+    u64 RHIUploadQueue::allocate(u32 const size, u32 const alignment)
+    {
+        WS_ASSERT(size <= m_capacity);
+
+        while (true)
+        {
+            u64 offset = (m_head + alignment - 1) & ~static_cast<u64>(alignment - 1);
+            // a copy never straddles the end of the ring
+            if ((offset % m_capacity) + size > m_capacity)
+            {
+                offset = (offset / m_capacity + 1) * m_capacity;
+            }
+
+            reclaim();
+            if (offset + size - m_tail <= m_capacity)
+            {
+                m_head = offset + size;
+                return offset % m_capacity;
+            }
+
+            // ring is full, the oldest batch has to retire first
+            if (m_inFlight.empty())
+            {
+                flushLocked();
+            }
+            m_queue->waitTimeline(m_inFlight.front().value);
+        }
+    }
+
+    void RHIUploadQueue::reclaim()
+    {
+        if (m_inFlight.empty())
+        {
+            return;
+        }
+
+        u64 const completed = m_queue->getCompletedValue();
+        while (!m_inFlight.empty() && (m_inFlight.front().value <= completed))
+        {
+            Batch& batch = m_inFlight.front();
+            m_tail       = batch.end;
+            for (RHINativeHandle buffer : batch.dedicated)
+            {
+                RHIDevice::memoryBufferDestroy(buffer);
+            }
+            m_inFlight.pop_front();
+        }
+    }
+
+    void RHIUploadQueue::beginBatch()
+    {
+        if (!m_cmdList)
+        {
+            m_cmdList = m_queue->nextCommandList();
+            m_cmdList->begin();
+        }
+    }
+
+    RHIUploadToken RHIUploadQueue::flushLocked()
+    {
+        if (!m_cmdList)
+        {
+            return {m_submittedValue};
+        }
+
+        m_cmdList->submit(nullptr);
+        m_cmdList = nullptr;
+
+        m_recording.end   = m_head;
+        m_recording.value = m_queue->getTimelineValue();
+        m_submittedValue  = m_recording.value;
+        m_acquires.insert(m_acquires.end(), m_recording.acquires.begin(), m_recording.acquires.end());
+        m_inFlight.push_back(std::move(m_recording));
+        m_recording = {};
+        ++m_batchCount;
+
+        return {m_submittedValue};
+    }
+
+    RHIUploadToken RHIUploadQueue::recordingToken() const
+    {
+        // this queue is the only one submitting to the transfer queue, so the
+        // recording batch signals the next timeline value
+        return {m_cmdList ? m_queue->getTimelineValue() + 1 : m_submittedValue};
+    }
+
+    RHINativeHandle RHIUploadQueue::stage(void const* data, u32 const size, u32 const alignment, u64& offset)
+    {
+        if (size > m_capacity)
+        {
+            // too large for the ring, released with the batch
+            RHINativeHandle buffer = RHIDevice::memoryBufferCreate(
+                size,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                data,
+                "upload_staging_dedicated");
+            m_recording.dedicated.push_back(buffer);
+
+            offset = 0;
+            return buffer;
+        }
+
+        offset = allocate(size, alignment);
+        // host coherent memory, no flush needed
+        std::memcpy(m_mappedData + offset, data, size);
+        return m_staging;
+    }
+
+    void RHIUploadQueue::recordMipCopy(RHITexture* texture, RHINativeHandle source, u64 const srcOffset, u32 const level, u32& barrierBatch)
+    {
+        beginBatch();
+
+        // clang-format off
+        if (barrierBatch != m_batchCount)
+        {
+            barrierBatch = m_batchCount;
+            m_cmdList->insertBarrier(texture->getImage(), texture->getFormat(), RHIImageLayout::TransferDestination,
+                                     RHIPipelineStageFlagBits::TopOfPipe, RHIAccessFlagBits::None,
+                                     RHIPipelineStageFlagBits::Transfer, RHIAccessFlagBits::TransferWrite);
+        }
+
+        VkBufferImageCopy2 copyRegion = {};
+        copyRegion.sType                           = VK_STRUCTURE_TYPE_BUFFER_IMAGE_COPY_2;
+        copyRegion.bufferOffset                    = srcOffset;
+        copyRegion.bufferRowLength                 = 0;
+        copyRegion.bufferImageHeight               = 0;
+        copyRegion.imageSubresource.aspectMask     = vulkanImageAspectFlags(texture->getFormat());
+        copyRegion.imageSubresource.baseArrayLayer = 0;
+        copyRegion.imageSubresource.layerCount     = 1;
+        copyRegion.imageSubresource.mipLevel       = level;
+        copyRegion.imageOffset                     = {0, 0, 0};
+        copyRegion.imageExtent                     = {std::max(texture->getWidth() >> level, 1u),
+                                                      std::max(texture->getHeight() >> level, 1u),
+                                                      std::max(texture->getDepth() >> level, 1u)};
+
+        VkCopyBufferToImageInfo2 infoCopy = {};
+        infoCopy.sType          = VK_STRUCTURE_TYPE_COPY_BUFFER_TO_IMAGE_INFO_2;
+        infoCopy.srcBuffer      = source.asValue<VkBuffer>();
+        infoCopy.dstImage       = texture->getImage().asValue<VkImage>();
+        infoCopy.dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        infoCopy.regionCount    = 1;
+        infoCopy.pRegions       = &copyRegion;
+        // clang-format on
+
+        vkCmdCopyBufferToImage2KHR(m_cmdList->getHandle().asValue<VkCommandBuffer>(), &infoCopy);
+    }
+
+    void RHIUploadQueue::recordTextureEnd(RHITexture* texture, RHIImageLayout const layout)
+    {
+        WS_ASSERT(m_cmdList);
+
+        if (m_ownershipTransfer)
+        {
+            // the layout changes as part of the transfer
+            RHIOwnershipTransfer transfer = {};
+            transfer.resource             = texture->getImage();
+            transfer.format               = texture->getFormat();
+            transfer.layoutOld            = RHICommandList::getImageLayout(texture->getImage());
+            transfer.layoutNew            = layout;
+            recordRelease(transfer);
+            return;
+        }
+
+        // the semaphore wait of the consumer makes the write visible, no
+        // access on this queue follows
+        // clang-format off
+        m_cmdList->insertBarrier(texture->getImage(), texture->getFormat(), layout,
+                                 RHIPipelineStageFlagBits::Transfer, RHIAccessFlagBits::TransferWrite,
+                                 RHIPipelineStageFlagBits::AllCommands, RHIAccessFlagBits::None);
+        // clang-format on
+    }
+
+    void RHIUploadQueue::recordRelease(RHIOwnershipTransfer const& transfer)
+    {
+        if (!m_ownershipTransfer)
+        {
+            return;
+        }
+
+        // resources are uploaded right after creation, nothing on the
+        // graphics queue has to be released to this queue first
+        m_cmdList->releaseOwnership(std::span(&transfer, 1), RHIQueueType::Graphics);
+        m_recording.acquires.push_back(transfer);
+    }
+
+} // namespace worse
@@ -23,11 +23,15 @@
 namespace worse
 {
 
+    // IDxcCompiler3 is not safe to use from multiple threads at once, every
+    // thread gets its own instance created on first use
     class DXCompiler
     {
     public:
         static void initialize();
+        // destroy instances of all threads
         static void shutdown();
+        // instance of the calling thread
         static DXCompiler* instance();
 
         DXCompiler();
@@ -35,8 +39,11 @@ namespace worse
 
         CComPtr<IDxcBlob> compile(std::string const& source, std::vector<std::wstring> const& wArguments);
 
+        // "major.minor[-commit]" of the loaded dxcompiler, part of shader cache key
+        std::string const& getVersion() const { return m_version; }
+
     private:
-        static inline DXCompiler* s_instance = nullptr;
+        std::string m_version;
 
         CComPtr<IDxcCompiler3> m_compiler;
         CComPtr<IDxcUtils> m_utils;
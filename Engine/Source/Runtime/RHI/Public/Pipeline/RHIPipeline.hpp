@@ -2,7 +2,14 @@
 #include "RHIResource.hpp"
 #include "RHIPipelineState.hpp"
 #include "RHIDescriptorSetLayout.hpp"
+#include "RHIPipelineManifest.hpp"
 
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+#include <filesystem>
 #include <unordered_map>
 
 namespace worse
@@ -40,14 +47,45 @@ namespace worse
         RHIPipelinePool();
         ~RHIPipelinePool();
 
-        // get pipeline from pool or create a new one
+        // get pipeline from pool or create a new one, thread safe, waits if
+        // the pipeline is being prewarmed
         RHIPipeline* getPipeline(RHIPipelineState const& pso);
 
+        // create every pipeline of the manifest on the thread pool
+        void prewarm();
+
+        // remove pipelines using the shader source in one step, callers
+        // rebuild their pipeline states at a frame boundary
+        u32 evict(std::filesystem::path const& shaderPath);
+
+        // clang-format off
+        u32 getPrewarmedCount() const { return m_prewarmedCount.load(std::memory_order_relaxed); }
+        // clang-format on
+
     private:
+        // shaders and states referenced by a prewarmed pipeline, kept alive
+        // with the pool
+        struct PrewarmEntry
+        {
+            RHIPipelineManifestEntry desc;
+            std::vector<std::unique_ptr<RHIShader>> shaders;
+        };
+
+        std::shared_ptr<RHIPipeline> createPipeline(RHIPipelineState const& pso);
+        void prewarmEntry(PrewarmEntry& entry);
+        void waitPending();
+
+        std::mutex m_mutex;
         // clang-format off
-        // hash by pso
+        // hash by native pipeline content, see RHIPipelineState::getPipelineHash
         std::unordered_map<u64, std::shared_ptr<RHIPipeline>> m_pipelines;
+        // prewarm jobs not known to be finished
+        std::unordered_map<u64, std::shared_future<void>> m_pending;
         // clang-format on
+        std::vector<std::unique_ptr<PrewarmEntry>> m_prewarmEntries;
+        std::atomic<u32> m_prewarmedCount = 0;
+
+        RHIPipelineManifest m_manifest;
     };
 
 } // namespace worse
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+#include "Types.hpp"
+#include "RHIVertex.hpp"
+#include "RHIDefinitions.hpp"
+#include "Pipeline/RHIBlendState.hpp"
+#include "Pipeline/RHIRasterizerState.hpp"
+#include "Pipeline/RHIDepthStencilState.hpp"
+
+#include <array>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <unordered_set>
+
+namespace worse
+{
+
+    class RHIPipelineState;
+
+    // everything needed to recreate a native pipeline without the renderer
+    struct RHIPipelineManifestEntry
+    {
+        struct Shader
+        {
+            std::string path;
+            RHIShaderType type       = RHIShaderType::Max;
+            RHIVertexType vertexType = RHIVertexType::None;
+        };
+
+        // clang-format off
+        u64 pipelineHash                       = 0;
+        std::string name                       = "";
+        RHIPipelineType type                   = RHIPipelineType::Graphics;
+        RHIPrimitiveTopology primitiveTopology = RHIPrimitiveTopology::TriangleList;
+
+        bool hasRasterizerState   = false;
+        bool hasDepthStencilState = false;
+        bool hasBlendState        = false;
+        RHIRasterizerState rasterizerState     = {};
+        RHIDepthStencilState depthStencilState = {};
+        RHIBlendState blendState               = {};
+
+        std::vector<Shader> shaders;
+        std::array<RHIFormat, RHIConfig::MAX_RENDER_TARGET> renderTargetColorFormats = {};
+        RHIFormat renderTargetDepthFormat                                            = RHIFormat::Max;
+        // clang-format on
+    };
+
+    /**
+     * @brief PSO 清单
+     *
+     * 记录运行中创建过的管线描述并保存到磁盘, 下次启动时据此在后台线程预先
+     * 创建管线, 避免首次使用时在帧中途编译
+     */
+    class RHIPipelineManifest : public NonCopyable
+    {
+    public:
+        static std::filesystem::path getPath();
+
+        bool load();
+        // only writes when entries changed since load
+        bool save();
+
+        // thread safe, returns false if the pipeline is already recorded
+        bool record(RHIPipelineState const& pso);
+        // thread safe, drop an entry that no longer matches the sources
+        void remove(u64 const pipelineHash);
+
+        // clang-format off
+        std::vector<RHIPipelineManifestEntry> const& getEntries() const { return m_entries; }
+        // clang-format on
+
+    private:
+        std::mutex m_mutex;
+        std::vector<RHIPipelineManifestEntry> m_entries;
+        std::unordered_set<u64> m_hashes;
+        bool m_dirty = false;
+    };
+
+} // namespace worse
@@ -14,14 +14,22 @@ namespace worse
         ~RHIPipelineState();
 
         // making sure shaders are compiled, and states are complete,
-        // and generate hash
+        // generate hash and resolve the native pipeline
         void finalize();
+        // finalize without render target textures, formats must be set,
+        // used to create pipelines ahead of time
+        void finalizeForPrewarm();
         RHIShader const* getShader(RHIShaderType const type) const;
         std::vector<RHIDescriptor> collectDescriptors() const;
 
         // clang-format off
         bool isValidated() const      { return m_validated; }
         u64 getHash() const { return m_hash; }
+        // hash of everything the native pipeline depends on, render targets
+        // only contribute their formats, stable across runs
+        u64 getPipelineHash() const { return m_pipelineHash; }
+        // resolved by finalize, owned by the pipeline pool
+        RHIPipeline* getPipeline() const { return m_pipeline; }
         // clang-format on
 
         std::string name = "pso";
@@ -35,6 +43,9 @@ namespace worse
         EnumArray<RHIShaderType, RHIShader*> shaders= {};
         std::array<RHITexture*, RHIConfig::MAX_RENDER_TARGET> renderTargetColorTextures = {nullptr};
         RHITexture* renderTargetDepthTexture = nullptr;
+        // filled from render targets by finalize, unused slots are Max
+        std::array<RHIFormat, RHIConfig::MAX_RENDER_TARGET> renderTargetColorFormats = {};
+        RHIFormat renderTargetDepthFormat = RHIFormat::Max;
         // clang-format on
 
         math::Rectangle scissor = {};
@@ -43,8 +54,10 @@ namespace worse
         Color clearColor        = Color::Black();
 
     private:
-        bool m_validated = false;
-        u64 m_hash       = 0;
+        bool m_validated    = false;
+        u64 m_hash          = 0;
+        u64 m_pipelineHash  = 0;
+        RHIPipeline* m_pipeline = nullptr;
     };
 
     class RHIPipelineStateBuilder
@@ -14,6 +14,8 @@ namespace worse
         static constexpr RHIBufferUsageFlags Instance{0b0001'0010};
         static constexpr RHIBufferUsageFlags Index   {0b0001'0100};
         static constexpr RHIBufferUsageFlags Storage {0b0010'0000};
+        // persistent mapped host memory, may be bound as any kind of buffer
+        static constexpr RHIBufferUsageFlags Upload  {0b0100'0000};
         static constexpr RHIBufferUsageFlags Uniform {0b1000'0000};
         // clang-format on
     };
@@ -46,19 +48,9 @@ namespace worse
             nativeDestroy();
         }
 
-        // update mapped buffer data
-        void update(RHICommandList* cmdList, void const* cpuData, u32 const size);
-
-        void resetOffset()
-        {
-            m_offset      = 0;
-            m_firstUpdate = true;
-        }
-
         // clang-format off
         RHIBufferUsageFlags getUsage() const        { return m_usage; }
         u32                 getStride() const       { return m_stride; }
-        u32                 getOffset() const       { return m_offset; }
         u32                 getElementCount() const { return m_elementCount; }
         u32                 getSize() const         { return m_size; }
         void*               getMappedData() const   { return m_gpuData; }
@@ -67,12 +59,10 @@ namespace worse
     private:
         RHIBufferUsageFlags m_usage = RHIBufferUsageFlagBits::None;
         u32 m_stride                = 0;
-        u32 m_offset                = 0;
         u32 m_elementCount          = 0;
         u32 m_size                  = 0;
         void* m_gpuData             = nullptr;
         bool m_mappable             = false;
-        bool m_firstUpdate          = true;
 
         RHINativeHandle m_handle = {};
     };
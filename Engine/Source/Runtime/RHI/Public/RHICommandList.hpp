@@ -3,11 +3,13 @@
 #include "RHIDefinitions.hpp"
 #include "RHIResource.hpp"
 #include "RHIViewport.hpp"
+#include "RHIQueue.hpp"
 #include "RHIDescriptor.hpp"
 #include "Pipeline/RHIPipelineState.hpp"
 
 #include <span>
 #include <atomic>
+#include <vector>
 
 namespace worse
 {
@@ -32,6 +34,20 @@ namespace worse
         bool isDepth             = false;
     };
 
+    // exclusive resource handed from one queue family to another, the same
+    // description is released on the source and acquired on the destination
+    struct RHIOwnershipTransfer
+    {
+        RHINativeHandle resource = {}; // image or buffer
+        // image only, the layout changes as part of the transfer
+        RHIFormat format         = RHIFormat::Max;
+        RHIImageLayout layoutOld = RHIImageLayout::Max;
+        RHIImageLayout layoutNew = RHIImageLayout::Max;
+        // buffer only
+        u64 offset = 0;
+        u64 size   = 0;
+    };
+
     class RHICommandList : public RHIResource
     {
     public:
@@ -40,8 +56,12 @@ namespace worse
         ~RHICommandList();
 
         void begin();
-        void submit(RHISyncPrimitive* semaphoreWait);
+        // semaphoreWaitStage: stages of the submission that wait for semaphoreWait
+        void submit(RHISyncPrimitive* semaphoreWait, RHIPipelineStageFlags const semaphoreWaitStage = RHIPipelineStageFlagBits::AllCommands);
         void waitForExecution();
+        // make the stages of next submission wait for another queue's timeline
+        // value, waits on the same queue are merged
+        void waitQueue(RHIQueue* queue, u64 const value, RHIPipelineStageFlags const stage = RHIPipelineStageFlagBits::AllCommands);
 
         void renderPassBegin();
         void renderPassEnd();
@@ -59,8 +79,9 @@ namespace worse
         void dispatch(u32 const x, u32 const y, u32 const z = 1);
 
         // bind pipeline specific resources and begin render pass make sure pso
-        // has been called `finalize()`
-        void setPipelineState(RHIPipelineState const& pso);
+        // has been called `finalize()`, the pso must outlive the recording,
+        // binding the same pso again is a pointer compare
+        void setPipelineState(RHIPipelineState const* pso);
         // must call this at the end of the render operation if only has one pso
         // in reneder loop, otherwise the activation of next pass will fail
         void clearPipelineState();
@@ -77,6 +98,16 @@ namespace worse
             RHIAccessFlags const srcAccess       = RHIAccessFlagBits::MemoryRead,
             RHIPipelineStageFlags const dstStage = RHIPipelineStageFlagBits::AllCommands,
             RHIAccessFlags const dstAccess       = RHIAccessFlagBits::MemoryWrite | RHIAccessFlagBits::MemoryWrite);
+        // execution and memory dependency without layout transition
+        void insertMemoryBarrier(RHIPipelineStageFlags const srcStage,
+                                 RHIAccessFlags const srcAccess,
+                                 RHIPipelineStageFlags const dstStage,
+                                 RHIAccessFlags const dstAccess);
+        // release half of queue family ownership transfers, makes writes of
+        // this queue available
+        void releaseOwnership(std::span<RHIOwnershipTransfer const> transfers, RHIQueueType const destination);
+        // acquire half, the submission must wait for the one that released
+        void acquireOwnership(std::span<RHIOwnershipTransfer const> transfers, RHIQueueType const source);
 
         void blit(RHITexture const* source, RHITexture const* destination);
         void blit(RHITexture const* source, RHISwapchain const* destination);
@@ -86,7 +117,8 @@ namespace worse
 
         void pushConstants(std::span<byte, RHIConfig::MAX_PUSH_CONSTANT_SIZE> data);
 
-        void setBufferVertex(RHIBuffer* buffer);
+        // offset for sub-range of a shared buffer, e.g. upload ring
+        void setBufferVertex(RHIBuffer* buffer, u32 const offset = 0);
         void setBufferIndex(RHIBuffer* buffer);
 
         void updateBuffer(RHIBuffer* buffer, u32 const offset, u32 const size, void const* data);
@@ -110,11 +142,12 @@ namespace worse
     private:
         std::shared_ptr<RHISyncPrimitive> m_renderingCompleteBinaySemaphore;
         std::shared_ptr<RHISyncPrimitive> m_renderingCompleteTimelineSemaphore;
+        std::vector<RHIQueueWait> m_queueWaits;
 
         // for bind global descriptor set once
         bool m_isFirstGraphicsPass = true;
-        RHIPipelineState m_pso;
-        RHIPipeline* m_pipeline = nullptr;
+        RHIPipelineState const* m_pso = nullptr;
+        RHIPipeline* m_pipeline       = nullptr;
 
         std::atomic<RHICommandListState> m_state = RHICommandListState::Idle;
         RHIQueue* m_submissionQueue              = nullptr;
@@ -53,6 +53,7 @@ namespace worse
     class RHIDescriptor;
     class RHIDescriptorSet;
     class RHIDescriptorSetLayout;
+    class RHIUploadQueue;
 
     enum class RHIBackendType
     {
@@ -73,6 +74,7 @@ namespace worse
         Shader,
         Pipeline,
         PipelineLayout,
+        PipelineCache,
         DescriptorPool,
         DescriptorSetLayout,
         DescriptorSet,
@@ -210,6 +212,34 @@ namespace worse
         Compute,
     };
 
+    // what a device allocation backs, used for memory reports
+    enum class RHIMemoryCategory
+    {
+        Texture,
+        RenderTarget,
+        Mesh,
+        Uniform,
+        Staging,
+        Other,
+        Max
+    };
+
+    constexpr char const* rhiMemoryCategoryToString(RHIMemoryCategory const category)
+    {
+        switch (category)
+        {
+            // clang-format off
+        case RHIMemoryCategory::Texture:      return "Texture";
+        case RHIMemoryCategory::RenderTarget: return "RenderTarget";
+        case RHIMemoryCategory::Mesh:         return "Mesh";
+        case RHIMemoryCategory::Uniform:      return "Uniform";
+        case RHIMemoryCategory::Staging:      return "Staging";
+        case RHIMemoryCategory::Other:        return "Other";
+        default:                              return "Unknown";
+            // clang-format on
+        }
+    }
+
     WS_DEFINE_FLAGS(RHIShaderStage, u32);
     // clang-format off
     struct RHIShaderStageFlagBits
@@ -377,16 +407,21 @@ namespace worse
     // clang-format off
     struct RHIAccessFlagBits
     {
-        static constexpr RHIAccessFlags None              {0x00000000ULL};
-        static constexpr RHIAccessFlags ShaderRead        {0x00000020ULL};
-        static constexpr RHIAccessFlags ShaderWrite       {0x00000040ULL};
-        static constexpr RHIAccessFlags TransferRead      {0x00000800ULL};
-        static constexpr RHIAccessFlags TransferWrite     {0x00001000ULL};
-        static constexpr RHIAccessFlags MemoryRead        {0x00008000ULL};
-        static constexpr RHIAccessFlags MemoryWrite       {0x00010000ULL};
-        static constexpr RHIAccessFlags ShaderSampledRead {0x100000000ULL};
-        static constexpr RHIAccessFlags ShaderStorageRead {0x200000000ULL};
-        static constexpr RHIAccessFlags ShaderStorageWrite{0x400000000ULL};
+        static constexpr RHIAccessFlags None                        {0x00000000ULL};
+        static constexpr RHIAccessFlags UniformRead                 {0x00000008ULL};
+        static constexpr RHIAccessFlags ShaderRead                  {0x00000020ULL};
+        static constexpr RHIAccessFlags ShaderWrite                 {0x00000040ULL};
+        static constexpr RHIAccessFlags ColorAttachmentRead         {0x00000080ULL};
+        static constexpr RHIAccessFlags ColorAttachmentWrite        {0x00000100ULL};
+        static constexpr RHIAccessFlags DepthStencilAttachmentRead  {0x00000200ULL};
+        static constexpr RHIAccessFlags DepthStencilAttachmentWrite {0x00000400ULL};
+        static constexpr RHIAccessFlags TransferRead                {0x00000800ULL};
+        static constexpr RHIAccessFlags TransferWrite               {0x00001000ULL};
+        static constexpr RHIAccessFlags MemoryRead                  {0x00008000ULL};
+        static constexpr RHIAccessFlags MemoryWrite                 {0x00010000ULL};
+        static constexpr RHIAccessFlags ShaderSampledRead           {0x100000000ULL};
+        static constexpr RHIAccessFlags ShaderStorageRead           {0x200000000ULL};
+        static constexpr RHIAccessFlags ShaderStorageWrite          {0x400000000ULL};
     };
     // clang-format on
 
@@ -394,17 +429,20 @@ namespace worse
     // clang-format off
     struct RHIPipelineStageFlagBits
     {
-        static constexpr RHIPipelineStageFlags None          {0x00000000ULL};
-        static constexpr RHIPipelineStageFlags TopOfPipe     {0x00000001ULL};
-        static constexpr RHIPipelineStageFlags DrawIndirect  {0x00000002ULL};
-        static constexpr RHIPipelineStageFlags VertexInput   {0x00000004ULL};
-        static constexpr RHIPipelineStageFlags VertexShader  {0x00000008ULL};
-        static constexpr RHIPipelineStageFlags FragmentShader{0x00000080ULL};
-        static constexpr RHIPipelineStageFlags ComputeShader {0x00000800ULL};
-        static constexpr RHIPipelineStageFlags Transfer      {0x00001000ULL};
-        static constexpr RHIPipelineStageFlags BottomOfPipe  {0x00002000ULL};       
-        static constexpr RHIPipelineStageFlags AllGraphics   {0x00008000ULL};
-        static constexpr RHIPipelineStageFlags AllCommands   {0x00010000ULL};
+        static constexpr RHIPipelineStageFlags None                 {0x00000000ULL};
+        static constexpr RHIPipelineStageFlags TopOfPipe            {0x00000001ULL};
+        static constexpr RHIPipelineStageFlags DrawIndirect         {0x00000002ULL};
+        static constexpr RHIPipelineStageFlags VertexInput          {0x00000004ULL};
+        static constexpr RHIPipelineStageFlags VertexShader         {0x00000008ULL};
+        static constexpr RHIPipelineStageFlags FragmentShader       {0x00000080ULL};
+        static constexpr RHIPipelineStageFlags EarlyFragmentTests   {0x00000100ULL};
+        static constexpr RHIPipelineStageFlags LateFragmentTests    {0x00000200ULL};
+        static constexpr RHIPipelineStageFlags ColorAttachmentOutput{0x00000400ULL};
+        static constexpr RHIPipelineStageFlags ComputeShader        {0x00000800ULL};
+        static constexpr RHIPipelineStageFlags Transfer             {0x00001000ULL};
+        static constexpr RHIPipelineStageFlags BottomOfPipe         {0x00002000ULL};
+        static constexpr RHIPipelineStageFlags AllGraphics          {0x00008000ULL};
+        static constexpr RHIPipelineStageFlags AllCommands          {0x00010000ULL};
     };
     // clang-format on
 
@@ -481,6 +519,7 @@ namespace worse
         case RHINativeHandleType::Shader:              return VK_OBJECT_TYPE_SHADER_MODULE;
         case RHINativeHandleType::Pipeline:            return VK_OBJECT_TYPE_PIPELINE;
         case RHINativeHandleType::PipelineLayout:      return VK_OBJECT_TYPE_PIPELINE_LAYOUT;
+        case RHINativeHandleType::PipelineCache:       return VK_OBJECT_TYPE_PIPELINE_CACHE;
         case RHINativeHandleType::DescriptorPool:      return VK_OBJECT_TYPE_DESCRIPTOR_POOL;
         case RHINativeHandleType::DescriptorSet:       return VK_OBJECT_TYPE_DESCRIPTOR_SET;
         case RHINativeHandleType::DescriptorSetLayout: return VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT;
@@ -517,6 +556,11 @@ namespace worse
         case RHIFormat::R16G16B16A16Snorm: return VK_FORMAT_R16G16B16A16_SNORM;
         case RHIFormat::R16G16B16A16Float: return VK_FORMAT_R16G16B16A16_SFLOAT;
         case RHIFormat::R32G32B32A32Float: return VK_FORMAT_R32G32B32A32_SFLOAT;
+        case RHIFormat::BC1Unorm:          return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case RHIFormat::BC3Unorm:          return VK_FORMAT_BC3_UNORM_BLOCK;
+        case RHIFormat::BC4Unorm:          return VK_FORMAT_BC4_UNORM_BLOCK;
+        case RHIFormat::BC5Unorm:          return VK_FORMAT_BC5_UNORM_BLOCK;
+        case RHIFormat::BC7Unorm:          return VK_FORMAT_BC7_UNORM_BLOCK;
         case RHIFormat::D16Unorm:          return VK_FORMAT_D16_UNORM;
         case RHIFormat::D32Float:          return VK_FORMAT_D32_SFLOAT;
         case RHIFormat::D32FloatS8X24Uint: return VK_FORMAT_D32_SFLOAT_S8_UINT;
@@ -721,6 +765,11 @@ namespace worse
         WS_RHI_FORMAT_CASE(R16G16B16A16Snorm);
         WS_RHI_FORMAT_CASE(R16G16B16A16Float);
         WS_RHI_FORMAT_CASE(R32G32B32A32Float);
+        WS_RHI_FORMAT_CASE(BC1Unorm);
+        WS_RHI_FORMAT_CASE(BC3Unorm);
+        WS_RHI_FORMAT_CASE(BC4Unorm);
+        WS_RHI_FORMAT_CASE(BC5Unorm);
+        WS_RHI_FORMAT_CASE(BC7Unorm);
         WS_RHI_FORMAT_CASE(D16Unorm);
         WS_RHI_FORMAT_CASE(D32Float);
         WS_RHI_FORMAT_CASE(D32FloatS8X24Uint);
@@ -749,15 +798,30 @@ namespace worse
     {
         static bool enableVSync            = true;
         static bool enableValidationLayers = true;
+        // watch shader sources and recompile edited shaders at runtime
+        static bool enableShaderHotReload  = true;
 
         constexpr usize MAX_RENDER_TARGET = 8;
+        // CPU records frame N+1 while GPU executes frame N, per frame
+        // resources (uniform buffers, descriptor pools) are ring buffered
+        constexpr u32 MAX_FRAMES_IN_FLIGHT = 2;
+        // one frame may split into several submissions per queue
+        constexpr usize MAX_COMMAND_LISTS_PER_QUEUE = 8;
         // Minimum descriptor for initial descriptor pool
         constexpr u32 MIN_DESCRIPTORS             = 512;
         constexpr u32 MAX_DESCRIPTORS             = 2048;
         constexpr u32 MAX_DESCRIPTOR_SETS         = 512;
         constexpr u32 MAX_DESCRIPTOR_SET_BINDINGS = 256;
+        // texture slots of the global bindless array
+        constexpr u32 MAX_BINDLESS_TEXTURES       = 16384;
         constexpr usize MAX_BUFFER_UPDATE_SIZE    = 64 * 1024; // 64 KB
         constexpr usize MAX_PUSH_CONSTANT_SIZE    = 128;       // 128 bytes
+        // upload ring region of one frame
+        constexpr u32 UPLOAD_RING_FRAME_SIZE = 4 * 1024 * 1024; // 4 MB
+        // max minUniformBufferOffsetAlignment allowed by Vulkan spec
+        constexpr u32 UPLOAD_RING_ALIGNMENT = 256;
+        // staging ring of the transfer queue uploads
+        constexpr u32 UPLOAD_STAGING_SIZE = 64 * 1024 * 1024; // 64 MB
 
         constexpr u32 HLSL_REGISTER_SHIFT_B = 0;
         constexpr u32 HLSL_REGISTER_SHIFT_S = 100;
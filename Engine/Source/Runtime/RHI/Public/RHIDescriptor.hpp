@@ -50,6 +50,10 @@ namespace worse
         u32 index                      = 0;
         RHIDescriptorResource resource = {};
         RHIDescriptorType type         = RHIDescriptorType::Max;
+        // buffer sub-range (e.g. upload ring allocation), 0 range means the
+        // whole buffer
+        u32 offset = 0;
+        u32 range  = 0;
     };
 
     class RHIDescriptor
@@ -92,7 +96,9 @@ namespace worse
         RHIDescriptorAllocator();
         ~RHIDescriptorAllocator();
 
-        void resetAll();
+        // switch to pools of the frame slot, sets are persistent and never
+        // reset, allocated sets stay valid
+        void setFrameIndex(u32 const frameIndex);
 
         RHINativeHandle allocateSet(RHINativeHandle layout);
         RHINativeHandle allocateVariableSet(RHINativeHandle layout, u32 count);
@@ -100,8 +106,8 @@ namespace worse
     private:
         u32 m_expandRatio = 1;
         u32 m_rotateIndex = 0;
-        std::array<std::vector<RHINativeHandle>, 2> m_pools;
-        std::array<u32, 2> m_currentPoolIndex;
+        std::array<std::vector<RHINativeHandle>, RHIConfig::MAX_FRAMES_IN_FLIGHT> m_pools;
+        std::array<u32, RHIConfig::MAX_FRAMES_IN_FLIGHT> m_currentPoolIndex;
     };
 
 } // namespace worse
\ No newline at end of file
@@ -2,12 +2,38 @@
 #include "Types.hpp"
 #include "RHIResource.hpp"
 #include "RHIDescriptor.hpp"
+#include "RHIUploadRing.hpp"
 
 #include <span>
+#include <vector>
+#include <filesystem>
 
 namespace worse
 {
 
+    struct RHIMemoryHeapBudget
+    {
+        // bytes used by this process and the budget reported by the driver
+        u64 usage  = 0;
+        u64 budget = 0;
+        // device memory blocks allocated by VMA and the bytes suballocated
+        u64 blockBytes      = 0;
+        u64 allocationBytes = 0;
+        bool isDeviceLocal  = false;
+    };
+
+    struct RHIMemoryStatistics
+    {
+        std::vector<RHIMemoryHeapBudget> heaps;
+        EnumArray<RHIMemoryCategory, u64> categoryBytes = {};
+        EnumArray<RHIMemoryCategory, u32> categoryCount = {};
+
+        u64 blockBytes      = 0;
+        u64 allocationBytes = 0;
+        u32 blockCount      = 0;
+        u32 allocationCount = 0;
+    };
+
     class RHIDevice : public NonCopyable, public NonMovable
     {
     public:
@@ -18,6 +44,9 @@ namespace worse
         static void setResourceProvider(RHIResourceProvider* provider);
         static RHIResourceProvider* getResourceProvider();
 
+        // BC1-BC7 sampling, cooked textures fall back to their sources without it
+        static bool isTextureCompressionSupported();
+
         // =====================================================================
         // Queues
         // =====================================================================
@@ -32,26 +61,34 @@ namespace worse
         // Descriptor
         // =====================================================================
 
-        // reset allocated descriptors
-        static void resetDescriptorAllocator();
+        // select persistent descriptor sets of the frame slot and point the
+        // frame constant binding at this frame's data, call at frame start
+        static void beginDescriptorFrame(u32 const frameIndex, RHIUploadAllocation const& frameConstant);
         // expose for pipeline layout creation
         static RHINativeHandle getGlobalDescriptorSetLayout();
         static RHINativeHandle getGlobalDescriptorSet();
-        // allocate and write global descriptor set
-        static void writeGlobalDescriptorSet();
+        // descriptors of global set written since frame start
+        static u32 getGlobalDescriptorWriteCount();
+        // only slots that differ from the current content are written
         static void
-        updateBindlessTextures(std::span<RHIDescriptorWrite> updates);
+        updateBindlessTextures(std::span<RHIDescriptorWrite const> updates);
         // used by RHIPipelinePool to create pipeline layout
         static RHIDescriptorSetLayout*
         getSpecificDescriptorSetLayout(RHIPipelineState const& pso);
         static RHINativeHandle getSpecificDescriptorSet(u64 descriptorHash);
-        static void resetSpecificDescriptorSets();
+        // returns false if the set already holds the descriptor
+        static bool cacheSpecificDescriptorWrite(RHINativeHandle set, u32 const binding, u32 const arrayElement, u64 const resource, u64 const offset, u64 const range);
 
         static RHINativeHandle createImGuiPool(u32 descriptorCount = 512,
                                                u32 maxSets         = 512);
 
         // get descriptor set layout from pool or create a new one
         static RHIPipeline* getPipeline(RHIPipelineState const& pso);
+        // drop pipelines built from the shader source, returns the count,
+        // pipeline states resolved against them must be finalized again
+        static u32 evictPipelines(std::filesystem::path const& shaderPath);
+        // driver pipeline cache, persisted across runs
+        static RHINativeHandle getPipelineCache();
 
         // =====================================================================
         // Memory
@@ -59,19 +96,40 @@ namespace worse
 
         static void memoryTextureCreate(RHITexture* texture);
         static void memoryTextureDestroy(RHINativeHandle handle);
+        // cross queue buffers are shared by graphics and compute families,
+        // others belong to one family and are handed over explicitly
         static RHINativeHandle memoryBufferCreate(u32 size, u32 bufferUsage,
                                                   u32 memoryProperty,
                                                   void const* data,
-                                                  std::string_view name);
+                                                  std::string_view name,
+                                                  bool const crossQueue = false);
         static void memoryBufferDestroy(RHINativeHandle handle);
         // get mapped buffer data pointer from VMA allocation map
         static void* memoryGetMappedBufferData(RHINativeHandle handle);
+        // per frame linear allocator for dynamic data
+        static RHIUploadRing* getUploadRing();
+        // size of the allocation backing a buffer or image, zero if unknown
+        static u64 memoryGetAllocationSize(RHINativeHandle handle);
+        // heap budgets and per category usage of live allocations
+        static RHIMemoryStatistics memoryGetStatistics();
+        // write statistics, every named allocation and the VMA report as JSON
+        static bool memoryDumpStatistics(std::filesystem::path const& path);
+        // batched texture and buffer uploads on the transfer queue
+        static RHIUploadQueue* getUploadQueue();
 
         // =====================================================================
         // RHI GC
         // =====================================================================
 
+        // thread safe and lock free, destroyed after the GPU retired every
+        // frame that could have used the resource
         static void deletionQueueAdd(RHINativeHandle const& resource);
+        // tag resources enqueued so far with the timeline values submitted
+        // so far, called once per frame after submission
+        static void deletionQueueEndFrame();
+        // destroy resources whose frames retired, never blocks
+        static void deletionQueueCollect();
+        // destroy everything, GPU must be idle
         static void deletionQueueFlush();
 
         // =====================================================================
@@ -2,6 +2,7 @@
 #include "RHIResource.hpp"
 #include "RHISyncPrimitive.hpp"
 
+#include <span>
 #include <array>
 #include <atomic>
 #include <memory>
@@ -9,6 +10,15 @@
 namespace worse
 {
 
+    // wait until another queue's timeline reaches the value before the
+    // stages execute, other stages of the submission may start earlier
+    struct RHIQueueWait
+    {
+        RHIQueue* queue             = nullptr;
+        u64 value                   = 0;
+        RHIPipelineStageFlags stage = RHIPipelineStageFlagBits::AllCommands;
+    };
+
     class RHIQueue : public RHIResource
     {
     public:
@@ -16,24 +26,36 @@ namespace worse
         ~RHIQueue();
 
         void wait();
-        void submit(void* cmdBuffer, u32 const waitFlags,
+        // block cpu until the queue timeline reaches the value
+        void waitTimeline(u64 const value);
+        // value the gpu has reached on the queue timeline, never blocks
+        u64 getCompletedValue() const;
+        void submit(void* cmdBuffer, RHIPipelineStageFlags const semaphoreWaitStage,
                     RHISyncPrimitive* semaphoreWait,
                     RHISyncPrimitive* semaphoreSignal,
-                    RHISyncPrimitive* semaphoreTimeline);
+                    RHISyncPrimitive* semaphoreTimeline,
+                    std::span<RHIQueueWait const> queueWaits = {});
         void present(RHINativeHandle swapchain, u32 const imageIndex,
                      RHISyncPrimitive* semaphoreWait);
         RHICommandList* nextCommandList();
 
         // clang-format off
-        u32 getIndex() const { return m_index; }
-        RHIQueueType  getType() const  { return m_type; }
+        u32 getIndex() const                   { return m_index; }
+        RHIQueueType  getType() const          { return m_type; }
+        RHISyncPrimitive* getTimeline() const  { return m_timeline.get(); }
+        // value signaled by the latest submission
+        u64 getTimelineValue() const           { return m_timelineValue; }
         // clang-format on
 
     private:
-        std::array<std::shared_ptr<RHICommandList>, 2> m_cmdLists = {nullptr};
-        std::atomic<u32> m_index                                  = 0;
-        RHIQueueType m_type                                       = RHIQueueType::Max;
+        std::array<std::shared_ptr<RHICommandList>, RHIConfig::MAX_COMMAND_LISTS_PER_QUEUE> m_cmdLists = {nullptr};
+        std::atomic<u32> m_index                                                                       = 0;
+        RHIQueueType m_type                                                                            = RHIQueueType::Max;
         RHINativeHandle m_handle; // command pool
+
+        // signaled by every submission, other queues and cpu wait on it
+        std::shared_ptr<RHISyncPrimitive> m_timeline;
+        std::atomic<u64> m_timelineValue = 0;
     };
 
 } // namespace worse
\ No newline at end of file
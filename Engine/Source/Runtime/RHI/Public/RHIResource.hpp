@@ -106,7 +106,6 @@ namespace worse
         // clang-format off
         virtual std::pair<RHIShader*, RHIShader*> getPlaceholderShader() const = 0;
         virtual RHITexture* getPlaceholderTexture() const = 0;
-        virtual RHIBuffer* getFrameConstantBuffer() const = 0;
         virtual EnumArray<RHISamplerType, RHISampler*> getSamplers() const = 0;
         // clang-format on
 
@@ -117,7 +116,6 @@ namespace worse
             validated &= ((getPlaceholderShader().first != nullptr) &&
                           (getPlaceholderShader().second != nullptr));
             validated &= (getPlaceholderTexture() != nullptr);
-            validated &= (getFrameConstantBuffer() != nullptr);
 
             return validated;
         }
@@ -4,6 +4,8 @@
 #include "RHIDescriptor.hpp"
 
 #include <regex>
+#include <atomic>
+#include <future>
 #include <string>
 #include <vector>
 #include <filesystem>
@@ -26,6 +28,9 @@ namespace worse
     public:
         std::string parse(std::filesystem::path const& path);
 
+        // canonical paths of the parsed file and everything it includes
+        std::unordered_set<std::filesystem::path> const& getIncludes() const { return m_includes; }
+
     private:
         std::unordered_set<std::filesystem::path> m_includes;
 
@@ -35,6 +40,8 @@ namespace worse
     class RHIShader : public RHIResource
     {
         RHINativeHandle nativeCompile();
+        // preprocess, compile and reflect, runs on the calling thread
+        void compileInternal();
         // extract descriptor from spirv
         void reflect(RHIShaderType const shaderType, u32* spirvData,
                      usize const spirvSize);
@@ -46,32 +53,45 @@ namespace worse
         void compile(std::filesystem::path const& filepath,
                      RHIShaderType const shaderType,
                      RHIVertexType const vertexType = RHIVertexType::None);
+        // submit compilation to the thread pool, the state is Compiling
+        // until the job finishes
+        void compileAsync(std::filesystem::path const& filepath,
+                          RHIShaderType const shaderType,
+                          RHIVertexType const vertexType = RHIVertexType::None);
+        // block until a pending async compilation finishes
+        void waitForCompilation() const;
 
         // clang-format off
         std::string_view                  getEntryPoint() const;
+        std::filesystem::path const&      getPath() const        { return m_path; }
+        // source file and its includes, valid once compilation finished
+        std::vector<std::filesystem::path> const& getDependencies() const { return m_dependencies; }
         std::vector<RHIDescriptor> const& getDescriptors() const { return m_descriptors; }
-        RHIShaderCompilationState         getState() const       { return m_state; }
+        RHIShaderCompilationState         getState() const       { return m_state.load(std::memory_order_acquire); }
         RHIShaderType                     getShaderType() const  { return m_shaderType; }
         RHIVertexType                     getVertexType() const  { return m_vertexType; }
         RHIInputLayout const&             getInputLayout() const { return m_inputLayout; }
         u64                               getHash() const        { return m_hash; }
+        bool                              isFromCache() const    { return m_fromCache; }
         RHINativeHandle                   getHandle() const      { return m_shaderModule; }
         // clang-format on
 
     private:
-        inline static PreprocessIncludesParser preprocessParser;
-
         std::filesystem::path m_path;
         std::string m_source;
+        std::vector<std::filesystem::path> m_dependencies;
 
         std::vector<RHIDescriptor> m_descriptors;
-        RHIShaderCompilationState m_state = RHIShaderCompilationState::Idle;
-        RHIShaderType m_shaderType        = RHIShaderType::Max;
-        RHIVertexType m_vertexType        = RHIVertexType::None;
+        std::atomic<RHIShaderCompilationState> m_state = RHIShaderCompilationState::Idle;
+        RHIShaderType m_shaderType                     = RHIShaderType::Max;
+        RHIVertexType m_vertexType                     = RHIVertexType::None;
         RHIInputLayout m_inputLayout;
+        std::shared_future<void> m_compileTask;
 
         u64 m_hash                     = 0;
         RHINativeHandle m_shaderModule = {};
+        // spirv and reflection were loaded from the disk cache
+        bool m_fromCache = false;
     };
 
 } // namespace worse
\ No newline at end of file
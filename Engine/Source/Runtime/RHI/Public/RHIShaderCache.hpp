@@ -0,0 +1,52 @@
+#pragma once
+#include "Types.hpp"
+#include "RHIDescriptor.hpp"
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <string_view>
+
+namespace worse
+{
+
+    struct RHIShaderCacheEntry
+    {
+        std::vector<u32> spirv;
+        std::vector<RHIDescriptor> descriptors;
+    };
+
+    /**
+     * @brief SPIR-V 磁盘缓存
+     *
+     * 以预处理后的源码, 入口, 着色器类型, 编译参数(含宏定义)和编译器版本的哈希
+     * 为键, 缓存 SPIR-V 与反射得到的描述符, 命中时跳过 DXC 编译与反射
+     */
+    class RHIShaderCache
+    {
+    public:
+        static u64 computeKey(std::string_view source,
+                              std::string_view entryPoint,
+                              RHIShaderType const shaderType,
+                              std::vector<std::wstring> const& arguments,
+                              std::string_view compilerVersion);
+
+        // returns false on miss or invalid file
+        static bool load(u64 const key, RHIShaderCacheEntry& entry);
+        // thread safe, written to a temporary file and renamed
+        static bool store(u64 const key, RHIShaderCacheEntry const& entry);
+
+        static std::filesystem::path getDirectory();
+
+        // clang-format off
+        static u32 getHitCount()  { return s_hitCount.load(std::memory_order_relaxed); }
+        static u32 getMissCount() { return s_missCount.load(std::memory_order_relaxed); }
+        // clang-format on
+
+    private:
+        static inline std::atomic<u32> s_hitCount  = 0;
+        static inline std::atomic<u32> s_missCount = 0;
+    };
+
+} // namespace worse
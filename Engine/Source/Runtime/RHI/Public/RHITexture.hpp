@@ -7,6 +7,7 @@
 
 namespace worse
 {
+    struct TextureLoadView;
 
     WS_DEFINE_FLAGS(RHITextureView, u32);
     struct RHITextureViewFlagBits
@@ -20,6 +21,10 @@ namespace worse
         // depth stencil view
         static constexpr RHITextureViewFlags DepthStencilView{1u << 3};
         static constexpr RHITextureViewFlags ClearOrBlit{1u << 4};
+        // keep the mip data in CPU memory after the upload
+        static constexpr RHITextureViewFlags KeepData{1u << 5};
+        // accessed by graphics and compute queues, concurrent sharing
+        static constexpr RHITextureViewFlags CrossQueue{1u << 6};
     };
 
     struct RHITextureMip
@@ -29,7 +34,7 @@ namespace worse
 
     struct RHITextureSlice
     {
-        // TODO: only has mip 0 for now
+        // mip 0 first, each level half the size of the previous one
         std::vector<RHITextureMip> mips;
     };
 
@@ -37,14 +42,16 @@ namespace worse
     {
         friend class RHIDevice;
 
-        bool nativeCreate();
+        // data comes from the view when given, otherwise from the slices
+        bool nativeCreate(TextureLoadView const* view = nullptr);
 
     public:
         RHITexture() = default;
         /**
          * @brief 创建纹理
          *
-         * @note only accept mip 0 texture or texture array
+         * @note data holds mipCount levels per slice, or none for render targets.
+         *       Released after the upload unless usage has KeepData
          */
         RHITexture(RHITextureType const type, u32 const width, u32 const height,
                    u32 const depth, u32 const mipCount, RHIFormat const format,
@@ -52,12 +59,15 @@ namespace worse
                    std::vector<RHITextureSlice> data, std::string const& name);
         /**
          * @brief 从文件加载纹理
+         *
+         * @param maxSize 非 0 时块压缩文件只加载宽高不超过该值的 mip 尾部
+         * @param flipVertically 解码时上下翻转行序
          */
-        RHITexture(std::filesystem::path const& path);
+        RHITexture(std::filesystem::path const& path, u32 const maxSize = 0, bool const flipVertically = true);
         /**
          * @brief 从内存数据创建纹理
          */
-        RHITexture(std::span<byte> data, std::string const& name);
+        RHITexture(std::span<byte const> data, std::string const& name, bool const flipVertically = false);
         /**
          * @brief 从多个通道的纹理文件创建纹理
          */
@@ -84,15 +94,17 @@ namespace worse
         bool isValid() const;
 
         // clang-format off
-        RHITextureType      getType() const     { return m_type; }
-        u32                 getWidth() const    { return m_width; }
-        u32                 getHeight() const   { return m_height; }
-        u32                 getDepth() const    { return m_depth; }
-        u32                 getMipCount() const { return m_mipCount; }
-        RHIFormat           getFormat() const   { return m_format; }
-        RHITextureViewFlags getUsage() const    { return m_usage; }
-        RHINativeHandle     getView() const     { return m_rtv; }
-        RHINativeHandle     getImage() const    { return m_image; }
+        RHITextureType      getType() const            { return m_type; }
+        u32                 getWidth() const           { return m_width; }
+        u32                 getHeight() const          { return m_height; }
+        u32                 getDepth() const           { return m_depth; }
+        u32                 getMipCount() const        { return m_mipCount; }
+        // source mips above mip 0 that were left on disk
+        u32                 getSkippedMipCount() const { return m_skippedMipCount; }
+        RHIFormat           getFormat() const          { return m_format; }
+        RHITextureViewFlags getUsage() const           { return m_usage; }
+        RHINativeHandle     getView() const            { return m_rtv; }
+        RHINativeHandle     getImage() const           { return m_image; }
         // clang-format on
 
     private:
@@ -101,6 +113,7 @@ namespace worse
         u32 m_height          = 0;
         u32 m_depth           = 1;
         u32 m_mipCount        = 1;
+        u32 m_skippedMipCount = 0;
         RHIFormat m_format    = RHIFormat::Max;
         RHITextureViewFlags m_usage;
 
@@ -0,0 +1,116 @@
+#pragma once
+#include "Types.hpp"
+#include "RHIDefinitions.hpp"
+#include "RHIResource.hpp"
+#include "RHICommandList.hpp"
+
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <string_view>
+
+namespace worse
+{
+    struct TextureLoadView;
+
+    // value of the transfer queue timeline signaled when the batch holding the
+    // upload finished, zero means nothing to wait for
+    struct RHIUploadToken
+    {
+        u64 value = 0;
+
+        explicit operator bool() const
+        {
+            return value != 0;
+        }
+    };
+
+    /**
+     * @brief 传输队列上的异步上传
+     *
+     * 数据先写入持久映射的暂存环形缓冲, 拷贝命令录制到传输队列的命令列表,
+     * flush 时整批一次提交. 每批以传输队列时间线值作为完成令牌, 暂存空间在
+     * 令牌到达后回收. 资源以独占模式创建, 传输队列族与图形队列族不同时,
+     * 批次末尾释放所有权, 由 flush 的使用方命令列表获取
+     */
+    class RHIUploadQueue : public NonCopyable
+    {
+    public:
+        RHIUploadQueue(u32 const stagingSize, std::string_view name);
+        ~RHIUploadQueue();
+
+        // thread safe, the copy is recorded now and executed with the batch
+        RHIUploadToken uploadBuffer(RHINativeHandle buffer, void const* data, u32 const size, u32 const offset = 0);
+        // copy every mip with data and leave the image in the given layout
+        RHIUploadToken uploadTexture(RHITexture* texture, RHIImageLayout const layout);
+        // the view writes into staging memory directly, missing R8G8B8A8 mips
+        // are filtered there. decoding runs on the calling thread unlocked
+        RHIUploadToken uploadTexture(RHITexture* texture, TextureLoadView const& view, RHIImageLayout const layout);
+
+        // submit the recorded batch, returns the token of the last batch. the
+        // consumer waits for every submitted batch and acquires the resources
+        // they released, it must be a graphics queue command list
+        RHIUploadToken flush(RHICommandList* consumer = nullptr);
+        // flushes first if the token belongs to the recording batch
+        void wait(RHIUploadToken const token);
+        bool isComplete(RHIUploadToken const token) const;
+        // token covering every upload recorded so far, flushed or not
+        RHIUploadToken getPendingToken() const;
+
+        // clang-format off
+        // token of the last submitted batch, consumers wait on it before use
+        RHIUploadToken getSubmittedToken() const { return {m_submittedValue}; }
+        RHIQueue* getQueue() const               { return m_queue; }
+        u64 getUploadedBytes() const             { return m_uploadedBytes; }
+        u32 getBatchCount() const                { return m_batchCount; }
+        // clang-format on
+
+    private:
+        struct Batch
+        {
+            u64 end   = 0; // staging head when the batch was submitted
+            u64 value = 0;
+            // staging buffers for uploads larger than the ring
+            std::vector<RHINativeHandle> dedicated;
+            // released on the transfer queue, acquired by the next consumer
+            std::vector<RHIOwnershipTransfer> acquires;
+        };
+
+        // returns staging offset, may flush and wait for older batches
+        u64 allocate(u32 const size, u32 const alignment);
+        void reclaim();
+        void beginBatch();
+        RHIUploadToken flushLocked();
+        RHIUploadToken recordingToken() const;
+        // staging memory and its buffer for the data of one upload
+        RHINativeHandle stage(void const* data, u32 const size, u32 const alignment, u64& offset);
+        // transitions to transfer destination once per batch the texture spans
+        void recordMipCopy(RHITexture* texture, RHINativeHandle source, u64 const srcOffset, u32 const level, u32& barrierBatch);
+        void recordTextureEnd(RHITexture* texture, RHIImageLayout const layout);
+        // hands the resource to the graphics family, no-op on a shared family
+        void recordRelease(RHIOwnershipTransfer const& transfer);
+
+        mutable std::mutex m_mutex;
+
+        RHIQueue* m_queue          = nullptr;
+        RHICommandList* m_cmdList  = nullptr;
+        RHINativeHandle m_staging  = {};
+        byte* m_mappedData         = nullptr;
+        u64 m_capacity             = 0;
+        // monotonic offsets, the ring position is offset % capacity
+        u64 m_head                 = 0;
+        u64 m_tail                 = 0;
+
+        Batch m_recording;
+        std::deque<Batch> m_inFlight;
+        u64 m_submittedValue = 0;
+        // transfer and graphics queues are different families
+        bool m_ownershipTransfer = false;
+        // releases of submitted batches not acquired by a consumer yet
+        std::vector<RHIOwnershipTransfer> m_acquires;
+
+        u64 m_uploadedBytes = 0;
+        u32 m_batchCount    = 0;
+    };
+
+} // namespace worse
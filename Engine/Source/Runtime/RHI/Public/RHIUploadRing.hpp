@@ -0,0 +1,69 @@
+#pragma once
+#include "Types.hpp"
+#include "RHIDefinitions.hpp"
+
+#include <atomic>
+#include <memory>
+#include <string_view>
+
+namespace worse
+{
+
+    class RHIBuffer;
+
+    // sub-range of the upload ring, valid until the frame retires
+    struct RHIUploadAllocation
+    {
+        RHIBuffer* buffer = nullptr;
+        void* data        = nullptr;
+        u32 offset        = 0;
+        u32 size          = 0;
+
+        explicit operator bool() const
+        {
+            return data != nullptr;
+        }
+    };
+
+    /**
+     * @brief 每帧线性上传分配器
+     *
+     * 一个持久映射的大缓冲, 按 MAX_FRAMES_IN_FLIGHT 切分为帧区域, 每帧从区域
+     * 头部线性分配对齐的子范围, CPU 直接 memcpy 写入, 使用时通过偏移绑定.
+     * 帧区域在该帧的 timeline 信号后由 beginFrame 整体回收
+     */
+    class RHIUploadRing : public NonCopyable
+    {
+    public:
+        RHIUploadRing(u32 const frameSize, std::string_view name);
+        ~RHIUploadRing();
+
+        // reclaim the whole region of the frame slot, caller must have waited
+        // the GPU work that used the slot last time
+        void beginFrame(u32 const frameIndex);
+
+        // thread safe, returns empty allocation when the frame region is full
+        RHIUploadAllocation allocate(u32 const size, u32 const alignment = RHIConfig::UPLOAD_RING_ALIGNMENT);
+        // allocate and copy data
+        RHIUploadAllocation write(void const* data, u32 const size, u32 const alignment = RHIConfig::UPLOAD_RING_ALIGNMENT);
+
+        // clang-format off
+        RHIBuffer* getBuffer() const  { return m_buffer.get(); }
+        u32 getFrameSize() const      { return m_frameSize; }
+        u32 getFrameOffset() const    { return m_frameOffset; }
+        u32 getUsedSize() const       { return m_head.load(std::memory_order_relaxed); }
+        u32 getPeakUsedSize() const   { return m_peakUsedSize; }
+        // clang-format on
+
+    private:
+        std::shared_ptr<RHIBuffer> m_buffer;
+        byte* m_mappedData = nullptr;
+
+        u32 m_frameSize   = 0;
+        u32 m_frameOffset = 0;
+        // bytes used in current frame region
+        std::atomic<u32> m_head = 0;
+        u32 m_peakUsedSize      = 0;
+    };
+
+} // namespace worse
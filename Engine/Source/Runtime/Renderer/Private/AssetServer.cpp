@@ -2,25 +2,60 @@
 #include "Platform.hpp"
 #include "Definitions.hpp"
 #include "Math/Hash.hpp"
+#include "RHIDevice.hpp"
+#include "ThreadPool.hpp"
 #include "AssetServer.hpp"
+#include "AssetDatabase.hpp"
+#include "TextureCooker.hpp"
+
+#include <bit>
+#include <utility>
+#include <chrono>
+#include <algorithm>
 
 namespace worse
 {
 
+    namespace
+    {
+        u64 getTextureSize(RHITexture const* texture)
+        {
+            return texture ? RHIDevice::memoryGetAllocationSize(texture->getImage()) : 0;
+        }
+
+        // cooked block compressed file when it is current and the device can sample it
+        std::filesystem::path resolveTexturePath(std::filesystem::path const& path)
+        {
+            return RHIDevice::isTextureCompressionSupported() ? TextureCooker::resolve(path) : path;
+        }
+
+        u32 getTextureExtent(RHITexture const* texture)
+        {
+            return std::max(texture->getWidth(), texture->getHeight());
+        }
+    } // namespace
+
     AssetServer::AssetServer()
     {
         std::filesystem::path const textureDir = std::filesystem::path{worse::EngineDirectory} / "Binary/Textures";
         m_errorTextureHandle                   = addTexture(textureDir / "no_texture.png");
+        pinTexture(m_errorTextureHandle);
     }
 
     AssetServer::~AssetServer()
     {
+        // workers write back into the slots
+        waitLoadTasks();
         unloadAll();
+
+        // keeps timestamps refreshed by cache lookups
+        AssetDatabase::save();
     }
 
     AssetHandle AssetServer::addTexture(
         std::filesystem::path const& path,
-        LoadStrategy strategy)
+        LoadStrategy strategy,
+        bool const flipVertically)
     {
         std::hash<std::filesystem::path> hasher;
         AssetHandle handle = hasher(path);
@@ -31,29 +66,42 @@ namespace worse
         if (it != m_textures.end())
         {
             AssetState state = it->second.state;
-            if (state == AssetState::Queued || state == AssetState::Loaded)
+            if (state != AssetState::Unloaded && state != AssetState::Failed)
             {
-                return handle; // already queued or loaded
+                return handle; // already loading or loaded
             }
         }
 
         if (strategy == LoadStrategy::Immediate)
         {
-            std::shared_ptr<RHITexture> texture = std::make_shared<RHITexture>(path);
+            TextureAssetSlot& slot = m_textures[handle];
+            slot.path              = path;
+            slot.flipVertically    = flipVertically;
+
+            std::shared_ptr<RHITexture> texture = std::make_shared<RHITexture>(resolveTexturePath(path), 0, flipVertically);
             if (texture->isValid())
             {
-                m_textures.emplace(handle, TextureAssetSlot{.texture = std::move(texture), .state = AssetState::Loaded});
+                slot.size         = getTextureSize(texture.get());
+                slot.residentSize = getTextureExtent(texture.get());
+                slot.texture      = std::move(texture);
+                slot.state        = AssetState::Loaded;
+                m_residencyChanges.push_back(handle);
             }
             else
             {
-                m_textures.emplace(handle, TextureAssetSlot{.texture = nullptr, .state = AssetState::Failed});
+                slot.texture = nullptr;
+                slot.state   = AssetState::Failed;
                 WS_LOG_ERROR("AssetServer", "Failed to load texture {}", path.string());
             }
         }
         else
         {
             m_loadQueue.push(path);
-            m_textures.emplace(handle, TextureAssetSlot{.texture = nullptr, .state = AssetState::Queued});
+
+            TextureAssetSlot& slot = m_textures[handle];
+            slot.path              = path;
+            slot.flipVertically    = flipVertically;
+            slot.state             = AssetState::Queued;
         }
 
         return handle;
@@ -84,7 +132,9 @@ namespace worse
             name);
         if (texture->isValid())
         {
-            m_textures.emplace(handle, TextureAssetSlot{.texture = std::move(texture), .state = AssetState::Loaded});
+            u64 const size = getTextureSize(texture.get());
+            m_textures.emplace(handle, TextureAssetSlot{.texture = std::move(texture), .state = AssetState::Loaded, .size = size});
+            m_residencyChanges.push_back(handle);
         }
         else
         {
@@ -95,7 +145,7 @@ namespace worse
         return handle;
     }
 
-    AssetHandle AssetServer::addTexture(std::span<byte> data, std::string const& name)
+    AssetHandle AssetServer::addTexture(std::span<byte const> data, std::string const& name, bool const flipVertically)
     {
         if (data.empty())
         {
@@ -106,25 +156,20 @@ namespace worse
         std::hash<std::string> hasher;
         AssetHandle handle = hasher(name);
 
-        std::lock_guard<std::mutex> lock(m_mtxTexture);
-
-        auto it = m_textures.find(handle);
-        if (it != m_textures.end())
         {
-            return handle;
-        }
+            std::lock_guard<std::mutex> lock(m_mtxTexture);
 
-        std::shared_ptr<RHITexture> texture = std::make_shared<RHITexture>(data, name);
-        if (texture->isValid())
-        {
-            m_textures.emplace(handle, TextureAssetSlot{.texture = std::move(texture), .state = AssetState::Loaded});
-        }
-        else
-        {
-            m_textures.emplace(handle, TextureAssetSlot{.texture = nullptr, .state = AssetState::Failed});
-            WS_LOG_ERROR("AssetServer", "Failed to load texture");
+            auto it = m_textures.find(handle);
+            if (it != m_textures.end())
+            {
+                return handle;
+            }
+
+            // claim the slot, importers add textures from several threads
+            m_textures.emplace(handle, TextureAssetSlot{.state = AssetState::Decoding});
         }
 
+        storeTexture(handle, std::make_shared<RHITexture>(data, name, flipVertically), name);
         return handle;
     }
 
@@ -162,30 +207,232 @@ namespace worse
 
     void AssetServer::loadTexture()
     {
-        std::lock_guard<std::mutex> lock(m_mtxTexture);
-
-        while (!m_loadQueue.empty())
+        std::vector<std::pair<std::filesystem::path, bool>> paths;
+        std::vector<std::pair<AssetHandle, u32>> streams;
+        std::vector<std::filesystem::path> streamPaths;
         {
-            std::filesystem::path path = m_loadQueue.front();
-            m_loadQueue.pop();
+            std::lock_guard<std::mutex> lock(m_mtxTexture);
+
+            // a finished upload was submitted before this frame's flush, the
+            // frame waits on it and may sample the texture
+            RHIUploadQueue const* uploadQueue = RHIDevice::getUploadQueue();
+            for (auto& [handle, slot] : m_textures)
+            {
+                if ((slot.state == AssetState::Uploading) && uploadQueue->isComplete(slot.uploadToken))
+                {
+                    slot.state = AssetState::Loaded;
+                    m_residencyChanges.push_back(handle);
+                }
+            }
+
+            std::erase_if(m_loadTasks,
+                          [](std::shared_future<void> const& task)
+                          {
+                              return task.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+                          });
 
             std::hash<std::filesystem::path> hasher;
-            AssetHandle handle     = hasher(path);
-            TextureAssetSlot& slot = m_textures[handle];
-            WS_ASSERT_MSG(slot.state != AssetState::Loaded, "Asset already loaded");
+            while (!m_loadQueue.empty())
+            {
+                std::filesystem::path path = std::move(m_loadQueue.front());
+                m_loadQueue.pop();
+
+                // unloaded while it was queued
+                TextureAssetSlot& slot = m_textures[hasher(path)];
+                if (slot.state != AssetState::Queued)
+                {
+                    continue;
+                }
+
+                slot.state = AssetState::Decoding;
+                paths.emplace_back(std::move(path), slot.flipVertically);
+            }
 
-            // Load the texture from the file system
-            slot.texture = std::make_shared<RHITexture>(path);
-            if (slot.texture->isValid())
+            streams = updateStreamingLocked();
+            for (auto const& [handle, maxSize] : streams)
             {
-                slot.state = AssetState::Loaded;
+                streamPaths.push_back(m_textures[handle].path);
             }
-            else
+        }
+
+        // outside the lock, an uninitialized pool runs the task inline
+        for (auto& [path, flipVertically] : paths)
+        {
+            std::shared_future<void> task = ThreadPool::addTask(
+                [this, path = std::move(path), flipVertically = flipVertically]()
+                {
+                    decodeTexture(path, flipVertically);
+                });
+
+            std::lock_guard<std::mutex> lock(m_mtxTexture);
+            m_loadTasks.push_back(std::move(task));
+        }
+
+        for (usize i = 0; i < streams.size(); ++i)
+        {
+            std::shared_future<void> task = ThreadPool::addTask(
+                [this, handle = streams[i].first, maxSize = streams[i].second, path = std::move(streamPaths[i])]()
+                {
+                    streamTexture(handle, path, maxSize);
+                });
+
+            std::lock_guard<std::mutex> lock(m_mtxTexture);
+            m_loadTasks.push_back(std::move(task));
+        }
+    }
+
+    std::vector<std::pair<AssetHandle, u32>> AssetServer::updateStreamingLocked()
+    {
+        RHIUploadQueue const* uploadQueue = RHIDevice::getUploadQueue();
+
+        u64 resident = 0;
+        std::vector<std::pair<f32, AssetHandle>> candidates;
+        for (auto& [handle, slot] : m_textures)
+        {
+            if (slot.state != AssetState::Loaded)
             {
-                slot.state   = AssetState::Failed;
-                slot.texture = nullptr;
-                WS_LOG_ERROR("AssetServer", "Failed to load texture {}", path.string());
+                continue;
+            }
+
+            // the old chain goes to the deletion queue, frames in flight keep it alive
+            if (slot.isStreaming && slot.streamTexture && uploadQueue->isComplete(slot.streamToken))
+            {
+                slot.texture      = std::move(slot.streamTexture);
+                slot.size         = getTextureSize(slot.texture.get());
+                slot.residentSize = getTextureExtent(slot.texture.get());
+                slot.isStreamable = slot.texture->getSkippedMipCount() > 0;
+                slot.isStreaming  = false;
+                m_residencyChanges.push_back(handle);
+            }
+
+            resident += slot.size;
+            if (slot.isStreamable && !slot.isStreaming && !slot.path.empty() && (slot.demandSize > slot.residentSize))
+            {
+                candidates.emplace_back(static_cast<f32>(slot.demandSize) / static_cast<f32>(slot.residentSize), handle);
+            }
+        }
+
+        // most under-resolved first
+        std::sort(candidates.begin(), candidates.end(), std::greater<>{});
+
+        std::vector<std::pair<AssetHandle, u32>> streams;
+        for (auto const& [ratio, handle] : candidates)
+        {
+            if (streams.size() >= STREAMING_MAX_REQUESTS)
+            {
+                break;
+            }
+
+            TextureAssetSlot& slot = m_textures[handle];
+            u32 const fullSize     = slot.residentSize << slot.texture->getSkippedMipCount();
+            u32 const maxSize      = std::min(std::bit_ceil(slot.demandSize), fullSize);
+
+            // every doubling of the extent quadruples the memory
+            f32 const scale  = static_cast<f32>(maxSize) / static_cast<f32>(slot.residentSize);
+            u64 const growth = static_cast<u64>(static_cast<f64>(slot.size) * (scale * scale - 1.0f));
+            if ((m_textureBudget != 0) && (resident + growth > m_textureBudget))
+            {
+                continue;
             }
+
+            resident += growth;
+            slot.isStreaming = true;
+            streams.emplace_back(handle, maxSize);
+        }
+
+        // demand is collected again during the next frame
+        for (auto& [handle, slot] : m_textures)
+        {
+            slot.demandSize = 0;
+        }
+
+        return streams;
+    }
+
+    void AssetServer::decodeTexture(std::filesystem::path const& path, bool const flipVertically)
+    {
+        // cooked chains start with their tail, the rest streams on demand
+        std::filesystem::path const resolved = resolveTexturePath(path);
+        u32 const maxSize                    = (resolved.extension() == ".dds") ? STREAMING_TAIL_SIZE : 0;
+
+        std::hash<std::filesystem::path> hasher;
+        storeTexture(hasher(path), std::make_shared<RHITexture>(resolved, maxSize, flipVertically), path.string());
+    }
+
+    void AssetServer::streamTexture(AssetHandle const handle, std::filesystem::path const& path, u32 const maxSize)
+    {
+        std::shared_ptr<RHITexture> texture = std::make_shared<RHITexture>(resolveTexturePath(path), maxSize);
+        RHIUploadToken const token          = RHIDevice::getUploadQueue()->getPendingToken();
+
+        std::lock_guard<std::mutex> lock(m_mtxTexture);
+
+        auto it = m_textures.find(handle);
+        if ((it == m_textures.end()) || (it->second.state != AssetState::Loaded) || !it->second.isStreaming)
+        {
+            // evicted or unloaded meanwhile
+            return;
+        }
+
+        TextureAssetSlot& slot = it->second;
+        if (texture->isValid())
+        {
+            slot.streamTexture = std::move(texture);
+            slot.streamToken   = token;
+        }
+        else
+        {
+            // keep the resident chain and stop asking for more
+            slot.isStreaming  = false;
+            slot.isStreamable = false;
+            WS_LOG_WARN("AssetServer", "Failed to stream texture {}", path.string());
+        }
+    }
+
+    void AssetServer::storeTexture(AssetHandle const handle, std::shared_ptr<RHITexture> texture, std::string const& name)
+    {
+        bool const isValid = texture->isValid();
+        u64 const size     = isValid ? getTextureSize(texture.get()) : 0;
+        // covers the copy recorded by the constructor
+        RHIUploadToken const token = RHIDevice::getUploadQueue()->getPendingToken();
+
+        std::lock_guard<std::mutex> lock(m_mtxTexture);
+
+        auto it = m_textures.find(handle);
+        if ((it == m_textures.end()) || (it->second.state != AssetState::Decoding))
+        {
+            // unloaded meanwhile, the deletion queue retires the texture
+            return;
+        }
+
+        TextureAssetSlot& slot = it->second;
+        if (isValid)
+        {
+            slot.residentSize = getTextureExtent(texture.get());
+            slot.isStreamable = texture->getSkippedMipCount() > 0;
+            slot.texture      = std::move(texture);
+            slot.size         = size;
+            slot.uploadToken  = token;
+            slot.state        = AssetState::Uploading;
+        }
+        else
+        {
+            slot.texture = nullptr;
+            slot.state   = AssetState::Failed;
+            WS_LOG_ERROR("AssetServer", "Failed to load texture {}", name);
+        }
+    }
+
+    void AssetServer::waitLoadTasks()
+    {
+        std::vector<std::shared_future<void>> tasks;
+        {
+            std::lock_guard<std::mutex> lock(m_mtxTexture);
+            tasks.swap(m_loadTasks);
+        }
+
+        for (std::shared_future<void> const& task : tasks)
+        {
+            task.wait();
         }
     }
 
@@ -212,6 +459,24 @@ namespace worse
                    : nullptr;
     }
 
+    RHITexture* AssetServer::getBindableTexture(AssetHandle handle) const
+    {
+        std::lock_guard<std::mutex> lock(m_mtxTexture);
+        auto it = m_textures.find(handle);
+        return it != m_textures.end() ? getBindableTextureLocked(it->second) : nullptr;
+    }
+
+    RHITexture* AssetServer::getBindableTextureLocked(TextureAssetSlot const& slot) const
+    {
+        if (slot.state == AssetState::Loaded)
+        {
+            return slot.texture.get();
+        }
+
+        auto it = m_textures.find(m_errorTextureHandle);
+        return it != m_textures.end() ? it->second.texture.get() : nullptr;
+    }
+
     StandardMaterial const* AssetServer::getMaterial(AssetHandle handle) const
     {
         std::lock_guard<std::mutex> lock(m_mtxMaterial);
@@ -240,8 +505,11 @@ namespace worse
         auto it = m_textures.find(handle);
         if (it != m_textures.end())
         {
-            it->second.texture = nullptr;
-            it->second.state   = AssetState::Unloaded;
+            it->second.texture       = nullptr;
+            it->second.streamTexture = nullptr;
+            it->second.isStreaming   = false;
+            it->second.state         = AssetState::Unloaded;
+            m_residencyChanges.push_back(handle);
         }
     }
 
@@ -262,7 +530,10 @@ namespace worse
             for (auto& pair : m_textures)
             {
                 pair.second.texture.reset();
-                pair.second.state = AssetState::Unloaded;
+                pair.second.streamTexture.reset();
+                pair.second.isStreaming = false;
+                pair.second.state       = AssetState::Unloaded;
+                m_residencyChanges.push_back(pair.first);
             }
         }
         {
@@ -301,6 +572,155 @@ namespace worse
             });
     }
 
+    void AssetServer::touchTexture(AssetHandle const handle, u64 const frame, u32 const demandSize)
+    {
+        std::lock_guard<std::mutex> lock(m_mtxTexture);
+        auto it = m_textures.find(handle);
+        if (it == m_textures.end())
+        {
+            return;
+        }
+
+        TextureAssetSlot& slot = it->second;
+        slot.lastUsedFrame     = frame;
+        slot.demandSize        = std::max(slot.demandSize, demandSize);
+        if ((slot.state == AssetState::Unloaded) && !slot.path.empty())
+        {
+            // evicted, bring it back with the next load
+            m_loadQueue.push(slot.path);
+            slot.state = AssetState::Queued;
+        }
+    }
+
+    void AssetServer::touchMaterial(AssetHandle const handle, u64 const frame, u32 const demandSize)
+    {
+        StandardMaterial material;
+        {
+            std::lock_guard<std::mutex> lock(m_mtxMaterial);
+            auto it = m_materials.find(handle);
+            if (it == m_materials.end())
+            {
+                return;
+            }
+            material = it->second.material;
+        }
+
+        for (std::optional<AssetHandle> const& texture : {material.baseColorTexture,
+                                                          material.normalTexture,
+                                                          material.metallicRoughnessTexture,
+                                                          material.ambientOcclusionTexture,
+                                                          material.emissiveTexture})
+        {
+            if (texture)
+            {
+                touchTexture(*texture, frame, demandSize);
+            }
+        }
+    }
+
+    void AssetServer::pinTexture(AssetHandle const handle)
+    {
+        std::lock_guard<std::mutex> lock(m_mtxTexture);
+        auto it = m_textures.find(handle);
+        if (it != m_textures.end())
+        {
+            it->second.isPinned = true;
+        }
+    }
+
+    void AssetServer::setTextureBudget(u64 const bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mtxTexture);
+        m_textureBudget = bytes;
+    }
+
+    usize AssetServer::evictTextures(u64 const frame)
+    {
+        std::lock_guard<std::mutex> lock(m_mtxTexture);
+        if (m_textureBudget == 0)
+        {
+            return 0;
+        }
+
+        u64 resident = 0;
+        std::vector<std::pair<u64, AssetHandle>> candidates;
+        for (auto const& [handle, slot] : m_textures)
+        {
+            if (slot.state != AssetState::Loaded)
+            {
+                continue;
+            }
+
+            resident += slot.size;
+            // frames in flight may still sample recently used textures
+            bool const isInFlight = slot.lastUsedFrame + RHIConfig::MAX_FRAMES_IN_FLIGHT >= frame;
+            if (!slot.isPinned && !slot.path.empty() && !isInFlight)
+            {
+                candidates.emplace_back(slot.lastUsedFrame, handle);
+            }
+        }
+
+        if (resident <= m_textureBudget)
+        {
+            return 0;
+        }
+
+        // least recently used first
+        std::sort(candidates.begin(), candidates.end());
+
+        usize evicted = 0;
+        for (auto const& [lastUsedFrame, handle] : candidates)
+        {
+            if (resident <= m_textureBudget)
+            {
+                break;
+            }
+
+            // comes back with its tail only when touched again
+            TextureAssetSlot& slot = m_textures[handle];
+            resident -= slot.size;
+            slot.texture       = nullptr;
+            slot.streamTexture = nullptr;
+            slot.isStreaming   = false;
+            slot.state         = AssetState::Unloaded;
+            m_residencyChanges.push_back(handle);
+            ++evicted;
+        }
+
+        if (evicted > 0)
+        {
+            WS_LOG_INFO("AssetServer", "Evicted {} textures, resident {:.2f} MB of {:.2f} MB budget", evicted, resident / (1024.0 * 1024.0), m_textureBudget / (1024.0 * 1024.0));
+        }
+
+        return evicted;
+    }
+
+    u64 AssetServer::getTextureMemory() const
+    {
+        std::lock_guard<std::mutex> lock(m_mtxTexture);
+        u64 bytes = 0;
+        for (auto const& [handle, slot] : m_textures)
+        {
+            if (slot.state == AssetState::Loaded)
+            {
+                bytes += slot.size;
+            }
+        }
+        return bytes;
+    }
+
+    u64 AssetServer::getTextureBudget() const
+    {
+        std::lock_guard<std::mutex> lock(m_mtxTexture);
+        return m_textureBudget;
+    }
+
+    std::vector<AssetHandle> AssetServer::takeResidencyChanges()
+    {
+        std::lock_guard<std::mutex> lock(m_mtxTexture);
+        return std::exchange(m_residencyChanges, {});
+    }
+
     usize AssetServer::getMaterialCount() const
     {
         std::lock_guard<std::mutex> lock(m_mtxMaterial);
@@ -313,9 +733,10 @@ namespace worse
         std::lock_guard<std::mutex> lock(m_mtxTexture);
         for (auto const& [handle, slot] : m_textures)
         {
-            if (slot.state == AssetState::Loaded)
+            // loading textures get a bindless slot now and their texture later
+            if ((slot.state != AssetState::Unloaded) && (slot.state != AssetState::Failed))
             {
-                callback(handle, slot.texture.get());
+                callback(handle, getBindableTextureLocked(slot));
             }
         }
     }
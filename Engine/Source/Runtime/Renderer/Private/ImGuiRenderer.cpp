@@ -7,7 +7,10 @@
 #include "Platform.hpp"
 #include "RHIDevice.hpp"
 #include "Renderer.hpp"
+#include "AssetServer.hpp"
 #include "ImGuiRenderer.hpp"
+#include "VirtualFileSystem.hpp"
+#include "Profiling/Stopwatch.hpp"
 
 namespace worse
 {
@@ -30,7 +33,17 @@ namespace worse
     namespace
     {
         RHINativeHandle imguiPool = {};
-    }
+
+        // statistics walk every VMA block, refreshed a few times per second
+        RHIMemoryStatistics memoryStatistics = {};
+        profiling::Stopwatch memoryStopwatch;
+        bool hasMemoryStatistics = false;
+
+        f32 toMB(u64 const bytes)
+        {
+            return static_cast<f32>(bytes) / (1024.0f * 1024.0f);
+        }
+    } // namespace
 
     void ImGuiRenderer::initialize()
     {
@@ -43,13 +56,20 @@ namespace worse
         io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
 
         std::filesystem::path fontPath = std::filesystem::path{worse::EngineDirectory} / "Binary/Fonts/NotoSerifSC-Regular.ttf";
-        
-        io.Fonts->AddFontFromFileTTF(
-            fontPath.string().c_str(),
-            18.0f,
-            nullptr,
-            io.Fonts->GetGlyphRangesChineseSimplifiedCommon()
-        );
+
+        // the atlas owns and frees the font data, copy out of the mapping
+        if (std::optional<VirtualFile> font = VirtualFileSystem::open(fontPath))
+        {
+            void* fontData = IM_ALLOC(font->getSize());
+            std::memcpy(fontData, font->getData(), font->getSize());
+            io.Fonts->AddFontFromMemoryTTF(
+                fontData,
+                static_cast<int>(font->getSize()),
+                18.0f,
+                nullptr,
+                io.Fonts->GetGlyphRangesChineseSimplifiedCommon()
+            );
+        }
         io.DisplayFramebufferScale = ImVec2(2.0f, 2.0f);
 
         ImGuiStyle& style = ImGui::GetStyle();
@@ -151,7 +171,7 @@ namespace worse
         infoInit.Device              = RHIContext::device;
         infoInit.QueueFamily         = RHIDevice::getQueueIndex(RHIQueueType::Graphics);
         infoInit.Queue               = RHIDevice::getQueueHandle(RHIQueueType::Graphics).asValue<VkQueue>();
-        infoInit.PipelineCache       = VK_NULL_HANDLE;
+        infoInit.PipelineCache       = RHIDevice::getPipelineCache().asValue<VkPipelineCache>();
         infoInit.DescriptorPool      = imguiPool.asValue<VkDescriptorPool>();
         infoInit.Subpass             = 0;
         infoInit.MinImageCount       = 2;
@@ -214,4 +234,90 @@ namespace worse
         ImGui::Render();
     }
 
-} // namespace worse
\ No newline at end of file
+    void ImGuiRenderer::drawMemoryStatistics(AssetServer* assetServer)
+    {
+        if (!hasMemoryStatistics || (memoryStopwatch.elapsedMs() > 500.0f))
+        {
+            memoryStatistics    = RHIDevice::memoryGetStatistics();
+            hasMemoryStatistics = true;
+            memoryStopwatch.reset();
+        }
+
+        ImGui::Begin("GPU Memory");
+
+        for (usize i = 0; i < memoryStatistics.heaps.size(); ++i)
+        {
+            RHIMemoryHeapBudget const& heap = memoryStatistics.heaps[i];
+            f32 const fraction              = heap.budget ? static_cast<f32>(heap.usage) / static_cast<f32>(heap.budget) : 0.0f;
+
+            std::string overlay = std::format("{:.1f} / {:.1f} MB", toMB(heap.usage), toMB(heap.budget));
+            ImGui::Text("Heap %zu (%s)", i, heap.isDeviceLocal ? "device" : "host");
+            ImGui::ProgressBar(fraction, ImVec2(-1.0f, 0.0f), overlay.c_str());
+        }
+
+        ImGui::Separator();
+        ImGui::Text("Blocks %u: %.1f MB, allocations %u: %.1f MB",
+                    memoryStatistics.blockCount,
+                    toMB(memoryStatistics.blockBytes),
+                    memoryStatistics.allocationCount,
+                    toMB(memoryStatistics.allocationBytes));
+
+        if (ImGui::BeginTable("categories", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Category");
+            ImGui::TableSetupColumn("Count");
+            ImGui::TableSetupColumn("MB");
+            ImGui::TableHeadersRow();
+            for (usize i = 0; i < static_cast<usize>(RHIMemoryCategory::Max); ++i)
+            {
+                RHIMemoryCategory const category = static_cast<RHIMemoryCategory>(i);
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(rhiMemoryCategoryToString(category));
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", memoryStatistics.categoryCount[category]);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", toMB(memoryStatistics.categoryBytes[category]));
+            }
+            ImGui::EndTable();
+        }
+
+        if (assetServer)
+        {
+            ImGui::Separator();
+
+            // 0 disables eviction
+            int budgetMB = static_cast<int>(assetServer->getTextureBudget() / (1024 * 1024));
+            ImGui::Text("Textures resident %.1f MB", toMB(assetServer->getTextureMemory()));
+            if (ImGui::SliderInt("Texture budget (MB)", &budgetMB, 0, 4096))
+            {
+                assetServer->setTextureBudget(static_cast<u64>(budgetMB) * 1024 * 1024);
+            }
+        }
+
+        if (ImGui::Button("Dump JSON"))
+        {
+            std::filesystem::path const path = std::filesystem::path{worse::EngineDirectory} / "Intermediate/MemoryStatistics/memory_statistics.json";
+            RHIDevice::memoryDumpStatistics(path);
+        }
+
+        ImGui::End();
+    }
+
+    void ImGuiRenderer::drawRendererStatistics()
+    {
+        RendererStatistics const& statistics = Renderer::getStatistics();
+
+        ImGui::Begin("Renderer");
+
+        ImGui::Text("Frame time %.3f ms", statistics.frameTimeMs);
+        ImGui::Text("Frame time %.3f ms (async compute)", statistics.frameTimeAsyncMs);
+
+        ImGui::Separator();
+        ImGui::Text("updateBuffers %.4f ms", statistics.updateBuffersMs);
+        ImGui::Text("Bindless textures %u, descriptor writes %.1f per frame", statistics.bindlessTextureCount, statistics.descriptorWrites);
+
+        ImGui::End();
+    }
+
+} // namespace worse
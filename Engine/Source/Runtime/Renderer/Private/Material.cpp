@@ -45,7 +45,8 @@ namespace worse
             materials.add(StandardMaterial{});
         }
 
-        // make sure texture files are loaded
+        // start loading queued texture files, they bind the error texture
+        // until their upload finished
         assetServer->loadTexture();
 
         // generate material indices map and descritpor write data
@@ -60,11 +61,13 @@ namespace worse
                 [&index, &textureWrites, &textureIndexMap](AssetHandle handle, RHITexture* texture)
                 {
                     // 纹理索引
-                    textureWrites->add(texture, index);
+                    textureWrites->add(texture, index, handle);
                     // 保存索引映射，用于后续构建材质
                     textureIndexMap.emplace(handle, index);
                     ++index;
                 });
+            // slots are renumbered, written again with the next frame
+            Renderer::invalidateBindlessTextures();
         }
 
         materialGPUs.clear();
@@ -77,6 +80,19 @@ namespace worse
         {
             StandardMaterial* materialECS = materials.get(i);
 
+            // drawcalls of ECS materials are not tracked, keep their textures resident
+            for (std::optional<AssetHandle> const& texture : {materialECS->baseColorTexture,
+                                                              materialECS->normalTexture,
+                                                              materialECS->metallicRoughnessTexture,
+                                                              materialECS->ambientOcclusionTexture,
+                                                              materialECS->emissiveTexture})
+            {
+                if (texture)
+                {
+                    assetServer->pinTexture(*texture);
+                }
+            }
+
             StandardMaterialGPU& data = materialGPUs[i];
             data.flags                = 0;
 
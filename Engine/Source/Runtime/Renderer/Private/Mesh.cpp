@@ -5,6 +5,14 @@
 namespace worse
 {
 
+    namespace
+    {
+        math::BoundingBox merge(math::BoundingBox const& a, math::BoundingBox const& b)
+        {
+            return math::BoundingBox(math::min(a.getMin(), b.getMin()), math::max(a.getMax(), b.getMax()));
+        }
+    } // namespace
+
     Mesh::Mesh()
     {
     }
@@ -39,6 +47,7 @@ namespace worse
         lod0.boundingBox  = math::BoundingBox(vertices);
 
         subMesh.lods.push_back(lod0);
+        m_boundingBox = m_subMeshes.empty() ? lod0.boundingBox : merge(m_boundingBox, lod0.boundingBox);
 
         m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
         m_indices.insert(m_indices.end(), indices.begin(), indices.end());
@@ -73,4 +82,47 @@ namespace worse
                 "MeshIndexBuffer");
         }
     }
+
+    void Mesh::createGPUBuffers(std::span<RHIVertexPosUvNrmTan const> vertices,
+                                std::span<byte const> indices,
+                                u32 const indexStride,
+                                std::vector<SubMesh> subMeshes)
+    {
+        WS_ASSERT((indexStride == sizeof(u16)) || (indexStride == sizeof(u32)));
+
+        if (vertices.empty())
+        {
+            WS_LOG_WARN("Mesh", "No vertices");
+            return;
+        }
+
+        m_subMeshes = std::move(subMeshes);
+        for (usize i = 0; i < m_subMeshes.size(); ++i)
+        {
+            if (!m_subMeshes[i].lods.empty())
+            {
+                math::BoundingBox const& box = m_subMeshes[i].lods[0].boundingBox;
+                m_boundingBox                = (i == 0) ? box : merge(m_boundingBox, box);
+            }
+        }
+
+        m_vertexBuffer = std::make_shared<RHIBuffer>(
+            RHIBufferUsageFlagBits::Vertex,
+            sizeof(RHIVertexPosUvNrmTan),
+            static_cast<u32>(vertices.size()),
+            vertices.data(),
+            false,
+            "MeshVertexBuffer");
+
+        if (!indices.empty())
+        {
+            m_indexBuffer = std::make_shared<RHIBuffer>(
+                RHIBufferUsageFlagBits::Index,
+                indexStride,
+                static_cast<u32>(indices.size() / indexStride),
+                indices.data(),
+                false,
+                "MeshIndexBuffer");
+        }
+    }
 } // namespace worse
\ No newline at end of file
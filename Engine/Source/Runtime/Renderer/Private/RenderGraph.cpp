@@ -0,0 +1,578 @@
+#include "Log.hpp"
+#include "RHIQueue.hpp"
+#include "RHIDevice.hpp"
+#include "RHICommandList.hpp"
+#include "RHITexture.hpp"
+#include "Renderer.hpp"
+#include "RenderGraph.hpp"
+
+#include <format>
+#include <fstream>
+#include <algorithm>
+
+namespace worse
+{
+
+    namespace
+    {
+        struct AccessInfo
+        {
+            RHIImageLayout layout;
+            RHIPipelineStageFlags stage;
+            RHIAccessFlags access;
+        };
+
+        // clang-format off
+        constexpr char const* accessNames[] = {
+            "ColorAttachment",
+            "DepthAttachment",
+            "DepthRead",
+            "SampledRead",
+            "StorageRead",
+            "StorageWrite",
+            "TransferSource",
+            "TransferDestination",
+        };
+
+        constexpr char const* passTypeNames[] = {
+            "Graphics",
+            "Compute",
+            "Transfer",
+        };
+        // clang-format on
+
+        bool isWriteAccess(RenderGraphAccess const access)
+        {
+            return (access == RenderGraphAccess::ColorAttachment) ||
+                   (access == RenderGraphAccess::DepthAttachment) ||
+                   (access == RenderGraphAccess::StorageWrite) ||
+                   (access == RenderGraphAccess::TransferDestination);
+        }
+
+        AccessInfo resolveAccess(RenderGraphPassType const type,
+                                 RenderGraphAccess const access)
+        {
+            RHIPipelineStageFlags shaderStage =
+                (type == RenderGraphPassType::Compute)
+                    ? RHIPipelineStageFlagBits::ComputeShader
+                    : RHIPipelineStageFlagBits::VertexShader |
+                          RHIPipelineStageFlagBits::FragmentShader;
+            RHIPipelineStageFlags depthStage =
+                RHIPipelineStageFlagBits::EarlyFragmentTests |
+                RHIPipelineStageFlagBits::LateFragmentTests;
+
+            // clang-format off
+            switch (access)
+            {
+            case RenderGraphAccess::ColorAttachment:
+                return {RHIImageLayout::Attachment, RHIPipelineStageFlagBits::ColorAttachmentOutput, RHIAccessFlagBits::ColorAttachmentRead | RHIAccessFlagBits::ColorAttachmentWrite};
+            case RenderGraphAccess::DepthAttachment:
+                return {RHIImageLayout::Attachment, depthStage, RHIAccessFlagBits::DepthStencilAttachmentRead | RHIAccessFlagBits::DepthStencilAttachmentWrite};
+            case RenderGraphAccess::DepthRead:
+                return {RHIImageLayout::Attachment, depthStage, RHIAccessFlagBits::DepthStencilAttachmentRead};
+            case RenderGraphAccess::SampledRead:
+                return {RHIImageLayout::ShaderRead, shaderStage, RHIAccessFlagBits::ShaderSampledRead};
+            case RenderGraphAccess::StorageRead:
+                return {RHIImageLayout::General, shaderStage, RHIAccessFlagBits::ShaderStorageRead};
+            case RenderGraphAccess::StorageWrite:
+                return {RHIImageLayout::General, shaderStage, RHIAccessFlagBits::ShaderStorageRead | RHIAccessFlagBits::ShaderStorageWrite};
+            case RenderGraphAccess::TransferSource:
+                return {RHIImageLayout::TransferSource, RHIPipelineStageFlagBits::Transfer, RHIAccessFlagBits::TransferRead};
+            case RenderGraphAccess::TransferDestination:
+                return {RHIImageLayout::TransferDestination, RHIPipelineStageFlagBits::Transfer, RHIAccessFlagBits::TransferWrite};
+            case RenderGraphAccess::Max:
+                break;
+            }
+            // clang-format on
+
+            WS_ASSERT_MSG(false, "Invalid render graph access");
+            return {RHIImageLayout::General, RHIPipelineStageFlagBits::AllCommands, RHIAccessFlagBits::MemoryRead | RHIAccessFlagBits::MemoryWrite};
+        }
+
+        bool isAliasCompatible(RenderGraphTextureDesc const& a,
+                               RenderGraphTextureDesc const& b)
+        {
+            return (a.width == b.width) && (a.height == b.height) &&
+                   (a.format == b.format);
+        }
+    } // namespace
+
+    RenderGraphBuilder::RenderGraphBuilder(usize const passIndex,
+                                           RenderGraph* graph)
+        : m_passIndex(passIndex), m_graph(graph)
+    {
+    }
+
+    RenderGraphBuilder& RenderGraphBuilder::read(RendererTarget const target,
+                                                 RenderGraphAccess const access)
+    {
+        WS_ASSERT(!isWriteAccess(access));
+        m_graph->m_passes[m_passIndex].accesses.push_back({target, access, false});
+        return *this;
+    }
+
+    RenderGraphBuilder& RenderGraphBuilder::write(RendererTarget const target,
+                                                  RenderGraphAccess const access)
+    {
+        WS_ASSERT(isWriteAccess(access));
+        m_graph->m_passes[m_passIndex].accesses.push_back({target, access, true});
+        return *this;
+    }
+
+    RenderGraphBuilder& RenderGraphBuilder::sideEffect()
+    {
+        m_graph->m_passes[m_passIndex].sideEffect = true;
+        return *this;
+    }
+
+    RenderGraphBuilder& RenderGraphBuilder::asyncCompute()
+    {
+        WS_ASSERT(m_graph->m_passes[m_passIndex].type == RenderGraphPassType::Compute);
+        m_graph->m_passes[m_passIndex].asyncCompute = true;
+        return *this;
+    }
+
+    void RenderGraph::declareTexture(RendererTarget const target,
+                                     RenderGraphTextureDesc const& desc)
+    {
+        m_textures[target].desc     = desc;
+        m_textures[target].declared = true;
+        m_dirty                     = true;
+    }
+
+    void RenderGraph::addPass(std::string const& name,
+                              RenderGraphPassType const type,
+                              SetupFn const& setup,
+                              ExecuteFn execute)
+    {
+        Pass& pass   = m_passes.emplace_back();
+        pass.name    = name;
+        pass.type    = type;
+        pass.execute = std::move(execute);
+
+        RenderGraphBuilder builder(m_passes.size() - 1, this);
+        setup(builder);
+
+        m_dirty = true;
+    }
+
+    void RenderGraph::setOutput(RendererTarget const target)
+    {
+        m_textures[target].output = true;
+        m_dirty                   = true;
+    }
+
+    void RenderGraph::setPassEnabled(std::string_view name, bool const enabled)
+    {
+        for (Pass& pass : m_passes)
+        {
+            if ((pass.name == name) && (pass.enabled != enabled))
+            {
+                pass.enabled = enabled;
+                m_dirty      = true;
+            }
+        }
+    }
+
+    bool RenderGraph::compile()
+    {
+        if (!m_dirty)
+        {
+            return false;
+        }
+        m_dirty = false;
+
+        // 剔除: 从输出反向遍历, 只保留结果最终被输出消费的 pass
+        EnumArray<RendererTarget, bool> needed;
+        for (usize i = 0; i < m_textures.size(); ++i)
+        {
+            needed[i] = m_textures[i].output;
+        }
+
+        for (usize i = m_passes.size(); i-- > 0;)
+        {
+            Pass& pass = m_passes[i];
+            pass.alive = false;
+            if (!pass.enabled)
+            {
+                continue;
+            }
+
+            bool alive = pass.sideEffect;
+            for (Access const& access : pass.accesses)
+            {
+                alive |= access.isWrite && needed[access.target];
+            }
+            if (!alive)
+            {
+                continue;
+            }
+
+            pass.alive = true;
+            for (Access const& access : pass.accesses)
+            {
+                if (!access.isWrite)
+                {
+                    needed[access.target] = true;
+                }
+            }
+        }
+
+        // 生命周期
+        for (Texture& texture : m_textures)
+        {
+            texture.used = false;
+        }
+        for (usize i = 0; i < m_passes.size(); ++i)
+        {
+            if (!m_passes[i].alive)
+            {
+                continue;
+            }
+
+            for (Access const& access : m_passes[i].accesses)
+            {
+                Texture& texture = m_textures[access.target];
+                WS_ASSERT_MSG(texture.declared, "Render graph texture is not declared");
+                if (!texture.used)
+                {
+                    texture.first = i;
+                    texture.used  = true;
+                }
+                texture.last = i;
+            }
+        }
+
+        // 可能在计算队列执行的 pass 访问的纹理以并发模式在两个队列族间共享,
+        // 与模式无关, 切换异步计算不需要重建
+        EnumArray<RendererTarget, bool> crossQueue = {};
+        for (Pass const& pass : m_passes)
+        {
+            if (!pass.alive || !pass.asyncCompute)
+            {
+                continue;
+            }
+            for (Access const& access : pass.accesses)
+            {
+                crossQueue[access.target] = true;
+            }
+        }
+
+        // 别名: 按首次使用排序, 贪心放入最后使用早于自身首次使用的兼容槽位
+        std::vector<usize> order;
+        for (usize i = 0; i < m_textures.size(); ++i)
+        {
+            if (m_textures[i].declared)
+            {
+                order.push_back(i);
+            }
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [this](usize const a, usize const b)
+                         {
+                             Texture const& ta = m_textures[a];
+                             Texture const& tb = m_textures[b];
+                             return (ta.used ? ta.first : m_passes.size()) <
+                                    (tb.used ? tb.first : m_passes.size());
+                         });
+
+        std::vector<RenderGraphAliasSlot> slots;
+        std::vector<usize> slotLast;
+        std::vector<bool> slotShareable;
+        for (usize const index : order)
+        {
+            Texture& texture = m_textures[index];
+            bool shareable   = texture.desc.transient && texture.used && !texture.output;
+
+            RenderGraphTextureDesc desc = texture.desc;
+            if (crossQueue[index])
+            {
+                desc.usage |= RHITextureViewFlagBits::CrossQueue;
+            }
+
+            usize slot = slots.size();
+            if (shareable)
+            {
+                for (usize s = 0; s < slots.size(); ++s)
+                {
+                    if (slotShareable[s] && (slotLast[s] < texture.first) &&
+                        isAliasCompatible(slots[s].desc, desc))
+                    {
+                        slot = s;
+                        break;
+                    }
+                }
+            }
+
+            if (slot == slots.size())
+            {
+                slots.push_back({{}, desc});
+                slotLast.push_back(0);
+                slotShareable.push_back(shareable);
+            }
+            else
+            {
+                slots[slot].desc.usage |= desc.usage;
+                slots[slot].desc.name += "+" + desc.name;
+            }
+
+            slots[slot].targets.push_back(static_cast<RendererTarget>(index));
+            slotLast[slot] = texture.last;
+            texture.slot   = slot;
+        }
+
+        bool changed = slots.size() != m_aliasSlots.size();
+        for (usize s = 0; !changed && (s < slots.size()); ++s)
+        {
+            changed = (slots[s].targets != m_aliasSlots[s].targets) ||
+                      (slots[s].desc.usage != m_aliasSlots[s].desc.usage);
+        }
+        m_aliasSlots = std::move(slots);
+
+        usize alivePasses = std::count_if(m_passes.begin(), m_passes.end(), [](Pass const& pass) { return pass.alive; });
+        WS_LOG_INFO("RenderGraph", "Compiled {} passes ({} culled), {} textures -> {} allocations", alivePasses, m_passes.size() - alivePasses, order.size(), m_aliasSlots.size());
+        for (RenderGraphAliasSlot const& slot : m_aliasSlots)
+        {
+            if (slot.targets.size() > 1)
+            {
+                WS_LOG_DEBUG("RenderGraph", "Alias: {}", slot.desc.name);
+            }
+        }
+
+        return changed;
+    }
+
+    RHICommandList* RenderGraph::execute(RHICommandList* cmdList)
+    {
+        WS_ASSERT_MSG(!m_dirty, "Render graph must be compiled before execution");
+
+        m_barrierCount     = 0;
+        m_queueSwitchCount = 0;
+
+        // the previous frame's command lists are all submitted
+        resolvePending(RHIQueueType::Graphics);
+        resolvePending(RHIQueueType::Compute);
+
+        for (Pass& pass : m_passes)
+        {
+            if (!pass.alive)
+            {
+                continue;
+            }
+
+            RHIQueueType queue = (m_asyncCompute && pass.asyncCompute) ? RHIQueueType::Compute : RHIQueueType::Graphics;
+            if (queue != cmdList->getQueue()->getType())
+            {
+                cmdList = switchQueue(cmdList, queue);
+            }
+
+            // barriers are not allowed inside dynamic rendering
+            cmdList->renderPassEnd();
+            for (Access const& access : pass.accesses)
+            {
+                transition(cmdList, Renderer::getRenderTarget(access.target), pass.type, access.access);
+            }
+
+            pass.execute(cmdList);
+        }
+        cmdList->renderPassEnd();
+
+        // the frame always ends on the graphics queue (present), the present
+        // blit reads the output after the last compute pass, so the frame's
+        // last graphics submission also retires its compute work
+        if (cmdList->getQueue()->getType() != RHIQueueType::Graphics)
+        {
+            cmdList = switchQueue(cmdList, RHIQueueType::Graphics);
+        }
+
+        return cmdList;
+    }
+
+    void RenderGraph::access(RHICommandList* cmdList,
+                             RendererTarget const target,
+                             RenderGraphPassType const type,
+                             RenderGraphAccess const access)
+    {
+        cmdList->renderPassEnd();
+        transition(cmdList, Renderer::getRenderTarget(target), type, access);
+    }
+
+    RHICommandList* RenderGraph::switchQueue(RHICommandList* cmdList, RHIQueueType const type)
+    {
+        // 提交当前队列上的部分, 新队列上的 pass 在 transition 中按纹理等待
+        RHIQueueType const typeCurrent = cmdList->getQueue()->getType();
+        cmdList->submit(nullptr);
+        resolvePending(typeCurrent);
+
+        RHICommandList* cmdListNext = RHIDevice::getQueue(type)->nextCommandList();
+        cmdListNext->begin();
+
+        ++m_queueSwitchCount;
+        return cmdListNext;
+    }
+
+    void RenderGraph::resolvePending(RHIQueueType const type)
+    {
+        u64 const value = RHIDevice::getQueue(type)->getTimelineValue();
+        for (auto& [texture, state] : m_states)
+        {
+            if (state.values[type] == SUBMISSION_PENDING)
+            {
+                state.values[type] = value;
+            }
+        }
+    }
+
+    void RenderGraph::resetTracking()
+    {
+        m_states.clear();
+    }
+
+    void RenderGraph::transition(RHICommandList* cmdList,
+                                 RHITexture* texture,
+                                 RenderGraphPassType const type,
+                                 RenderGraphAccess const access)
+    {
+        AccessInfo info     = resolveAccess(type, access);
+        TextureState& state = m_states[texture];
+        bool layoutChange   = texture->getImageLayout() != info.layout;
+
+        RHIQueueType queue = cmdList->getQueue()->getType();
+
+        // 另一队列上的访问通过时间线信号量排序, 只有本次访问的阶段等待,
+        // 提交中的其他阶段以及之后的提交不受影响
+        for (usize i = 0; i < state.values.size(); ++i)
+        {
+            RHIQueueType const other = static_cast<RHIQueueType>(i);
+            if ((other != queue) && (state.values[other] != 0))
+            {
+                WS_ASSERT_MSG(state.values[other] != SUBMISSION_PENDING, "Cross queue access before submission");
+                cmdList->waitQueue(RHIDevice::getQueue(other), state.values[other], info.stage);
+                state.values[other] = 0;
+            }
+        }
+
+        if (state.queue != queue)
+        {
+            // 屏障以等待的阶段接上依赖链, 信号量已使写入可见,
+            // 异步计算访问的纹理以 CrossQueue 并发共享, 不需要所有权转移
+            state            = {};
+            state.writeStage = info.stage;
+            state.queue      = queue;
+        }
+        state.values[queue] = SUBMISSION_PENDING;
+
+        if (isWriteAccess(access) || layoutChange)
+        {
+            // 写或布局转换需要等待上一次写以及其后的所有读
+            RHIPipelineStageFlags srcStage = state.writeStage | state.readStages;
+            RHIAccessFlags srcAccess       = state.writeAccess;
+            if (layoutChange)
+            {
+                cmdList->insertBarrier(texture->getImage(), texture->getFormat(), info.layout, srcStage, srcAccess, info.stage, info.access);
+                ++m_barrierCount;
+            }
+            else if (srcStage)
+            {
+                cmdList->insertMemoryBarrier(srcStage, srcAccess, info.stage, info.access);
+                ++m_barrierCount;
+            }
+
+            if (isWriteAccess(access))
+            {
+                state.writeStage    = info.stage;
+                state.writeAccess   = info.access;
+                state.readStages    = RHIPipelineStageFlagBits::None;
+                state.visibleStages = RHIPipelineStageFlagBits::None;
+                state.visibleAccess = RHIAccessFlagBits::None;
+            }
+            else
+            {
+                state.readStages    = state.readStages | info.stage;
+                state.visibleStages = info.stage;
+                state.visibleAccess = info.access;
+            }
+            return;
+        }
+
+        // 同布局的读只需保证上一次写对当前阶段可见, 已可见则跳过
+        bool visible = ((state.visibleStages & info.stage) == info.stage) &&
+                       ((state.visibleAccess & info.access) == info.access);
+        if (state.writeAccess && !visible)
+        {
+            cmdList->insertMemoryBarrier(state.writeStage, state.writeAccess, info.stage, info.access);
+            ++m_barrierCount;
+            state.visibleStages = state.visibleStages | info.stage;
+            state.visibleAccess = state.visibleAccess | info.access;
+        }
+        state.readStages = state.readStages | info.stage;
+    }
+
+    std::string RenderGraph::dump() const
+    {
+        std::string dot = "digraph RenderGraph\n{\n";
+        dot += "    rankdir=LR;\n";
+        dot += "    node [fontname=\"Helvetica\", fontsize=10];\n";
+
+        for (usize i = 0; i < m_passes.size(); ++i)
+        {
+            Pass const& pass = m_passes[i];
+            dot += std::format("    p{} [shape=box, style=\"{}\", label=\"{}\\n({}{})\"];\n",
+                               i,
+                               pass.alive ? "filled" : "dashed",
+                               pass.name,
+                               passTypeNames[static_cast<usize>(pass.type)],
+                               pass.alive ? "" : ", culled");
+        }
+
+        for (usize i = 0; i < m_textures.size(); ++i)
+        {
+            Texture const& texture = m_textures[i];
+            if (!texture.declared)
+            {
+                continue;
+            }
+            dot += std::format("    t{} [shape=ellipse, style=\"{}\", label=\"{}\\n{}x{}\\nslot {}\"];\n",
+                               i,
+                               texture.output ? "bold" : (texture.desc.transient ? "solid" : "filled"),
+                               texture.desc.name,
+                               texture.desc.width,
+                               texture.desc.height,
+                               texture.slot);
+        }
+
+        for (usize i = 0; i < m_passes.size(); ++i)
+        {
+            for (Access const& access : m_passes[i].accesses)
+            {
+                usize target = static_cast<usize>(access.target);
+                if (access.isWrite)
+                {
+                    dot += std::format("    p{} -> t{} [label=\"{}\"];\n", i, target, accessNames[static_cast<usize>(access.access)]);
+                }
+                else
+                {
+                    dot += std::format("    t{} -> p{} [label=\"{}\"];\n", target, i, accessNames[static_cast<usize>(access.access)]);
+                }
+            }
+        }
+
+        dot += "}\n";
+        return dot;
+    }
+
+    bool RenderGraph::dumpToFile(std::filesystem::path const& path) const
+    {
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            WS_LOG_WARN("RenderGraph", "Failed to open {}", path.string());
+            return false;
+        }
+
+        file << dump();
+        WS_LOG_INFO("RenderGraph", "Dumped to {}", path.string());
+        return true;
+    }
+
+} // namespace worse
@@ -1,17 +1,25 @@
 #include "imgui.h"
 
+#include "RHIDevice.hpp"
 #include "RHICommandList.hpp"
 #include "RHITexture.hpp"
 #include "RHIBuffer.hpp"
 #include "Renderer.hpp"
 #include "RendererBuffer.hpp"
+#include "RenderGraph.hpp"
 namespace worse
 {
 
     namespace
     {
         PushConstantData pushConstantData = {};
-    }
+
+        RenderGraph renderGraph;
+
+        // 当前帧的资源, 在 produceFrame 开始时设置供 pass 回调使用
+        DrawcallStorage* frameDrawcalls = nullptr;
+        AssetServer* frameAssetServer   = nullptr;
+    } // namespace
 
     void Renderer::setPushParameters(f32 a, f32 b)
     {
@@ -20,23 +28,7 @@ namespace worse
 
     void Renderer::passDepthPrepass(RHICommandList* cmdList, ecs::Resource<DrawcallStorage> drawcalls)
     {
-        RHITexture* depthTexture = Renderer::getRenderTarget(RendererTarget::DepthGBuffer);
-
-        cmdList->setPipelineState(
-            RHIPipelineStateBuilder()
-                .setName("DepthPrepass")
-                .setType(RHIPipelineType::Graphics)
-                .setPrimitiveTopology(RHIPrimitiveTopology::TriangleList)
-                .setRasterizerState(Renderer::getRasterizerState(RendererRasterizerState::DepthPrepass))
-                .setDepthStencilState(Renderer::getDepthStencilState(RendererDepthStencilState::ReadWrite))
-                .setBlendState(Renderer::getBlendState(RendererBlendState::Off))
-                .addShader(Renderer::getShader(RendererShader::DepthPrepassV))
-                .addShader(Renderer::getShader(RendererShader::DepthPrepassP))
-                .setRenderTargetDepthTexture(depthTexture)
-                .setScissor({0, 0, depthTexture->getWidth(), depthTexture->getHeight()})
-                .setViewport(Renderer::getViewport())
-                .setClearDepth(0.0f) // clear with far value
-                .build());
+        cmdList->setPipelineState(Renderer::getPipelineState(RendererPSO::DepthPrepass));
 
         for (Drawcall const& drawcall : drawcalls->solid)
         {
@@ -64,29 +56,11 @@ namespace worse
         }
 
         cmdList->renderPassEnd();
-
-        cmdList->insertBarrier(depthTexture->getImage(), depthTexture->getFormat(), RHIImageLayout::ShaderRead, RHIPipelineStageFlagBits::AllGraphics, RHIAccessFlagBits::MemoryWrite, RHIPipelineStageFlagBits::AllGraphics, RHIAccessFlagBits::MemoryRead);
     }
 
     void Renderer::passShadowMap(RHICommandList* cmdList, ecs::Resource<DrawcallStorage> drawcalls)
     {
-        RHITexture* depthLight = Renderer::getRenderTarget(RendererTarget::DepthLight);
-
-        cmdList->setPipelineState(
-            RHIPipelineStateBuilder()
-                .setName("DepthLight")
-                .setType(RHIPipelineType::Graphics)
-                .setPrimitiveTopology(RHIPrimitiveTopology::TriangleList)
-                .setRasterizerState(Renderer::getRasterizerState(RendererRasterizerState::SolidCullBack))
-                .setDepthStencilState(Renderer::getDepthStencilState(RendererDepthStencilState::ReadWrite))
-                .setBlendState(Renderer::getBlendState(RendererBlendState::Off))
-                .addShader(Renderer::getShader(RendererShader::DepthLightV))
-                .addShader(Renderer::getShader(RendererShader::DepthLightP))
-                .setRenderTargetDepthTexture(depthLight)
-                .setScissor({0, 0, depthLight->getWidth(), depthLight->getHeight()})
-                .setViewport(Renderer::getViewport())
-                .setClearDepth(0.0f) // clear with far value
-                .build());
+        cmdList->setPipelineState(Renderer::getPipelineState(RendererPSO::DepthLight));
 
         static math::Matrix4 lightSpaceMatrix =
             math::projectionOrtho(-10.0f, 10.0f, -10.0f, 10.0f, 1.0f, 100.0f) *
@@ -122,39 +96,11 @@ namespace worse
         }
 
         cmdList->renderPassEnd();
-
-        cmdList->insertBarrier(depthLight->getImage(), depthLight->getFormat(), RHIImageLayout::ShaderRead, RHIPipelineStageFlagBits::FragmentShader, RHIAccessFlagBits::ShaderWrite, RHIPipelineStageFlagBits::ComputeShader, RHIAccessFlagBits::ShaderSampledRead);
     }
 
     void Renderer::passGBuffer(RHICommandList* cmdList, ecs::Resource<DrawcallStorage> drawcalls, ecs::Resource<AssetServer> assetServer)
     {
-        RHITexture* gbufferAlbedo   = Renderer::getRenderTarget(RendererTarget::GBufferAlbedo);
-        RHITexture* gbufferNormal   = Renderer::getRenderTarget(RendererTarget::GBufferNormal);
-        RHITexture* gbufferMaterial = Renderer::getRenderTarget(RendererTarget::GBufferMaterial);
-        RHITexture* depthTexture    = Renderer::getRenderTarget(RendererTarget::DepthGBuffer);
-        RHITexture* depthLight      = Renderer::getRenderTarget(RendererTarget::DepthLight);
-        RHITexture* gbufferPosition = Renderer::getRenderTarget(RendererTarget::GBufferPosition);
-
-        cmdList->setPipelineState(
-            RHIPipelineStateBuilder()
-                .setName("GBuffer")
-                .setType(RHIPipelineType::Graphics)
-                .setPrimitiveTopology(RHIPrimitiveTopology::TriangleList)
-                .setRasterizerState(Renderer::getRasterizerState(RendererRasterizerState::SolidCullBack))
-                .setDepthStencilState(Renderer::getDepthStencilState(RendererDepthStencilState::ReadGreaterEqual))
-                .setBlendState(Renderer::getBlendState(RendererBlendState::Off))
-                .addShader(Renderer::getShader(RendererShader::GBufferV))
-                .addShader(Renderer::getShader(RendererShader::GBufferP))
-                .setRenderTargetColorTexture(0, gbufferAlbedo)
-                .setRenderTargetColorTexture(1, gbufferNormal)
-                .setRenderTargetColorTexture(2, gbufferMaterial)
-                .setRenderTargetColorTexture(3, gbufferPosition)
-                .setRenderTargetDepthTexture(depthTexture)
-                .setScissor({0, 0, gbufferAlbedo->getWidth(), gbufferAlbedo->getHeight()})
-                .setViewport(Renderer::getViewport())
-                .setClearColor(Color{0.02f, 0.02f, 0.02f, 1.0f})
-                .setClearDepth(2.0f)
-                .build());
+        cmdList->setPipelineState(Renderer::getPipelineState(RendererPSO::GBuffer));
 
         // 材质缓冲
         std::array updates = {
@@ -199,22 +145,7 @@ namespace worse
             cmdList->drawIndexed(object.indexCount, object.startIndex, 0, 0, 1);
         }
 
-        cmdList->setPipelineState(
-            RHIPipelineStateBuilder()
-                .setName("Point")
-                .setType(RHIPipelineType::Graphics)
-                .setPrimitiveTopology(RHIPrimitiveTopology::PointList)
-                .setRasterizerState(Renderer::getRasterizerState(RendererRasterizerState::SolidCullBack))
-                .setDepthStencilState(Renderer::getDepthStencilState(RendererDepthStencilState::ReadGreaterEqual))
-                .setBlendState(Renderer::getBlendState(RendererBlendState::Off))
-                .addShader(Renderer::getShader(RendererShader::PointV))
-                .addShader(Renderer::getShader(RendererShader::PointP))
-                .setRenderTargetColorTexture(0, gbufferAlbedo)
-                .setRenderTargetDepthTexture(depthTexture)
-                .setScissor({0, 0, gbufferAlbedo->getWidth(), gbufferAlbedo->getHeight()})
-                .setViewport(Renderer::getViewport())
-                .setClearDepth(2.0f)
-                .build());
+        cmdList->setPipelineState(Renderer::getPipelineState(RendererPSO::Point));
 
         for (Drawcall const& drawcall : drawcalls->point)
         {
@@ -233,10 +164,6 @@ namespace worse
         }
 
         cmdList->renderPassEnd();
-
-        cmdList->insertBarrier(gbufferAlbedo->getImage(), gbufferAlbedo->getFormat(), RHIImageLayout::ShaderRead, RHIPipelineStageFlagBits::FragmentShader, RHIAccessFlagBits::ShaderWrite, RHIPipelineStageFlagBits::ComputeShader, RHIAccessFlagBits::ShaderSampledRead);
-        cmdList->insertBarrier(gbufferNormal->getImage(), gbufferNormal->getFormat(), RHIImageLayout::ShaderRead, RHIPipelineStageFlagBits::FragmentShader, RHIAccessFlagBits::ShaderWrite, RHIPipelineStageFlagBits::ComputeShader, RHIAccessFlagBits::ShaderSampledRead);
-        cmdList->insertBarrier(gbufferMaterial->getImage(), gbufferMaterial->getFormat(), RHIImageLayout::ShaderRead, RHIPipelineStageFlagBits::FragmentShader, RHIAccessFlagBits::ShaderWrite, RHIPipelineStageFlagBits::ComputeShader, RHIAccessFlagBits::ShaderSampledRead);
     }
 
     void Renderer::passLight(RHICommandList* cmdList)
@@ -248,14 +175,7 @@ namespace worse
         RHITexture* depthLight      = Renderer::getRenderTarget(RendererTarget::DepthLight);
         RHITexture* scene           = Renderer::getRenderTarget(RendererTarget::SceneHDR);
 
-        cmdList->insertBarrier(scene->getImage(), scene->getFormat(), RHIImageLayout::General, RHIPipelineStageFlagBits::TopOfPipe, RHIAccessFlagBits::None, RHIPipelineStageFlagBits::ComputeShader, RHIAccessFlagBits::ShaderStorageWrite);
-
-        cmdList->setPipelineState(
-            RHIPipelineStateBuilder()
-                .setName("Light")
-                .setType(RHIPipelineType::Compute)
-                .addShader(Renderer::getShader(RendererShader::LightC))
-                .build());
+        cmdList->setPipelineState(Renderer::getPipelineState(RendererPSO::Light));
 
         std::array updates = {
             RHIDescriptorWrite{.reg      = 0, // t0
@@ -293,22 +213,7 @@ namespace worse
 
     void Renderer::passDebugWireFrame(RHICommandList* cmdList, ecs::Resource<DrawcallStorage> drawcalls)
     {
-        RHITexture* screenHDR = Renderer::getRenderTarget(RendererTarget::ScreenHDR);
-
-        cmdList->setPipelineState(
-            RHIPipelineStateBuilder()
-                .setName("WireFrame")
-                .setType(RHIPipelineType::Graphics)
-                .setPrimitiveTopology(RHIPrimitiveTopology::TriangleList)
-                .setRasterizerState(Renderer::getRasterizerState(RendererRasterizerState::Wireframe))
-                .setDepthStencilState(Renderer::getDepthStencilState(RendererDepthStencilState::Off))
-                .setBlendState(Renderer::getBlendState(RendererBlendState::Off))
-                .addShader(Renderer::getShader(RendererShader::LineV))
-                .addShader(Renderer::getShader(RendererShader::LineP))
-                .setRenderTargetColorTexture(0, screenHDR) // 渲染到后处理之后
-                .setScissor({0, 0, screenHDR->getWidth(), screenHDR->getHeight()})
-                .setViewport(Renderer::getViewport())
-                .build());
+        cmdList->setPipelineState(Renderer::getPipelineState(RendererPSO::WireFrame));
 
         for (Drawcall const& drawcall : drawcalls->solid)
         {
@@ -338,28 +243,12 @@ namespace worse
         cmdList->renderPassEnd();
     }
 
-    void Renderer::passBloom(RHICommandList* cmdList)
+    void Renderer::passBloomLuminance(RHICommandList* cmdList)
     {
-        RHITexture* scene = Renderer::getRenderTarget(RendererTarget::SceneHDR);
-
+        RHITexture* scene        = Renderer::getRenderTarget(RendererTarget::SceneHDR);
         RHITexture* bloomInitial = Renderer::getRenderTarget(RendererTarget::BloomInitial);
-        RHITexture* bloomStage0  = Renderer::getRenderTarget(RendererTarget::BloomDownSampleStage0);
-        RHITexture* bloomStage1  = Renderer::getRenderTarget(RendererTarget::BloomDownSampleStage1);
-        RHITexture* bloomStage2  = Renderer::getRenderTarget(RendererTarget::BloomDownSampleStage2);
-        RHITexture* bloomStage3  = Renderer::getRenderTarget(RendererTarget::BloomDownSampleStage3);
-        RHITexture* bloomFinal   = Renderer::getRenderTarget(RendererTarget::BloomFinal);
-
-        // Downsample
-        // Scene -> Stage0 | x2
-        cmdList->insertBarrier(scene->getImage(), scene->getFormat(), RHIImageLayout::ShaderRead, RHIPipelineStageFlagBits::FragmentShader, RHIAccessFlagBits::ShaderWrite, RHIPipelineStageFlagBits::ComputeShader, RHIAccessFlagBits::ShaderSampledRead);
-        cmdList->insertBarrier(bloomInitial->getImage(), bloomInitial->getFormat(), RHIImageLayout::General, RHIPipelineStageFlagBits::TopOfPipe, RHIAccessFlagBits::MemoryRead, RHIPipelineStageFlagBits::ComputeShader, RHIAccessFlagBits::ShaderStorageWrite);
 
-        cmdList->setPipelineState(
-            RHIPipelineStateBuilder()
-                .setName("BloomLuminance")
-                .setType(RHIPipelineType::Compute)
-                .addShader(Renderer::getShader(RendererShader::BloomLuminanceC))
-                .build());
+        cmdList->setPipelineState(Renderer::getPipelineState(RendererPSO::BloomLuminance));
 
         std::array updatesBrightFilter = {
             RHIDescriptorWrite{.reg      = 0, // t0
@@ -371,29 +260,46 @@ namespace worse
         };
         cmdList->updateSpecificSet(updatesBrightFilter);
         cmdList->dispatch(bloomInitial->getWidth() / 8, bloomInitial->getHeight() / 8, 1);
+    }
+
+    void Renderer::passBloomDownsample(RHICommandList* cmdList)
+    {
+        RHITexture* bloomInitial = Renderer::getRenderTarget(RendererTarget::BloomInitial);
+        RHITexture* bloomStage0  = Renderer::getRenderTarget(RendererTarget::BloomDownSampleStage0);
+        RHITexture* bloomStage1  = Renderer::getRenderTarget(RendererTarget::BloomDownSampleStage1);
+        RHITexture* bloomStage2  = Renderer::getRenderTarget(RendererTarget::BloomDownSampleStage2);
+        RHITexture* bloomStage3  = Renderer::getRenderTarget(RendererTarget::BloomDownSampleStage3);
+
+        // 链内每一级既是上一次 blit 的目标又是下一次的源, 帧图只负责入口状态,
+        // 级间的写后读在此处同步
+        auto nextSource = [cmdList](RHITexture* stage)
+        {
+            cmdList->insertBarrier(stage->getImage(), stage->getFormat(), RHIImageLayout::TransferSource, RHIPipelineStageFlagBits::Transfer, RHIAccessFlagBits::TransferWrite, RHIPipelineStageFlagBits::Transfer, RHIAccessFlagBits::TransferRead);
+        };
 
         // Initial -> Stage0 | x2
         cmdList->blit(bloomInitial, bloomStage0);
         // Stage0 -> Stage1 | x4
+        nextSource(bloomStage0);
         cmdList->blit(bloomStage0, bloomStage1);
         // Stage1 -> Stage2 | x8
+        nextSource(bloomStage1);
         cmdList->blit(bloomStage1, bloomStage2);
         // Stage2 -> Stage3 | x16
+        nextSource(bloomStage2);
         cmdList->blit(bloomStage2, bloomStage3);
+    }
+
+    void Renderer::passBloomUpscale(RHICommandList* cmdList)
+    {
+        RHITexture* bloomStage0 = Renderer::getRenderTarget(RendererTarget::BloomDownSampleStage0);
+        RHITexture* bloomStage1 = Renderer::getRenderTarget(RendererTarget::BloomDownSampleStage1);
+        RHITexture* bloomStage2 = Renderer::getRenderTarget(RendererTarget::BloomDownSampleStage2);
+        RHITexture* bloomStage3 = Renderer::getRenderTarget(RendererTarget::BloomDownSampleStage3);
+        RHITexture* bloomFinal  = Renderer::getRenderTarget(RendererTarget::BloomFinal);
 
         // Upsacle and Additive blend
-        cmdList->insertBarrier(bloomStage0->getImage(), bloomStage0->getFormat(), RHIImageLayout::ShaderRead, RHIPipelineStageFlagBits::Transfer, RHIAccessFlagBits::TransferRead, RHIPipelineStageFlagBits::ComputeShader, RHIAccessFlagBits::ShaderSampledRead);
-        cmdList->insertBarrier(bloomStage1->getImage(), bloomStage1->getFormat(), RHIImageLayout::ShaderRead, RHIPipelineStageFlagBits::Transfer, RHIAccessFlagBits::TransferRead, RHIPipelineStageFlagBits::ComputeShader, RHIAccessFlagBits::ShaderSampledRead);
-        cmdList->insertBarrier(bloomStage2->getImage(), bloomStage2->getFormat(), RHIImageLayout::ShaderRead, RHIPipelineStageFlagBits::Transfer, RHIAccessFlagBits::TransferRead, RHIPipelineStageFlagBits::ComputeShader, RHIAccessFlagBits::ShaderSampledRead);
-        cmdList->insertBarrier(bloomStage3->getImage(), bloomStage3->getFormat(), RHIImageLayout::ShaderRead, RHIPipelineStageFlagBits::Transfer, RHIAccessFlagBits::TransferWrite, RHIPipelineStageFlagBits::ComputeShader, RHIAccessFlagBits::ShaderSampledRead);
-        cmdList->insertBarrier(bloomFinal->getImage(), bloomFinal->getFormat(), RHIImageLayout::General, RHIPipelineStageFlagBits::TopOfPipe, RHIAccessFlagBits::None, RHIPipelineStageFlagBits::ComputeShader, RHIAccessFlagBits::ShaderStorageWrite);
-
-        cmdList->setPipelineState(
-            RHIPipelineStateBuilder()
-                .setName("BloomUpscale")
-                .setType(RHIPipelineType::Compute)
-                .addShader(Renderer::getShader(RendererShader::BloomUpscaleC))
-                .build());
+        cmdList->setPipelineState(Renderer::getPipelineState(RendererPSO::BloomUpscale));
 
         std::array updatesUpscale = {
             RHIDescriptorWrite{.reg      = 0, // t0
@@ -422,17 +328,7 @@ namespace worse
         RHITexture* bloom  = Renderer::getRenderTarget(RendererTarget::BloomFinal);
         RHITexture* screen = Renderer::getRenderTarget(RendererTarget::ScreenHDR);
 
-        // 同步
-        cmdList->insertBarrier(scene->getImage(), scene->getFormat(), RHIImageLayout::ShaderRead, RHIPipelineStageFlagBits::FragmentShader, RHIAccessFlagBits::ShaderWrite, RHIPipelineStageFlagBits::ComputeShader, RHIAccessFlagBits::ShaderSampledRead);
-        cmdList->insertBarrier(bloom->getImage(), bloom->getFormat(), RHIImageLayout::ShaderRead, RHIPipelineStageFlagBits::ComputeShader, RHIAccessFlagBits::ShaderStorageWrite, RHIPipelineStageFlagBits::ComputeShader, RHIAccessFlagBits::ShaderSampledRead);
-        cmdList->insertBarrier(screen->getImage(), screen->getFormat(), RHIImageLayout::General, RHIPipelineStageFlagBits::TopOfPipe, RHIAccessFlagBits::MemoryRead, RHIPipelineStageFlagBits::ComputeShader, RHIAccessFlagBits::ShaderStorageWrite);
-
-        cmdList->setPipelineState(
-            RHIPipelineStateBuilder()
-                .setName("PostFX")
-                .setType(RHIPipelineType::Compute)
-                .addShader(Renderer::getShader(RendererShader::PostFXC))
-                .build());
+        cmdList->setPipelineState(Renderer::getPipelineState(RendererPSO::PostFX));
 
         std::array updates = {
             RHIDescriptorWrite{.reg      = 0, // t0
@@ -463,32 +359,144 @@ namespace worse
         cmdList->imguiPassEnd(ImGui::GetDrawData());
     }
 
-    void Renderer::produceFrame(
-        RHICommandList* cmdList,
-        ecs::Resource<GlobalContext> globalContext,
-        ecs::Resource<DrawcallStorage> drawcalls,
-        ecs::Resource<AssetServer> assetServer)
+    void Renderer::createRenderGraph()
     {
-        passDepthPrepass(cmdList, drawcalls);
+        // clang-format off
+        renderGraph.addPass("DepthPrepass", RenderGraphPassType::Graphics,
+            [](RenderGraphBuilder& builder)
+            {
+                builder.write(RendererTarget::DepthGBuffer, RenderGraphAccess::DepthAttachment);
+            },
+            [](RHICommandList* cmdList)
+            {
+                passDepthPrepass(cmdList, ecs::Resource<DrawcallStorage>(frameDrawcalls));
+            });
 
-        passShadowMap(cmdList, drawcalls);
+        renderGraph.addPass("ShadowMap", RenderGraphPassType::Graphics,
+            [](RenderGraphBuilder& builder)
+            {
+                builder.write(RendererTarget::DepthLight, RenderGraphAccess::DepthAttachment);
+            },
+            [](RHICommandList* cmdList)
+            {
+                passShadowMap(cmdList, ecs::Resource<DrawcallStorage>(frameDrawcalls));
+            });
 
-        passGBuffer(cmdList, drawcalls, assetServer);
+        renderGraph.addPass("GBuffer", RenderGraphPassType::Graphics,
+            [](RenderGraphBuilder& builder)
+            {
+                builder.read(RendererTarget::DepthGBuffer, RenderGraphAccess::DepthRead)
+                       .write(RendererTarget::GBufferAlbedo, RenderGraphAccess::ColorAttachment)
+                       .write(RendererTarget::GBufferNormal, RenderGraphAccess::ColorAttachment)
+                       .write(RendererTarget::GBufferMaterial, RenderGraphAccess::ColorAttachment)
+                       .write(RendererTarget::GBufferPosition, RenderGraphAccess::ColorAttachment);
+            },
+            [](RHICommandList* cmdList)
+            {
+                passGBuffer(cmdList, ecs::Resource<DrawcallStorage>(frameDrawcalls), ecs::Resource<AssetServer>(frameAssetServer));
+            });
+
+        renderGraph.addPass("Light", RenderGraphPassType::Compute,
+            [](RenderGraphBuilder& builder)
+            {
+                builder.read(RendererTarget::GBufferAlbedo)
+                       .read(RendererTarget::GBufferNormal)
+                       .read(RendererTarget::GBufferMaterial)
+                       .read(RendererTarget::DepthGBuffer)
+                       .read(RendererTarget::DepthLight)
+                       .write(RendererTarget::SceneHDR, RenderGraphAccess::StorageWrite)
+                       .asyncCompute();
+            },
+            passLight);
+
+        renderGraph.addPass("BloomLuminance", RenderGraphPassType::Compute,
+            [](RenderGraphBuilder& builder)
+            {
+                builder.read(RendererTarget::SceneHDR)
+                       .write(RendererTarget::BloomInitial, RenderGraphAccess::StorageWrite)
+                       .asyncCompute();
+            },
+            passBloomLuminance);
+
+        renderGraph.addPass("BloomDownsample", RenderGraphPassType::Transfer,
+            [](RenderGraphBuilder& builder)
+            {
+                builder.read(RendererTarget::BloomInitial, RenderGraphAccess::TransferSource)
+                       .write(RendererTarget::BloomDownSampleStage0, RenderGraphAccess::TransferDestination)
+                       .write(RendererTarget::BloomDownSampleStage1, RenderGraphAccess::TransferDestination)
+                       .write(RendererTarget::BloomDownSampleStage2, RenderGraphAccess::TransferDestination)
+                       .write(RendererTarget::BloomDownSampleStage3, RenderGraphAccess::TransferDestination);
+            },
+            passBloomDownsample);
+
+        renderGraph.addPass("BloomUpscale", RenderGraphPassType::Compute,
+            [](RenderGraphBuilder& builder)
+            {
+                builder.read(RendererTarget::BloomDownSampleStage0)
+                       .read(RendererTarget::BloomDownSampleStage1)
+                       .read(RendererTarget::BloomDownSampleStage2)
+                       .read(RendererTarget::BloomDownSampleStage3)
+                       .write(RendererTarget::BloomFinal, RenderGraphAccess::StorageWrite)
+                       .asyncCompute();
+            },
+            passBloomUpscale);
+
+        renderGraph.addPass("PostFX", RenderGraphPassType::Compute,
+            [](RenderGraphBuilder& builder)
+            {
+                builder.read(RendererTarget::SceneHDR)
+                       .read(RendererTarget::BloomFinal)
+                       .write(RendererTarget::ScreenHDR, RenderGraphAccess::StorageWrite)
+                       .asyncCompute();
+            },
+            passPostProcessing);
+
+        renderGraph.addPass("WireFrame", RenderGraphPassType::Graphics,
+            [](RenderGraphBuilder& builder)
+            {
+                builder.write(RendererTarget::ScreenHDR, RenderGraphAccess::ColorAttachment);
+            },
+            [](RHICommandList* cmdList)
+            {
+                passDebugWireFrame(cmdList, ecs::Resource<DrawcallStorage>(frameDrawcalls));
+            });
+        // clang-format on
 
-        passLight(cmdList);
+        renderGraph.setOutput(RendererTarget::ScreenHDR);
+        renderGraph.setPassEnabled("WireFrame", false);
+    }
 
-        passBloom(cmdList);
+    RenderGraph* Renderer::getRenderGraph()
+    {
+        return &renderGraph;
+    }
 
-        passPostProcessing(cmdList);
+    RHICommandList* Renderer::produceFrame(
+        RHICommandList* cmdList,
+        ecs::Resource<GlobalContext> globalContext,
+        ecs::Resource<DrawcallStorage> drawcalls,
+        ecs::Resource<AssetServer> assetServer)
+    {
+        frameDrawcalls   = &(*drawcalls);
+        frameAssetServer = &(*assetServer);
 
-        if (globalContext->isWireFrameMode)
+        renderGraph.setPassEnabled("WireFrame", globalContext->isWireFrameMode);
+        renderGraph.setAsyncCompute(globalContext->isAsyncComputeMode);
+        if (renderGraph.compile())
         {
-            passDebugWireFrame(cmdList, drawcalls);
+            // 别名布局变化, 重新分配物理纹理, 管线状态引用了旧的渲染目标
+            RHIDevice::queueWaitAll();
+            allocateRendererTargets();
+            createPipelineStates();
         }
 
+        cmdList = renderGraph.execute(cmdList);
+
         // passImGui(cmdList);
 
         drawcalls->ctx.clear();
+
+        return cmdList;
     }
 
-} // namespace worse
\ No newline at end of file
+} // namespace worse
@@ -7,11 +7,17 @@
 #include "RHICommandList.hpp"
 #include "RHIBuffer.hpp"
 #include "RHITexture.hpp"
+#include "RHIUploadQueue.hpp"
 #include "Renderer.hpp"
+#include "RenderGraph.hpp"
 #include "RendererBuffer.hpp"
 #include "AssetServer.hpp"
+#include "Profiling/Stopwatch.hpp"
 
+#include <array>
+#include <vector>
 #include <memory>
+#include <unordered_map>
 
 namespace worse
 {
@@ -19,6 +25,8 @@ namespace worse
     namespace
     {
         u64 frameCount = 0;
+        // slot of per frame resources, frameCount % MAX_FRAMES_IN_FLIGHT
+        u32 frameIndex = 0;
 
         math::Vector2 resolutionRender = math::Vector2{0, 0};
         math::Vector2 resolutionOutput = math::Vector2{0, 0};
@@ -27,7 +35,79 @@ namespace worse
         std::shared_ptr<RHISwapchain> swapchain = nullptr;
         RHICommandList* m_currentCmdList        = nullptr;
 
-        std::shared_ptr<RHIBuffer> frameConstantBuffer = nullptr;
+        // graphics timeline value of the last submission of each frame slot
+        std::array<u64, RHIConfig::MAX_FRAMES_IN_FLIGHT> frameTimelineValues = {};
+        // entries of textureWrites changed by texture upload or eviction,
+        // written with the next frame instead of diffing every slot
+        std::vector<usize> bindlessDirty;
+        // textureWrites was rebuilt, the asset lookup and every slot are stale
+        bool bindlessInvalid = true;
+        // asset handle to its entry in textureWrites
+        std::unordered_map<AssetHandle, usize> bindlessAssetWrites;
+
+        RendererStatistics statistics = {};
+
+        // 异步计算开关的帧时间对比
+        struct FrameTiming
+        {
+            static constexpr u32 SAMPLE_COUNT = 256;
+
+            profiling::Stopwatch stopwatch;
+            f32 accumulatedMs = 0.0f;
+            u32 frameCount    = 0;
+            bool asyncCompute = false;
+
+            void tick(bool const isAsyncCompute)
+            {
+                f32 const elapsed = stopwatch.elapsedMs();
+                stopwatch.reset();
+
+                if (isAsyncCompute != asyncCompute)
+                {
+                    asyncCompute  = isAsyncCompute;
+                    accumulatedMs = 0.0f;
+                    frameCount    = 0;
+                    return;
+                }
+
+                accumulatedMs += elapsed;
+                if (++frameCount == SAMPLE_COUNT)
+                {
+                    f32& average  = asyncCompute ? statistics.frameTimeAsyncMs : statistics.frameTimeMs;
+                    average       = accumulatedMs / SAMPLE_COUNT;
+                    accumulatedMs = 0.0f;
+                    frameCount    = 0;
+                }
+            }
+        } frameTiming;
+
+        // updateBuffers 的 CPU 耗时, 与无绑定纹理数量一起统计
+        struct UpdateBuffersTiming
+        {
+            static constexpr u32 SAMPLE_COUNT = 256;
+
+            f32 accumulatedMs = 0.0f;
+            u32 frameCount    = 0;
+            u32 writeCount    = 0;
+
+            void add(f32 const elapsedMs, u32 const bindlessCount, u32 const descriptorWrites)
+            {
+                accumulatedMs += elapsedMs;
+                writeCount += descriptorWrites;
+                statistics.bindlessTextureCount = bindlessCount;
+                if (++frameCount == SAMPLE_COUNT)
+                {
+                    statistics.updateBuffersMs  = accumulatedMs / SAMPLE_COUNT;
+                    statistics.descriptorWrites = static_cast<f32>(writeCount) / SAMPLE_COUNT;
+                    accumulatedMs               = 0.0f;
+                    frameCount                  = 0;
+                    writeCount                  = 0;
+                }
+            }
+        } updateBuffersTiming;
+
+        // reused every frame to avoid reallocation
+        std::vector<RHIDescriptorWrite> bindlessUpdates;
 
         class RendererResourceProvider : public RHIResourceProvider
         {
@@ -46,11 +126,6 @@ namespace worse
                 return Renderer::getTexture(RendererTexture::Placeholder);
             }
 
-            RHIBuffer* getFrameConstantBuffer() const override
-            {
-                return frameConstantBuffer.get();
-            }
-
             EnumArray<RHISamplerType, RHISampler*> getSamplers() const override
             {
                 EnumArray<RHISamplerType, RHISampler*> samplers;
@@ -95,23 +170,18 @@ namespace worse
 
         // resources
         {
-            FrameConstantData frameConstantData = {};
-            frameConstantBuffer                 = std::make_shared<RHIBuffer>(
-                RHIBufferUsageFlagBits::Uniform,
-                sizeof(FrameConstantData),
-                1,
-                &frameConstantData,
-                true,
-                "frame_constant_buffer");
-
             Renderer::createRasterizerStates();
             Renderer::createDepthStencilStates();
             Renderer::createBlendStates();
+            Renderer::createRenderGraph();
             Renderer::createRendererTarget();
             Renderer::createShaders();
             Renderer::createTextures();
             Renderer::createSamplers();
             Renderer::createStandardMeshes();
+            // shaders compiled in the background while the rest was created
+            Renderer::waitForShaders();
+            Renderer::createPipelineStates();
         }
 
         RHIDevice::setResourceProvider(&resourceProvider);
@@ -128,7 +198,6 @@ namespace worse
     {
         RHIDevice::queueWaitAll();
         {
-            frameConstantBuffer.reset();
 
             destroyResources();
             swapchain.reset();
@@ -155,13 +224,35 @@ namespace worse
         swapchain->acquireNextImage();
 
         RHIQueue* graphicsQueue = RHIDevice::getQueue(RHIQueueType::Graphics);
-        m_currentCmdList        = graphicsQueue->nextCommandList();
+
+        // a frame may use several command lists, wait for the frame that used
+        // the same per frame resources explicitly, at most
+        // MAX_FRAMES_IN_FLIGHT - 1 older frames keep running on the GPU
+        frameIndex = static_cast<u32>(frameCount % RHIConfig::MAX_FRAMES_IN_FLIGHT);
+        graphicsQueue->waitTimeline(frameTimelineValues[frameIndex]);
+        // the frame slot retired, reclaim its upload memory
+        RHIDevice::getUploadRing()->beginFrame(frameIndex);
+        // destroy resources released by frames the GPU finished
+        RHIDevice::deletionQueueCollect();
+        frameTiming.tick(globalContext->isAsyncComputeMode);
+
+        // no command list is recording, safe to replace pipeline states
+        Renderer::reloadShaders();
+        // before the upload flush, reloaded textures join this frame's batch
+        Renderer::updateTextureResidency(drawcalls, camera, textureWrites, assetServer);
+
+        m_currentCmdList = graphicsQueue->nextCommandList();
         m_currentCmdList->begin();
 
+        // submit uploads recorded since the last frame, the frame starts
+        // after they landed and takes ownership of the uploaded resources,
+        // later work follows the graphics queue
+        RHIDevice::getUploadQueue()->flush(m_currentCmdList);
+
         updateBuffers(m_currentCmdList, camera, globalContext, textureWrites);
 
-        // render passes
-        produceFrame(m_currentCmdList, globalContext, drawcalls, assetServer);
+        // render passes, async compute may switch to another command list
+        m_currentCmdList = produceFrame(m_currentCmdList, globalContext, drawcalls, assetServer);
 
         // 将渲染结果拷贝到交换链图像
         blitToBackBuffer(m_currentCmdList);
@@ -171,9 +262,92 @@ namespace worse
         // [Present] wait rendering semaphore(CommandList)
         Renderer::submitAndPresent();
 
+        frameTimelineValues[frameIndex] = graphicsQueue->getTimelineValue();
+        // resources released during this frame wait for its submissions
+        RHIDevice::deletionQueueEndFrame();
         ++frameCount;
     } // namespace worse
 
+    void Renderer::updateTextureResidency(
+        ecs::Resource<DrawcallStorage> drawcalls,
+        ecs::Resource<Camera> camera,
+        ecs::ResourceArray<TextureWrite> textureWrites,
+        ecs::Resource<AssetServer> assetServer)
+    {
+        // texel demand is estimated on the CPU: a texture mapped once across
+        // an object wants about as many texels as the pixels its bounding
+        // sphere covers on screen
+        f32 const pixelsPerUnit = viewport.height / (2.0f * std::tan(camera->getFovY() * 0.5f));
+        for (RenderObject const& object : drawcalls->ctx.opaqueObjects)
+        {
+            math::BoundingBox const& box = object.mesh->getBoundingBox();
+            math::Vector3 const center   = (object.transform * math::Vector4(box.getCenter(), 1.0f)).xyz();
+            f32 const scale              = std::max({math::length(object.transform.col0.xyz()),
+                                                     math::length(object.transform.col1.xyz()),
+                                                     math::length(object.transform.col2.xyz())});
+            f32 const radius             = math::length(box.getExtent()) * scale;
+            f32 const distance           = std::max(math::length(center - camera->getPosition()) - radius, 0.01f);
+
+            f32 const pixels = std::min(2.0f * radius * pixelsPerUnit / distance, 16384.0f);
+            assetServer->touchMaterial(object.material, frameCount, static_cast<u32>(pixels));
+        }
+
+        // dispatch queued loads and streams, pick up finished ones, evicted
+        // textures touched this frame were queued again
+        assetServer->loadTexture();
+        assetServer->evictTextures(frameCount);
+
+        // bindless slots point at the resident texture, the error texture
+        // while it loads, or a placeholder, streamed chains swap in here
+        auto bindTexture = [&assetServer](TextureWrite& write)
+        {
+            RHITexture* texture = assetServer->getBindableTexture(write.asset);
+            write.texture       = texture ? texture : Renderer::getTexture(RendererTexture::Placeholder);
+        };
+
+        std::vector<AssetHandle> const changes = assetServer->takeResidencyChanges();
+        std::vector<TextureWrite>& writes      = textureWrites->data();
+        if (bindlessInvalid)
+        {
+            // every slot is written anyway, earlier changes are covered
+            bindlessAssetWrites.clear();
+            for (usize i = 0; i < writes.size(); ++i)
+            {
+                if (writes[i].asset != 0)
+                {
+                    bindlessAssetWrites[writes[i].asset] = i;
+                    bindTexture(writes[i]);
+                }
+            }
+            return;
+        }
+
+        for (AssetHandle const handle : changes)
+        {
+            auto it = bindlessAssetWrites.find(handle);
+            if ((it != bindlessAssetWrites.end()) && (it->second < writes.size()))
+            {
+                bindTexture(writes[it->second]);
+                bindlessDirty.push_back(it->second);
+            }
+        }
+    }
+
+    u64 Renderer::getFrameCount()
+    {
+        return frameCount;
+    }
+
+    RendererStatistics const& Renderer::getStatistics()
+    {
+        return statistics;
+    }
+
+    u32 Renderer::getFrameIndex()
+    {
+        return frameIndex;
+    }
+
     RHISwapchain* Renderer::getSwapchain()
     {
         return swapchain.get();
@@ -181,6 +355,8 @@ namespace worse
 
     void Renderer::blitToBackBuffer(RHICommandList* cmdList)
     {
+        // with async compute this waits for PostFX at the transfer stage only
+        getRenderGraph()->access(cmdList, RendererTarget::ScreenHDR, RenderGraphPassType::Transfer, RenderGraphAccess::TransferSource);
         cmdList->blit(getRenderTarget(RendererTarget::ScreenHDR), swapchain.get());
     }
 
@@ -189,41 +365,74 @@ namespace worse
         if (m_currentCmdList->getState() == RHICommandListState::Recording)
         {
             m_currentCmdList->insertBarrier(swapchain->getCurrentRt(), RHIFormat::B8R8G8A8Unorm, RHIImageLayout::PresentSource, RHIPipelineStageFlagBits::AllCommands, RHIAccessFlagBits::MemoryWrite, RHIPipelineStageFlagBits::BottomOfPipe, RHIAccessFlagBits::MemoryRead);
-            m_currentCmdList->submit(swapchain->getImageAcquireSemaphore());
+            // only the blit writes the swapchain image, the next frame's work
+            // queued behind this submission does not wait for the acquire
+            m_currentCmdList->submit(swapchain->getImageAcquireSemaphore(), RHIPipelineStageFlagBits::Transfer);
             swapchain->present(m_currentCmdList);
         }
     }
 
     void Renderer::writeBindlessTextures(ecs::ResourceArray<TextureWrite> textureWrites)
     {
-        std::vector<RHIDescriptorWrite> updates;
-        updates.reserve(static_cast<usize>(RendererTexture::Max) + textureWrites->data().size());
-
-        // builtin textures (0-5)
-        // clang-format off
-        updates.emplace_back(0, 0, RHIDescriptorResource{Renderer::getTexture(RendererTexture::Placeholder)},             RHIDescriptorType::Texture);
-        updates.emplace_back(0, 1, RHIDescriptorResource{Renderer::getTexture(RendererTexture::DefaultAlbedo)},           RHIDescriptorType::Texture);
-        updates.emplace_back(0, 2, RHIDescriptorResource{Renderer::getTexture(RendererTexture::DefaultNormal)},           RHIDescriptorType::Texture);
-        updates.emplace_back(0, 3, RHIDescriptorResource{Renderer::getTexture(RendererTexture::DefaultMetallicRoughness)},         RHIDescriptorType::Texture);
-        updates.emplace_back(0, 4, RHIDescriptorResource{Renderer::getTexture(RendererTexture::DefaultAmbientOcclusion)}, RHIDescriptorType::Texture);
-        updates.emplace_back(0, 5, RHIDescriptorResource{Renderer::getTexture(RendererTexture::DefaultEmissive)},         RHIDescriptorType::Texture);
-        
-        // dynamic textures
-        for (auto const& textureWrite : textureWrites->data())
-        {   
-            updates.emplace_back(0, textureWrite.index, RHIDescriptorResource{textureWrite.texture}, RHIDescriptorType::Texture);
+        std::vector<RHIDescriptorWrite>& updates = bindlessUpdates;
+        updates.clear();
+
+        std::vector<TextureWrite> const& writes = textureWrites->data();
+        if (bindlessInvalid)
+        {
+            bindlessInvalid = false;
+            bindlessDirty.clear();
+            updates.reserve(static_cast<usize>(RendererTexture::Max) + writes.size());
+
+            // builtin textures (0-5)
+            // clang-format off
+            updates.emplace_back(0, 0, RHIDescriptorResource{Renderer::getTexture(RendererTexture::Placeholder)},             RHIDescriptorType::Texture);
+            updates.emplace_back(0, 1, RHIDescriptorResource{Renderer::getTexture(RendererTexture::DefaultAlbedo)},           RHIDescriptorType::Texture);
+            updates.emplace_back(0, 2, RHIDescriptorResource{Renderer::getTexture(RendererTexture::DefaultNormal)},           RHIDescriptorType::Texture);
+            updates.emplace_back(0, 3, RHIDescriptorResource{Renderer::getTexture(RendererTexture::DefaultMetallicRoughness)}, RHIDescriptorType::Texture);
+            updates.emplace_back(0, 4, RHIDescriptorResource{Renderer::getTexture(RendererTexture::DefaultAmbientOcclusion)}, RHIDescriptorType::Texture);
+            updates.emplace_back(0, 5, RHIDescriptorResource{Renderer::getTexture(RendererTexture::DefaultEmissive)},         RHIDescriptorType::Texture);
+            // clang-format on
+
+            // dynamic textures
+            for (TextureWrite const& write : writes)
+            {
+                updates.emplace_back(0, write.index, RHIDescriptorResource{write.texture}, RHIDescriptorType::Texture);
+            }
+        }
+        else
+        {
+            if (bindlessDirty.empty())
+            {
+                return;
+            }
+
+            for (usize const position : bindlessDirty)
+            {
+                if (position < writes.size())
+                {
+                    updates.emplace_back(0, writes[position].index, RHIDescriptorResource{writes[position].texture}, RHIDescriptorType::Texture);
+                }
+            }
+            bindlessDirty.clear();
         }
-        // clang-format on
 
         RHIDevice::updateBindlessTextures(updates);
     }
 
+    void Renderer::invalidateBindlessTextures()
+    {
+        bindlessInvalid = true;
+    }
+
     void Renderer::updateBuffers(
         RHICommandList* cmdList,
         ecs::Resource<Camera> camera,
         ecs::Resource<GlobalContext> globalContext,
         ecs::ResourceArray<TextureWrite> textureWrites)
     {
+        profiling::Stopwatch stopwatch;
+
         // update frame constant data
 
         FrameConstantData frameConstantData     = {};
@@ -236,22 +445,18 @@ namespace worse
         frameConstantData.viewProjection        = frameConstantData.projection * frameConstantData.view;
         frameConstantData.viewProjectionInverse = math::inverse(frameConstantData.viewProjection);
 
-        auto mat = frameConstantData.viewProjection * frameConstantData.viewProjectionInverse;
-
-        m_currentCmdList->updateBuffer(frameConstantBuffer.get(), 0, sizeof(FrameConstantData), &frameConstantData);
+        // the slot is no longer read by GPU, write mapped memory directly
+        RHIUploadAllocation frameConstant = RHIDevice::getUploadRing()->write(&frameConstantData, sizeof(FrameConstantData));
 
         // prepare descriptor
 
-        // 重置描述符池
-        RHIDevice::resetDescriptorAllocator();
-
-        // 重新写入全局描述符集 FrameConstantData
-        RHIDevice::writeGlobalDescriptorSet();
-        // 重新写入纹理数组
+        // 切换到当前帧的常驻描述符集, 帧常量偏移变化时才重写
+        RHIDevice::beginDescriptorFrame(frameIndex, frameConstant);
+        // 纹理数组只写入变化的槽位
         Renderer::writeBindlessTextures(textureWrites);
 
-        // 重置管线特定描述符集
-        RHIDevice::resetSpecificDescriptorSets();
+        u32 const bindlessCount = static_cast<u32>(static_cast<usize>(RendererTexture::Max) + textureWrites->data().size());
+        updateBuffersTiming.add(stopwatch.elapsedMs(), bindlessCount, RHIDevice::getGlobalDescriptorWriteCount());
     }
 
     void Renderer::setViewport(f32 const width, f32 const height)
@@ -1,17 +1,27 @@
 #include "Types.hpp"
 #include "Platform.hpp"
+#include "ThreadPool.hpp"
+#include "FileSystem.hpp"
+#include "FileWatcher.hpp"
+#include "VirtualFileSystem.hpp"
+#include "Profiling/Stopwatch.hpp"
+#include "RHIDevice.hpp"
 #include "RHIBuffer.hpp"
 #include "RHIShader.hpp"
+#include "RHIShaderCache.hpp"
 #include "RHIVertex.hpp"
 #include "RHITexture.hpp"
 #include "RHISampler.hpp"
 #include "Pipeline/RHIBlendState.hpp"
 #include "Pipeline/RHIRasterizerState.hpp"
 #include "Pipeline/RHIDepthStencilState.hpp"
+#include "Pipeline/RHIPipelineState.hpp"
 #include "Renderer.hpp"
+#include "RenderGraph.hpp"
 
 #include <filesystem>
 #include <memory>
+#include <algorithm>
 
 namespace worse
 {
@@ -20,13 +30,211 @@ namespace worse
         EnumArray<RendererRasterizerState, std::unique_ptr<RHIRasterizerState>> rasterizerStates;
         EnumArray<RendererDepthStencilState, std::unique_ptr<RHIDepthStencilState>> depthStencilStates;
         EnumArray<RendererBlendState, std::unique_ptr<RHIBlendState>> blendStates;
-        EnumArray<RendererTarget, std::unique_ptr<RHITexture>> renderTargets;
+        // 不重叠的瞬态目标可能共享同一个物理纹理
+        EnumArray<RendererTarget, std::shared_ptr<RHITexture>> renderTargets;
         EnumArray<RendererShader, std::unique_ptr<RHIShader>> shaders;
+        // 预构建的 pass 管线状态, 哈希与原生管线在创建时确定
+        EnumArray<RendererPSO, std::unique_ptr<RHIPipelineState>> pipelineStates;
         EnumArray<RendererTexture, std::unique_ptr<RHITexture>> textures;
         EnumArray<RHISamplerType, std::unique_ptr<RHISampler>> samplers;
         EnumArray<geometry::GeometryType, std::unique_ptr<Mesh>> standardMeshes;
 
         std::shared_ptr<RHIBuffer> materialBuffer;
+
+        // measures shader compilation from submission to the last finished job
+        profiling::Stopwatch shaderStopwatch;
+        u32 shaderCacheHitBegin  = 0;
+        u32 shaderCacheMissBegin = 0;
+        // 着色器热重载, 新版本在后台编译, 全部完成后在帧边界替换
+        struct ShaderReload
+        {
+            RendererShader id = RendererShader::Max;
+            std::unique_ptr<RHIShader> shader;
+        };
+        std::unique_ptr<FileWatcher> shaderWatcher;
+        std::vector<ShaderReload> shaderReloads;
+        profiling::Stopwatch shaderReloadStopwatch;
+
+#ifdef WS_RENDERER_PSO_BIND_BENCHMARK
+        // per pass bind overhead is measured once, on the first build
+        bool pipelineStateBindMeasured = false;
+#endif
+
+        RHIPipelineState buildPipelineState(RendererPSO const pso)
+        {
+            // clang-format off
+            switch (pso)
+            {
+            case RendererPSO::DepthPrepass:
+            {
+                RHITexture* depthTexture = Renderer::getRenderTarget(RendererTarget::DepthGBuffer);
+                return RHIPipelineStateBuilder()
+                    .setName("DepthPrepass")
+                    .setType(RHIPipelineType::Graphics)
+                    .setPrimitiveTopology(RHIPrimitiveTopology::TriangleList)
+                    .setRasterizerState(Renderer::getRasterizerState(RendererRasterizerState::DepthPrepass))
+                    .setDepthStencilState(Renderer::getDepthStencilState(RendererDepthStencilState::ReadWrite))
+                    .setBlendState(Renderer::getBlendState(RendererBlendState::Off))
+                    .addShader(Renderer::getShader(RendererShader::DepthPrepassV))
+                    .addShader(Renderer::getShader(RendererShader::DepthPrepassP))
+                    .setRenderTargetDepthTexture(depthTexture)
+                    .setScissor({0, 0, depthTexture->getWidth(), depthTexture->getHeight()})
+                    .setViewport(Renderer::getViewport())
+                    .setClearDepth(0.0f) // clear with far value
+                    .build();
+            }
+            case RendererPSO::DepthLight:
+            {
+                RHITexture* depthLight = Renderer::getRenderTarget(RendererTarget::DepthLight);
+                return RHIPipelineStateBuilder()
+                    .setName("DepthLight")
+                    .setType(RHIPipelineType::Graphics)
+                    .setPrimitiveTopology(RHIPrimitiveTopology::TriangleList)
+                    .setRasterizerState(Renderer::getRasterizerState(RendererRasterizerState::SolidCullBack))
+                    .setDepthStencilState(Renderer::getDepthStencilState(RendererDepthStencilState::ReadWrite))
+                    .setBlendState(Renderer::getBlendState(RendererBlendState::Off))
+                    .addShader(Renderer::getShader(RendererShader::DepthLightV))
+                    .addShader(Renderer::getShader(RendererShader::DepthLightP))
+                    .setRenderTargetDepthTexture(depthLight)
+                    .setScissor({0, 0, depthLight->getWidth(), depthLight->getHeight()})
+                    .setViewport(Renderer::getViewport())
+                    .setClearDepth(0.0f) // clear with far value
+                    .build();
+            }
+            case RendererPSO::GBuffer:
+            {
+                RHITexture* gbufferAlbedo = Renderer::getRenderTarget(RendererTarget::GBufferAlbedo);
+                return RHIPipelineStateBuilder()
+                    .setName("GBuffer")
+                    .setType(RHIPipelineType::Graphics)
+                    .setPrimitiveTopology(RHIPrimitiveTopology::TriangleList)
+                    .setRasterizerState(Renderer::getRasterizerState(RendererRasterizerState::SolidCullBack))
+                    .setDepthStencilState(Renderer::getDepthStencilState(RendererDepthStencilState::ReadGreaterEqual))
+                    .setBlendState(Renderer::getBlendState(RendererBlendState::Off))
+                    .addShader(Renderer::getShader(RendererShader::GBufferV))
+                    .addShader(Renderer::getShader(RendererShader::GBufferP))
+                    .setRenderTargetColorTexture(0, gbufferAlbedo)
+                    .setRenderTargetColorTexture(1, Renderer::getRenderTarget(RendererTarget::GBufferNormal))
+                    .setRenderTargetColorTexture(2, Renderer::getRenderTarget(RendererTarget::GBufferMaterial))
+                    .setRenderTargetColorTexture(3, Renderer::getRenderTarget(RendererTarget::GBufferPosition))
+                    .setRenderTargetDepthTexture(Renderer::getRenderTarget(RendererTarget::DepthGBuffer))
+                    .setScissor({0, 0, gbufferAlbedo->getWidth(), gbufferAlbedo->getHeight()})
+                    .setViewport(Renderer::getViewport())
+                    .setClearColor(Color{0.02f, 0.02f, 0.02f, 1.0f})
+                    .setClearDepth(2.0f)
+                    .build();
+            }
+            case RendererPSO::Point:
+            {
+                RHITexture* gbufferAlbedo = Renderer::getRenderTarget(RendererTarget::GBufferAlbedo);
+                return RHIPipelineStateBuilder()
+                    .setName("Point")
+                    .setType(RHIPipelineType::Graphics)
+                    .setPrimitiveTopology(RHIPrimitiveTopology::PointList)
+                    .setRasterizerState(Renderer::getRasterizerState(RendererRasterizerState::SolidCullBack))
+                    .setDepthStencilState(Renderer::getDepthStencilState(RendererDepthStencilState::ReadGreaterEqual))
+                    .setBlendState(Renderer::getBlendState(RendererBlendState::Off))
+                    .addShader(Renderer::getShader(RendererShader::PointV))
+                    .addShader(Renderer::getShader(RendererShader::PointP))
+                    .setRenderTargetColorTexture(0, gbufferAlbedo)
+                    .setRenderTargetDepthTexture(Renderer::getRenderTarget(RendererTarget::DepthGBuffer))
+                    .setScissor({0, 0, gbufferAlbedo->getWidth(), gbufferAlbedo->getHeight()})
+                    .setViewport(Renderer::getViewport())
+                    .setClearDepth(2.0f)
+                    .build();
+            }
+            case RendererPSO::Light:
+                return RHIPipelineStateBuilder()
+                    .setName("Light")
+                    .setType(RHIPipelineType::Compute)
+                    .addShader(Renderer::getShader(RendererShader::LightC))
+                    .build();
+            case RendererPSO::WireFrame:
+            {
+                RHITexture* screenHDR = Renderer::getRenderTarget(RendererTarget::ScreenHDR);
+                return RHIPipelineStateBuilder()
+                    .setName("WireFrame")
+                    .setType(RHIPipelineType::Graphics)
+                    .setPrimitiveTopology(RHIPrimitiveTopology::TriangleList)
+                    .setRasterizerState(Renderer::getRasterizerState(RendererRasterizerState::Wireframe))
+                    .setDepthStencilState(Renderer::getDepthStencilState(RendererDepthStencilState::Off))
+                    .setBlendState(Renderer::getBlendState(RendererBlendState::Off))
+                    .addShader(Renderer::getShader(RendererShader::LineV))
+                    .addShader(Renderer::getShader(RendererShader::LineP))
+                    .setRenderTargetColorTexture(0, screenHDR) // 渲染到后处理之后
+                    .setScissor({0, 0, screenHDR->getWidth(), screenHDR->getHeight()})
+                    .setViewport(Renderer::getViewport())
+                    .build();
+            }
+            case RendererPSO::BloomLuminance:
+                return RHIPipelineStateBuilder()
+                    .setName("BloomLuminance")
+                    .setType(RHIPipelineType::Compute)
+                    .addShader(Renderer::getShader(RendererShader::BloomLuminanceC))
+                    .build();
+            case RendererPSO::BloomUpscale:
+                return RHIPipelineStateBuilder()
+                    .setName("BloomUpscale")
+                    .setType(RHIPipelineType::Compute)
+                    .addShader(Renderer::getShader(RendererShader::BloomUpscaleC))
+                    .build();
+            case RendererPSO::PostFX:
+                return RHIPipelineStateBuilder()
+                    .setName("PostFX")
+                    .setType(RHIPipelineType::Compute)
+                    .addShader(Renderer::getShader(RendererShader::PostFXC))
+                    .build();
+            default:
+                WS_ASSERT_MSG(false, "Unknown renderer pipeline state");
+                return {};
+            }
+            // clang-format on
+        }
+
+#ifdef WS_RENDERER_PSO_BIND_BENCHMARK
+        // 每个 pass 绑定管线状态的 CPU 开销: 旧路径每帧构建 (校验 + 哈希 +
+        // 管线池查找), 新路径只比较句柄指针
+        void measurePipelineStateBind()
+        {
+            constexpr u32 ITERATIONS = 256;
+            constexpr usize PASS_COUNT = static_cast<usize>(RendererPSO::Max);
+
+            u64 sink = 0;
+
+            profiling::Stopwatch stopwatch;
+            for (u32 i = 0; i < ITERATIONS; ++i)
+            {
+                for (usize pass = 0; pass < PASS_COUNT; ++pass)
+                {
+                    RHIPipelineState pso = buildPipelineState(static_cast<RendererPSO>(pass));
+                    sink ^= pso.getHash();
+                }
+            }
+            f32 const rebuildMs = stopwatch.elapsedMs();
+
+            stopwatch.reset();
+            for (u32 i = 0; i < ITERATIONS; ++i)
+            {
+                RHIPipelineState const* bound = nullptr;
+                for (usize pass = 0; pass < PASS_COUNT; ++pass)
+                {
+                    RHIPipelineState const* pso = pipelineStates[pass].get();
+                    if (pso != bound)
+                    {
+                        bound = pso;
+                        sink ^= reinterpret_cast<u64>(pso->getPipeline());
+                    }
+                }
+            }
+            f32 const handleMs = stopwatch.elapsedMs();
+
+            // keep the loops from being optimized away
+            [[maybe_unused]] volatile u64 result = sink;
+
+            f32 const scale = 1000.0f / static_cast<f32>(ITERATIONS * PASS_COUNT);
+            WS_LOG_INFO("Renderer", "PSO bind per pass: rebuild {:.3f}us, handle {:.3f}us", rebuildMs * scale, handleMs * scale);
+        }
+#endif
     } // namespace
 
     void Renderer::createRasterizerStates()
@@ -57,28 +265,55 @@ namespace worse
         u32 width                = static_cast<u32>(resolution.x);
         u32 height               = static_cast<u32>(resolution.y);
 
-        std::vector<RHITextureSlice> dummy;
+        RHITextureViewFlags const colorUsage   = RHITextureViewFlagBits::RenderTargetView | RHITextureViewFlagBits::UnorderedAccessView | RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit;
+        RHITextureViewFlags const gbufferUsage = RHITextureViewFlagBits::RenderTargetView | RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit;
+        RHITextureViewFlags const depthUsage   = RHITextureViewFlagBits::DepthStencilView | RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit;
 
-        renderTargets[RendererTarget::SceneHDR]  = std::make_unique<RHITexture>(RHITextureType::Texture2D, width, height, 1, 1, RHIFormat::R16G16B16A16Float, RHITextureViewFlagBits::RenderTargetView | RHITextureViewFlagBits::UnorderedAccessView | RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit, dummy, "scene_hdr");
-        renderTargets[RendererTarget::ScreenHDR] = std::make_unique<RHITexture>(RHITextureType::Texture2D, width, height, 1, 1, RHIFormat::R16G16B16A16Float, RHITextureViewFlagBits::RenderTargetView | RHITextureViewFlagBits::UnorderedAccessView | RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit, dummy, "screen_hdr");
+        RenderGraph* graph = getRenderGraph();
+        graph->declareTexture(RendererTarget::SceneHDR,  {width, height, RHIFormat::R16G16B16A16Float, colorUsage, "scene_hdr"});
+        graph->declareTexture(RendererTarget::ScreenHDR, {width, height, RHIFormat::R16G16B16A16Float, colorUsage, "screen_hdr", false});
 
         // GBuffer
-        renderTargets[RendererTarget::GBufferPosition] = std::make_unique<RHITexture>(RHITextureType::Texture2D, width, height, 1, 1, RHIFormat::R16G16B16A16Float, RHITextureViewFlagBits::RenderTargetView | RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit, dummy, "gbuffer_position");
-        renderTargets[RendererTarget::GBufferAlbedo]   = std::make_unique<RHITexture>(RHITextureType::Texture2D, width, height, 1, 1, RHIFormat::R16G16B16A16Float, RHITextureViewFlagBits::RenderTargetView | RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit, dummy, "gbuffer_albedo");
-        renderTargets[RendererTarget::GBufferNormal]   = std::make_unique<RHITexture>(RHITextureType::Texture2D, width, height, 1, 1, RHIFormat::R16G16B16A16Float, RHITextureViewFlagBits::RenderTargetView | RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit, dummy, "gbuffer_normal");
-        renderTargets[RendererTarget::GBufferMaterial] = std::make_unique<RHITexture>(RHITextureType::Texture2D, width, height, 1, 1, RHIFormat::R16G16B16A16Float, RHITextureViewFlagBits::RenderTargetView | RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit, dummy, "gbuffer_material");
+        graph->declareTexture(RendererTarget::GBufferPosition, {width, height, RHIFormat::R16G16B16A16Float, gbufferUsage, "gbuffer_position"});
+        graph->declareTexture(RendererTarget::GBufferAlbedo,   {width, height, RHIFormat::R16G16B16A16Float, gbufferUsage, "gbuffer_albedo"});
+        graph->declareTexture(RendererTarget::GBufferNormal,   {width, height, RHIFormat::R16G16B16A16Float, gbufferUsage, "gbuffer_normal"});
+        graph->declareTexture(RendererTarget::GBufferMaterial, {width, height, RHIFormat::R16G16B16A16Float, gbufferUsage, "gbuffer_material"});
 
         // bloom
-        renderTargets[RendererTarget::BloomInitial]          = std::make_unique<RHITexture>(RHITextureType::Texture2D, width, height, 1, 1, RHIFormat::R16G16B16A16Float, RHITextureViewFlagBits::RenderTargetView | RHITextureViewFlagBits::UnorderedAccessView | RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit, dummy, "bloom_initial");
-        renderTargets[RendererTarget::BloomDownSampleStage0] = std::make_unique<RHITexture>(RHITextureType::Texture2D, width / 2, height / 2, 1, 1, RHIFormat::R16G16B16A16Float, RHITextureViewFlagBits::RenderTargetView | RHITextureViewFlagBits::UnorderedAccessView | RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit, dummy, "bloom_downsample_stage0");
-        renderTargets[RendererTarget::BloomDownSampleStage1] = std::make_unique<RHITexture>(RHITextureType::Texture2D, width / 4, height / 4, 1, 1, RHIFormat::R16G16B16A16Float, RHITextureViewFlagBits::RenderTargetView | RHITextureViewFlagBits::UnorderedAccessView | RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit, dummy, "bloom_downsample_stage1");
-        renderTargets[RendererTarget::BloomDownSampleStage2] = std::make_unique<RHITexture>(RHITextureType::Texture2D, width / 8, height / 8, 1, 1, RHIFormat::R16G16B16A16Float, RHITextureViewFlagBits::RenderTargetView | RHITextureViewFlagBits::UnorderedAccessView | RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit, dummy, "bloom_downsample_stage2");
-        renderTargets[RendererTarget::BloomDownSampleStage3] = std::make_unique<RHITexture>(RHITextureType::Texture2D, width / 16, height / 16, 1, 1, RHIFormat::R16G16B16A16Float, RHITextureViewFlagBits::RenderTargetView | RHITextureViewFlagBits::UnorderedAccessView | RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit, dummy, "bloom_downsample_stage3");
-        renderTargets[RendererTarget::BloomFinal]            = std::make_unique<RHITexture>(RHITextureType::Texture2D, width, height, 1, 1, RHIFormat::R16G16B16A16Float, RHITextureViewFlagBits::RenderTargetView | RHITextureViewFlagBits::UnorderedAccessView | RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit, dummy, "bloom_final");
+        graph->declareTexture(RendererTarget::BloomInitial,          {width, height, RHIFormat::R16G16B16A16Float, colorUsage, "bloom_initial"});
+        graph->declareTexture(RendererTarget::BloomDownSampleStage0, {width / 2, height / 2, RHIFormat::R16G16B16A16Float, colorUsage, "bloom_downsample_stage0"});
+        graph->declareTexture(RendererTarget::BloomDownSampleStage1, {width / 4, height / 4, RHIFormat::R16G16B16A16Float, colorUsage, "bloom_downsample_stage1"});
+        graph->declareTexture(RendererTarget::BloomDownSampleStage2, {width / 8, height / 8, RHIFormat::R16G16B16A16Float, colorUsage, "bloom_downsample_stage2"});
+        graph->declareTexture(RendererTarget::BloomDownSampleStage3, {width / 16, height / 16, RHIFormat::R16G16B16A16Float, colorUsage, "bloom_downsample_stage3"});
+        graph->declareTexture(RendererTarget::BloomFinal,            {width, height, RHIFormat::R16G16B16A16Float, colorUsage, "bloom_final"});
 
-        renderTargets[RendererTarget::DepthGBuffer] = std::make_unique<RHITexture>(RHITextureType::Texture2D, width, height, 1, 1, RHIFormat::D32Float, RHITextureViewFlagBits::DepthStencilView | RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit, dummy, "depth_gbuffer");
+        graph->declareTexture(RendererTarget::DepthGBuffer, {width, height, RHIFormat::D32Float, depthUsage, "depth_gbuffer"});
 
-        renderTargets[RendererTarget::DepthLight] = std::make_unique<RHITexture>(RHITextureType::Texture2D, width, height, 1, 1, RHIFormat::D32Float, RHITextureViewFlagBits::DepthStencilView | RHITextureViewFlagBits::ShaderReadView | RHITextureViewFlagBits::ClearOrBlit, dummy, "light_shadow");
+        graph->declareTexture(RendererTarget::DepthLight, {width, height, RHIFormat::D32Float, depthUsage, "light_shadow"});
+
+        graph->compile();
+        allocateRendererTargets();
+    }
+
+    void Renderer::allocateRendererTargets()
+    {
+        std::vector<RHITextureSlice> dummy;
+
+        for (std::shared_ptr<RHITexture>& renderTarget : renderTargets)
+        {
+            renderTarget.reset();
+        }
+
+        for (RenderGraphAliasSlot const& slot : getRenderGraph()->getAliasSlots())
+        {
+            std::shared_ptr<RHITexture> texture = std::make_shared<RHITexture>(RHITextureType::Texture2D, slot.desc.width, slot.desc.height, 1, 1, slot.desc.format, slot.desc.usage, dummy, slot.desc.name);
+            for (RendererTarget const target : slot.targets)
+            {
+                renderTargets[target] = texture;
+            }
+        }
+
+        getRenderGraph()->resetTracking();
     }
 
     void Renderer::createShaders()
@@ -86,11 +321,26 @@ namespace worse
         std::filesystem::path shaderDir = std::filesystem::path{worse::EngineDirectory} / "Shaders";
         WS_LOG_INFO("Renderer", "Shader directory: {}", shaderDir.string());
 
+        // a mounted Shaders.wspak would hide the edited sources, the loose
+        // directory mounted last is searched first and the archive only
+        // serves files missing on disk
+        if (RHIConfig::enableShaderHotReload && FileSystem::isDirectoryExists(shaderDir))
+        {
+            VirtualFileSystem::mount(shaderDir, shaderDir);
+        }
+
+        shaderStopwatch.reset();
+        shaderCacheHitBegin  = RHIShaderCache::getHitCount();
+        shaderCacheMissBegin = RHIShaderCache::getMissCount();
+
+        // every shader is a job on the thread pool, pipelines wait for the
+        // shaders they use when they are finalized
+
 #define MAKE_SHADER_GRAPHICS(shaderName, vertexType)                                                                     \
     shaders[RendererShader::shaderName##V] = std::make_unique<RHIShader>(#shaderName "V");                               \
-    shaders[RendererShader::shaderName##V]->compile(shaderDir / #shaderName ".hlsl", RHIShaderType::Vertex, vertexType); \
+    shaders[RendererShader::shaderName##V]->compileAsync(shaderDir / #shaderName ".hlsl", RHIShaderType::Vertex, vertexType); \
     shaders[RendererShader::shaderName##P] = std::make_unique<RHIShader>(#shaderName "P");                               \
-    shaders[RendererShader::shaderName##P]->compile(shaderDir / #shaderName ".hlsl", RHIShaderType::Pixel);
+    shaders[RendererShader::shaderName##P]->compileAsync(shaderDir / #shaderName ".hlsl", RHIShaderType::Pixel);
 
         MAKE_SHADER_GRAPHICS(Placeholder, RHIVertexType::PosUvNrmTan);
         MAKE_SHADER_GRAPHICS(DepthPrepass, RHIVertexType::PosUvNrmTan);
@@ -103,7 +353,7 @@ namespace worse
 
 #define MAKE_SHADER_COMPUTE(shaderName)                                                    \
     shaders[RendererShader::shaderName##C] = std::make_unique<RHIShader>(#shaderName "C"); \
-    shaders[RendererShader::shaderName##C]->compile(shaderDir / #shaderName ".hlsl", RHIShaderType::Compute);
+    shaders[RendererShader::shaderName##C]->compileAsync(shaderDir / #shaderName ".hlsl", RHIShaderType::Compute);
 
         MAKE_SHADER_COMPUTE(Light);
         MAKE_SHADER_COMPUTE(PostFX);
@@ -111,6 +361,135 @@ namespace worse
         MAKE_SHADER_COMPUTE(BloomUpscale);
 
 #undef MAKE_SHADER_COMPUTE
+
+        if (RHIConfig::enableShaderHotReload)
+        {
+            shaderWatcher = std::make_unique<FileWatcher>();
+            if (!shaderWatcher->watchDirectory(shaderDir))
+            {
+                WS_LOG_WARN("Renderer", "Shader hot reload disabled, can not watch {}", shaderDir.string());
+                shaderWatcher.reset();
+            }
+        }
+    }
+
+    void Renderer::reloadShaders()
+    {
+        if (!shaderWatcher)
+        {
+            return;
+        }
+
+        // recompile every shader whose source or includes changed, the disk
+        // cache keeps untouched permutations cheap
+        std::vector<std::filesystem::path> const changed = shaderWatcher->poll();
+        if (!changed.empty())
+        {
+            EnumArray<RendererShader, bool> queued = {};
+            for (std::filesystem::path const& path : changed)
+            {
+                for (usize i = 0; i < shaders.size(); ++i)
+                {
+                    RHIShader const* shader = shaders[i].get();
+                    if (!shader || queued[i])
+                    {
+                        continue;
+                    }
+
+                    std::vector<std::filesystem::path> const& dependencies = shader->getDependencies();
+                    if (std::find(dependencies.begin(), dependencies.end(), path) == dependencies.end())
+                    {
+                        continue;
+                    }
+
+                    if (shaderReloads.empty())
+                    {
+                        shaderReloadStopwatch.reset();
+                    }
+
+                    ShaderReload& reload = shaderReloads.emplace_back();
+                    reload.id            = static_cast<RendererShader>(i);
+                    reload.shader        = std::make_unique<RHIShader>(shader->getName());
+                    reload.shader->compileAsync(shader->getPath(), shader->getShaderType(), shader->getVertexType());
+                    queued[i] = true;
+                }
+            }
+        }
+
+        // swap only when the whole batch is done, so passes never mix old
+        // and new versions
+        bool const isPending = std::any_of(shaderReloads.begin(),
+                                           shaderReloads.end(),
+                                           [](ShaderReload const& reload)
+                                           {
+                                               return reload.shader->getState() == RHIShaderCompilationState::Compiling;
+                                           });
+        if (shaderReloads.empty() || isPending)
+        {
+            return;
+        }
+
+        u32 reloadedCount = 0;
+        u32 evictedCount  = 0;
+        // later saves of the same file come later in the batch and win
+        for (ShaderReload& reload : shaderReloads)
+        {
+            std::unique_ptr<RHIShader>& current = shaders[reload.id];
+            if (reload.shader->getState() != RHIShaderCompilationState::CompiledSuccess)
+            {
+                WS_LOG_ERROR("Renderer", "Failed to reload {}, keep the previous version", current->getPath().string());
+                continue;
+            }
+
+            evictedCount += RHIDevice::evictPipelines(current->getPath());
+            // the old shader module goes through the deletion queue
+            current = std::move(reload.shader);
+            ++reloadedCount;
+        }
+        shaderReloads.clear();
+
+        if (reloadedCount > 0)
+        {
+            // handles still point at evicted pipelines and old shaders
+            createPipelineStates();
+
+            WS_LOG_INFO("Renderer", "Reloaded {} shaders, {} pipelines in {:.1f}ms", reloadedCount, evictedCount, shaderReloadStopwatch.elapsedMs());
+        }
+    }
+
+    void Renderer::waitForShaders()
+    {
+        for (std::unique_ptr<RHIShader> const& shader : shaders)
+        {
+            if (shader)
+            {
+                shader->waitForCompilation();
+            }
+        }
+
+        // cold start compiles everything, warm start only loads the cache
+        WS_LOG_INFO("Renderer",
+                    "Shaders ready in {:.1f}ms on {} threads, cache hit {}, miss {}",
+                    shaderStopwatch.elapsedMs(),
+                    std::max(ThreadPool::getThreadCount(), 1u),
+                    RHIShaderCache::getHitCount() - shaderCacheHitBegin,
+                    RHIShaderCache::getMissCount() - shaderCacheMissBegin);
+    }
+
+    void Renderer::createPipelineStates()
+    {
+        for (usize i = 0; i < pipelineStates.size(); ++i)
+        {
+            pipelineStates[i] = std::make_unique<RHIPipelineState>(buildPipelineState(static_cast<RendererPSO>(i)));
+        }
+
+#ifdef WS_RENDERER_PSO_BIND_BENCHMARK
+        if (!pipelineStateBindMeasured)
+        {
+            measurePipelineStateBind();
+            pipelineStateBindMeasured = true;
+        }
+#endif
     }
 
     void Renderer::createTextures()
@@ -305,11 +684,20 @@ namespace worse
             blendState.reset();
         }
 
-        for (std::unique_ptr<worse::RHITexture>& renderTarget : renderTargets)
+        for (std::shared_ptr<worse::RHITexture>& renderTarget : renderTargets)
         {
             renderTarget.reset();
         }
 
+        for (std::unique_ptr<RHIPipelineState>& pipelineState : pipelineStates)
+        {
+            pipelineState.reset();
+        }
+
+        // destructors wait for jobs still compiling
+        shaderReloads.clear();
+        shaderWatcher.reset();
+
         for (std::unique_ptr<worse::RHIShader>& shader : shaders)
         {
             shader.reset();
@@ -355,6 +743,12 @@ namespace worse
         return renderTargets[target].get();
     }
 
+    RHIPipelineState const* Renderer::getPipelineState(RendererPSO const pso)
+    {
+        WS_ASSERT_MSG(pipelineStates[pso], "Pipeline states are not created");
+        return pipelineStates[pso].get();
+    }
+
     RHIShader* Renderer::getShader(RendererShader const shader)
     {
         return shaders[shader].get();
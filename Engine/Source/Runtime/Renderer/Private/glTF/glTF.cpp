@@ -1,12 +1,18 @@
 #include "glTF/glTF.hpp"
+#include "glTFMeshCache.hpp"
 #include "AssetServer.hpp"
+#include "VirtualFileSystem.hpp"
 #include "Log.hpp"
+#include "ThreadPool.hpp"
 #include "Math/Transform.hpp"
+#include "Profiling/Stopwatch.hpp"
 #include "RHITypes.hpp"
 
 #include "MathElementTraits.hpp" // IWYU pragma: keep
 
 #include <span>
+#include <future>
+#include <numeric>
 #include <optional>
 #include <filesystem>
 
@@ -14,6 +20,10 @@ namespace worse
 {
     namespace
     {
+        // glTF texture coordinates start at the top left row of the image,
+        // URI and embedded images are both decoded in stored order
+        constexpr bool IMAGE_FLIP_VERTICALLY = false;
+
         /**
          * @brief 使用 AssetServer 加载 glTF 纹理
          */
@@ -36,13 +46,18 @@ namespace worse
                     std::visit(fastgltf::visitor{
                         [&](fastgltf::sources::Vector vector)
                         {
-                            std::span<byte> data{vector.bytes.data() + bufferView.byteOffset, bufferView.byteLength};
-                            handle = assetServer.addTexture(data, imageName);
+                            std::span<byte const> data{vector.bytes.data() + bufferView.byteOffset, bufferView.byteLength};
+                            handle = assetServer.addTexture(data, imageName, IMAGE_FLIP_VERTICALLY);
                         },
                         [&](fastgltf::sources::Array array)
                         {
-                            std::span<byte> data{array.bytes.data() + bufferView.byteOffset, bufferView.byteLength};
-                            handle = assetServer.addTexture(data, imageName);
+                            std::span<byte const> data{array.bytes.data() + bufferView.byteOffset, bufferView.byteLength};
+                            handle = assetServer.addTexture(data, imageName, IMAGE_FLIP_VERTICALLY);
+                        },
+                        [&](fastgltf::sources::ByteView view)
+                        {
+                            std::span<byte const> data{view.bytes.data() + bufferView.byteOffset, bufferView.byteLength};
+                            handle = assetServer.addTexture(data, imageName, IMAGE_FLIP_VERTICALLY);
                         },
                         [&](auto arg)
                         {
@@ -54,12 +69,18 @@ namespace worse
                     WS_ASSERT(path.fileByteOffset == 0);
                     WS_ASSERT(path.uri.isLocalPath());
 
-                    handle = assetServer.addTexture(parentDir / path.uri.fspath(), AssetServer::LoadStrategy::Immediate);
+                    // decoded by the asset server workers
+                    handle = assetServer.addTexture(parentDir / path.uri.fspath(), AssetServer::LoadStrategy::Deferred, IMAGE_FLIP_VERTICALLY);
                 },
                 [&](fastgltf::sources::Vector vector)
                 {
-                    std::span<byte> data{vector.bytes.data(), vector.bytes.size()};
-                    handle = assetServer.addTexture(data, imageName);
+                    std::span<byte const> data{vector.bytes.data(), vector.bytes.size()};
+                    handle = assetServer.addTexture(data, imageName, IMAGE_FLIP_VERTICALLY);
+                },
+                [&](fastgltf::sources::Array array)
+                {
+                    std::span<byte const> data{array.bytes.data(), array.bytes.size()};
+                    handle = assetServer.addTexture(data, imageName, IMAGE_FLIP_VERTICALLY);
                 },
                 [&](auto arg)
                 {
@@ -147,6 +168,149 @@ namespace worse
             }
         }
 
+        /**
+         * @brief 在线程池上执行 fn(0..count), 已在工作线程上时直接执行
+         */
+        template <typename Fn>
+        void parallelFor(usize const count, Fn&& fn)
+        {
+            // a worker waiting on its own pool could starve it
+            if ((count <= 1) || ThreadPool::isWorkerThread())
+            {
+                for (usize i = 0; i < count; ++i)
+                {
+                    fn(i);
+                }
+                return;
+            }
+
+            std::vector<std::shared_future<void>> tasks;
+            tasks.reserve(count);
+            for (usize i = 0; i < count; ++i)
+            {
+                tasks.push_back(ThreadPool::addTask(
+                    [&fn, i]()
+                    {
+                        fn(i);
+                    }));
+            }
+            for (std::shared_future<void> const& task : tasks)
+            {
+                task.wait();
+            }
+        }
+
+        // where a primitive lands in the arrays of its mesh
+        struct PrimitiveRange
+        {
+            fastgltf::Primitive const* primitive = nullptr;
+            usize mesh                           = 0;
+            usize vertexOffset                   = 0;
+            usize vertexCount                    = 0;
+            usize indexOffset                    = 0;
+            usize indexCount                     = 0;
+        };
+
+        /**
+         * @brief 读取图元的顶点属性和索引到其所属网格数组的区间
+         */
+        void convertPrimitive(fastgltf::Asset const& asset,
+                              PrimitiveRange const& range,
+                              std::span<RHIVertexPosUvNrmTan> vertices,
+                              std::span<u32> indices,
+                              std::string const& modelName)
+        {
+            fastgltf::Primitive const& primitive = *range.primitive;
+
+            // load indexes, primitive local until the tangents are done
+            if (primitive.indicesAccessor.has_value())
+            {
+                fastgltf::iterateAccessorWithIndex<u32>(
+                    asset,
+                    asset.accessors[primitive.indicesAccessor.value()],
+                    [&](u32 index, usize i)
+                    {
+                        indices[i] = index;
+                    });
+            }
+            else
+            {
+                std::iota(indices.begin(), indices.end(), 0u);
+            }
+
+            // load vertex positions
+            fastgltf::iterateAccessorWithIndex<math::Vector3>(
+                asset,
+                asset.accessors[primitive.findAttribute("POSITION")->accessorIndex],
+                [&](math::Vector3 const& position, usize index)
+                {
+                    RHIVertexPosUvNrmTan& vtx = vertices[index];
+                    vtx.position              = position;
+                    // default
+                    vtx.normal  = math::Vector3::ZERO();
+                    vtx.uv      = math::Vector2::ZERO();
+                    vtx.tangent = math::Vector4::ZERO();
+                });
+
+            // load vertex normals
+            fastgltf::Attribute const* normals = primitive.findAttribute("NORMAL");
+            if (normals != primitive.attributes.end())
+            {
+                fastgltf::iterateAccessorWithIndex<math::Vector3>(
+                    asset,
+                    asset.accessors[normals->accessorIndex],
+                    [&](math::Vector3 const& normal, usize index)
+                    {
+                        // glTF -> Vulkan
+                        vertices[index].normal = -normal;
+                    });
+            }
+            else
+            {
+                WS_LOG_WARN("gltf", "{} does not have attribute NORMAL", modelName);
+            }
+
+            // load UVs
+            fastgltf::Attribute const* uvs = primitive.findAttribute("TEXCOORD_0");
+            if (uvs != primitive.attributes.end())
+            {
+                fastgltf::iterateAccessorWithIndex<math::Vector2>(
+                    asset,
+                    asset.accessors[uvs->accessorIndex],
+                    [&](math::Vector2 const& uv, usize index)
+                    {
+                        vertices[index].uv = uv;
+                    });
+            }
+            else
+            {
+                WS_LOG_WARN("gltf", "{} does not have attribute TEXCOORD_0", modelName);
+            }
+
+            // load tangents, generate them when the file has none
+            fastgltf::Attribute const* tangents = primitive.findAttribute("TANGENT");
+            if (tangents != primitive.attributes.end())
+            {
+                fastgltf::iterateAccessorWithIndex<math::Vector4>(
+                    asset,
+                    asset.accessors[tangents->accessorIndex],
+                    [&](math::Vector4 const& tangent, usize index)
+                    {
+                        vertices[index].tangent = tangent;
+                    });
+            }
+            else
+            {
+                calculateTangent(vertices, indices);
+            }
+
+            // mesh relative indices
+            for (u32& index : indices)
+            {
+                index += static_cast<u32>(range.vertexOffset);
+            }
+        }
+
     } // namespace
 
     void glTFMeshNode::draw(math::Matrix4 const& topMat, DrawContext& ctx)
@@ -176,20 +340,37 @@ namespace worse
     {
     }
 
-    glTFModel* glTFManager::load(std::string const& filepath, std::string const& modelName)
+    glTFModel* glTFManager::load(std::string const& filepath, std::string const& modelName, glTFLoadStatistics* statistics)
     {
-        std::lock_guard<std::mutex> lock(m_mtxParser);
+        profiling::Stopwatch stopwatch;
+
+        // the cooked geometry is read while the document is parsed
+        glTFMeshCache cache;
+        cache.prefetch(filepath);
+
+        // resolved through the mounts, the parser keeps its own padded copy
+        std::optional<VirtualFile> source = VirtualFileSystem::open(filepath);
+        if (!source)
+        {
+            WS_LOG_ERROR("glTF", "Failed to load file {}", filepath);
+            return nullptr;
+        }
 
-        auto gltfFile = fastgltf::GltfDataBuffer::FromPath(filepath);
+        auto gltfFile = fastgltf::GltfDataBuffer::FromBytes(source->getData(), source->getSize());
+        source.reset();
         if (gltfFile.error() != fastgltf::Error::None)
         {
             WS_LOG_ERROR("glTF", "Failed to load file {}", filepath);
             return nullptr;
         }
 
+        // a parser per import, models load concurrently
+        fastgltf::Parser parser;
+
+        // external files stay URIs: images load by path through the asset
+        // server, buffers are only read when the geometry is not cooked
         std::filesystem::path parentDir = std::filesystem::path(filepath).parent_path();
-        fastgltf::Options options       = fastgltf::Options::LoadExternalBuffers | fastgltf::Options::LoadExternalImages;
-        auto asset                      = m_parser.loadGltf(gltfFile.get(), parentDir, options);
+        auto asset                      = parser.loadGltf(gltfFile.get(), parentDir, fastgltf::Options::None);
 
         if (auto error = asset.error(); error != fastgltf::Error::None)
         {
@@ -197,6 +378,66 @@ namespace worse
             return nullptr;
         }
 
+        // files the import reads, recorded with the cooked geometry
+        std::vector<std::filesystem::path> dependencies;
+        bool hasExternalBuffers = false;
+        for (fastgltf::Buffer const& buffer : asset->buffers)
+        {
+            if (fastgltf::sources::URI const* uri = std::get_if<fastgltf::sources::URI>(&buffer.data))
+            {
+                dependencies.push_back(parentDir / uri->uri.fspath());
+                hasExternalBuffers = true;
+            }
+        }
+        bool hasBufferImages = false;
+        for (fastgltf::Image const& image : asset->images)
+        {
+            if (fastgltf::sources::URI const* uri = std::get_if<fastgltf::sources::URI>(&image.data))
+            {
+                dependencies.push_back(parentDir / uri->uri.fspath());
+            }
+            hasBufferImages = hasBufferImages || std::holds_alternative<fastgltf::sources::BufferView>(image.data);
+        }
+
+        // cooked geometry is already GPU-ready, it goes from the prefetched bytes
+        // straight into staging memory
+        bool isCached = cache.open(filepath) && (cache.getMeshCount() == asset->meshes.size());
+        for (u32 meshIndex = 0; isCached && (meshIndex < cache.getMeshCount()); ++meshIndex)
+        {
+            isCached = cache.getMesh(meshIndex).surfaces.size() == asset->meshes[meshIndex].primitives.size();
+        }
+
+        // external buffers resolve through the mounts as well, mapped files
+        // and archive entries back the byte views until the import is done
+        std::vector<VirtualFile> bufferFiles;
+        if (hasExternalBuffers && (!isCached || hasBufferImages))
+        {
+            for (fastgltf::Buffer& buffer : asset->buffers)
+            {
+                fastgltf::sources::URI const* uri = std::get_if<fastgltf::sources::URI>(&buffer.data);
+                if (!uri)
+                {
+                    continue;
+                }
+
+                std::filesystem::path const path = parentDir / uri->uri.fspath();
+                std::optional<VirtualFile> file  = VirtualFileSystem::open(path);
+                if (!file || (uri->fileByteOffset + buffer.byteLength > file->getSize()))
+                {
+                    WS_LOG_ERROR("glTF", "Failed to load buffer {} of {}", path.string(), filepath);
+                    return nullptr;
+                }
+
+                fastgltf::sources::ByteView view;
+                view.bytes    = fastgltf::span<byte const>(file->getData() + uri->fileByteOffset, buffer.byteLength);
+                view.mimeType = uri->mimeType;
+                buffer.data   = view;
+                bufferFiles.push_back(std::move(*file));
+            }
+        }
+
+        f32 const parseMs = stopwatch.elapsedMs();
+
         std::unique_ptr<glTFModel> model = std::make_unique<glTFModel>();
 
         // TODO: 读取 Samplers
@@ -205,15 +446,14 @@ namespace worse
         // 读取纹理文件
         // =====================================================================
 
-        // 暂存载入纹理，并保存纹理句柄，为加载失败的纹理分配默认纹理
-        std::vector<AssetHandle> textures;
-        textures.reserve(asset->images.size());
+        // 纹理可能没有名称，而 AssetServer 需要唯一的名称来生成句柄。
+        // 所以需要为匿名纹理生成唯一的名称
+        std::vector<std::string> textureNames;
+        textureNames.reserve(asset->images.size());
 
         u32 anonymousTextureIndex = 0;
         for (fastgltf::Image const& image : asset->images)
         {
-            // 纹理可能没有名称，而 AssetServer 需要唯一的名称来生成句柄。
-            // 所以需要为匿名纹理生成唯一的名称
             std::string textureName = modelName;
             if (image.name.empty())
             {
@@ -223,17 +463,27 @@ namespace worse
             {
                 textureName += "_" + image.name;
             }
+            textureNames.push_back(std::move(textureName));
+        }
 
-            if (std::optional<AssetHandle> handle = loadTexture(image, asset.get(), m_assetServer, parentDir, textureName))
-            {
-                textures.push_back(handle.value());
-            }
-            else
+        // 暂存载入纹理，并保存纹理句柄，为加载失败的纹理分配默认纹理
+        std::vector<AssetHandle> textures(asset->images.size());
+        parallelFor(
+            asset->images.size(),
+            [&](usize const i)
             {
-                textures.push_back(m_assetServer.getErrorTexture());
-                WS_LOG_WARN("gltf", "Faile to load {}", textureName);
-            }
-        }
+                if (std::optional<AssetHandle> handle = loadTexture(asset->images[i], asset.get(), m_assetServer, parentDir, textureNames[i]))
+                {
+                    textures[i] = handle.value();
+                }
+                else
+                {
+                    textures[i] = m_assetServer.getErrorTexture();
+                    WS_LOG_WARN("gltf", "Faile to load {}", textureNames[i]);
+                }
+            });
+
+        f32 const textureMs = stopwatch.elapsedMs() - parseMs;
 
         // =====================================================================
         // 读取材质
@@ -266,145 +516,132 @@ namespace worse
         // =====================================================================
 
         std::vector<std::shared_ptr<glTFMesh>> meshes;
-        std::vector<RHIVertexPosUvNrmTan> vertices;
-        std::vector<u32> indices;
-
+        meshes.reserve(asset->meshes.size());
+        usize primitiveCount = 0;
         for (fastgltf::Mesh const& mesh : asset->meshes)
         {
             std::shared_ptr<glTFMesh> newMesh = std::make_shared<glTFMesh>();
             newMesh->name                     = mesh.name;
+            newMesh->mesh                     = std::make_unique<Mesh>();
+            meshes.push_back(std::move(newMesh));
 
-            vertices.clear();
-            indices.clear();
-
-            u32 verticesOffset = 0;
-
-            for (fastgltf::Primitive const& primitive : mesh.primitives)
-            {
-                glTFSurface& newSurface = newMesh->surfaces.emplace_back();
-
-                verticesOffset = vertices.size();
-
-                // load indexes
-                fastgltf::Accessor& indexAccessor = asset->accessors[primitive.indicesAccessor.value()];
-                newSurface.indexCount             = static_cast<u32>(indexAccessor.count);
-
-                if (indexAccessor.componentType == fastgltf::ComponentType::UnsignedShort)
-                {
-                    newSurface.startIndex = indices.size();
+            primitiveCount += mesh.primitives.size();
+        }
 
-                    indices.reserve(indices.size() + indexAccessor.count);
-                    fastgltf::iterateAccessor<u16>(
-                        asset.get(),
-                        indexAccessor,
-                        [&](u16 index)
-                        {
-                            indices.push_back(static_cast<u32>(index) + verticesOffset);
-                        });
-                }
-                else
+        if (isCached)
+        {
+            parallelFor(
+                meshes.size(),
+                [&](usize const i)
                 {
-                    newSurface.startIndex = indices.size();
-
-                    indices.reserve(indices.size() + indexAccessor.count);
-                    fastgltf::iterateAccessor<u32>(
-                        asset.get(),
-                        indexAccessor,
-                        [&](u32 index)
-                        {
-                            indices.push_back(index + verticesOffset);
-                        });
-                }
-
-                // load vertex positions
-
-                fastgltf::Accessor& positionAccessor = asset->accessors[primitive.findAttribute("POSITION")->accessorIndex];
-                // Fit current size
-                vertices.resize(vertices.size() + positionAccessor.count);
+                    glTFCachedMesh const cached = cache.getMesh(static_cast<u32>(i));
 
-                fastgltf::iterateAccessorWithIndex<math::Vector3>(
-                    asset.get(),
-                    positionAccessor,
-                    [&](math::Vector3 const& position, usize index)
+                    for (meshcache::Surface const& surface : cached.surfaces)
                     {
-                        RHIVertexPosUvNrmTan& vtx = vertices[verticesOffset + index];
-                        vtx.position              = position;
-                        // default
-                        vtx.normal  = math::Vector3::ZERO();
-                        vtx.uv      = math::Vector2::ZERO();
-                        vtx.tangent = math::Vector4::ZERO();
-                    });
+                        glTFSurface& newSurface = meshes[i]->surfaces.emplace_back();
+                        newSurface.startIndex   = surface.startIndex;
+                        newSurface.indexCount   = surface.indexCount;
+                        newSurface.material     = materials[surface.materialIndex];
+                    }
+
+                    SubMesh subMesh;
+                    for (meshcache::Lod const& lod : cached.lods)
+                    {
+                        MeshLod& meshLod     = subMesh.lods.emplace_back();
+                        meshLod.vertexCount  = lod.vertexCount;
+                        meshLod.vertexOffset = lod.vertexOffset;
+                        meshLod.indexCount   = lod.indexCount;
+                        meshLod.indexOffset  = lod.indexOffset;
+                        meshLod.boundingBox  = math::BoundingBox(math::Vector3(lod.boundsMin), math::Vector3(lod.boundsMax));
+                    }
+
+                    meshes[i]->mesh->createGPUBuffers(cached.vertices, cached.indices, cached.indexStride, {subMesh});
+                });
+        }
+        else
+        {
+            // lay out every primitive in its mesh first, then convert them in parallel
+            std::vector<std::vector<RHIVertexPosUvNrmTan>> meshVertices(asset->meshes.size());
+            std::vector<std::vector<u32>> meshIndices(asset->meshes.size());
+            std::vector<glTFMeshCookSource> cookSources(asset->meshes.size());
+            std::vector<PrimitiveRange> ranges;
+            ranges.reserve(primitiveCount);
+
+            for (usize meshIndex = 0; meshIndex < asset->meshes.size(); ++meshIndex)
+            {
+                fastgltf::Mesh const& mesh = asset->meshes[meshIndex];
 
-                // load vertex normals
-                fastgltf::Attribute const* normals = primitive.findAttribute("NORMAL");
-                if (normals != primitive.attributes.end())
-                {
-                    fastgltf::iterateAccessorWithIndex<math::Vector3>(
-                        asset.get(),
-                        asset->accessors[normals->accessorIndex],
-                        [&](math::Vector3 const& normal, usize index)
-                        {
-                            RHIVertexPosUvNrmTan& vtx = vertices[verticesOffset + index];
-                            // glTF -> Vulkan
-                            vtx.normal                = -normal;
-                        });
-                }
-                else
+                usize vertexCount = 0;
+                usize indexCount  = 0;
+                for (fastgltf::Primitive const& primitive : mesh.primitives)
                 {
-                    WS_LOG_WARN("gltf", "{} does not have attribute NORMAL", modelName);
+                    PrimitiveRange range;
+                    range.primitive    = &primitive;
+                    range.mesh         = meshIndex;
+                    range.vertexOffset = vertexCount;
+                    range.vertexCount  = asset->accessors[primitive.findAttribute("POSITION")->accessorIndex].count;
+                    range.indexOffset  = indexCount;
+                    range.indexCount   = primitive.indicesAccessor.has_value() ? asset->accessors[primitive.indicesAccessor.value()].count : range.vertexCount;
+                    ranges.push_back(range);
+
+                    u32 const materialIndex = static_cast<u32>(primitive.materialIndex.has_value() ? primitive.materialIndex.value() : 0);
+
+                    glTFSurface& newSurface = meshes[meshIndex]->surfaces.emplace_back();
+                    newSurface.startIndex   = static_cast<u32>(range.indexOffset);
+                    newSurface.indexCount   = static_cast<u32>(range.indexCount);
+                    newSurface.material     = materials[materialIndex];
+
+                    cookSources[meshIndex].surfaces.push_back({newSurface.startIndex, newSurface.indexCount, materialIndex, 0});
+
+                    vertexCount += range.vertexCount;
+                    indexCount += range.indexCount;
                 }
 
-                // load UVs
-                fastgltf::Attribute const* uvs = primitive.findAttribute("TEXCOORD_0");
-                if (uvs != primitive.attributes.end())
-                {
-
-                    fastgltf::iterateAccessorWithIndex<math::Vector2>(
-                        asset.get(),
-                        asset->accessors[uvs->accessorIndex],
-                        [&](math::Vector2 const& uv, usize index)
-                        {
-                            RHIVertexPosUvNrmTan& vtx = vertices[verticesOffset + index];
-                            vtx.uv                    = uv;
-                        });
-                }
-                else
-                {
-                    WS_LOG_WARN("gltf", "{} does not have attribute TEXCOORD_0", modelName);
-                }
+                meshVertices[meshIndex].resize(vertexCount);
+                meshIndices[meshIndex].resize(indexCount);
+                cookSources[meshIndex].name = mesh.name;
+                cookSources[meshIndex].mesh = meshes[meshIndex]->mesh.get();
+            }
 
-                // load tangents
-                fastgltf::Attribute const* tangents = primitive.findAttribute("TANGENT");
-                if (tangents != primitive.attributes.end())
+            parallelFor(
+                ranges.size(),
+                [&](usize const i)
                 {
-                    fastgltf::iterateAccessorWithIndex<math::Vector4>(
-                        asset.get(),
-                        asset->accessors[tangents->accessorIndex],
-                        [&](math::Vector4 const& tangent, usize index)
-                        {
-                            RHIVertexPosUvNrmTan& vtx = vertices[verticesOffset + index];
-                            vtx.tangent               = tangent;
-                        });
-                }
+                    PrimitiveRange const& range = ranges[i];
+                    convertPrimitive(asset.get(),
+                                     range,
+                                     std::span{meshVertices[range.mesh]}.subspan(range.vertexOffset, range.vertexCount),
+                                     std::span{meshIndices[range.mesh]}.subspan(range.indexOffset, range.indexCount),
+                                     modelName);
+                });
+
+            // buffer creation records on the upload queue, which is thread safe
+            parallelFor(
+                meshes.size(),
+                [&](usize const i)
                 {
-                    WS_LOG_WARN("gltf", "{} does not have attribute TANGENT", modelName);
+                    meshes[i]->mesh->addGeometry(meshVertices[i], meshIndices[i]);
+                    meshes[i]->mesh->createGPUBuffers();
 
-                    // TODO: 计算切线
-                    calculateTangent(vertices, indices);
-                }
+                    meshVertices[i] = {};
+                    meshIndices[i]  = {};
+                });
 
-                newSurface.material = materials[primitive.materialIndex.has_value() ? primitive.materialIndex.value() : 0];
+            // the CPU copies are only kept around for the cooker
+            glTFMeshCache::write(filepath, cookSources, dependencies);
+            for (std::shared_ptr<glTFMesh> const& mesh : meshes)
+            {
+                mesh->mesh->clearCPU();
             }
+        }
 
-            newMesh->mesh = std::make_unique<Mesh>();
-            newMesh->mesh->addGeometry(vertices, indices);
-            newMesh->mesh->createGPUBuffers();
-            newMesh->mesh->clearCPU();
-
-            meshes.push_back(newMesh);
-            model->meshes[std::string{mesh.name}] = newMesh;
+        for (usize meshIndex = 0; meshIndex < meshes.size(); ++meshIndex)
+        {
+            model->meshes[std::string{asset->meshes[meshIndex].name}] = meshes[meshIndex];
         }
 
+        f32 const meshMs = stopwatch.elapsedMs() - parseMs - textureMs;
+
         // =====================================================================
         // 读取节点
         // =====================================================================
@@ -476,12 +713,35 @@ namespace worse
             }
         }
 
+        WS_LOG_INFO("glTF",
+                    "Loaded {} in {:.2f} ms (parse {:.2f}, images {:.2f}, meshes {:.2f}{}), {} images, {} primitives",
+                    modelName,
+                    stopwatch.elapsedMs(),
+                    parseMs,
+                    textureMs,
+                    meshMs,
+                    isCached ? " cached" : "",
+                    asset->images.size(),
+                    primitiveCount);
+
+        if (statistics)
+        {
+            statistics->parseMs        = parseMs;
+            statistics->imageMs        = textureMs;
+            statistics->meshMs         = meshMs;
+            statistics->totalMs        = stopwatch.elapsedMs();
+            statistics->isCached       = isCached;
+            statistics->imageCount     = asset->images.size();
+            statistics->primitiveCount = primitiveCount;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mtxModels);
         return m_modelStorage.emplace(modelName, std::move(model)).first->second.get();
     }
 
     glTFModel* glTFManager::getModel(std::string const& modelName)
     {
-        std::lock_guard<std::mutex> lock(m_mtxParser);
+        std::lock_guard<std::mutex> lock(m_mtxModels);
 
         auto it = m_modelStorage.find(modelName);
         if (it != m_modelStorage.end())
@@ -0,0 +1,297 @@
+#include "Log.hpp"
+#include "Mesh.hpp"
+#include "FileSystem.hpp"
+#include "AssetDatabase.hpp"
+#include "glTFMeshCache.hpp"
+
+#include <limits>
+#include <cstring>
+#include <fstream>
+
+namespace worse
+{
+
+    namespace
+    {
+        constexpr char const* COOKED_DIRECTORY = ".cooked";
+        constexpr u64 DATA_ALIGNMENT           = 16;
+
+        u64 alignUp(u64 const value)
+        {
+            return (value + DATA_ALIGNMENT - 1) & ~(DATA_ALIGNMENT - 1);
+        }
+
+        void storeBounds(math::BoundingBox const& box, f32 (&min)[3], f32 (&max)[3])
+        {
+            std::memcpy(min, box.getMin().data, sizeof(min));
+            std::memcpy(max, box.getMax().data, sizeof(max));
+        }
+
+        bool isInside(u64 const offset, u64 const size, u64 const fileSize)
+        {
+            return (offset <= fileSize) && (size <= fileSize - offset);
+        }
+    } // namespace
+
+    std::filesystem::path glTFMeshCache::getCachePath(std::filesystem::path const& source)
+    {
+        return source.parent_path() / COOKED_DIRECTORY / std::filesystem::path{source.filename()}.concat(".mesh");
+    }
+
+    bool glTFMeshCache::write(std::filesystem::path const& source,
+                              std::span<glTFMeshCookSource const> meshes,
+                              std::vector<std::filesystem::path> const& dependencies)
+    {
+        std::vector<meshcache::MeshRecord> records(meshes.size());
+        std::vector<meshcache::Surface> surfaces;
+        std::vector<meshcache::Lod> lods;
+        std::string names;
+
+        for (usize i = 0; i < meshes.size(); ++i)
+        {
+            glTFMeshCookSource const& cook = meshes[i];
+            meshcache::MeshRecord& record  = records[i];
+            record                         = {};
+
+            record.vertexCount = static_cast<u32>(cook.mesh->getVertices().size());
+            record.indexCount  = static_cast<u32>(cook.mesh->getIndices().size());
+            record.indexStride = (record.vertexCount <= std::numeric_limits<u16>::max()) ? sizeof(u16) : sizeof(u32);
+            record.nameOffset  = static_cast<u32>(names.size());
+            record.nameLength  = static_cast<u32>(cook.name.size());
+            names.append(cook.name);
+
+            record.firstSurface = static_cast<u32>(surfaces.size());
+            record.surfaceCount = static_cast<u32>(cook.surfaces.size());
+            surfaces.insert(surfaces.end(), cook.surfaces.begin(), cook.surfaces.end());
+
+            record.firstLod = static_cast<u32>(lods.size());
+            for (SubMesh const& subMesh : cook.mesh->getSubMeshes())
+            {
+                for (MeshLod const& meshLod : subMesh.lods)
+                {
+                    meshcache::Lod& lod = lods.emplace_back();
+                    lod.vertexCount     = meshLod.vertexCount;
+                    lod.vertexOffset    = meshLod.vertexOffset;
+                    lod.indexCount      = meshLod.indexCount;
+                    lod.indexOffset     = meshLod.indexOffset;
+                    storeBounds(meshLod.boundingBox, lod.boundsMin, lod.boundsMax);
+                }
+            }
+            record.lodCount = static_cast<u32>(lods.size()) - record.firstLod;
+
+            storeBounds(math::BoundingBox(cook.mesh->getVertices()), record.boundsMin, record.boundsMax);
+        }
+
+        // lay out the bulk data after the tables
+        u64 offset = sizeof(meshcache::FileHeader) +
+                     records.size() * sizeof(meshcache::MeshRecord) +
+                     surfaces.size() * sizeof(meshcache::Surface) +
+                     lods.size() * sizeof(meshcache::Lod) +
+                     names.size();
+        for (meshcache::MeshRecord& record : records)
+        {
+            record.vertexOffset = alignUp(offset);
+            offset              = record.vertexOffset + static_cast<u64>(record.vertexCount) * sizeof(RHIVertexPosUvNrmTan);
+            record.indexOffset  = alignUp(offset);
+            offset              = record.indexOffset + static_cast<u64>(record.indexCount) * record.indexStride;
+        }
+
+        meshcache::FileHeader header = {};
+        header.magic                 = meshcache::MAGIC;
+        header.version               = meshcache::VERSION;
+        header.vertexStride          = sizeof(RHIVertexPosUvNrmTan);
+        header.meshCount             = static_cast<u32>(records.size());
+        header.surfaceCount          = static_cast<u32>(surfaces.size());
+        header.lodCount              = static_cast<u32>(lods.size());
+        header.fileSize              = offset;
+
+        std::filesystem::path const cachePath = getCachePath(source);
+        std::error_code ec;
+        std::filesystem::create_directories(cachePath.parent_path(), ec);
+        if (ec)
+        {
+            WS_LOG_ERROR("glTFMeshCache", "Failed to create {}", cachePath.parent_path().string());
+            return false;
+        }
+
+        // a crash mid write must not leave a file newer than its source
+        std::filesystem::path const temporary = std::filesystem::path{cachePath}.concat(".tmp");
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            auto writeBytes = [&file](void const* data, usize const size)
+            {
+                file.write(static_cast<char const*>(data), static_cast<std::streamsize>(size));
+            };
+            auto padTo = [&file](u64 const position)
+            {
+                char const zeros[DATA_ALIGNMENT] = {};
+                file.write(zeros, static_cast<std::streamsize>(position - static_cast<u64>(file.tellp())));
+            };
+
+            writeBytes(&header, sizeof(header));
+            writeBytes(records.data(), records.size() * sizeof(meshcache::MeshRecord));
+            writeBytes(surfaces.data(), surfaces.size() * sizeof(meshcache::Surface));
+            writeBytes(lods.data(), lods.size() * sizeof(meshcache::Lod));
+            writeBytes(names.data(), names.size());
+
+            std::vector<u16> narrow;
+            for (usize i = 0; i < meshes.size(); ++i)
+            {
+                meshcache::MeshRecord const& record = records[i];
+                Mesh const* mesh                    = meshes[i].mesh;
+
+                padTo(record.vertexOffset);
+                writeBytes(mesh->getVertices().data(), mesh->getVertices().size() * sizeof(RHIVertexPosUvNrmTan));
+
+                padTo(record.indexOffset);
+                if (record.indexStride == sizeof(u16))
+                {
+                    narrow.assign(mesh->getIndices().begin(), mesh->getIndices().end());
+                    writeBytes(narrow.data(), narrow.size() * sizeof(u16));
+                }
+                else
+                {
+                    writeBytes(mesh->getIndices().data(), mesh->getIndices().size() * sizeof(u32));
+                }
+            }
+
+            if (!file)
+            {
+                WS_LOG_ERROR("glTFMeshCache", "Failed to write {}", temporary.string());
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temporary, cachePath, ec);
+        if (ec)
+        {
+            WS_LOG_ERROR("glTFMeshCache", "Failed to write {}", cachePath.string());
+            return false;
+        }
+
+        AssetDatabase::record(source, dependencies, {cachePath});
+        AssetDatabase::save();
+
+        WS_LOG_INFO("glTFMeshCache", "Cooked {} meshes of {} ({:.1f} MB)", records.size(), source.filename().string(), offset / (1024.0 * 1024.0));
+        return true;
+    }
+
+    void glTFMeshCache::prefetch(std::filesystem::path const& source)
+    {
+        m_source  = source;
+        m_pending = {};
+
+        // content hashes, touching the files does not invalidate the cache.
+        // packed sources have nothing to hash, the archive ships the cache
+        // cooked with them
+        std::filesystem::path const cachePath = getCachePath(source);
+        if ((FileSystem::isFileExists(source) && !AssetDatabase::isUpToDate(source)) || !VirtualFileSystem::exists(cachePath))
+        {
+            return;
+        }
+
+        m_pending = VirtualFileSystem::readAsync(cachePath);
+    }
+
+    bool glTFMeshCache::open(std::filesystem::path const& source)
+    {
+        m_header = nullptr;
+        m_file   = {};
+
+        if (m_source != source)
+        {
+            prefetch(source);
+        }
+        m_source.clear();
+        if (!m_pending.valid())
+        {
+            return false;
+        }
+
+        // the shared state keeps the bytes, so they are not copied out
+        auto pending                   = std::make_shared<std::shared_future<std::vector<byte>>>(std::move(m_pending));
+        std::vector<byte> const& bytes = pending->get();
+        if (bytes.empty())
+        {
+            return false;
+        }
+        m_file = VirtualFile{std::move(pending), std::span<byte const>{bytes.data(), bytes.size()}};
+
+        if (m_file.getSize() >= sizeof(meshcache::FileHeader))
+        {
+            m_header = reinterpret_cast<meshcache::FileHeader const*>(m_file.getData());
+        }
+        if (!m_header || !validate())
+        {
+            WS_LOG_WARN("glTFMeshCache", "{} is stale or corrupted, recooking", getCachePath(source).string());
+            m_header = nullptr;
+            m_file   = {};
+            return false;
+        }
+
+        return true;
+    }
+
+    bool glTFMeshCache::validate() const
+    {
+        u64 const fileSize = m_file.getSize();
+        if ((m_header->magic != meshcache::MAGIC) ||
+            (m_header->version != meshcache::VERSION) ||
+            (m_header->vertexStride != sizeof(RHIVertexPosUvNrmTan)) ||
+            (m_header->fileSize != fileSize))
+        {
+            return false;
+        }
+
+        u64 const tablesSize = static_cast<u64>(m_header->meshCount) * sizeof(meshcache::MeshRecord) +
+                               static_cast<u64>(m_header->surfaceCount) * sizeof(meshcache::Surface) +
+                               static_cast<u64>(m_header->lodCount) * sizeof(meshcache::Lod);
+        if (!isInside(sizeof(meshcache::FileHeader), tablesSize, fileSize))
+        {
+            return false;
+        }
+
+        u64 const namesOffset = sizeof(meshcache::FileHeader) + tablesSize;
+        auto const* records   = reinterpret_cast<meshcache::MeshRecord const*>(m_header + 1);
+        for (u32 i = 0; i < m_header->meshCount; ++i)
+        {
+            meshcache::MeshRecord const& record = records[i];
+            if (((record.indexStride != sizeof(u16)) && (record.indexStride != sizeof(u32))) ||
+                ((record.vertexOffset % DATA_ALIGNMENT) != 0) ||
+                ((record.indexOffset % DATA_ALIGNMENT) != 0) ||
+                !isInside(record.vertexOffset, static_cast<u64>(record.vertexCount) * sizeof(RHIVertexPosUvNrmTan), fileSize) ||
+                !isInside(record.indexOffset, static_cast<u64>(record.indexCount) * record.indexStride, fileSize) ||
+                (static_cast<u64>(record.firstSurface) + record.surfaceCount > m_header->surfaceCount) ||
+                (static_cast<u64>(record.firstLod) + record.lodCount > m_header->lodCount) ||
+                !isInside(namesOffset + record.nameOffset, record.nameLength, fileSize))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    glTFCachedMesh glTFMeshCache::getMesh(u32 const index) const
+    {
+        WS_ASSERT(m_header && (index < m_header->meshCount));
+
+        byte const* base     = m_file.getData();
+        auto const* records  = reinterpret_cast<meshcache::MeshRecord const*>(m_header + 1);
+        auto const* surfaces = reinterpret_cast<meshcache::Surface const*>(records + m_header->meshCount);
+        auto const* lods     = reinterpret_cast<meshcache::Lod const*>(surfaces + m_header->surfaceCount);
+        auto const* names    = reinterpret_cast<char const*>(lods + m_header->lodCount);
+
+        meshcache::MeshRecord const& record = records[index];
+
+        glTFCachedMesh mesh;
+        mesh.name        = std::string_view{names + record.nameOffset, record.nameLength};
+        mesh.vertices    = {reinterpret_cast<RHIVertexPosUvNrmTan const*>(base + record.vertexOffset), record.vertexCount};
+        mesh.indices     = {base + record.indexOffset, static_cast<usize>(record.indexCount) * record.indexStride};
+        mesh.indexStride = record.indexStride;
+        mesh.surfaces    = {surfaces + record.firstSurface, record.surfaceCount};
+        mesh.lods        = {lods + record.firstLod, record.lodCount};
+        return mesh;
+    }
+
+} // namespace worse
@@ -0,0 +1,144 @@
+#pragma once
+#include "Types.hpp"
+#include "RHITypes.hpp"
+#include "VirtualFileSystem.hpp"
+
+#include <span>
+#include <string>
+#include <vector>
+#include <future>
+#include <optional>
+#include <filesystem>
+#include <string_view>
+
+namespace worse
+{
+
+    class Mesh;
+
+    // cooked glTF geometry, written on the first import next to the source
+    // as <dir>/.cooked/<file>.mesh and read back in one call on later runs
+    //
+    // layout: FileHeader | MeshRecord[] | Surface[] | Lod[] | names |
+    //         per mesh 16 byte aligned vertices and indices
+    namespace meshcache
+    {
+        constexpr u32 MAGIC = 0x434D5357; // "WSMC"
+        // bump when the layout or the vertex conversion changes
+        constexpr u32 VERSION = 1;
+
+        // clang-format off
+        struct FileHeader
+        {
+            u32 magic;
+            u32 version;
+            u32 vertexStride;
+            u32 meshCount;
+            u32 surfaceCount;
+            u32 lodCount;
+            u64 fileSize;
+        };
+
+        struct MeshRecord
+        {
+            u64 vertexOffset; // bytes from the start of the file
+            u64 indexOffset;
+            u32 vertexCount;
+            u32 indexCount;
+            u32 indexStride;  // 2 when every index fits u16
+            u32 firstSurface;
+            u32 surfaceCount;
+            u32 firstLod;
+            u32 lodCount;
+            u32 nameOffset;
+            u32 nameLength;
+            f32 boundsMin[3];
+            f32 boundsMax[3];
+            u32 reserved;
+        };
+
+        struct Surface
+        {
+            u32 startIndex;
+            u32 indexCount;
+            u32 materialIndex; // glTF material index
+            u32 reserved;
+        };
+
+        struct Lod
+        {
+            u32 vertexCount;
+            u32 vertexOffset;
+            u32 indexCount;
+            u32 indexOffset;
+            f32 boundsMin[3];
+            f32 boundsMax[3];
+        };
+        // clang-format on
+
+        static_assert(sizeof(FileHeader) == 32);
+        static_assert(sizeof(MeshRecord) == 80);
+        static_assert(sizeof(Surface) == 16);
+        static_assert(sizeof(Lod) == 40);
+    } // namespace meshcache
+
+    // views into the bytes read, valid while the cache is open
+    struct glTFCachedMesh
+    {
+        std::string_view name;
+        std::span<RHIVertexPosUvNrmTan const> vertices;
+        std::span<byte const> indices;
+        u32 indexStride = sizeof(u32);
+        std::span<meshcache::Surface const> surfaces;
+        std::span<meshcache::Lod const> lods;
+    };
+
+    // what the importer hands to the writer for one glTF mesh
+    struct glTFMeshCookSource
+    {
+        std::string_view name;
+        Mesh const* mesh = nullptr;
+        std::vector<meshcache::Surface> surfaces;
+    };
+
+    class glTFMeshCache
+    {
+    public:
+        // <dir>/.cooked/<filename>.mesh
+        static std::filesystem::path getCachePath(std::filesystem::path const& source);
+
+        // cooked data of every mesh, in glTF mesh order, recorded in the
+        // asset database together with the buffers and images it was read with
+        static bool write(std::filesystem::path const& source,
+                          std::span<glTFMeshCookSource const> meshes,
+                          std::vector<std::filesystem::path> const& dependencies);
+
+        // starts reading the cache through VirtualFileSystem::readAsync if
+        // the asset database has the source and its dependencies unchanged,
+        // sources only found in a mounted archive use its cache as is
+        void prefetch(std::filesystem::path const& source);
+
+        // waits for the read started by prefetch, or starts it, and uses the
+        // cache if it matches the layout version. the whole file is
+        // validated before use
+        bool open(std::filesystem::path const& source);
+
+        // clang-format off
+        u32 getMeshCount() const { return m_header ? m_header->meshCount : 0; }
+        // clang-format on
+
+        glTFCachedMesh getMesh(u32 const index) const;
+
+    private:
+        bool validate() const;
+
+        // the prefetched read, empty when the cache is stale or missing
+        std::filesystem::path m_source;
+        std::shared_future<std::vector<byte>> m_pending;
+
+        // owns the bytes read
+        VirtualFile m_file;
+        meshcache::FileHeader const* m_header = nullptr;
+    };
+
+} // namespace worse
@@ -1,10 +1,13 @@
 #pragma once
 #include "RHITexture.hpp"
+#include "RHIUploadQueue.hpp"
 
 #include <span>
 #include <queue>
 #include <mutex>
+#include <future>
 #include <memory>
+#include <vector>
 #include <optional>
 #include <filesystem>
 #include <functional>
@@ -38,6 +41,8 @@ namespace worse
     {
         Unloaded,
         Queued,
+        Decoding,  // on a worker thread
+        Uploading, // copy recorded, waiting for the transfer queue
         Loaded,
         Failed
     };
@@ -46,6 +51,25 @@ namespace worse
     {
         std::shared_ptr<RHITexture> texture = nullptr;
         AssetState state                    = AssetState::Unloaded;
+        // 源文件路径, 为空时纹理不可驱逐(无法重新加载)
+        std::filesystem::path path;
+        // 显存占用字节数
+        u64 size          = 0;
+        u64 lastUsedFrame = 0;
+        bool isPinned     = false;
+        // 解码时上下翻转行序
+        bool flipVertically = true;
+        // 上传完成后才可采样
+        RHIUploadToken uploadToken = {};
+
+        // 流式加载: 常驻的最大边长和本帧屏幕上需要的最大边长
+        u32 residentSize  = 0;
+        u32 demandSize    = 0;
+        bool isStreamable = false; // 源文件还有未加载的更高 mip
+        // 更高分辨率的版本, 上传完成后替换 texture
+        std::shared_ptr<RHITexture> streamTexture = nullptr;
+        RHIUploadToken streamToken                = {};
+        bool isStreaming                          = false;
     };
 
     struct MaterialAssetSlot
@@ -72,9 +96,10 @@ namespace worse
          *
          * @param path 纹理文件路径
          * @param strategy 加载策略
+         * @param flipVertically 解码时上下翻转行序, 重新加载时沿用
          * @return AssetHandle 资源句柄
          */
-        AssetHandle addTexture(std::filesystem::path const& path, LoadStrategy strategy = LoadStrategy::Deferred);
+        AssetHandle addTexture(std::filesystem::path const& path, LoadStrategy strategy = LoadStrategy::Deferred, bool const flipVertically = true);
 
         /**
          * @brief 将独立的金属度和粗糙度纹理文件合并加载
@@ -88,9 +113,11 @@ namespace worse
         /**
          * @brief 使用内存中的数据创建纹理
          *
-         * @note 立即加载
+         * @param flipVertically 解码时上下翻转行序
+         * @note 在调用线程立即解码, 不持有锁, 可从多个线程并行调用;
+         *       上传完成前绑定错误纹理
          */
-        AssetHandle addTexture(std::span<byte> data, std::string const& name);
+        AssetHandle addTexture(std::span<byte const> data, std::string const& name, bool const flipVertically = false);
 
         /**
          * @brief 立即添加纹理资源到服务器
@@ -98,7 +125,12 @@ namespace worse
         AssetHandle addMaterial(StandardMaterial const& material);
 
         /**
-         * @brief 加载排队的纹理资源
+         * @brief 将排队的纹理分发到线程池解码上传, 并将上传完成的纹理标记为已加载
+         *
+         * 烘焙的块压缩纹理先只加载不超过 STREAMING_TAIL_SIZE 的 mip 尾部,
+         * 需求超过常驻尺寸时在预算内后台加载更大的 mip 链, 上传完成后替换
+         *
+         * @note 每帧调用, 不等待解码
          */
         void loadTexture();
         /**
@@ -118,18 +150,52 @@ namespace worse
          */
         void cleanSlots();
 
+        /**
+         * @brief 标记纹理在该帧被使用, 已驱逐的纹理重新排队加载
+         *
+         * @param demandSize 屏幕上需要的最大边长(像素), 0 表示不提出需求
+         */
+        void touchTexture(AssetHandle const handle, u64 const frame, u32 const demandSize = 0);
+        /**
+         * @brief 标记材质引用的所有纹理在该帧被使用
+         */
+        void touchMaterial(AssetHandle const handle, u64 const frame, u32 const demandSize = 0);
+        /**
+         * @brief 固定纹理, 不参与驱逐
+         */
+        void pinTexture(AssetHandle const handle);
+        /**
+         * @brief 纹理显存预算, 0 表示不限制
+         */
+        void setTextureBudget(u64 const bytes);
+        /**
+         * @brief 超出预算时按最近最少使用顺序驱逐纹理
+         *
+         * @param frame 当前帧, 最近 MAX_FRAMES_IN_FLIGHT 帧内使用过的纹理不会被驱逐
+         * @return usize 驱逐的纹理数量
+         */
+        usize evictTextures(u64 const frame);
+
         bool isLoaded(AssetHandle const handle) const;
         AssetState getState(AssetHandle const handle) const;
         RHITexture* getTexture(AssetHandle handle) const;
+        // 已加载的纹理, 未加载完成时为错误纹理
+        RHITexture* getBindableTexture(AssetHandle handle) const;
         StandardMaterial const* getMaterial(AssetHandle handle) const;
         u32 getMaterialIndex(AssetHandle handle) const;
         usize getLoadedTextureCount() const;
         usize getMaterialCount() const;
+        // 已加载纹理的显存占用
+        u64 getTextureMemory() const;
+        u64 getTextureBudget() const;
+        // 可绑定纹理变化(加载, 流送替换, 驱逐, 卸载)的句柄, 取出后清空,
+        // 只需重写这些纹理的绑定
+        std::vector<AssetHandle> takeResidencyChanges();
 
         /**
-         * @brief 批量处理加载的纹理
+         * @brief 批量处理已加载和加载中的纹理
          *
-         * @param callback 对纹理的处理回调
+         * @param callback 对纹理的处理回调, 加载中的纹理传入错误纹理
          */
         void eachTexture(std::function<void(AssetHandle, RHITexture*)> const& callback) const;
         void eachMaterial(std::function<void(AssetHandle, MaterialAssetSlot&)> const& callback);
@@ -138,13 +204,34 @@ namespace worse
         AssetHandle getErrorTexture() const { return m_errorTextureHandle; }
         // clang-format on
 
+        // largest mip streamed in when a cooked texture is first loaded
+        static constexpr u32 STREAMING_TAIL_SIZE = 128;
+        // higher resolution loads started per loadTexture call
+        static constexpr u32 STREAMING_MAX_REQUESTS = 4;
+
     private:
+        // worker side of loadTexture, decodes and records the upload
+        void decodeTexture(std::filesystem::path const& path, bool const flipVertically);
+        // hands a decoded texture to its Decoding slot
+        void storeTexture(AssetHandle const handle, std::shared_ptr<RHITexture> texture, std::string const& name);
+        // worker side of streaming, loads the chain up to maxSize for a Loaded slot
+        void streamTexture(AssetHandle const handle, std::filesystem::path const& path, u32 const maxSize);
+        // swaps finished streams in and picks slots to stream, returns the
+        // loads to dispatch, call with the lock held
+        std::vector<std::pair<AssetHandle, u32>> updateStreamingLocked();
+        void waitLoadTasks();
+        RHITexture* getBindableTextureLocked(TextureAssetSlot const& slot) const;
+
         std::queue<std::filesystem::path> m_loadQueue;
+        std::vector<std::shared_future<void>> m_loadTasks;
         mutable std::mutex m_mtxTexture;
         std::unordered_map<AssetHandle, TextureAssetSlot> m_textures;
         mutable std::mutex m_mtxMaterial;
         std::unordered_map<AssetHandle, MaterialAssetSlot> m_materials;
 
         AssetHandle m_errorTextureHandle;
+
+        u64 m_textureBudget = 0;
+        std::vector<AssetHandle> m_residencyChanges;
     };
 } // namespace worse
\ No newline at end of file
@@ -9,6 +9,8 @@
 namespace worse
 {
 
+    class AssetServer;
+
     void defaultPage(int state);
 
     template <typename State>
@@ -115,6 +117,11 @@ namespace worse
             alwaysRenderPages.push_back(std::move(page));
         }
 
+        // GPU heap budgets, per category usage and texture residency
+        static void drawMemoryStatistics(AssetServer* assetServer = nullptr);
+        // frame timing with async compute on and off, descriptor updates
+        static void drawRendererStatistics();
+
     private:
         inline static Page activePage = nullptr;
         inline static std::vector<Page> alwaysRenderPages;
@@ -6,6 +6,7 @@
 #include "ECS/Resource.hpp"
 #include "ECS/QueryView.hpp"
 
+#include <span>
 #include <concepts>
 #include <memory>
 
@@ -155,16 +156,30 @@ namespace worse
                          std::vector<u32> const& indices);
 
         void createGPUBuffers();
+        // GPU-ready data is copied straight into staging memory without CPU
+        // copies, index stride is sizeof(u16) or sizeof(u32)
+        void createGPUBuffers(std::span<RHIVertexPosUvNrmTan const> vertices,
+                              std::span<byte const> indices,
+                              u32 const indexStride,
+                              std::vector<SubMesh> subMeshes);
 
         // clang-format off
         RHIBuffer* getVertexBuffer() const { return m_vertexBuffer.get(); }
         RHIBuffer* getIndexBuffer() const { return m_indexBuffer.get(); }
+
+        // CPU data, empty after clearCPU
+        std::vector<RHIVertexPosUvNrmTan> const& getVertices() const { return m_vertices; }
+        std::vector<u32> const& getIndices() const                   { return m_indices; }
+        std::vector<SubMesh> const& getSubMeshes() const             { return m_subMeshes; }
+        // object space bounds of every lod 0, kept after clearCPU
+        math::BoundingBox const& getBoundingBox() const              { return m_boundingBox; }
         // clang-format on
 
     private:
         std::vector<RHIVertexPosUvNrmTan> m_vertices;
         std::vector<u32> m_indices;
         std::vector<SubMesh> m_subMeshes;
+        math::BoundingBox m_boundingBox;
 
         std::shared_ptr<RHIBuffer> m_vertexBuffer = nullptr;
         std::shared_ptr<RHIBuffer> m_indexBuffer  = nullptr;
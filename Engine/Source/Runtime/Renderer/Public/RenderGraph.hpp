@@ -0,0 +1,194 @@
+#pragma once
+#include "Types.hpp"
+#include "RHITexture.hpp"
+#include "RendererDefinitions.hpp"
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <filesystem>
+#include <string_view>
+#include <unordered_map>
+
+namespace worse
+{
+    class RHICommandList;
+    class RenderGraph;
+
+    enum class RenderGraphPassType
+    {
+        Graphics,
+        Compute,
+        Transfer,
+    };
+
+    enum class RenderGraphAccess
+    {
+        ColorAttachment,     // 颜色附件写入
+        DepthAttachment,     // 深度读写
+        DepthRead,           // 只读深度测试
+        SampledRead,         // SRV
+        StorageRead,         // UAV 读
+        StorageWrite,        // UAV 写
+        TransferSource,      // blit/copy 源
+        TransferDestination, // blit/copy 目标
+        Max
+    };
+
+    struct RenderGraphTextureDesc
+    {
+        u32 width                 = 0;
+        u32 height                = 0;
+        RHIFormat format          = RHIFormat::Max;
+        RHITextureViewFlags usage = {};
+        std::string name          = "";
+        // transient texture only lives inside one frame and may share memory
+        // with other transient textures whose lifetimes do not overlap
+        bool transient = true;
+    };
+
+    // a group of logical render targets backed by one physical texture
+    struct RenderGraphAliasSlot
+    {
+        std::vector<RendererTarget> targets;
+        RenderGraphTextureDesc desc;
+    };
+
+    class RenderGraphBuilder
+    {
+        friend class RenderGraph;
+
+    public:
+        RenderGraphBuilder& read(RendererTarget const target, RenderGraphAccess const access = RenderGraphAccess::SampledRead);
+        RenderGraphBuilder& write(RendererTarget const target, RenderGraphAccess const access);
+        // the pass is never culled even if nothing consumes its outputs
+        RenderGraphBuilder& sideEffect();
+        // compute pass that may run on the compute queue
+        RenderGraphBuilder& asyncCompute();
+
+    private:
+        RenderGraphBuilder(usize const passIndex, RenderGraph* graph);
+
+        usize m_passIndex    = 0;
+        RenderGraph* m_graph = nullptr;
+    };
+
+    /**
+     * @brief 帧图
+     *
+     * pass 声明读写的渲染目标, 编译时剔除无用 pass, 计算瞬态目标的生命周期并
+     * 分组复用物理纹理, 执行时根据每个物理纹理的上一次访问自动插入屏障
+     */
+    class RenderGraph : public NonCopyable
+    {
+        friend class RenderGraphBuilder;
+
+    public:
+        using SetupFn   = std::function<void(RenderGraphBuilder&)>;
+        using ExecuteFn = std::function<void(RHICommandList*)>;
+
+        void declareTexture(RendererTarget const target, RenderGraphTextureDesc const& desc);
+        void addPass(std::string const& name, RenderGraphPassType const type, SetupFn const& setup, ExecuteFn execute);
+        // outputs are kept alive and are the roots of pass culling
+        void setOutput(RendererTarget const target);
+        void setPassEnabled(std::string_view name, bool const enabled);
+
+        // cull passes, compute lifetimes and alias slots, returns true if the
+        // alias slots changed and physical textures must be recreated
+        bool compile();
+        // record all alive passes, physical textures are resolved through
+        // Renderer::getRenderTarget, with async compute the passes are split
+        // into submissions per queue and the returned graphics command list
+        // continues the frame
+        RHICommandList* execute(RHICommandList* cmdList);
+        // synchronize an access recorded outside the passes, such as the
+        // present blit, with the tracked state of the target
+        void access(RHICommandList* cmdList, RendererTarget const target, RenderGraphPassType const type, RenderGraphAccess const access);
+        // barrier tracking refers to physical textures, must be called after
+        // they are recreated
+        void resetTracking();
+
+        // graphviz dot text
+        std::string dump() const;
+        bool dumpToFile(std::filesystem::path const& path) const;
+
+        // clang-format off
+        std::vector<RenderGraphAliasSlot> const& getAliasSlots() const { return m_aliasSlots; }
+        RenderGraphTextureDesc const& getTextureDesc(RendererTarget const target) const { return m_textures[target].desc; }
+        u32 getBarrierCount() const                                   { return m_barrierCount; }
+        u32 getQueueSwitchCount() const                               { return m_queueSwitchCount; }
+        // a pass waits only for the other queue's accesses to its textures, at
+        // its own stages, the next frame's depth and shadow passes overlap the
+        // compute tail that does not touch their targets
+        void setAsyncCompute(bool const enabled)                      { m_asyncCompute = enabled; }
+        bool isAsyncCompute() const                                   { return m_asyncCompute; }
+        // clang-format on
+
+    private:
+        struct Access
+        {
+            RendererTarget target;
+            RenderGraphAccess access;
+            bool isWrite;
+        };
+
+        struct Pass
+        {
+            std::string name;
+            RenderGraphPassType type;
+            std::vector<Access> accesses;
+            ExecuteFn execute;
+            bool enabled      = true;
+            bool sideEffect   = false;
+            bool asyncCompute = false;
+            bool alive        = false;
+        };
+
+        struct Texture
+        {
+            RenderGraphTextureDesc desc;
+            bool declared = false;
+            bool output   = false;
+            // index of first and last alive pass that accesses the texture
+            usize first = 0;
+            usize last  = 0;
+            bool used   = false;
+            usize slot  = 0;
+        };
+
+        // last known synchronization state of a physical texture
+        struct TextureState
+        {
+            RHIPipelineStageFlags writeStage = RHIPipelineStageFlagBits::None;
+            RHIAccessFlags writeAccess       = RHIAccessFlagBits::None;
+            // stages that have read since the last write
+            RHIPipelineStageFlags readStages = RHIPipelineStageFlagBits::None;
+            // stages/accesses the last write has been made visible to
+            RHIPipelineStageFlags visibleStages = RHIPipelineStageFlagBits::None;
+            RHIAccessFlags visibleAccess        = RHIAccessFlagBits::None;
+            // queue of the last access
+            RHIQueueType queue = RHIQueueType::Graphics;
+            // per queue timeline value of the submission holding an access not
+            // yet waited for by the other queue, SUBMISSION_PENDING while it records
+            EnumArray<RHIQueueType, u64> values = {};
+        };
+
+        static constexpr u64 SUBMISSION_PENDING = ~0ull;
+
+        void transition(RHICommandList* cmdList, RHITexture* texture, RenderGraphPassType const type, RenderGraphAccess const access);
+        RHICommandList* switchQueue(RHICommandList* cmdList, RHIQueueType const type);
+        // replace pending values of the queue with its latest submission
+        void resolvePending(RHIQueueType const type);
+
+        std::vector<Pass> m_passes;
+        EnumArray<RendererTarget, Texture> m_textures;
+        std::vector<RenderGraphAliasSlot> m_aliasSlots;
+        std::unordered_map<RHITexture const*, TextureState> m_states;
+
+        bool m_dirty           = true;
+        bool m_asyncCompute    = false;
+        u32 m_barrierCount     = 0;
+        u32 m_queueSwitchCount = 0;
+    };
+
+} // namespace worse
@@ -13,6 +13,7 @@
 
 namespace worse
 {
+    class RenderGraph;
 
     class Renderer
     {
@@ -25,6 +26,11 @@ namespace worse
                          ecs::ResourceArray<TextureWrite> textureWrites,
                          ecs::Resource<AssetServer> assetServer);
 
+        static u64 getFrameCount();
+        // slot of per frame resources in [0, RHIConfig::MAX_FRAMES_IN_FLIGHT)
+        static u32 getFrameIndex();
+        static RendererStatistics const& getStatistics();
+
         // swapchain
         static RHISwapchain* getSwapchain();
         static void blitToBackBuffer(RHICommandList* cmdList);
@@ -33,7 +39,10 @@ namespace worse
 
         static void createMaterialBuffers(std::span<StandardMaterialGPU> materials);
 
+        // writes the bindless slots marked dirty since the last frame
         static void writeBindlessTextures(ecs::ResourceArray<TextureWrite> textureWrites);
+        // texture writes were rebuilt, every slot is written with the next frame
+        static void invalidateBindlessTextures();
 
         static void setViewport(f32 const width, f32 const height);
         static RHIViewport const& getViewport();
@@ -45,10 +54,12 @@ namespace worse
         static RHIBlendState* getBlendState(RendererBlendState const state);
         static RHITexture* getRenderTarget(RendererTarget const target);
         static RHIShader* getShader(RendererShader const shader);
+        static RHIPipelineState const* getPipelineState(RendererPSO const pso);
         static RHITexture* getTexture(RendererTexture const texture);
         static RHISampler* getSampler(RHISamplerType const sampler);
         static Mesh* getStandardMesh(geometry::GeometryType const type);
         static RHIBuffer* getMaterialBuffer();
+        static RenderGraph* getRenderGraph();
 
         static math::Vector2 getResolutionRender();
         static math::Vector2 getResolutionOutput();
@@ -56,6 +67,12 @@ namespace worse
         static void setPushParameters(f32 a, f32 b);
 
     private:
+        // track texture use and on-screen size of the frame, reload, stream
+        // and evict by budget
+        static void updateTextureResidency(ecs::Resource<DrawcallStorage> drawcalls,
+                                           ecs::Resource<Camera> camera,
+                                           ecs::ResourceArray<TextureWrite> textureWrites,
+                                           ecs::Resource<AssetServer> assetServer);
         static void updateBuffers(RHICommandList* cmdList,
                                   ecs::Resource<Camera> camera,
                                   ecs::Resource<GlobalContext> globalContext,
@@ -69,10 +86,21 @@ namespace worse
         static void createDepthStencilStates();
         static void createBlendStates();
         static void createRendererTarget();
+        // create physical textures for render graph alias slots
+        static void allocateRendererTargets();
+        // submit shader compilation jobs, returns immediately
         static void createShaders();
+        // block until every renderer shader finished compiling
+        static void waitForShaders();
+        // poll shader file changes, recompile dependent shaders in the
+        // background and swap them in once ready, call at frame boundary
+        static void reloadShaders();
         static void createTextures();
         static void createSamplers();
         static void createStandardMeshes();
+        // build pass pipeline states against current render targets and
+        // viewport, must be called again after either of them changes
+        static void createPipelineStates();
 
         static void destroyResources();
 
@@ -86,15 +114,20 @@ namespace worse
                                 ecs::Resource<AssetServer> assetServer);
         static void passLight(RHICommandList* cmdList);
         static void passDebugWireFrame(RHICommandList* cmdList, ecs::Resource<DrawcallStorage> drawcalls);
-        static void passBloom(RHICommandList* cmdList);
+        static void passBloomLuminance(RHICommandList* cmdList);
+        static void passBloomDownsample(RHICommandList* cmdList);
+        static void passBloomUpscale(RHICommandList* cmdList);
         static void passPostProcessing(RHICommandList* cmdList);
 
         static void passImGui(RHICommandList* cmdList);
 
-        static void produceFrame(RHICommandList* cmdList,
-                                 ecs::Resource<GlobalContext> globalContext,
-                                 ecs::Resource<DrawcallStorage> drawcalls,
-                                 ecs::Resource<AssetServer> assetServer);
+        static void createRenderGraph();
+
+        // returns the graphics command list that continues the frame
+        static RHICommandList* produceFrame(RHICommandList* cmdList,
+                                            ecs::Resource<GlobalContext> globalContext,
+                                            ecs::Resource<DrawcallStorage> drawcalls,
+                                            ecs::Resource<AssetServer> assetServer);
     };
 
 } // namespace worse
\ No newline at end of file
@@ -53,6 +53,21 @@ namespace worse
         Max
     };
 
+    // pipeline states bound by passes, built once per render target layout
+    enum class RendererPSO : usize
+    {
+        DepthPrepass,
+        DepthLight,
+        GBuffer,
+        Point,
+        Light,
+        WireFrame,
+        BloomLuminance,
+        BloomUpscale,
+        PostFX,
+        Max
+    };
+
     enum class RendererTarget : usize
     {
         // 渲染目标
@@ -107,6 +122,20 @@ namespace worse
     {
         RHITexture* texture;
         usize index;
+        // asset server handle, zero for textures it does not own
+        u64 asset = 0;
+    };
+
+    // averages over the last complete sample window, zero until measured
+    struct RendererStatistics
+    {
+        // frame time with async compute off and on, for comparison
+        f32 frameTimeMs      = 0.0f;
+        f32 frameTimeAsyncMs = 0.0f;
+        // CPU time of updateBuffers and descriptor writes per frame
+        f32 updateBuffersMs      = 0.0f;
+        f32 descriptorWrites     = 0.0f;
+        u32 bindlessTextureCount = 0;
     };
 
 } // namespace worse
\ No newline at end of file
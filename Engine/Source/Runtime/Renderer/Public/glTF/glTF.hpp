@@ -45,19 +45,36 @@ namespace worse
         std::unordered_map<std::string, AssetHandle> textures;
     };
 
+    // 一次导入各阶段的耗时
+    struct glTFLoadStatistics
+    {
+        f32 parseMs          = 0.0f;
+        f32 imageMs          = 0.0f;
+        f32 meshMs           = 0.0f;
+        f32 totalMs          = 0.0f;
+        bool isCached        = false; // 几何体来自烘焙缓存
+        usize imageCount     = 0;
+        usize primitiveCount = 0;
+    };
+
     class glTFManager
     {
     public:
         glTFManager(AssetServer& assetServer);
         ~glTFManager();
 
-        glTFModel* load(std::string const& filepath, std::string const& modelName);
+        /**
+         * @brief 导入 glTF 模型
+         *
+         * @param statistics 非空时写入各阶段耗时
+         * @note 图像解码和图元转换在线程池上并行, 可从多个线程同时导入不同模型
+         */
+        glTFModel* load(std::string const& filepath, std::string const& modelName, glTFLoadStatistics* statistics = nullptr);
 
         glTFModel* getModel(std::string const& modelName);
 
     private:
-        fastgltf::Parser m_parser{};
-        mutable std::mutex m_mtxParser;
+        mutable std::mutex m_mtxModels;
 
         AssetServer& m_assetServer;
 